@@ -0,0 +1,96 @@
+#include "AnimNode_OffsetTurretAim.h"
+#include "TurretAimGeometry.h"
+#include "TurretRotation.h"
+#include "Animation/AnimInstanceProxy.h"
+
+
+DECLARE_CYCLE_STAT( TEXT( "Offset Turret Aim Eval" ), STAT_OffsetTurretAim_Eval, STATGROUP_TurretRotation );
+
+
+FAnimNode_OffsetTurretAim::FAnimNode_OffsetTurretAim()
+	: TargetLocation( FVector::ZeroVector )
+	, TargetLocationSpace( ETurretAimTargetSpace::World )
+	, bLimitYaw( false )
+	, MinYaw( -180.0f )
+	, MaxYaw( 180.0f )
+	, bLimitPitch( false )
+	, MinPitch( -90.0f )
+	, MaxPitch( 90.0f )
+	, LastAimJointRotation( FRotator::ZeroRotator )
+{
+}
+
+void FAnimNode_OffsetTurretAim::GatherDebugData( FNodeDebugData& DebugData )
+{
+	FString DebugLine = DebugData.GetNodeName( this );
+	DebugLine += FString::Printf( TEXT( "(AimJoint: %s, Yaw: %.1f, Pitch: %.1f)" ), *AimJoint.BoneName.ToString(), LastAimJointRotation.Yaw, LastAimJointRotation.Pitch );
+	DebugData.AddDebugItem( DebugLine );
+
+	ComponentPose.GatherDebugData( DebugData );
+}
+
+void FAnimNode_OffsetTurretAim::EvaluateSkeletalControl_AnyThread( FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms )
+{
+	SCOPE_CYCLE_COUNTER( STAT_OffsetTurretAim_Eval );
+	TURRETROTATION_TRACE_SCOPE( OffsetTurretAim_Eval );
+
+	check( OutBoneTransforms.Num() == 0 );
+
+	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+	const FCompactPoseBoneIndex AimJointIndex = AimJoint.GetCompactPoseIndex( BoneContainer );
+
+	const FTransform AimJointTransform = Output.Pose.GetComponentSpaceTransform( AimJointIndex );
+	const FVector BarrelStartLocation = Output.Pose.GetComponentSpaceTransform( BarrelStart.GetCompactPoseIndex( BoneContainer ) ).GetLocation();
+	const FVector BarrelEndLocation = Output.Pose.GetComponentSpaceTransform( BarrelEnd.GetCompactPoseIndex( BoneContainer ) ).GetLocation();
+
+	const FVector TargetComponentLocation = ( TargetLocationSpace == ETurretAimTargetSpace::World )
+		? Output.AnimInstanceProxy->GetComponentTransform().InverseTransformPosition( TargetLocation )
+		: TargetLocation;
+
+	// Everything is un-rotated into the AimJoint's incoming space, the same way SolveForActor un-rotates into the Actor's space.
+	// The component space locations already include any scale, so the geometry doesn't need to scale them again.
+	const FQuat AimJointRotation = AimJointTransform.GetRotation();
+	const FVector AimJointLocation = AimJointTransform.GetLocation();
+	const FVector AimJoint_To_BarrelStart = AimJointRotation.UnrotateVector( BarrelStartLocation - AimJointLocation );
+	const FVector AimJoint_To_BarrelEnd = AimJointRotation.UnrotateVector( BarrelEndLocation - AimJointLocation );
+	const FVector Target_InAimJointSpace = AimJointRotation.UnrotateVector( TargetComponentLocation - AimJointLocation );
+
+	const FTurretAimGeometry Geometry( FVector::ZeroVector, AimJoint_To_BarrelStart, AimJoint_To_BarrelEnd - AimJoint_To_BarrelStart );
+	FTurretSolveStats SolveStats;
+	LastAimJointRotation = ApplyLimits( Geometry.Solve( Target_InAimJointSpace, FTurretAimGeometry::GetSolveSettings(), &SolveStats ) );
+
+	FTransform NewAimJointTransform = AimJointTransform;
+	NewAimJointTransform.SetRotation( AimJointRotation * LastAimJointRotation.Quaternion() );
+	OutBoneTransforms.Add( FBoneTransform( AimJointIndex, NewAimJointTransform ) );
+}
+
+bool FAnimNode_OffsetTurretAim::IsValidToEvaluate( const USkeleton* Skeleton, const FBoneContainer& RequiredBones )
+{
+	return AimJoint.IsValidToEvaluate( RequiredBones )
+		&& BarrelStart.IsValidToEvaluate( RequiredBones )
+		&& BarrelEnd.IsValidToEvaluate( RequiredBones );
+}
+
+void FAnimNode_OffsetTurretAim::InitializeBoneReferences( const FBoneContainer& RequiredBones )
+{
+	AimJoint.Initialize( RequiredBones );
+	BarrelStart.Initialize( RequiredBones );
+	BarrelEnd.Initialize( RequiredBones );
+}
+
+FRotator FAnimNode_OffsetTurretAim::ApplyLimits( const FRotator& AimJointRotation ) const
+{
+	FRotator Result = AimJointRotation;
+
+	if ( bLimitYaw )
+	{
+		Result.Yaw = FMath::Clamp( FRotator::NormalizeAxis( Result.Yaw ), MinYaw, MaxYaw );
+	}
+
+	if ( bLimitPitch )
+	{
+		Result.Pitch = FMath::Clamp( FRotator::NormalizeAxis( Result.Pitch ), MinPitch, MaxPitch );
+	}
+
+	return Result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BoneContainer.h"
+#include "BoneControllers/AnimNode_SkeletalControlBase.h"
+#include "AnimNode_OffsetTurretAim.generated.h"
+
+/** Which space the Offset Turret Aim node's TargetLocation is in. */
+UENUM( BlueprintType )
+enum class ETurretAimTargetSpace : uint8
+{
+	/** World space.  Converted to component space with the mesh component's transform (cached by the anim instance proxy). */
+	World,
+
+	/** The skeletal mesh component's space. */
+	Component,
+};
+
+/**
+ * Aims a skeletal mesh turret at a target during animation evaluation, so the solve runs on the animation worker threads
+ * instead of on the game thread, and uses this frame's pose instead of last frame's.
+ *
+ * The AimJoint/BarrelStart/BarrelEnd locations are read from the component space pose every evaluation, so any animation on the
+ * barrel (recoil, for example) is taken into account.  BarrelStart and BarrelEnd should be children of the AimJoint.
+ *
+ * The AimJoint's incoming rotation is treated as the turret's "unrotated" rotation (like the Actor's rotation is for
+ * CalculateTurretRotation_ForActor), and the solved yaw/pitch are added on top of it.  Alpha blends from the incoming pose.
+ */
+USTRUCT( BlueprintInternalUseOnly )
+struct TURRETROTATION_API FAnimNode_OffsetTurretAim : public FAnimNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+public:
+	FAnimNode_OffsetTurretAim();
+
+	/** The bone that rotates to aim the turret. */
+	UPROPERTY( EditAnywhere, Category = "Skeletal Control" )
+	FBoneReference AimJoint;
+
+	/** A bone at the back of the barrel (where projectiles start traveling along the barrel). */
+	UPROPERTY( EditAnywhere, Category = "Skeletal Control" )
+	FBoneReference BarrelStart;
+
+	/** A bone at the end of the barrel (where projectiles leave the barrel). */
+	UPROPERTY( EditAnywhere, Category = "Skeletal Control" )
+	FBoneReference BarrelEnd;
+
+	/** The location to aim at. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Target", meta = ( PinShownByDefault ) )
+	FVector TargetLocation;
+
+	/** Which space TargetLocation is in. */
+	UPROPERTY( EditAnywhere, Category = "Target" )
+	ETurretAimTargetSpace TargetLocationSpace;
+
+	/** If true, then the solved yaw is clamped to MinYaw/MaxYaw. */
+	UPROPERTY( EditAnywhere, Category = "Limits" )
+	bool bLimitYaw;
+
+	/** Smallest yaw (in degrees) the AimJoint can turn to. */
+	UPROPERTY( EditAnywhere, Category = "Limits", meta = ( EditCondition = "bLimitYaw", ClampMin = "-180.0", ClampMax = "180.0" ) )
+	float MinYaw;
+
+	/** Largest yaw (in degrees) the AimJoint can turn to. */
+	UPROPERTY( EditAnywhere, Category = "Limits", meta = ( EditCondition = "bLimitYaw", ClampMin = "-180.0", ClampMax = "180.0" ) )
+	float MaxYaw;
+
+	/** If true, then the solved pitch is clamped to MinPitch/MaxPitch. */
+	UPROPERTY( EditAnywhere, Category = "Limits" )
+	bool bLimitPitch;
+
+	/** Smallest pitch (in degrees) the AimJoint can turn to. */
+	UPROPERTY( EditAnywhere, Category = "Limits", meta = ( EditCondition = "bLimitPitch", ClampMin = "-180.0", ClampMax = "180.0" ) )
+	float MinPitch;
+
+	/** Largest pitch (in degrees) the AimJoint can turn to. */
+	UPROPERTY( EditAnywhere, Category = "Limits", meta = ( EditCondition = "bLimitPitch", ClampMin = "-180.0", ClampMax = "180.0" ) )
+	float MaxPitch;
+
+	/** The yaw/pitch (relative to the incoming pose) from the last evaluation, after the limits.  For debugging. */
+	FRotator LastAimJointRotation;
+
+	// FAnimNode_Base interface
+	virtual void GatherDebugData( FNodeDebugData& DebugData ) override;
+
+	// FAnimNode_SkeletalControlBase interface
+	virtual void EvaluateSkeletalControl_AnyThread( FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms ) override;
+	virtual bool IsValidToEvaluate( const USkeleton* Skeleton, const FBoneContainer& RequiredBones ) override;
+
+private:
+	// FAnimNode_SkeletalControlBase interface
+	virtual void InitializeBoneReferences( const FBoneContainer& RequiredBones ) override;
+
+	/** @return Returns the rotation clamped to the yaw/pitch limits. */
+	FRotator ApplyLimits( const FRotator& AimJointRotation ) const;
+};
@@ -0,0 +1,58 @@
+#include "TurretAimCache.h"
+
+
+FTurretAimCache::FTurretAimCache()
+	: LastActorLocation( FVector::ZeroVector )
+	, LastActorRotation( FQuat::Identity )
+	, LastTargetWorldLocation( FVector::ZeroVector )
+	, LastAimJointRotation( FRotator::ZeroRotator )
+	, bHasResult( false )
+	, NumHits( 0 )
+	, NumMisses( 0 )
+{
+}
+
+bool FTurretAimCache::TryGetCachedResult(
+	const FTransform& ActorWorldTransform,
+	const FVector& TargetWorldLocation,
+	float PositionEpsilon,
+	float AngleEpsilonDegrees,
+	FRotator& Out_AimJointRotation )
+{
+	const float PositionEpsilonSquared = FMath::Square( PositionEpsilon );
+
+	const bool bCanUseResult = bHasResult
+		&& FVector::DistSquared( TargetWorldLocation, LastTargetWorldLocation ) <= PositionEpsilonSquared
+		&& FVector::DistSquared( ActorWorldTransform.GetLocation(), LastActorLocation ) <= PositionEpsilonSquared
+		&& FMath::RadiansToDegrees( ActorWorldTransform.GetRotation().AngularDistance( LastActorRotation ) ) <= AngleEpsilonDegrees;
+
+	if ( !bCanUseResult )
+	{
+		++NumMisses;
+		return false;
+	}
+
+	++NumHits;
+	Out_AimJointRotation = LastAimJointRotation;
+	return true;
+}
+
+void FTurretAimCache::Store( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FRotator& AimJointRotation )
+{
+	LastActorLocation = ActorWorldTransform.GetLocation();
+	LastActorRotation = ActorWorldTransform.GetRotation();
+	LastTargetWorldLocation = TargetWorldLocation;
+	LastAimJointRotation = AimJointRotation;
+	bHasResult = true;
+}
+
+void FTurretAimCache::Invalidate()
+{
+	bHasResult = false;
+}
+
+void FTurretAimCache::ResetCounters()
+{
+	NumHits = 0;
+	NumMisses = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Remembers the inputs and result of a turret's last solve, so the solve can be skipped while nothing has meaningfully changed.
+ *
+ * Idle turrets, and turrets tracking slow targets, end up solving for (almost) the same inputs every frame.  With this cache, a new
+ * solve only happens once the Actor or the target has moved further than PositionEpsilon, or the Actor has rotated by more than
+ * AngleEpsilonDegrees, since the last solve.  Comparing against the last solve (instead of the last frame) means slow movement can't
+ * sneak past the epsilons a little bit at a time.
+ *
+ * Hits/misses are counted so the epsilons can be tuned against the CPU saved.
+ */
+struct TURRETROTATION_API FTurretAimCache
+{
+public:
+	FTurretAimCache();
+
+	/**
+	 * Checks if the last result can be reused for the given inputs.  Counts a hit or a miss.
+	 *
+	 * @param ActorWorldTransform		The Actor's current world transform.
+	 * @param TargetWorldLocation		The target's current location in world space.
+	 * @param PositionEpsilon			How far (in world units) the Actor or the target can move before a new solve is needed.
+	 * @param AngleEpsilonDegrees		How far (in degrees) the Actor can rotate before a new solve is needed.
+	 * @param Out_AimJointRotation		OUT - The cached rotation, only set if this returns true.
+	 * @return Returns true if the cached result can be used, otherwise false (and the turret needs to be solved).
+	 */
+	bool TryGetCachedResult(
+		const FTransform& ActorWorldTransform,
+		const FVector& TargetWorldLocation,
+		float PositionEpsilon,
+		float AngleEpsilonDegrees,
+		FRotator& Out_AimJointRotation );
+
+	/**
+	 * Stores the inputs and result of a new solve.
+	 *
+	 * @param ActorWorldTransform		The Actor's world transform that was solved for.
+	 * @param TargetWorldLocation		The target's location that was solved for.
+	 * @param AimJointRotation			The result of the solve.
+	 */
+	void Store( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FRotator& AimJointRotation );
+
+	/** Forces the next TryGetCachedResult to miss.  Needed whenever the turret's geometry changes. */
+	void Invalidate();
+
+	/** Sets the hit/miss counters back to 0. */
+	void ResetCounters();
+
+	/** @return Returns how many times the cached result was used. */
+	int64 GetNumHits() const { return NumHits; }
+
+	/** @return Returns how many times a new solve was needed. */
+	int64 GetNumMisses() const { return NumMisses; }
+
+private:
+	/** Inputs of the last solve. */
+	FVector LastActorLocation;
+	FQuat LastActorRotation;
+	FVector LastTargetWorldLocation;
+
+	/** Result of the last solve. */
+	FRotator LastAimJointRotation;
+
+	bool bHasResult;
+
+	int64 NumHits;
+	int64 NumMisses;
+};
@@ -0,0 +1,699 @@
+#include "TurretAimCapture.h"
+#include "TurretRotation.h"
+#include "TurretRotationFunctionLibrary.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+
+
+namespace
+{
+	/** A multiple of the page size on every platform we run on. */
+	const uint32 CaptureChunkAlignment = 65536;
+
+	/** Alignment of every array inside a chunk. */
+	const int32 CaptureArrayAlignment = 16;
+
+	/** @return Returns the size of a frame with the given number of targets and turrets, including its padding. */
+	int64 GetCaptureFrameBytes( uint32 NumTargets, uint32 NumTurrets )
+	{
+		return sizeof( FTurretCaptureFrameHeader )
+			+ Align( int64( NumTargets ) * sizeof( FVector ), CaptureArrayAlignment )
+			+ ( int64( NumTurrets ) * sizeof( FTurretCaptureTurret ) );
+	}
+}
+
+
+FTurretCaptureWriter::FTurretCaptureWriter( int32 InFramesPerChunk )
+	: FramesPerChunk( FMath::Max( InFramesPerChunk, 1 ) )
+	, NumBytesWritten( 0 )
+	, NumFrames( 0 )
+	, NumFramesInChunk( 0 )
+	, bInFrame( false )
+{
+	FMemory::Memzero( FrameHeader );
+}
+
+FTurretCaptureWriter::~FTurretCaptureWriter()
+{
+	Close();
+}
+
+bool FTurretCaptureWriter::Open( const FString& Filename )
+{
+	Close();
+
+	IFileManager::Get().MakeDirectory( *FPaths::GetPath( Filename ), /*Tree*/ true );
+	File.Reset( IFileManager::Get().CreateFileWriter( *Filename ) );
+	if ( !File.IsValid() )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "Couldn't create the turret capture file %s" ), *Filename );
+		return false;
+	}
+
+	NumBytesWritten = 0;
+	NumFrames = 0;
+
+	FTurretCaptureFileHeader Header;
+	FMemory::Memzero( Header );
+	Header.Magic = TURRET_CAPTURE_FILE_MAGIC;
+	Header.Version = TURRET_CAPTURE_VERSION;
+	Header.ChunkAlignment = CaptureChunkAlignment;
+	WriteBytes( &Header, sizeof( Header ) );
+	PadFile( CaptureChunkAlignment );
+
+	return true;
+}
+
+void FTurretCaptureWriter::Close()
+{
+	if ( !File.IsValid() )
+	{
+		return;
+	}
+
+	if ( bInFrame )
+	{
+		EndFrame();
+	}
+
+	FlushChunk();
+	File->Close();
+	File.Reset();
+}
+
+void FTurretCaptureWriter::BeginFrame( uint64 FrameNumber, float DeltaSeconds )
+{
+	check( !bInFrame );
+	bInFrame = true;
+
+	FMemory::Memzero( FrameHeader );
+	FrameHeader.FrameNumber = FrameNumber;
+	FrameHeader.DeltaSeconds = DeltaSeconds;
+
+	FrameTargets.Reset();
+	FrameTargetIndices.Reset();
+	FrameTurrets.Reset();
+}
+
+void FTurretCaptureWriter::AddTurret(
+	uint32 TurretId,
+	const FTransform& ActorWorldTransform,
+	const FVector& Actor_To_AimJoint,
+	const FVector& AimJoint_To_BarrelStart,
+	const FVector& BarrelStart_To_BarrelEnd,
+	const FVector& TargetWorldLocation,
+	const FRotator& AimJointRotation )
+{
+	check( bInFrame );
+
+	// A turret's geometry hardly ever changes, so it's only stored again when it does.
+	const int32* ExistingGeometryIndex = ChunkGeometryIndices.Find( TurretId );
+	const bool bSameGeometry = ExistingGeometryIndex
+		&& ChunkGeometries[*ExistingGeometryIndex].Actor_To_AimJoint == Actor_To_AimJoint
+		&& ChunkGeometries[*ExistingGeometryIndex].AimJoint_To_BarrelStart == AimJoint_To_BarrelStart
+		&& ChunkGeometries[*ExistingGeometryIndex].BarrelStart_To_BarrelEnd == BarrelStart_To_BarrelEnd;
+
+	int32 GeometryIndex = bSameGeometry ? *ExistingGeometryIndex : INDEX_NONE;
+	if ( !bSameGeometry )
+	{
+		FTurretCaptureGeometry Geometry;
+		Geometry.Actor_To_AimJoint = Actor_To_AimJoint;
+		Geometry.AimJoint_To_BarrelStart = AimJoint_To_BarrelStart;
+		Geometry.BarrelStart_To_BarrelEnd = BarrelStart_To_BarrelEnd;
+
+		GeometryIndex = ChunkGeometries.Add( Geometry );
+		ChunkGeometryIndices.Add( TurretId, GeometryIndex );
+	}
+
+	int32 TargetIndex = INDEX_NONE;
+	if ( const int32* ExistingTargetIndex = FrameTargetIndices.Find( TargetWorldLocation ) )
+	{
+		TargetIndex = *ExistingTargetIndex;
+	}
+	else
+	{
+		TargetIndex = FrameTargets.Add( TargetWorldLocation );
+		FrameTargetIndices.Add( TargetWorldLocation, TargetIndex );
+	}
+
+	// Zeroed first, so whatever padding the compiler might add is always written out the same way.
+	FTurretCaptureTurret Turret;
+	FMemory::Memzero( Turret );
+	Turret.ActorRotation = ActorWorldTransform.GetRotation();
+	Turret.ActorLocation = ActorWorldTransform.GetLocation();
+	Turret.ActorScale = ActorWorldTransform.GetScale3D();
+	Turret.AimJointRotation = AimJointRotation;
+	Turret.TurretId = TurretId;
+	Turret.GeometryIndex = GeometryIndex;
+	Turret.TargetIndex = TargetIndex;
+	FrameTurrets.Add( Turret );
+}
+
+void FTurretCaptureWriter::EndFrame()
+{
+	check( bInFrame );
+	bInFrame = false;
+
+	FrameHeader.NumTargets = FrameTargets.Num();
+	FrameHeader.NumTurrets = FrameTurrets.Num();
+	FrameHeader.FrameBytes = static_cast<uint32>( GetCaptureFrameBytes( FrameHeader.NumTargets, FrameHeader.NumTurrets ) );
+
+	AppendBytes( ChunkFrameBytes, &FrameHeader, 1 );
+	AppendBytes( ChunkFrameBytes, FrameTargets.GetData(), FrameTargets.Num() );
+	PadBytes( ChunkFrameBytes, CaptureArrayAlignment );
+	AppendBytes( ChunkFrameBytes, FrameTurrets.GetData(), FrameTurrets.Num() );
+
+	++NumFrames;
+	++NumFramesInChunk;
+	if ( NumFramesInChunk >= FramesPerChunk )
+	{
+		FlushChunk();
+	}
+}
+
+void FTurretCaptureWriter::FlushChunk()
+{
+	if ( NumFramesInChunk == 0 || !File.IsValid() )
+	{
+		return;
+	}
+
+	FTurretCaptureChunkHeader Header;
+	FMemory::Memzero( Header );
+	Header.Magic = TURRET_CAPTURE_CHUNK_MAGIC;
+	Header.NumFrames = NumFramesInChunk;
+	Header.NumGeometries = ChunkGeometries.Num();
+	Header.GeometriesOffset = Align( sizeof( FTurretCaptureChunkHeader ), CaptureArrayAlignment );
+	Header.FramesOffset = Align( Header.GeometriesOffset + ( ChunkGeometries.Num() * sizeof( FTurretCaptureGeometry ) ), CaptureArrayAlignment );
+	Header.ChunkBytes = Align( Header.FramesOffset + ChunkFrameBytes.Num(), CaptureChunkAlignment );
+
+	// Chunks always start aligned, so aligning the file also aligns within the chunk.
+	WriteBytes( &Header, sizeof( Header ) );
+	PadFile( CaptureArrayAlignment );
+	WriteBytes( ChunkGeometries.GetData(), ChunkGeometries.Num() * sizeof( FTurretCaptureGeometry ) );
+	PadFile( CaptureArrayAlignment );
+	WriteBytes( ChunkFrameBytes.GetData(), ChunkFrameBytes.Num() );
+	PadFile( CaptureChunkAlignment );
+
+	ChunkFrameBytes.Reset();
+	NumFramesInChunk = 0;
+	ChunkGeometries.Reset();
+	ChunkGeometryIndices.Reset();
+}
+
+void FTurretCaptureWriter::WriteBytes( const void* Data, int64 NumBytes )
+{
+	if ( NumBytes > 0 )
+	{
+		File->Serialize( const_cast<void*>( Data ), NumBytes );
+		NumBytesWritten += NumBytes;
+	}
+}
+
+void FTurretCaptureWriter::PadFile( int64 Alignment )
+{
+	static const uint8 Zeros[1024] = {};
+
+	int64 NumPaddingBytes = Align( NumBytesWritten, Alignment ) - NumBytesWritten;
+	while ( NumPaddingBytes > 0 )
+	{
+		const int64 NumBytes = FMath::Min<int64>( NumPaddingBytes, sizeof( Zeros ) );
+		WriteBytes( Zeros, NumBytes );
+		NumPaddingBytes -= NumBytes;
+	}
+}
+
+void FTurretCaptureWriter::PadBytes( TArray<uint8>& Bytes, int32 Alignment )
+{
+	Bytes.AddZeroed( Align( Bytes.Num(), Alignment ) - Bytes.Num() );
+}
+
+
+FTurretCaptureReader::FTurretCaptureReader()
+	: FirstChunkOffset( 0 )
+{
+}
+
+FTurretCaptureReader::~FTurretCaptureReader()
+{
+	Close();
+}
+
+bool FTurretCaptureReader::Open( const FString& Filename )
+{
+	Close();
+
+	File.Reset( IFileManager::Get().CreateFileReader( *Filename ) );
+	if ( !File.IsValid() )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "Couldn't open the turret capture file %s" ), *Filename );
+		return false;
+	}
+
+	FTurretCaptureFileHeader Header;
+	if ( File->TotalSize() < int64( sizeof( Header ) ) )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "%s is too small to be a turret capture" ), *Filename );
+		Close();
+		return false;
+	}
+
+	File->Serialize( &Header, sizeof( Header ) );
+	if ( Header.Magic != TURRET_CAPTURE_FILE_MAGIC || Header.Version != TURRET_CAPTURE_VERSION || Header.ChunkAlignment < CaptureArrayAlignment )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "%s isn't a version %d turret capture" ), *Filename, TURRET_CAPTURE_VERSION );
+		Close();
+		return false;
+	}
+
+	FirstChunkOffset = Align( int64( sizeof( Header ) ), int64( Header.ChunkAlignment ) );
+	File->Seek( FirstChunkOffset );
+	return true;
+}
+
+void FTurretCaptureReader::Close()
+{
+	File.Reset();
+	ChunkBytes.Empty();
+	Geometries = TArrayView<const FTurretCaptureGeometry>();
+	FrameOffsets.Empty();
+}
+
+void FTurretCaptureReader::Rewind()
+{
+	ChunkBytes.Reset();
+	Geometries = TArrayView<const FTurretCaptureGeometry>();
+	FrameOffsets.Reset();
+
+	if ( File.IsValid() )
+	{
+		File->Seek( FirstChunkOffset );
+	}
+}
+
+bool FTurretCaptureReader::ReadNextChunk()
+{
+	ChunkBytes.Reset();
+	Geometries = TArrayView<const FTurretCaptureGeometry>();
+	FrameOffsets.Reset();
+
+	if ( !File.IsValid() )
+	{
+		return false;
+	}
+
+	const int64 ChunkOffset = File->Tell();
+	const int64 NumBytesLeft = File->TotalSize() - ChunkOffset;
+	if ( NumBytesLeft < int64( sizeof( FTurretCaptureChunkHeader ) ) )
+	{
+		return false;
+	}
+
+	FTurretCaptureChunkHeader Header;
+	File->Serialize( &Header, sizeof( Header ) );
+	if ( Header.Magic != TURRET_CAPTURE_CHUNK_MAGIC || Header.ChunkBytes < sizeof( Header ) || Header.ChunkBytes > uint64( NumBytesLeft ) || Header.ChunkBytes > MAX_int32 )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "The turret capture chunk at offset %lld is corrupt" ), ChunkOffset );
+		return false;
+	}
+
+	// The header was already read, so just copy it in, and read the rest of the chunk after it.
+	ChunkBytes.SetNumUninitialized( static_cast<int32>( Header.ChunkBytes ) );
+	FMemory::Memcpy( ChunkBytes.GetData(), &Header, sizeof( Header ) );
+	File->Serialize( ChunkBytes.GetData() + sizeof( Header ), Header.ChunkBytes - sizeof( Header ) );
+
+	if ( !IndexChunk() )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "The turret capture chunk at offset %lld is corrupt" ), ChunkOffset );
+		ChunkBytes.Reset();
+		Geometries = TArrayView<const FTurretCaptureGeometry>();
+		FrameOffsets.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FTurretCaptureReader::IndexChunk()
+{
+	const uint8* Base = ChunkBytes.GetData();
+	const uint64 NumChunkBytes = ChunkBytes.Num();
+	const FTurretCaptureChunkHeader& Header = *reinterpret_cast<const FTurretCaptureChunkHeader*>( Base );
+
+	if ( Header.GeometriesOffset % CaptureArrayAlignment != 0 || Header.FramesOffset % CaptureArrayAlignment != 0
+		|| Header.GeometriesOffset + ( uint64( Header.NumGeometries ) * sizeof( FTurretCaptureGeometry ) ) > NumChunkBytes
+		|| Header.FramesOffset > NumChunkBytes )
+	{
+		return false;
+	}
+
+	Geometries = TArrayView<const FTurretCaptureGeometry>( reinterpret_cast<const FTurretCaptureGeometry*>( Base + Header.GeometriesOffset ), Header.NumGeometries );
+
+	// Everything is checked once here, so replaying never has to.
+	uint64 FrameOffset = Header.FramesOffset;
+	for ( uint32 FrameIndex = 0; FrameIndex < Header.NumFrames; ++FrameIndex )
+	{
+		if ( FrameOffset + sizeof( FTurretCaptureFrameHeader ) > NumChunkBytes )
+		{
+			return false;
+		}
+
+		const FTurretCaptureFrameHeader& FrameHeader = *reinterpret_cast<const FTurretCaptureFrameHeader*>( Base + FrameOffset );
+		if ( FrameHeader.FrameBytes != GetCaptureFrameBytes( FrameHeader.NumTargets, FrameHeader.NumTurrets ) || FrameOffset + FrameHeader.FrameBytes > NumChunkBytes )
+		{
+			return false;
+		}
+
+		FrameOffsets.Add( FrameOffset );
+
+		const FTurretCaptureFrame Frame = GetFrame( FrameOffsets.Num() - 1 );
+		for ( const FTurretCaptureTurret& Turret : Frame.Turrets )
+		{
+			if ( !Geometries.IsValidIndex( Turret.GeometryIndex ) || !Frame.Targets.IsValidIndex( Turret.TargetIndex ) )
+			{
+				return false;
+			}
+		}
+
+		FrameOffset += FrameHeader.FrameBytes;
+	}
+
+	return true;
+}
+
+FTurretCaptureFrame FTurretCaptureReader::GetFrame( int32 Index ) const
+{
+	const uint8* FrameBase = ChunkBytes.GetData() + FrameOffsets[Index];
+	const FTurretCaptureFrameHeader* Header = reinterpret_cast<const FTurretCaptureFrameHeader*>( FrameBase );
+
+	const uint8* TargetsBase = FrameBase + sizeof( FTurretCaptureFrameHeader );
+	const uint8* TurretsBase = TargetsBase + Align( int64( Header->NumTargets ) * sizeof( FVector ), CaptureArrayAlignment );
+
+	FTurretCaptureFrame Frame;
+	Frame.Header = Header;
+	Frame.Targets = TArrayView<const FVector>( reinterpret_cast<const FVector*>( TargetsBase ), Header->NumTargets );
+	Frame.Turrets = TArrayView<const FTurretCaptureTurret>( reinterpret_cast<const FTurretCaptureTurret*>( TurretsBase ), Header->NumTurrets );
+	return Frame;
+}
+
+
+FTurretReplayStats::FTurretReplayStats()
+	: NumFrames( 0 )
+	, NumSolves( 0 )
+	, SolveSeconds( 0.0 )
+	, P50FrameSeconds( 0.0 )
+	, P99FrameSeconds( 0.0 )
+	, MaxFrameSeconds( 0.0 )
+	, MaxDeviationDegrees( 0.0f )
+{
+}
+
+bool FTurretCaptureReplay::Run( const FString& Filename, bool bUseParallelFor, int32 ParallelChunkSize, FTurretReplayStats& Out_Stats )
+{
+	Out_Stats = FTurretReplayStats();
+
+	FTurretCaptureReader Reader;
+	if ( !Reader.Open( Filename ) )
+	{
+		return false;
+	}
+
+	const int32 ChunkSize = FMath::Max( ParallelChunkSize, 1 );
+	const FTurretSolveSettings SolveSettings = FTurretAimGeometry::GetSolveSettings();
+
+	TArray<double> FrameSeconds;
+	TArray<FTransform> ActorWorldTransforms;
+	TArray<FRotator> AimJointRotations;
+
+	while ( Reader.ReadNextChunk() )
+	{
+		const TArrayView<const FTurretCaptureGeometry> Geometries = Reader.GetGeometries();
+
+		for ( int32 FrameIndex = 0; FrameIndex < Reader.GetNumFrames(); ++FrameIndex )
+		{
+			const FTurretCaptureFrame Frame = Reader.GetFrame( FrameIndex );
+			const int32 NumTurrets = Frame.Turrets.Num();
+
+			// Building the transforms is part of reading the file, not of solving, so it's done before the timer starts.
+			ActorWorldTransforms.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+			AimJointRotations.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+			for ( int32 Index = 0; Index < NumTurrets; ++Index )
+			{
+				const FTurretCaptureTurret& Turret = Frame.Turrets[Index];
+				ActorWorldTransforms[Index] = FTransform( Turret.ActorRotation, Turret.ActorLocation, Turret.ActorScale );
+			}
+
+			auto SolveTurrets = [&Frame, &Geometries, &ActorWorldTransforms, &AimJointRotations, &SolveSettings]( int32 StartIndex, int32 EndIndex )
+			{
+				FTurretSolveStats SolveStats;
+				for ( int32 Index = StartIndex; Index < EndIndex; ++Index )
+				{
+					const FTurretCaptureTurret& Turret = Frame.Turrets[Index];
+					const FTurretCaptureGeometry& Geometry = Geometries[Turret.GeometryIndex];
+
+					UTurretRotationFunctionLibrary::CalculateTurretRotation_ForActor(
+						ActorWorldTransforms[Index],
+						Geometry.Actor_To_AimJoint,
+						Geometry.AimJoint_To_BarrelStart,
+						Geometry.BarrelStart_To_BarrelEnd,
+						Frame.Targets[Turret.TargetIndex],
+						AimJointRotations[Index],
+						SolveSettings,
+						&SolveStats );
+				}
+			};
+
+			const double StartTime = FPlatformTime::Seconds();
+			if ( bUseParallelFor )
+			{
+				const int32 NumChunks = FMath::DivideAndRoundUp( NumTurrets, ChunkSize );
+				ParallelFor( NumChunks, [&SolveTurrets, NumTurrets, ChunkSize]( int32 ChunkIndex )
+				{
+					const int32 StartIndex = ChunkIndex * ChunkSize;
+					SolveTurrets( StartIndex, FMath::Min( StartIndex + ChunkSize, NumTurrets ) );
+				} );
+			}
+			else
+			{
+				SolveTurrets( 0, NumTurrets );
+			}
+			const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+			FrameSeconds.Add( Seconds );
+			Out_Stats.SolveSeconds += Seconds;
+			Out_Stats.NumSolves += NumTurrets;
+			++Out_Stats.NumFrames;
+
+			for ( int32 Index = 0; Index < NumTurrets; ++Index )
+			{
+				const FRotator& Captured = Frame.Turrets[Index].AimJointRotation;
+				const FRotator& Replayed = AimJointRotations[Index];
+				const float Deviation = FMath::Max(
+					FMath::Abs( FRotator::NormalizeAxis( Replayed.Yaw - Captured.Yaw ) ),
+					FMath::Abs( FRotator::NormalizeAxis( Replayed.Pitch - Captured.Pitch ) ) );
+				Out_Stats.MaxDeviationDegrees = FMath::Max( Out_Stats.MaxDeviationDegrees, Deviation );
+			}
+		}
+	}
+
+	if ( FrameSeconds.Num() > 0 )
+	{
+		FrameSeconds.Sort();
+
+		const int32 LastIndex = FrameSeconds.Num() - 1;
+		Out_Stats.P50FrameSeconds = FrameSeconds[LastIndex / 2];
+		Out_Stats.P99FrameSeconds = FrameSeconds[FMath::Clamp( FMath::CeilToInt( FrameSeconds.Num() * 0.99f ) - 1, 0, LastIndex )];
+		Out_Stats.MaxFrameSeconds = FrameSeconds[LastIndex];
+	}
+
+	return true;
+}
+
+bool FTurretCaptureReplay::RunAndLog( const FString& Filename, float MaxDeviationDegrees )
+{
+	FTurretReplayStats SingleThreadedStats;
+	FTurretReplayStats ParallelStats;
+	if ( !Run( Filename, /*bUseParallelFor*/ false, 64, SingleThreadedStats ) || !Run( Filename, /*bUseParallelFor*/ true, 64, ParallelStats ) )
+	{
+		return false;
+	}
+
+	UE_LOG( LogTurretRotation, Display, TEXT( "[Replay %s] %d frames, %lld solves (%.1f per frame)" ),
+		*FPaths::GetCleanFilename( Filename ),
+		SingleThreadedStats.NumFrames,
+		SingleThreadedStats.NumSolves,
+		double( SingleThreadedStats.NumSolves ) / FMath::Max( 1, SingleThreadedStats.NumFrames ) );
+
+	for ( const FTurretReplayStats* Stats : { &SingleThreadedStats, &ParallelStats } )
+	{
+		UE_LOG( LogTurretRotation, Display, TEXT( "    %s: %.2f Msolves/s, p50: %.3f ms/frame, p99: %.3f ms/frame, max: %.3f ms/frame, max deviation: %.5f degrees" ),
+			Stats == &SingleThreadedStats ? TEXT( "Single threaded" ) : TEXT( "ParallelFor    " ),
+			Stats->NumSolves / FMath::Max( Stats->SolveSeconds, 1.e-9 ) / 1.e6,
+			Stats->P50FrameSeconds * 1000.0,
+			Stats->P99FrameSeconds * 1000.0,
+			Stats->MaxFrameSeconds * 1000.0,
+			Stats->MaxDeviationDegrees );
+	}
+
+	const bool bPassed = FMath::Max( SingleThreadedStats.MaxDeviationDegrees, ParallelStats.MaxDeviationDegrees ) <= MaxDeviationDegrees;
+	UE_LOG( LogTurretRotation, Display, TEXT( "    Deviation within %.3f degrees: %s" ), MaxDeviationDegrees, bPassed ? TEXT( "passed" ) : TEXT( "FAILED" ) );
+	return bPassed;
+}
+
+bool FTurretCaptureReplay::WriteSyntheticCapture( const FString& Filename, int32 NumTurrets, int32 NumFrames )
+{
+	FTurretCaptureWriter Writer;
+	if ( !Writer.Open( Filename ) )
+	{
+		return false;
+	}
+
+	FRandomStream Random( 20 );
+
+	// Turrets are placed in groups of 16 around a shared point, and every group shares a handful of targets.
+	const int32 TurretsPerGroup = 16;
+	const int32 TargetsPerGroup = 4;
+	const int32 NumGroups = FMath::DivideAndRoundUp( NumTurrets, TurretsPerGroup );
+	const int32 GroupsPerRow = FMath::Max( 1, FMath::CeilToInt( FMath::Sqrt( float( NumGroups ) ) ) );
+	const float GroupSpacing = 10000.0f;
+	const float DeltaSeconds = 1.0f / 60.0f;
+
+	struct FSyntheticTurret
+	{
+		FTransform ActorWorldTransform;
+		FTurretCaptureGeometry Geometry;
+		float YawSpeed;
+	};
+
+	TArray<FSyntheticTurret> Turrets;
+	for ( int32 Index = 0; Index < NumTurrets; ++Index )
+	{
+		const int32 Group = Index / TurretsPerGroup;
+		const FVector GroupCenter( ( Group % GroupsPerRow ) * GroupSpacing, ( Group / GroupsPerRow ) * GroupSpacing, 0.0f );
+
+		// A quarter of them sit on something that turns.
+		FSyntheticTurret Turret;
+		Turret.ActorWorldTransform = FTransform(
+			FRotator( 0.0f, Random.FRandRange( -180.0f, 180.0f ), 0.0f ),
+			GroupCenter + FVector( Random.FRandRange( -2000.0f, 2000.0f ), Random.FRandRange( -2000.0f, 2000.0f ), Random.FRandRange( 0.0f, 200.0f ) ),
+			FVector( Random.FRandRange( 0.5f, 2.0f ) ) );
+		Turret.Geometry.Actor_To_AimJoint = FVector( 0.0f, 0.0f, Random.FRandRange( 50.0f, 200.0f ) );
+		Turret.Geometry.AimJoint_To_BarrelStart = FVector( Random.FRandRange( 0.0f, 50.0f ), Random.FRandRange( -30.0f, 30.0f ), Random.FRandRange( -50.0f, 50.0f ) );
+		Turret.Geometry.BarrelStart_To_BarrelEnd = FVector( Random.FRandRange( 50.0f, 300.0f ), 0.0f, Random.FRandRange( -20.0f, 20.0f ) );
+		Turret.YawSpeed = ( Index % 4 == 0 ) ? Random.FRandRange( -45.0f, 45.0f ) : 0.0f;
+		Turrets.Add( Turret );
+	}
+
+	TArray<FVector> TargetStarts;
+	TArray<FVector> TargetVelocities;
+	for ( int32 Index = 0; Index < NumGroups * TargetsPerGroup; ++Index )
+	{
+		const int32 Group = Index / TargetsPerGroup;
+		const FVector GroupCenter( ( Group % GroupsPerRow ) * GroupSpacing, ( Group / GroupsPerRow ) * GroupSpacing, 0.0f );
+		const FVector Direction = FVector( Random.FRandRange( -1.0f, 1.0f ), Random.FRandRange( -1.0f, 1.0f ), 0.0f ).GetSafeNormal();
+
+		TargetStarts.Add( GroupCenter - ( Direction * 4000.0f ) + FVector( 0.0f, 0.0f, Random.FRandRange( 0.0f, 1000.0f ) ) );
+		TargetVelocities.Add( Direction * Random.FRandRange( 1000.0f, 3000.0f ) );
+	}
+
+	for ( int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex )
+	{
+		const float Time = FrameIndex * DeltaSeconds;
+		Writer.BeginFrame( FrameIndex, DeltaSeconds );
+
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			FSyntheticTurret& Turret = Turrets[Index];
+			Turret.ActorWorldTransform.ConcatenateRotation( FRotator( 0.0f, Turret.YawSpeed * DeltaSeconds, 0.0f ).Quaternion() );
+
+			// Most turrets track their group's targets, which cross the group in bursts (and then loop back around).  Every eighth
+			// turret has a target hugging its AimJoint instead, now and then sitting right on it.
+			FVector TargetWorldLocation;
+			if ( Index % 8 == 7 )
+			{
+				const FVector AimJointWorldLocation = Turret.ActorWorldTransform.TransformPosition( Turret.Geometry.Actor_To_AimJoint );
+				const float Radius = ( FrameIndex % 30 == 0 ) ? 0.0f : 20.0f + ( 100.0f * FMath::Abs( FMath::Sin( Time + Index ) ) );
+				TargetWorldLocation = AimJointWorldLocation + FVector( FMath::Cos( Time * 3.0f ) * Radius, FMath::Sin( Time * 3.0f ) * Radius, FMath::Sin( Time ) * Radius );
+			}
+			else
+			{
+				const int32 Target = ( ( Index / TurretsPerGroup ) * TargetsPerGroup ) + ( Index % TargetsPerGroup );
+				const float BurstTime = FMath::Fmod( Time + ( Target * 0.37f ), 8000.0f / TargetVelocities[Target].Size() );
+				TargetWorldLocation = TargetStarts[Target] + ( TargetVelocities[Target] * BurstTime );
+			}
+
+			FRotator AimJointRotation;
+			UTurretRotationFunctionLibrary::CalculateTurretRotation_ForActor(
+				Turret.ActorWorldTransform,
+				Turret.Geometry.Actor_To_AimJoint,
+				Turret.Geometry.AimJoint_To_BarrelStart,
+				Turret.Geometry.BarrelStart_To_BarrelEnd,
+				TargetWorldLocation,
+				AimJointRotation );
+
+			Writer.AddTurret(
+				Index,
+				Turret.ActorWorldTransform,
+				Turret.Geometry.Actor_To_AimJoint,
+				Turret.Geometry.AimJoint_To_BarrelStart,
+				Turret.Geometry.BarrelStart_To_BarrelEnd,
+				TargetWorldLocation,
+				AimJointRotation );
+		}
+
+		Writer.EndFrame();
+	}
+
+	Writer.Close();
+	UE_LOG( LogTurretRotation, Display, TEXT( "Wrote %d frames of %d turrets to %s (%.1f MB)" ), NumFrames, NumTurrets, *Filename, Writer.GetNumBytesWritten() / ( 1024.0 * 1024.0 ) );
+	return true;
+}
+
+FString FTurretCaptureReplay::GetDefaultFilename( const FString& Name )
+{
+	return FPaths::GameSavedDir() / TEXT( "TurretCaptures" ) / ( Name + TEXT( ".trcap" ) );
+}
+
+
+namespace TurretCaptureCommands
+{
+	static void Replay( const TArray<FString>& Args )
+	{
+		FString Filename = Args.Num() > 0 ? Args[0] : FString();
+		const float MaxDeviationDegrees = Args.Num() > 1 ? FCString::Atof( *Args[1] ) : 0.01f;
+
+		// Without a capture, make one up, so the replay can still be run anywhere.
+		if ( Filename.IsEmpty() )
+		{
+			Filename = FTurretCaptureReplay::GetDefaultFilename( TEXT( "Synthetic" ) );
+			if ( !FTurretCaptureReplay::WriteSyntheticCapture( Filename, 2000, 600 ) )
+			{
+				return;
+			}
+		}
+
+		FTurretCaptureReplay::RunAndLog( Filename, MaxDeviationDegrees );
+	}
+
+	static void WriteSynthetic( const TArray<FString>& Args )
+	{
+		const FString Filename = Args.Num() > 0 ? Args[0] : FTurretCaptureReplay::GetDefaultFilename( TEXT( "Synthetic" ) );
+		const int32 NumTurrets = Args.Num() > 1 ? FMath::Max( 1, FCString::Atoi( *Args[1] ) ) : 2000;
+		const int32 NumFrames = Args.Num() > 2 ? FMath::Max( 1, FCString::Atoi( *Args[2] ) ) : 600;
+		FTurretCaptureReplay::WriteSyntheticCapture( Filename, NumTurrets, NumFrames );
+	}
+
+	static FAutoConsoleCommand ReplayCommand(
+		TEXT( "TurretRotation.Replay" ),
+		TEXT( "Replays a turret capture through CalculateTurretRotation_ForActor, single threaded and with ParallelFor, and checks it against the captured rotations.  Without a file, a synthetic capture is written and replayed.  Usage: TurretRotation.Replay [File [MaxDeviationDegrees]]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &Replay ) );
+
+	static FAutoConsoleCommand WriteSyntheticCommand(
+		TEXT( "TurretRotation.Capture.Synthetic" ),
+		TEXT( "Writes a synthetic turret capture (shared targets, crossing bursts, and targets hugging the AimJoint).  Usage: TurretRotation.Capture.Synthetic [File [NumTurrets [NumFrames]]]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &WriteSynthetic ) );
+}
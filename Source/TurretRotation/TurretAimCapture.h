@@ -0,0 +1,346 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "Templates/UniquePtr.h"
+
+/**
+ * A capture of real turret workloads (every turret's inputs and the rotation the game solved for them, frame by frame), so the solver
+ * can be measured end to end against what actually happens in a level, instead of against random micro-benchmark inputs.
+ *
+ * Capture with TurretRotation.Capture.Start / TurretRotation.Capture.Stop while turrets are updated by ATurretAimManager, then replay
+ * the file with the TurretRotation.Replay console command, or headless with the TurretReplay commandlet (see UTurretReplayCommandlet).
+ *
+ * The file is streamed out in chunks of a few dozen frames, so capturing never holds more than one chunk in memory:
+ *
+ *   FTurretCaptureFileHeader, padded to ChunkAlignment
+ *   Chunk 0, padded to ChunkAlignment:
+ *     FTurretCaptureChunkHeader
+ *     FTurretCaptureGeometry[NumGeometries]				(at GeometriesOffset, every turret geometry used by the chunk)
+ *     Frame 0 (at FramesOffset):
+ *       FTurretCaptureFrameHeader
+ *       FVector[NumTargets]								(target locations, shared by every turret aiming at the same point)
+ *       FTurretCaptureTurret[NumTurrets]					(16 byte aligned)
+ *     Frame 1 (at Frame 0 + FrameBytes) ...
+ *   Chunk 1 ...
+ *
+ * Everything is plain old data in the capturing platform's (little endian) layout, every array is 16 byte aligned, and every offset is
+ * relative to the start of its chunk.  So a chunk can be used straight from a memory mapping (or one read) of the file, without parsing
+ * or copying anything.  FTurretCaptureReader works that way on a chunk it has read into memory.
+ */
+
+/** Stored in FTurretCaptureFileHeader::Magic. */
+#define TURRET_CAPTURE_FILE_MAGIC 0x50435254	// "TRCP"
+
+/** Stored in FTurretCaptureChunkHeader::Magic. */
+#define TURRET_CAPTURE_CHUNK_MAGIC 0x4B435254	// "TRCK"
+
+/** Bumped whenever the layout changes.  Files with a different version are rejected. */
+#define TURRET_CAPTURE_VERSION 1
+
+struct FTurretCaptureFileHeader
+{
+	uint32 Magic;
+	uint32 Version;
+
+	/** Every chunk starts (and the file header is padded out) to a multiple of this.  A multiple of the page size, so chunks can be mapped on their own. */
+	uint32 ChunkAlignment;
+
+	uint32 Padding;
+};
+
+struct FTurretCaptureChunkHeader
+{
+	uint32 Magic;
+	uint32 NumFrames;
+	uint32 NumGeometries;
+	uint32 Padding;
+
+	/** Size of the whole chunk, including this header and the padding at the end.  The next chunk starts right after. */
+	uint64 ChunkBytes;
+
+	uint64 GeometriesOffset;
+	uint64 FramesOffset;
+};
+
+/** The same vectors CalculateTurretRotation_ForActor takes. */
+struct FTurretCaptureGeometry
+{
+	FVector Actor_To_AimJoint;
+	FVector AimJoint_To_BarrelStart;
+	FVector BarrelStart_To_BarrelEnd;
+};
+
+struct FTurretCaptureFrameHeader
+{
+	/** GFrameCounter when the frame was captured. */
+	uint64 FrameNumber;
+
+	float DeltaSeconds;
+	uint32 NumTargets;
+	uint32 NumTurrets;
+
+	/** Size of the frame, including this header and its padding.  The next frame starts right after. */
+	uint32 FrameBytes;
+
+	uint64 Padding;
+};
+
+/** One turret solve: its inputs, and the rotation the game came up with. */
+struct FTurretCaptureTurret
+{
+	FQuat ActorRotation;
+	FVector ActorLocation;
+	FVector ActorScale;
+
+	/** The rotation that was applied to the AimJoint (relative to the Actor). */
+	FRotator AimJointRotation;
+
+	/** Stays the same for a turret across the whole capture. */
+	uint32 TurretId;
+
+	/** Index into the chunk's geometries. */
+	int32 GeometryIndex;
+
+	/** Index into the frame's targets. */
+	int32 TargetIndex;
+};
+
+static_assert( sizeof( FTurretCaptureFileHeader ) == 16, "The capture format can't have compiler padding." );
+static_assert( sizeof( FTurretCaptureChunkHeader ) == 40, "The capture format can't have compiler padding." );
+static_assert( sizeof( FTurretCaptureGeometry ) == 36, "The capture format can't have compiler padding." );
+static_assert( sizeof( FTurretCaptureFrameHeader ) == 32, "The capture format can't have compiler padding." );
+static_assert( sizeof( FTurretCaptureTurret ) == 64, "The capture format can't have compiler padding." );
+
+/**
+ * Streams frames out to a capture file.  Frames are collected into the current chunk, which is written out once it has FramesPerChunk
+ * frames (or when the writer is closed).
+ *
+ *		Writer.BeginFrame( GFrameCounter, DeltaSeconds );
+ *		Writer.AddTurret( ... );	// For every turret solved this frame.
+ *		Writer.EndFrame();
+ */
+class TURRETROTATION_API FTurretCaptureWriter
+{
+public:
+	/**
+	 * @param InFramesPerChunk	Number of frames in each chunk.
+	 */
+	explicit FTurretCaptureWriter( int32 InFramesPerChunk = 64 );
+
+	/** Writes out the last chunk. */
+	~FTurretCaptureWriter();
+
+	/**
+	 * Creates the file (and any missing directories), and writes the file header.
+	 *
+	 * @param Filename	The file to write.  Replaced if it already exists.
+	 * @return Returns false if the file couldn't be created.
+	 */
+	bool Open( const FString& Filename );
+
+	/** Writes out the current chunk, and closes the file. */
+	void Close();
+
+	bool IsOpen() const { return File.IsValid(); }
+
+	/** Starts a new frame.  Every frame has to be ended with EndFrame before the next one begins. */
+	void BeginFrame( uint64 FrameNumber, float DeltaSeconds );
+
+	/**
+	 * Adds a turret solve to the current frame.
+	 *
+	 * @param TurretId					Anything that stays the same for the turret across the capture.
+	 * @param ActorWorldTransform		The Actor's world transform that was solved for.
+	 * @param Actor_To_AimJoint			Same as CalculateTurretRotation_ForActor.
+	 * @param AimJoint_To_BarrelStart	Same as CalculateTurretRotation_ForActor.
+	 * @param BarrelStart_To_BarrelEnd	Same as CalculateTurretRotation_ForActor.
+	 * @param TargetWorldLocation		The target's location that was solved for.  Turrets aiming at the same point share it.
+	 * @param AimJointRotation			The rotation that was solved for (and applied to) the AimJoint.
+	 */
+	void AddTurret(
+		uint32 TurretId,
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_AimJoint,
+		const FVector& AimJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation,
+		const FRotator& AimJointRotation );
+
+	/** Adds the current frame to the chunk, and writes the chunk out if it's full. */
+	void EndFrame();
+
+	/** @return Returns the number of frames written out (or waiting in the current chunk). */
+	int32 GetNumFrames() const { return NumFrames; }
+
+	/** @return Returns the size of everything written out so far, in bytes. */
+	int64 GetNumBytesWritten() const { return NumBytesWritten; }
+
+private:
+	/** Writes out the current chunk, and starts a new one. */
+	void FlushChunk();
+
+	/** Writes raw bytes to the end of the file. */
+	void WriteBytes( const void* Data, int64 NumBytes );
+
+	/** Writes zeros until the file is a multiple of Alignment in size. */
+	void PadFile( int64 Alignment );
+
+	/** Adds zeros to the end of Bytes, until it's a multiple of Alignment in size. */
+	static void PadBytes( TArray<uint8>& Bytes, int32 Alignment );
+
+	/** Adds the raw bytes of Count elements to the end of Bytes. */
+	template<typename ElementType>
+	static void AppendBytes( TArray<uint8>& Bytes, const ElementType* Elements, int32 Count )
+	{
+		Bytes.Append( reinterpret_cast<const uint8*>( Elements ), Count * sizeof( ElementType ) );
+	}
+
+	int32 FramesPerChunk;
+
+	TUniquePtr<FArchive> File;
+	int64 NumBytesWritten;
+	int32 NumFrames;
+
+	/** The current chunk: its frames (already laid out), its geometries, and which geometry each turret last used. */
+	TArray<uint8> ChunkFrameBytes;
+	int32 NumFramesInChunk;
+	TArray<FTurretCaptureGeometry> ChunkGeometries;
+	TMap<uint32, int32> ChunkGeometryIndices;
+
+	/** The current frame. */
+	bool bInFrame;
+	FTurretCaptureFrameHeader FrameHeader;
+	TArray<FVector> FrameTargets;
+	TMap<FVector, int32> FrameTargetIndices;
+	TArray<FTurretCaptureTurret> FrameTurrets;
+};
+
+/** One frame of a capture, pointing straight into the chunk it came from. */
+struct FTurretCaptureFrame
+{
+	const FTurretCaptureFrameHeader* Header;
+	TArrayView<const FVector> Targets;
+	TArrayView<const FTurretCaptureTurret> Turrets;
+};
+
+/**
+ * Reads a capture file back, one chunk at a time.  Only the current chunk is kept in memory.
+ *
+ *		FTurretCaptureReader Reader;
+ *		if ( Reader.Open( Filename ) )
+ *		{
+ *			while ( Reader.ReadNextChunk() )
+ *			{
+ *				for ( int32 Index = 0; Index < Reader.GetNumFrames(); ++Index )
+ *				{
+ *					const FTurretCaptureFrame Frame = Reader.GetFrame( Index );
+ *					...
+ */
+class TURRETROTATION_API FTurretCaptureReader
+{
+public:
+	FTurretCaptureReader();
+	~FTurretCaptureReader();
+
+	/**
+	 * Opens the file, and checks its header.
+	 *
+	 * @param Filename	The file to read.
+	 * @return Returns false (and logs why) if the file doesn't exist or isn't a capture of this version.
+	 */
+	bool Open( const FString& Filename );
+
+	void Close();
+
+	/**
+	 * Reads the next chunk, replacing the current one.
+	 *
+	 * @return Returns false at the end of the file, or (after logging why) if the chunk is corrupt.
+	 */
+	bool ReadNextChunk();
+
+	/** Goes back to the first chunk. */
+	void Rewind();
+
+	/** @return Returns the number of frames in the current chunk. */
+	int32 GetNumFrames() const { return FrameOffsets.Num(); }
+
+	/** @return Returns a frame of the current chunk.  Only valid until the next chunk is read. */
+	FTurretCaptureFrame GetFrame( int32 Index ) const;
+
+	/** @return Returns the geometries of the current chunk, which FTurretCaptureTurret::GeometryIndex indexes into. */
+	TArrayView<const FTurretCaptureGeometry> GetGeometries() const { return Geometries; }
+
+private:
+	/** Checks the current chunk's header, and finds every frame in it. */
+	bool IndexChunk();
+
+	TUniquePtr<FArchive> File;
+	int64 FirstChunkOffset;
+
+	/** The current chunk, aligned so the turrets inside it are too. */
+	TArray<uint8, TAlignedHeapAllocator<16>> ChunkBytes;
+	TArrayView<const FTurretCaptureGeometry> Geometries;
+	TArray<int64> FrameOffsets;
+};
+
+/** What came out of replaying a capture. */
+struct FTurretReplayStats
+{
+	FTurretReplayStats();
+
+	int32 NumFrames;
+	int64 NumSolves;
+
+	/** Time spent solving, over every frame (not counting reading the file). */
+	double SolveSeconds;
+
+	/** Median, 99th percentile, and worst time to solve one frame. */
+	double P50FrameSeconds;
+	double P99FrameSeconds;
+	double MaxFrameSeconds;
+
+	/** Largest yaw or pitch difference (in degrees) between a replayed solve and the captured one. */
+	float MaxDeviationDegrees;
+};
+
+/**
+ * Feeds a capture through UTurretRotationFunctionLibrary::CalculateTurretRotation_ForActor, frame by frame, and compares the results
+ * against the captured rotations.
+ */
+class TURRETROTATION_API FTurretCaptureReplay
+{
+public:
+	/**
+	 * @param Filename				The capture file.
+	 * @param bUseParallelFor		If true, each frame's turrets are solved in chunks across the worker threads with ParallelFor.
+	 * @param ParallelChunkSize		Number of turrets solved by each ParallelFor task.
+	 * @param Out_Stats				OUT - Throughput, per-frame cost, and the deviation from the capture.
+	 * @return Returns false if the file couldn't be read.
+	 */
+	static bool Run( const FString& Filename, bool bUseParallelFor, int32 ParallelChunkSize, FTurretReplayStats& Out_Stats );
+
+	/**
+	 * Replays a capture single threaded and with ParallelFor, and logs how both did.
+	 *
+	 * @param Filename	The capture file.
+	 * @return Returns false if the file couldn't be read, or if a replayed solve deviates from the capture by more than MaxDeviationDegrees.
+	 */
+	static bool RunAndLog( const FString& Filename, float MaxDeviationDegrees );
+
+	/**
+	 * Writes a capture without a level, for machines that can't run one: turrets sharing targets, bursts of targets crossing through
+	 * groups of turrets, and targets hugging (and sitting right on) the AimJoint.  The recorded rotations come from
+	 * CalculateTurretRotation_ForActor, so replaying it should show no deviation.
+	 *
+	 * @param Filename		The file to write.
+	 * @param NumTurrets	Number of turrets.
+	 * @param NumFrames		Number of frames, at 60 Hz.
+	 * @return Returns false if the file couldn't be written.
+	 */
+	static bool WriteSyntheticCapture( const FString& Filename, int32 NumTurrets, int32 NumFrames );
+
+	/** @return Returns where captures go when no filename is given: Saved/TurretCaptures/<Name>.trcap. */
+	static FString GetDefaultFilename( const FString& Name );
+};
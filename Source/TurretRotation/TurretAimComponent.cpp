@@ -0,0 +1,571 @@
+#include "TurretAimComponent.h"
+#include "TurretAimManager.h"
+#include "TurretEditorRefresher.h"
+#include "TurretRotation.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+
+UTurretAimComponent::UTurretAimComponent()
+	: AimJointName( TEXT( "AimJoint" ) )
+	, BarrelStartName( TEXT( "BarrelStart" ) )
+	, BarrelEndName( TEXT( "BarrelEnd" ) )
+	, TargetActor( nullptr )
+	, TargetLocation( FVector::ZeroVector )
+	, bUseTurretManager( false )
+	, bAutoAcquireTarget( false )
+	, AcquisitionMinRange( 0.0f )
+	, AcquisitionMaxRange( 5000.0f )
+	, AcquisitionHalfArcDegrees( 180.0f )
+	, bUseBallisticAim( false )
+	, bUseIncrementalSolve( false )
+	, IncrementalPositionEpsilon( 1.0f )
+	, IncrementalAngleEpsilonDegrees( 0.1f )
+	, bUseExtrapolation( false )
+	, ExtrapolationErrorDegrees( 0.1f )
+	, MaxExtrapolationSeconds( 0.25f )
+	, MaxYawSpeedDegrees( 0.0f )
+	, MaxPitchSpeedDegrees( 0.0f )
+	, bIsFiring( false )
+	, MaxYawDegrees( 180.0f )
+	, MinPitchDegrees( -180.0f )
+	, MaxPitchDegrees( 180.0f )
+	, AimReplication( ETurretAimReplication::None )
+	, ReplicatedYawBits( 12 )
+	, ReplicatedPitchBits( 12 )
+	, AimJoint( nullptr )
+	, BarrelStartComponent( nullptr )
+	, BarrelEndComponent( nullptr )
+	, GeometryActorScale( FVector::OneVector )
+	, GeometryAimJoint_To_BarrelStart( FVector::ZeroVector )
+	, GeometryBarrelStart_To_BarrelEnd( FVector::ZeroVector )
+	, bHasValidGeometry( false )
+	, bGeometryInvalidated( true )
+	, AimJointRotation( FRotator::ZeroRotator )
+	, LastAimTime( -1.0f )
+	, bReplicatingTarget( false )
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+
+	// Targets usually move during PrePhysics/DuringPhysics, so aim once they're done.
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UTurretAimComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	RefreshGeometry();
+
+#if WITH_EDITOR
+	FTurretEditorRefresher* Refresher = FTurretEditorRefresher::Get();
+	if ( Refresher && ShouldRefreshInEditor() )
+	{
+		Refresher->RegisterTurret( this );
+	}
+#endif
+}
+
+void UTurretAimComponent::OnUnregister()
+{
+#if WITH_EDITOR
+	if ( FTurretEditorRefresher* Refresher = FTurretEditorRefresher::Get() )
+	{
+		Refresher->UnregisterTurret( this );
+	}
+#endif
+
+	Super::OnUnregister();
+}
+
+void UTurretAimComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if ( AimReplication != ETurretAimReplication::None && GetOwnerRole() == ROLE_Authority )
+	{
+		SetIsReplicated( true );
+	}
+
+	if ( bUseTurretManager )
+	{
+		if ( ATurretAimManager* Manager = ATurretAimManager::Get( GetWorld() ) )
+		{
+			Manager->RegisterTurret( this );
+			SetComponentTickEnabled( false );
+		}
+	}
+}
+
+void UTurretAimComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	if ( bUseTurretManager )
+	{
+		if ( ATurretAimManager* Manager = ATurretAimManager::Get( GetWorld(), /*bCreateIfMissing*/ false ) )
+		{
+			Manager->UnregisterTurret( this );
+		}
+	}
+
+	Super::EndPlay( EndPlayReason );
+}
+
+void UTurretAimComponent::TickComponent( float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction )
+{
+	Super::TickComponent( DeltaTime, TickType, ThisTickFunction );
+
+	UpdateAim();
+}
+
+void UTurretAimComponent::GetLifetimeReplicatedProps( TArray<FLifetimeProperty>& OutLifetimeProps ) const
+{
+	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
+
+	// Either the target or the angles are sent, never both.  PreReplication picks which.
+	DOREPLIFETIME_CONDITION( UTurretAimComponent, TargetActor, COND_Custom );
+	DOREPLIFETIME_CONDITION( UTurretAimComponent, TargetLocation, COND_Custom );
+	DOREPLIFETIME_CONDITION( UTurretAimComponent, ReplicatedAim, COND_Custom );
+	DOREPLIFETIME( UTurretAimComponent, bReplicatingTarget );
+}
+
+void UTurretAimComponent::PreReplication( IRepChangedPropertyTracker& ChangedPropertyTracker )
+{
+	Super::PreReplication( ChangedPropertyTracker );
+
+	bReplicatingTarget = ShouldReplicateTarget();
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE( UTurretAimComponent, TargetActor, bReplicatingTarget );
+	DOREPLIFETIME_ACTIVE_OVERRIDE( UTurretAimComponent, TargetLocation, bReplicatingTarget );
+	DOREPLIFETIME_ACTIVE_OVERRIDE( UTurretAimComponent, ReplicatedAim, !bReplicatingTarget );
+}
+
+bool UTurretAimComponent::ShouldReplicateTarget() const
+{
+	switch ( AimReplication )
+	{
+	case ETurretAimReplication::Target:
+		return true;
+
+	case ETurretAimReplication::Auto:
+		// A replicated target (or a TargetLocation) is only sent when it changes, and clients can solve for it as well as we can.
+		// The angles change every time the turret or its target moves.
+		return !TargetActor || TargetActor->GetIsReplicated();
+
+	default:
+		return false;
+	}
+}
+
+bool UTurretAimComponent::IsReplicatedClient() const
+{
+	return AimReplication != ETurretAimReplication::None && GetOwnerRole() < ROLE_Authority;
+}
+
+bool UTurretAimComponent::ShouldSolveLocally() const
+{
+	return !IsReplicatedClient() || bReplicatingTarget;
+}
+
+bool UTurretAimComponent::ShouldAcquireTarget() const
+{
+	return bAutoAcquireTarget && !IsReplicatedClient();
+}
+
+void UTurretAimComponent::OnRep_ReplicatedAim()
+{
+	if ( !ShouldSolveLocally() )
+	{
+		ApplyAimJointRotation( ReplicatedAim.GetRotation() );
+	}
+}
+
+#if WITH_EDITOR
+void UTurretAimComponent::PostEditChangeProperty( FPropertyChangedEvent& PropertyChangedEvent )
+{
+	Super::PostEditChangeProperty( PropertyChangedEvent );
+
+	InvalidateGeometry();
+
+	// Registering again picks up a new TargetActor, and re-aims the turret during the next editor tick.
+	FTurretEditorRefresher* Refresher = FTurretEditorRefresher::Get();
+	if ( Refresher && IsRegistered() && ShouldRefreshInEditor() )
+	{
+		Refresher->RegisterTurret( this );
+	}
+}
+#endif
+
+bool UTurretAimComponent::ShouldRefreshInEditor() const
+{
+	const UWorld* World = GetWorld();
+	return World && World->WorldType == EWorldType::Editor;
+}
+
+void UTurretAimComponent::UpdateAim()
+{
+	AActor* Owner = GetOwner();
+	if ( !Owner || !ShouldSolveLocally() || !PrepareGeometry() )
+	{
+		return;
+	}
+
+	const FTransform ActorWorldTransform = Owner->GetActorTransform();
+	const FVector TargetWorldLocation = GetTargetWorldLocation();
+	if ( TryReuseLastSolve( ActorWorldTransform, TargetWorldLocation ) || TryExtrapolateAim( ActorWorldTransform, TargetWorldLocation ) )
+	{
+		return;
+	}
+
+	const FTurretSolveSettings SolveSettings = FTurretAimGeometry::GetSolveSettings();
+	FTurretSolveStats SolveStats;
+	if ( bUseBallisticAim )
+	{
+		LastBallisticSolution = Geometry.SolveBallisticForActor( ActorWorldTransform, TargetWorldLocation, GetTargetWorldVelocity(), FVector::ZeroVector, BallisticSettings, SolveSettings, &SolveStats );
+		ApplySolve( ActorWorldTransform, TargetWorldLocation, LastBallisticSolution.AimJointRotation );
+		return;
+	}
+
+	if ( UsesExtrapolation() )
+	{
+		const FVector TargetRelativeVelocity = GetTargetRelativeVelocity();
+		FTurretAimRates Rates;
+		const FRotator NewAimJointRotation = Geometry.SolveWithRatesForActor( ActorWorldTransform, TargetWorldLocation, TargetRelativeVelocity, MaxExtrapolationSeconds, /*out*/ Rates, SolveSettings, &SolveStats );
+		ApplySolveWithRates( GetWorld()->GetTimeSeconds(), ActorWorldTransform, TargetWorldLocation, TargetRelativeVelocity, NewAimJointRotation, Rates );
+		return;
+	}
+
+	ApplySolve( ActorWorldTransform, TargetWorldLocation, Geometry.SolveForActor( ActorWorldTransform, TargetWorldLocation, SolveSettings, &SolveStats ) );
+}
+
+bool UTurretAimComponent::TryReuseLastSolve( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation )
+{
+	if ( !bUseIncrementalSolve )
+	{
+		return false;
+	}
+
+	FRotator CachedAimJointRotation;
+	if ( !AimCache.TryGetCachedResult( ActorWorldTransform, TargetWorldLocation, IncrementalPositionEpsilon, IncrementalAngleEpsilonDegrees, /*out*/ CachedAimJointRotation ) )
+	{
+		return false;
+	}
+
+	// The cached rotation was already applied to the AimJoint when it was solved, so there's nothing else to do on a hit, unless the
+	// slew limit is still turning the AimJoint towards it.
+	if ( IsSlewRateLimited() && !AimJointRotation.Equals( CachedAimJointRotation, KINDA_SMALL_NUMBER ) )
+	{
+		ApplyAimJointRotation( CachedAimJointRotation );
+	}
+	return true;
+}
+
+bool UTurretAimComponent::TryExtrapolateAim( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation )
+{
+	if ( !UsesExtrapolation() )
+	{
+		return false;
+	}
+
+	FRotator ExtrapolatedAimJointRotation;
+	if ( !AimExtrapolation.TryExtrapolate( GetWorld()->GetTimeSeconds(), ActorWorldTransform, TargetWorldLocation, ExtrapolationErrorDegrees, MaxExtrapolationSeconds, /*out*/ ExtrapolatedAimJointRotation ) )
+	{
+		return false;
+	}
+
+	// Not stored in the incremental solve cache, since it isn't the exact result for these inputs.
+	ApplyAim( ExtrapolatedAimJointRotation );
+	return true;
+}
+
+void UTurretAimComponent::ApplySolveWithRates(
+	double SolveTime,
+	const FTransform& ActorWorldTransform,
+	const FVector& TargetWorldLocation,
+	const FVector& TargetRelativeVelocity,
+	const FRotator& NewAimJointRotation,
+	const FTurretAimRates& Rates )
+{
+	AimExtrapolation.RecordSolve( SolveTime, ActorWorldTransform, TargetWorldLocation, TargetRelativeVelocity, NewAimJointRotation, Rates );
+
+	ApplySolve( ActorWorldTransform, TargetWorldLocation, NewAimJointRotation );
+}
+
+void UTurretAimComponent::ApplySolve( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FRotator& NewAimJointRotation )
+{
+	if ( bUseIncrementalSolve )
+	{
+		AimCache.Store( ActorWorldTransform, TargetWorldLocation, NewAimJointRotation );
+	}
+
+	ApplyAim( NewAimJointRotation );
+}
+
+void UTurretAimComponent::ApplyAim( const FRotator& NewAimJointRotation )
+{
+	// Kept up to date even while the target is being replicated instead, so it's right as soon as PreReplication switches back.
+	// Clients apply the slew limit themselves, so this is the aim before the limit.
+	if ( AimReplication != ETurretAimReplication::None && GetOwnerRole() == ROLE_Authority )
+	{
+		ReplicatedAim.SetRotation( NewAimJointRotation, ReplicatedYawBits, ReplicatedPitchBits );
+	}
+
+	ApplyAimJointRotation( NewAimJointRotation );
+}
+
+bool UTurretAimComponent::PrepareGeometry()
+{
+	if ( NeedsGeometryRefresh() )
+	{
+		RefreshGeometry();
+	}
+
+	return bHasValidGeometry && AimJoint;
+}
+
+void UTurretAimComponent::ApplyAimJointRotation( const FRotator& NewAimJointRotation )
+{
+	const FRotator LimitedAimJointRotation = ApplyLimits( NewAimJointRotation );
+
+	if ( IsSlewRateLimited() )
+	{
+		const UWorld* World = GetWorld();
+		const float Now = World->GetTimeSeconds();
+
+		// A long gap since the last call (the turret sat still, or wasn't updated) only counts as one update, so the AimJoint can't snap.
+		const float MaxDeltaSeconds = FMath::Max( World->GetDeltaSeconds(), PrimaryComponentTick.TickInterval );
+		const float DeltaSeconds = ( LastAimTime >= 0.0f ) ? FMath::Clamp( Now - LastAimTime, 0.0f, MaxDeltaSeconds ) : 0.0f;
+		LastAimTime = Now;
+
+		TurretRotationCore::TAimAngles<float> Current;
+		Current.Pitch = AimJointRotation.Pitch;
+		Current.Yaw = AimJointRotation.Yaw;
+
+		TurretRotationCore::TAimAngles<float> Desired;
+		Desired.Pitch = LimitedAimJointRotation.Pitch;
+		Desired.Yaw = LimitedAimJointRotation.Yaw;
+
+		const TurretRotationCore::TAimAngles<float> Limited = TurretRotationCore::ApplySlewLimit( Current, Desired, MaxYawSpeedDegrees, MaxPitchSpeedDegrees, DeltaSeconds );
+		AimJointRotation = FRotator( Limited.Pitch, Limited.Yaw, 0.0f );
+	}
+	else
+	{
+		AimJointRotation = LimitedAimJointRotation;
+	}
+
+	if ( AimJoint )
+	{
+		AimJoint->SetRelativeRotation( AimJointRotation );
+	}
+}
+
+FRotator UTurretAimComponent::ApplyLimits( const FRotator& AimJointRotation ) const
+{
+	FRotator Result = AimJointRotation;
+
+	if ( MaxYawDegrees < 180.0f )
+	{
+		Result.Yaw = FMath::Clamp( FRotator::NormalizeAxis( Result.Yaw ), -MaxYawDegrees, MaxYawDegrees );
+	}
+
+	if ( ( MaxPitchDegrees - MinPitchDegrees ) < 360.0f )
+	{
+		Result.Pitch = FMath::Clamp( FRotator::NormalizeAxis( Result.Pitch ), MinPitchDegrees, MaxPitchDegrees );
+	}
+
+	return Result;
+}
+
+void UTurretAimComponent::GetIncrementalSolveCounters( int32& Out_NumHits, int32& Out_NumMisses ) const
+{
+	Out_NumHits = static_cast<int32>( FMath::Min<int64>( AimCache.GetNumHits(), MAX_int32 ) );
+	Out_NumMisses = static_cast<int32>( FMath::Min<int64>( AimCache.GetNumMisses(), MAX_int32 ) );
+}
+
+void UTurretAimComponent::ResetIncrementalSolveCounters()
+{
+	AimCache.ResetCounters();
+}
+
+void UTurretAimComponent::GetExtrapolationCounters( int32& Out_NumExtrapolated, int32& Out_NumSolves ) const
+{
+	Out_NumExtrapolated = static_cast<int32>( FMath::Min<int64>( AimExtrapolation.GetNumExtrapolated(), MAX_int32 ) );
+	Out_NumSolves = static_cast<int32>( FMath::Min<int64>( AimExtrapolation.GetNumSolves(), MAX_int32 ) );
+}
+
+void UTurretAimComponent::ResetExtrapolationCounters()
+{
+	AimExtrapolation.ResetCounters();
+}
+
+void UTurretAimComponent::InvalidateGeometry()
+{
+	bGeometryInvalidated = true;
+}
+
+FVector UTurretAimComponent::GetTargetWorldLocation() const
+{
+	return TargetActor ? TargetActor->GetActorLocation() : TargetLocation;
+}
+
+FTurretTargetQuery UTurretAimComponent::MakeTargetQuery( const FTransform& ActorWorldTransform ) const
+{
+	FTurretTargetQuery Query;
+	Query.Origin = bHasValidGeometry ? ActorWorldTransform.TransformPosition( Geometry.GetActorToAimJoint() ) : ActorWorldTransform.GetLocation();
+	Query.Forward = ActorWorldTransform.GetUnitAxis( EAxis::X );
+	Query.MinRange = AcquisitionMinRange;
+	Query.MaxRange = AcquisitionMaxRange;
+	Query.HalfArcDegrees = AcquisitionHalfArcDegrees;
+	Query.IgnoredTag = reinterpret_cast<UPTRINT>( GetOwner() );
+	return Query;
+}
+
+FTurretCoverageTurret UTurretAimComponent::MakeCoverageTurret( const FTransform& ActorWorldTransform ) const
+{
+	FTurretCoverageTurret Turret;
+	Turret.ActorWorldTransform = ActorWorldTransform;
+	Turret.Geometry = Geometry;
+	Turret.Limits.MinRange = AcquisitionMinRange;
+	Turret.Limits.MaxRange = AcquisitionMaxRange;
+	Turret.Limits.HalfArcDegrees = MaxYawDegrees;
+	Turret.Limits.MinPitchDegrees = MinPitchDegrees;
+	Turret.Limits.MaxPitchDegrees = MaxPitchDegrees;
+	return Turret;
+}
+
+FVector UTurretAimComponent::GetTargetWorldVelocity() const
+{
+	return TargetActor ? TargetActor->GetVelocity() : FVector::ZeroVector;
+}
+
+FVector UTurretAimComponent::GetTargetRelativeVelocity() const
+{
+	const AActor* Owner = GetOwner();
+	return GetTargetWorldVelocity() - ( Owner ? Owner->GetVelocity() : FVector::ZeroVector );
+}
+
+bool UTurretAimComponent::IsSlewRateLimited() const
+{
+	return ( MaxYawSpeedDegrees > 0.0f || MaxPitchSpeedDegrees > 0.0f ) && GetWorld() && !ShouldRefreshInEditor();
+}
+
+bool UTurretAimComponent::NeedsGeometryRefresh() const
+{
+	if ( bGeometryInvalidated || !bHasValidGeometry )
+	{
+		return true;
+	}
+
+	const AActor* Owner = GetOwner();
+	if ( Owner && !Owner->GetActorScale3D().Equals( GeometryActorScale ) )
+	{
+		return true;
+	}
+
+	return BarrelStartMesh.Get() != GetMeshAsset( BarrelStartComponent ) || BarrelEndMesh.Get() != GetMeshAsset( BarrelEndComponent );
+}
+
+void UTurretAimComponent::RefreshGeometry()
+{
+	bGeometryInvalidated = false;
+	bHasValidGeometry = false;
+	AimCache.Invalidate();
+	AimExtrapolation.Invalidate();
+
+	AActor* Owner = GetOwner();
+	if ( !Owner )
+	{
+		return;
+	}
+
+	// The AimJoint has to be a component, since sockets can't be rotated.
+	FName AimJointSocketName = NAME_None;
+	AimJoint = FindComponentOrSocket( AimJointName, /*out*/ AimJointSocketName );
+	if ( AimJointSocketName != NAME_None )
+	{
+		AimJoint = nullptr;
+	}
+
+	BarrelStartComponent = FindComponentOrSocket( BarrelStartName, /*out*/ BarrelStartSocketName );
+	BarrelEndComponent = FindComponentOrSocket( BarrelEndName, /*out*/ BarrelEndSocketName );
+
+	if ( !AimJoint || !BarrelStartComponent || !BarrelEndComponent )
+	{
+		return;
+	}
+
+	const FTransform ActorWorldTransform = Owner->GetActorTransform();
+	const FTransform& AimJointWorldTransform = AimJoint->GetComponentTransform();
+
+	// CalculateTurretRotation_ForActor wants the vectors "when the Actor is not Rotated/Scaled", which is exactly what inverse transforming
+	// by the Actor gives us.  The BarrelStart/BarrelEnd are read in the AimJoint's space, so however the AimJoint is currently rotated
+	// doesn't matter.  This assumes that the AimJoint itself isn't scaled relative to the Actor.
+	const FVector Actor_To_AimJoint = ActorWorldTransform.InverseTransformPosition( AimJointWorldTransform.GetLocation() );
+	const FVector AimJoint_To_BarrelStart = AimJointWorldTransform.InverseTransformPosition( BarrelStartComponent->GetSocketLocation( BarrelStartSocketName ) );
+	const FVector AimJoint_To_BarrelEnd = AimJointWorldTransform.InverseTransformPosition( BarrelEndComponent->GetSocketLocation( BarrelEndSocketName ) );
+
+	GeometryActorScale = ActorWorldTransform.GetScale3D();
+	GeometryAimJoint_To_BarrelStart = AimJoint_To_BarrelStart;
+	GeometryBarrelStart_To_BarrelEnd = AimJoint_To_BarrelEnd - AimJoint_To_BarrelStart;
+	Geometry = FTurretAimGeometry( Actor_To_AimJoint, GeometryAimJoint_To_BarrelStart, GeometryBarrelStart_To_BarrelEnd, GeometryActorScale );
+
+	BarrelStartMesh = GetMeshAsset( BarrelStartComponent );
+	BarrelEndMesh = GetMeshAsset( BarrelEndComponent );
+
+	bHasValidGeometry = true;
+}
+
+USceneComponent* UTurretAimComponent::FindComponentOrSocket( FName Name, FName& Out_SocketName ) const
+{
+	Out_SocketName = NAME_None;
+
+	AActor* Owner = GetOwner();
+	if ( !Owner || Name == NAME_None )
+	{
+		return nullptr;
+	}
+
+	TInlineComponentArray<USceneComponent*> SceneComponents;
+	Owner->GetComponents( SceneComponents );
+
+	// Components win over sockets with the same name.
+	for ( USceneComponent* SceneComponent : SceneComponents )
+	{
+		if ( SceneComponent->GetFName() == Name )
+		{
+			return SceneComponent;
+		}
+	}
+
+	for ( USceneComponent* SceneComponent : SceneComponents )
+	{
+		if ( SceneComponent->DoesSocketExist( Name ) )
+		{
+			Out_SocketName = Name;
+			return SceneComponent;
+		}
+	}
+
+	return nullptr;
+}
+
+const UObject* UTurretAimComponent::GetMeshAsset( const USceneComponent* Component )
+{
+	if ( const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>( Component ) )
+	{
+		return StaticMeshComponent->GetStaticMesh();
+	}
+
+	if ( const USkinnedMeshComponent* SkinnedMeshComponent = Cast<USkinnedMeshComponent>( Component ) )
+	{
+		return SkinnedMeshComponent->SkeletalMesh;
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,455 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TurretAimGeometry.h"
+#include "TurretAimCache.h"
+#include "TurretAimExtrapolation.h"
+#include "TurretTargetGrid.h"
+#include "TurretCoverageField.h"
+#include "TurretAimReplication.h"
+#include "TurretAimScheduler.h"
+#include "TurretAimComponent.generated.h"
+
+class USceneComponent;
+
+/**
+ * Aims a turret at a target every tick, entirely in C++.
+ *
+ * This does the same thing as the demo turret Blueprints (which build the input vectors and call CalculateTurretRotation_ForActor),
+ * except that the AimJoint/BarrelStart/BarrelEnd are only read when the component is registered, and again only if the owner's
+ * scale or the barrel's mesh changes.  Every other tick just solves using the cached FTurretAimGeometry and sets the AimJoint's
+ * relative rotation.
+ *
+ * The tick group and tick interval can be changed through PrimaryComponentTick (or SetComponentTickInterval at runtime).
+ *
+ * In the editor, the turret is kept aimed by FTurretEditorRefresher whenever it or its TargetActor is moved.
+ *
+ * In multiplayer, AimReplication picks whether clients get the server's aim or its target (the owner has to replicate too).
+ */
+UCLASS( ClassGroup=(Turret), meta=(BlueprintSpawnableComponent) )
+class TURRETROTATION_API UTurretAimComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTurretAimComponent();
+
+	/** Name of the owner's component that gets rotated.  This is expected to have no rotation of its own when the turret isn't aiming. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FName AimJointName;
+
+	/** Name of the owner's component, or of a socket on one of the owner's components, that marks the start of the barrel. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FName BarrelStartName;
+
+	/** Name of the owner's component, or of a socket on one of the owner's components, that marks the end of the barrel. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FName BarrelEndName;
+
+	/** The Actor to aim at.  If this isn't set, then the turret aims at TargetLocation instead. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Replicated, Category = "Turret" )
+	AActor* TargetActor;
+
+	/** The location (in world space) to aim at when there is no TargetActor. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Replicated, Category = "Turret" )
+	FVector TargetLocation;
+
+	/**
+	 * If true, this turret doesn't tick on its own during gameplay.  Instead it is updated by the world's ATurretAimManager,
+	 * along with every other managed turret.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	bool bUseTurretManager;
+
+	/**
+	 * If true, the turret picks its own TargetActor: the nearest Actor with a UTurretTargetComponent that is within the acquisition range
+	 * and firing arc.  TargetActor is cleared when there is no such Actor.  Only works with bUseTurretManager, since the manager keeps
+	 * track of the targets.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Acquisition", meta = ( EditCondition = "bUseTurretManager" ) )
+	bool bAutoAcquireTarget;
+
+	/** Targets closer than this (to the AimJoint) are ignored. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Acquisition", meta = ( EditCondition = "bAutoAcquireTarget", ClampMin = "0.0" ) )
+	float AcquisitionMinRange;
+
+	/** Targets farther away than this (from the AimJoint) are ignored. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Acquisition", meta = ( EditCondition = "bAutoAcquireTarget", ClampMin = "0.0" ) )
+	float AcquisitionMaxRange;
+
+	/**
+	 * How far (in degrees) to either side of the Actor's forward vector a target can be.  180 means all the way around.  Only limits which
+	 * targets get picked; how far the turret can turn is MaxYawDegrees.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Acquisition", meta = ( EditCondition = "bAutoAcquireTarget", ClampMin = "0.0", ClampMax = "180.0" ) )
+	float AcquisitionHalfArcDegrees;
+
+	/**
+	 * If true, the turret leads its target: it aims so that a projectile fired from the BarrelEnd (with BallisticSettings) hits the
+	 * TargetActor, given its current velocity.  Otherwise, the barrel points straight at the target.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic" )
+	bool bUseBallisticAim;
+
+	/** Muzzle speed, gravity, and high/low arc for bUseBallisticAim. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic", meta = ( EditCondition = "bUseBallisticAim" ) )
+	FTurretBallisticSettings BallisticSettings;
+
+	/**
+	 * If true, the turret is only solved again once its Actor or target has moved (or rotated) more than the epsilons below since
+	 * the last solve.  Otherwise the AimJoint keeps its last rotation.  See FTurretAimCache.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Incremental" )
+	bool bUseIncrementalSolve;
+
+	/** How far (in world units) the Actor or target can move before the turret is solved again.  Only used with bUseIncrementalSolve. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Incremental", meta = ( EditCondition = "bUseIncrementalSolve", ClampMin = "0.0" ) )
+	float IncrementalPositionEpsilon;
+
+	/** How far (in degrees) the Actor can rotate before the turret is solved again.  Only used with bUseIncrementalSolve. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Incremental", meta = ( EditCondition = "bUseIncrementalSolve", ClampMin = "0.0" ) )
+	float IncrementalAngleEpsilonDegrees;
+
+	/**
+	 * If true, the turret solves at a lower rate while it tracks a smoothly moving target.  In between solves, the aim keeps turning at
+	 * the rates found by the last solve, until the estimated error passes ExtrapolationErrorDegrees (or the last solve is older than
+	 * MaxExtrapolationSeconds).  Ignored with bUseBallisticAim.  See FTurretAimExtrapolation.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Extrapolation" )
+	bool bUseExtrapolation;
+
+	/** Largest estimated error (in degrees) to extrapolate with before solving again.  Only used with bUseExtrapolation. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Extrapolation", meta = ( EditCondition = "bUseExtrapolation", ClampMin = "0.0" ) )
+	float ExtrapolationErrorDegrees;
+
+	/** Longest time (in seconds) to extrapolate a solve over before solving again.  Only used with bUseExtrapolation. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Extrapolation", meta = ( EditCondition = "bUseExtrapolation", ClampMin = "0.0" ) )
+	float MaxExtrapolationSeconds;
+
+	/**
+	 * Fastest the AimJoint can turn its yaw, in degrees per second.  0 for no limit.  With a limit, the AimJoint turns towards each new
+	 * aim instead of snapping to it.  Turrets in the editor always snap.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Slew", meta = ( ClampMin = "0.0" ) )
+	float MaxYawSpeedDegrees;
+
+	/** Fastest the AimJoint can turn its pitch, in degrees per second.  0 for no limit.  Same as MaxYawSpeedDegrees. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Slew", meta = ( ClampMin = "0.0" ) )
+	float MaxPitchSpeedDegrees;
+
+	/**
+	 * Set this while the turret is firing.  With TurretRotation.Scheduler.Enabled, firing turrets are always in the Critical tier,
+	 * so they're solved every frame.  See FTurretAimScheduler.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Scheduling", meta = ( EditCondition = "bUseTurretManager" ) )
+	bool bIsFiring;
+
+	/**
+	 * How far (in degrees) to either side of the Actor's forward the AimJoint's yaw can turn.  180 means all the way around.  Every aim
+	 * (solved, extrapolated, or replicated) is clamped to this, and ATurretAimManager's coverage field (see FTurretCoverageField) uses
+	 * the same limit, so its answers match what the turret actually does.
+	 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Limits", meta = ( ClampMin = "0.0", ClampMax = "180.0" ) )
+	float MaxYawDegrees;
+
+	/** Lowest pitch (in degrees, relative to the Actor) the AimJoint can turn to.  Clamped and used by the coverage field, like MaxYawDegrees. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Limits", meta = ( ClampMin = "-180.0", ClampMax = "180.0" ) )
+	float MinPitchDegrees;
+
+	/** Highest pitch (in degrees, relative to the Actor) the AimJoint can turn to.  Clamped and used by the coverage field, like MaxYawDegrees. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Limits", meta = ( ClampMin = "-180.0", ClampMax = "180.0" ) )
+	float MaxPitchDegrees;
+
+	/** How the aim gets to clients.  Only read when play begins on the server. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret|Replication" )
+	ETurretAimReplication AimReplication;
+
+	/** Bits for the replicated yaw, when the angles are replicated.  Each step is 360 / 2^Bits degrees (0.088 degrees at 12 bits). */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret|Replication", meta = ( ClampMin = "10", ClampMax = "16" ) )
+	int32 ReplicatedYawBits;
+
+	/** Bits for the replicated pitch, when the angles are replicated. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret|Replication", meta = ( ClampMin = "10", ClampMax = "16" ) )
+	int32 ReplicatedPitchBits;
+
+	/**
+	 * Solves for the current target and applies the result to the AimJoint right away, instead of waiting for the next tick.
+	 */
+	UFUNCTION( BlueprintCallable, Category = "Turret" )
+	void UpdateAim();
+
+	/**
+	 * Forces the AimJoint/BarrelStart/BarrelEnd to be read again before the next solve.
+	 * Changes to the owner's scale or the barrel's mesh are detected automatically, so this is only needed for other changes
+	 * (like moving the BarrelStart/BarrelEnd components around).
+	 */
+	UFUNCTION( BlueprintCallable, Category = "Turret" )
+	void InvalidateGeometry();
+
+	/**
+	 * Gets how often the incremental solve was able to skip solving.
+	 *
+	 * @param Out_NumHits		OUT - Number of times the last result was reused.
+	 * @param Out_NumMisses		OUT - Number of times the turret had to be solved again.
+	 */
+	UFUNCTION( BlueprintPure, Category = "Turret|Incremental" )
+	void GetIncrementalSolveCounters( int32& Out_NumHits, int32& Out_NumMisses ) const;
+
+	/** Sets the incremental solve hit/miss counters back to 0. */
+	UFUNCTION( BlueprintCallable, Category = "Turret|Incremental" )
+	void ResetIncrementalSolveCounters();
+
+	/**
+	 * Gets how often bUseExtrapolation was able to skip solving.
+	 *
+	 * @param Out_NumExtrapolated	OUT - Number of times the aim was extrapolated.
+	 * @param Out_NumSolves			OUT - Number of times the turret had to be solved again.
+	 */
+	UFUNCTION( BlueprintPure, Category = "Turret|Extrapolation" )
+	void GetExtrapolationCounters( int32& Out_NumExtrapolated, int32& Out_NumSolves ) const;
+
+	/** Sets the extrapolation counters back to 0. */
+	UFUNCTION( BlueprintCallable, Category = "Turret|Extrapolation" )
+	void ResetExtrapolationCounters();
+
+	/** @return Returns the location (in world space) that the turret is aiming at. */
+	UFUNCTION( BlueprintPure, Category = "Turret" )
+	FVector GetTargetWorldLocation() const;
+
+	/**
+	 * Makes the query used to pick a target when bAutoAcquireTarget is set.
+	 *
+	 * @param ActorWorldTransform	The Actor's current world transform.
+	 * @return Returns a query from the AimJoint's location, with the acquisition range and the arc around the Actor's forward vector.
+	 */
+	FTurretTargetQuery MakeTargetQuery( const FTransform& ActorWorldTransform ) const;
+
+	/**
+	 * Makes the entry for ATurretAimManager's coverage field.  Only meaningful if HasValidGeometry returns true.
+	 *
+	 * @param ActorWorldTransform	The Actor's current world transform.
+	 * @return Returns the turret's geometry, with its yaw/pitch limits (the same ones the aim is clamped to), and the acquisition range.
+	 */
+	FTurretCoverageTurret MakeCoverageTurret( const FTransform& ActorWorldTransform ) const;
+
+	/** @return Returns the velocity (in world space) of the thing the turret is aiming at.  Zero when aiming at TargetLocation. */
+	UFUNCTION( BlueprintPure, Category = "Turret" )
+	FVector GetTargetWorldVelocity() const;
+
+	/** @return Returns the velocity (in world space) of the thing the turret is aiming at, minus the velocity of the turret's owner. */
+	FVector GetTargetRelativeVelocity() const;
+
+	/** @return Returns the last solution found with bUseBallisticAim.  Use this to know if (and where) to fire. */
+	UFUNCTION( BlueprintPure, Category = "Turret|Ballistic" )
+	const FTurretBallisticSolution& GetLastBallisticSolution() const { return LastBallisticSolution; }
+
+	/** Remembers the solution found for bUseBallisticAim.  Used by UpdateAim, and by ATurretAimManager after it solves this turret. */
+	void SetLastBallisticSolution( const FTurretBallisticSolution& Solution ) { LastBallisticSolution = Solution; }
+
+	/** @return Returns the last rotation applied to the AimJoint (relative to the Actor). */
+	UFUNCTION( BlueprintPure, Category = "Turret" )
+	FRotator GetAimJointRotation() const { return AimJointRotation; }
+
+	/** @return Returns the AimJoint component, or nullptr if AimJointName couldn't be found. */
+	USceneComponent* GetAimJoint() const { return AimJoint; }
+
+	/** @return Returns the cached geometry.  Only meaningful if HasValidGeometry returns true. */
+	const FTurretAimGeometry& GetGeometry() const { return Geometry; }
+
+	/** @return Returns the vector from the AimJoint to the BarrelStart that the geometry was made from (when the Actor is not Rotated/Scaled). */
+	const FVector& GetAimJointToBarrelStart() const { return GeometryAimJoint_To_BarrelStart; }
+
+	/** @return Returns the vector from the BarrelStart to the BarrelEnd that the geometry was made from (when the Actor is not Rotated/Scaled). */
+	const FVector& GetBarrelStartToBarrelEnd() const { return GeometryBarrelStart_To_BarrelEnd; }
+
+	/** @return Returns true if the AimJoint/BarrelStart/BarrelEnd were found, and the geometry was read from them. */
+	bool HasValidGeometry() const { return bHasValidGeometry; }
+
+	/**
+	 * Reads the geometry again if it needs to be (see InvalidateGeometry).  Must be called on the game thread.
+	 *
+	 * @return Returns true if the geometry is valid, and the turret can be solved.
+	 */
+	bool PrepareGeometry();
+
+	/**
+	 * With bUseIncrementalSolve, checks if the last solve can be reused for the given inputs.
+	 *
+	 * @param ActorWorldTransform	The Actor's current world transform.
+	 * @param TargetWorldLocation	The target's current location in world space.
+	 * @return Returns true if the AimJoint already has the right rotation, and the turret doesn't need to be solved.
+	 */
+	bool TryReuseLastSolve( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation );
+
+	/** @return Returns true if bUseExtrapolation is set, and the aim can be extrapolated (it isn't ballistic). */
+	bool UsesExtrapolation() const { return bUseExtrapolation && !bUseBallisticAim; }
+
+	/**
+	 * With bUseExtrapolation, checks if the last solve can be extrapolated to now instead of solving again, and applies it if so.
+	 *
+	 * @param ActorWorldTransform	The Actor's current world transform.
+	 * @param TargetWorldLocation	The target's current location in world space.
+	 * @return Returns true if the AimJoint was given the extrapolated rotation, and the turret doesn't need to be solved.
+	 */
+	bool TryExtrapolateAim( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation );
+
+	/**
+	 * Same as ApplySolve, but also remembers the rates for bUseExtrapolation.  See FTurretAimGeometry::SolveWithRatesForActor.
+	 *
+	 * @param SolveTime					World time (in seconds) when the inputs were read.
+	 * @param ActorWorldTransform		The Actor's world transform that was solved for.
+	 * @param TargetWorldLocation		The target's location that was solved for.
+	 * @param TargetRelativeVelocity	The target's velocity (relative to the Actor) that the rates were found for.
+	 * @param NewAimJointRotation		The new rotation for the AimJoint (relative to the Actor).
+	 * @param Rates						How fast the AimJoint turns, from the solve.
+	 */
+	void ApplySolveWithRates(
+		double SolveTime,
+		const FTransform& ActorWorldTransform,
+		const FVector& TargetWorldLocation,
+		const FVector& TargetRelativeVelocity,
+		const FRotator& NewAimJointRotation,
+		const FTurretAimRates& Rates );
+
+	/**
+	 * Applies the result of a new solve.  Used by UpdateAim, and by ATurretAimManager after it solves this turret.
+	 *
+	 * @param ActorWorldTransform	The Actor's world transform that was solved for.
+	 * @param TargetWorldLocation	The target's location that was solved for.
+	 * @param NewAimJointRotation	The new rotation for the AimJoint (relative to the Actor).
+	 */
+	void ApplySolve( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FRotator& NewAimJointRotation );
+
+	/**
+	 * Sets the AimJoint's relative rotation, clamped to MaxYawDegrees/MinPitchDegrees/MaxPitchDegrees.  With MaxYawSpeedDegrees/
+	 * MaxPitchSpeedDegrees, the AimJoint only turns towards it as far as it could have since the last call.
+	 *
+	 * @param NewAimJointRotation	The new rotation for the AimJoint (relative to the Actor).
+	 */
+	void ApplyAimJointRotation( const FRotator& NewAimJointRotation );
+
+	/** @return Returns the incremental solve cache. */
+	const FTurretAimCache& GetAimCache() const { return AimCache; }
+
+	/** @return Returns the extrapolation state for bUseExtrapolation. */
+	FTurretAimExtrapolation& GetAimExtrapolation() { return AimExtrapolation; }
+	const FTurretAimExtrapolation& GetAimExtrapolation() const { return AimExtrapolation; }
+
+	/** @return Returns what FTurretAimScheduler knows about this turret.  Only for ATurretAimManager and FTurretAimScheduler. */
+	FTurretScheduleState& GetScheduleState() { return ScheduleState; }
+	const FTurretScheduleState& GetScheduleState() const { return ScheduleState; }
+
+	/** @return Returns false on clients that get the server's angles instead of solving.  Solving would just be thrown away there. */
+	bool ShouldSolveLocally() const;
+
+	/** @return Returns true if bAutoAcquireTarget is set, and this isn't a client that gets its target (or its angles) from the server. */
+	bool ShouldAcquireTarget() const;
+
+	// UActorComponent interface
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+	virtual void TickComponent( float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
+	virtual void GetLifetimeReplicatedProps( TArray<FLifetimeProperty>& OutLifetimeProps ) const override;
+	virtual void PreReplication( IRepChangedPropertyTracker& ChangedPropertyTracker ) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty( FPropertyChangedEvent& PropertyChangedEvent ) override;
+#endif
+
+protected:
+	/** @return Returns true if this turret is in an editor world, and should be kept aimed by FTurretEditorRefresher. */
+	bool ShouldRefreshInEditor() const;
+
+	/** @return Returns true if the geometry needs to be read again (it was invalidated, or the owner's scale or barrel mesh changed). */
+	bool NeedsGeometryRefresh() const;
+
+	/** Finds the AimJoint/BarrelStart/BarrelEnd and reads the turret's geometry from them. */
+	void RefreshGeometry();
+
+	/** @return Returns true if the server should replicate the target instead of the angles right now (see ETurretAimReplication). */
+	bool ShouldReplicateTarget() const;
+
+	/** Sets the replicated aim (on the server) and the AimJoint's rotation. */
+	void ApplyAim( const FRotator& NewAimJointRotation );
+
+	/** @return Returns the rotation clamped to MaxYawDegrees, MinPitchDegrees, and MaxPitchDegrees. */
+	FRotator ApplyLimits( const FRotator& AimJointRotation ) const;
+
+	/** @return Returns true if MaxYawSpeedDegrees or MaxPitchSpeedDegrees limit how fast the AimJoint turns. */
+	bool IsSlewRateLimited() const;
+
+	/** @return Returns true if this is a client, and AimReplication is set. */
+	bool IsReplicatedClient() const;
+
+	UFUNCTION()
+	void OnRep_ReplicatedAim();
+
+	/**
+	 * Finds a component on the owner called Name, or a component that has a socket called Name.
+	 *
+	 * @param Name				Name of the component or socket to look for.
+	 * @param Out_SocketName	OUT - NAME_None if a component was found, otherwise the name of the socket.
+	 * @return Returns the component that was found, or nullptr.
+	 */
+	USceneComponent* FindComponentOrSocket( FName Name, FName& Out_SocketName ) const;
+
+	/** @return Returns the mesh asset used by the given component (if any).  Used to detect mesh changes. */
+	static const UObject* GetMeshAsset( const USceneComponent* Component );
+
+	/** The component that gets rotated. */
+	UPROPERTY( Transient )
+	USceneComponent* AimJoint;
+
+	/** The components (and sockets on them) that mark the start/end of the barrel. */
+	UPROPERTY( Transient )
+	USceneComponent* BarrelStartComponent;
+
+	UPROPERTY( Transient )
+	USceneComponent* BarrelEndComponent;
+
+	FName BarrelStartSocketName;
+	FName BarrelEndSocketName;
+
+	/** The meshes and the owner's scale that Geometry was read with, so changes can be detected. */
+	TWeakObjectPtr<const UObject> BarrelStartMesh;
+	TWeakObjectPtr<const UObject> BarrelEndMesh;
+	FVector GeometryActorScale;
+
+	/** The vectors Geometry was made from, so turret captures can replay them through CalculateTurretRotation_ForActor. */
+	FVector GeometryAimJoint_To_BarrelStart;
+	FVector GeometryBarrelStart_To_BarrelEnd;
+
+	/** Everything about the turret that doesn't depend on the target. */
+	FTurretAimGeometry Geometry;
+
+	/** Last solve, for bUseIncrementalSolve. */
+	FTurretAimCache AimCache;
+
+	/** Last solve and its rates, for bUseExtrapolation. */
+	FTurretAimExtrapolation AimExtrapolation;
+
+	/** Tier, significance, and the last solve, for FTurretAimScheduler. */
+	FTurretScheduleState ScheduleState;
+
+	bool bHasValidGeometry;
+	bool bGeometryInvalidated;
+
+	/** The last rotation applied to the AimJoint. */
+	FRotator AimJointRotation;
+
+	/** World time (in seconds) when the AimJoint's rotation was last set, for the slew limit.  Negative until it's first set. */
+	float LastAimTime;
+
+	/** The last solution found with bUseBallisticAim. */
+	FTurretBallisticSolution LastBallisticSolution;
+
+	/** The server's last aim, quantized.  Only replicated while bReplicatingTarget is false. */
+	UPROPERTY( ReplicatedUsing = OnRep_ReplicatedAim )
+	FTurretAimNetState ReplicatedAim;
+
+	/** True while the server replicates TargetActor/TargetLocation (and clients solve), false while it replicates ReplicatedAim. */
+	UPROPERTY( Replicated )
+	bool bReplicatingTarget;
+};
@@ -0,0 +1,113 @@
+#include "TurretAimExtrapolation.h"
+#include "TurretRotationRates.h"
+
+
+FTurretAimExtrapolation::FTurretAimExtrapolation()
+	: LastSolveTime( 0.0 )
+	, LastActorLocation( FVector::ZeroVector )
+	, LastActorRotation( FQuat::Identity )
+	, LastTargetOffset( FVector::ZeroVector )
+	, LastTargetRelativeVelocity( FVector::ZeroVector )
+	, LastAimJointRotation( FRotator::ZeroRotator )
+	, LastAimJointRates( FRotator::ZeroRotator )
+	, AngularAcceleration( 0.0f )
+	, bHasSolve( false )
+	, NumExtrapolated( 0 )
+	, NumSolves( 0 )
+{
+}
+
+void FTurretAimExtrapolation::RecordSolve(
+	double Time,
+	const FTransform& ActorWorldTransform,
+	const FVector& TargetWorldLocation,
+	const FVector& TargetRelativeVelocity,
+	const FRotator& AimJointRotation,
+	const FTurretAimRates& Rates )
+{
+	const FRotator& AimJointRates = Rates.AimJointRates;
+
+	// The solve only predicts the change for a target that keeps its velocity.  The rates are exact at each solve, so the change
+	// between the last two also covers targets that turn.
+	AngularAcceleration = Rates.AngularAcceleration;
+	const float SecondsSinceLastSolve = static_cast<float>( Time - LastSolveTime );
+	if ( bHasSolve && SecondsSinceLastSolve > KINDA_SMALL_NUMBER )
+	{
+		const float YawRateChange = FMath::Abs( AimJointRates.Yaw - LastAimJointRates.Yaw );
+		const float PitchRateChange = FMath::Abs( AimJointRates.Pitch - LastAimJointRates.Pitch );
+		AngularAcceleration = FMath::Max( AngularAcceleration, FMath::Max( YawRateChange, PitchRateChange ) / SecondsSinceLastSolve );
+	}
+
+	LastSolveTime = Time;
+	LastActorLocation = ActorWorldTransform.GetLocation();
+	LastActorRotation = ActorWorldTransform.GetRotation();
+	LastTargetOffset = TargetWorldLocation - LastActorLocation;
+	LastTargetRelativeVelocity = TargetRelativeVelocity;
+	LastAimJointRotation = AimJointRotation;
+	LastAimJointRates = AimJointRates;
+	bHasSolve = true;
+}
+
+bool FTurretAimExtrapolation::TryExtrapolate(
+	double Time,
+	const FTransform& ActorWorldTransform,
+	const FVector& TargetWorldLocation,
+	float MaxErrorDegrees,
+	float MaxSeconds,
+	FRotator& Out_AimJointRotation )
+{
+	const bool bCanExtrapolate = bHasSolve
+		&& ( Time - LastSolveTime ) <= MaxSeconds
+		&& EstimateErrorDegrees( Time, ActorWorldTransform, TargetWorldLocation ) <= MaxErrorDegrees;
+
+	if ( !bCanExtrapolate )
+	{
+		++NumSolves;
+		return false;
+	}
+
+	++NumExtrapolated;
+	Out_AimJointRotation = Extrapolate( Time );
+	return true;
+}
+
+float FTurretAimExtrapolation::EstimateErrorDegrees( double Time, const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation ) const
+{
+	const float Seconds = static_cast<float>( Time - LastSolveTime );
+
+	// Everything is relative to the Actor, so the Actor moving is the same as the target moving the other way.
+	const FVector TargetOffset = TargetWorldLocation - ActorWorldTransform.GetLocation();
+	const FVector PredictedTargetOffset = LastTargetOffset + ( LastTargetRelativeVelocity * Seconds );
+	const float TargetDeviation = FVector::Dist( TargetOffset, PredictedTargetOffset );
+
+	// The rates are relative to the Actor, so any rotation of the Actor since the solve is missing from them.
+	const float ActorRotationDegrees = FMath::RadiansToDegrees( ActorWorldTransform.GetRotation().AngularDistance( LastActorRotation ) );
+
+	return TurretRotationCore::EstimateExtrapolationErrorDegrees( AngularAcceleration, Seconds, TargetDeviation, TargetOffset.Size() ) + ActorRotationDegrees;
+}
+
+FRotator FTurretAimExtrapolation::Extrapolate( double Time ) const
+{
+	TurretRotationCore::TAimAngles<float> Angles;
+	Angles.Pitch = LastAimJointRotation.Pitch;
+	Angles.Yaw = LastAimJointRotation.Yaw;
+
+	TurretRotationCore::TAimAngles<float> Rates;
+	Rates.Pitch = LastAimJointRates.Pitch;
+	Rates.Yaw = LastAimJointRates.Yaw;
+
+	const TurretRotationCore::TAimAngles<float> Extrapolated = TurretRotationCore::ExtrapolateAimAngles( Angles, Rates, static_cast<float>( Time - LastSolveTime ) );
+	return FRotator( Extrapolated.Pitch, Extrapolated.Yaw, 0.0f );
+}
+
+void FTurretAimExtrapolation::Invalidate()
+{
+	bHasSolve = false;
+	AngularAcceleration = 0.0f;
+}
+
+void FTurretAimExtrapolation::ResetCounters()
+{
+	NumExtrapolated = 0;
+	NumSolves = 0;
+}
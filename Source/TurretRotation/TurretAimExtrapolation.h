@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TurretAimGeometry.h"
+
+/**
+ * Lets a turret tracking a smoothly moving target solve at a lower rate, by moving the aim along its angular velocity in between.
+ *
+ * Each solve also finds how fast the yaw/pitch are turning for the target's velocity (see TurretRotationRates.h).  Until the next solve,
+ * the aim is extrapolated along those rates, and a new solve only happens once the estimated error passes a threshold, or the last
+ * solve gets too old.  The error estimate covers the rates changing, the target not following its velocity, and the Actor rotating.
+ * How fast the rates change is the larger of what the solve predicts (see TurretRotationCore::EstimateAimAcceleration) and how much
+ * they actually changed between the last two solves.
+ *
+ * Solves/extrapolations are counted so the threshold can be tuned against the CPU saved.
+ */
+struct TURRETROTATION_API FTurretAimExtrapolation
+{
+public:
+	FTurretAimExtrapolation();
+
+	/**
+	 * Remembers a new solve and its rates.
+	 *
+	 * @param Time						World time (in seconds) of the solve.
+	 * @param ActorWorldTransform		The Actor's world transform that was solved for.
+	 * @param TargetWorldLocation		The target's location that was solved for.
+	 * @param TargetRelativeVelocity	The target's velocity relative to the Actor, in world space, that the rates were found for.
+	 * @param AimJointRotation			The result of the solve.
+	 * @param Rates						How fast the AimJoint turns, from the solve.
+	 */
+	void RecordSolve(
+		double Time,
+		const FTransform& ActorWorldTransform,
+		const FVector& TargetWorldLocation,
+		const FVector& TargetRelativeVelocity,
+		const FRotator& AimJointRotation,
+		const FTurretAimRates& Rates );
+
+	/**
+	 * Extrapolates the last solve to the given time, if it's still close enough.  Counts an extrapolation or a solve.
+	 *
+	 * @param Time						World time (in seconds) to extrapolate to.
+	 * @param ActorWorldTransform		The Actor's current world transform.
+	 * @param TargetWorldLocation		The target's current location in world space.
+	 * @param MaxErrorDegrees			Largest estimated error (see EstimateErrorDegrees) to extrapolate with.
+	 * @param MaxSeconds				Longest time since the last solve to extrapolate over.
+	 * @param Out_AimJointRotation		OUT - The extrapolated rotation, only set if this returns true.
+	 * @return Returns true if the extrapolated rotation can be used, otherwise false (and the turret needs to be solved).
+	 */
+	bool TryExtrapolate(
+		double Time,
+		const FTransform& ActorWorldTransform,
+		const FVector& TargetWorldLocation,
+		float MaxErrorDegrees,
+		float MaxSeconds,
+		FRotator& Out_AimJointRotation );
+
+	/**
+	 * @param Time						World time (in seconds) to extrapolate to.
+	 * @param ActorWorldTransform		The Actor's current world transform.
+	 * @param TargetWorldLocation		The target's current location in world space.
+	 * @return Returns how far (in degrees) the extrapolated aim is estimated to be from a new solve.  Only meaningful if HasSolve is true.
+	 */
+	float EstimateErrorDegrees( double Time, const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation ) const;
+
+	/** @return Returns the last solve moved along its rates to the given time.  Only meaningful if HasSolve is true. */
+	FRotator Extrapolate( double Time ) const;
+
+	/** Forces the next TryExtrapolate to fail, and forgets how fast the rates were changing.  Needed whenever the turret's geometry changes. */
+	void Invalidate();
+
+	/** Sets the solve/extrapolation counters back to 0. */
+	void ResetCounters();
+
+	bool HasSolve() const { return bHasSolve; }
+
+	/** @return Returns the world time (in seconds) of the last solve.  Only meaningful if HasSolve is true. */
+	double GetLastSolveTime() const { return LastSolveTime; }
+
+	/** @return Returns the rates found by the last solve, in degrees per second. */
+	const FRotator& GetLastAimJointRates() const { return LastAimJointRates; }
+
+	/** @return Returns how fast the rates are expected to change, in degrees per second squared. */
+	float GetAngularAcceleration() const { return AngularAcceleration; }
+
+	/** @return Returns how many times the aim was extrapolated instead of solved. */
+	int64 GetNumExtrapolated() const { return NumExtrapolated; }
+
+	/** @return Returns how many times a new solve was needed. */
+	int64 GetNumSolves() const { return NumSolves; }
+
+private:
+	/** Inputs of the last solve. */
+	double LastSolveTime;
+	FVector LastActorLocation;
+	FQuat LastActorRotation;
+	FVector LastTargetOffset;
+	FVector LastTargetRelativeVelocity;
+
+	/** Result of the last solve. */
+	FRotator LastAimJointRotation;
+	FRotator LastAimJointRates;
+
+	/** How fast the rates are expected to change (the larger of the pitch/yaw). */
+	float AngularAcceleration;
+
+	bool bHasSolve;
+
+	int64 NumExtrapolated;
+	int64 NumSolves;
+};
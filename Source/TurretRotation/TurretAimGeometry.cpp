@@ -0,0 +1,213 @@
+#include "TurretAimGeometry.h"
+#include "TurretRotationBallistics.h"
+#include "TurretRotation.h"
+#include "HAL/IConsoleManager.h"
+
+
+static TAutoConsoleVariable<int32> CVarTurretAimAccuracy(
+	TEXT( "TurretRotation.Accuracy" ),
+	0,
+	TEXT( "How accurately the trig in every turret yaw/pitch solve is done.\n" )
+	TEXT( " 0: Exact (default)\n" )
+	TEXT( " 1: Fast - polynomial Atan2, within 0.0002 degrees of Exact\n" )
+	TEXT( " 2: Approximate - lower order polynomial Atan2, within 0.036 degrees of Exact" ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<int32> CVarTurretSpecializedKernels(
+	TEXT( "TurretRotation.SpecializedKernels" ),
+	1,
+	TEXT( "If 1 (default), turret yaw/pitch solves use the kernel specialized for each turret's geometry (see TurretRotationKernels.h).\n" )
+	TEXT( "The batched solve (CalculateTurretRotations_ForActors, UTurretInstancedAimComponent) is its own SIMD kernel and ignores this.\n" )
+	TEXT( "If 0, every turret uses the general solve.  Both agree to within 0.1 degrees (AIM_KERNEL_TOLERANCE_DEGREES); turrets whose\n" )
+	TEXT( "barrel ends much closer to the AimJoint than it starts always use the general solve, since float rounding can't match there." ),
+	ECVF_Default );
+
+
+FTurretAimGeometry::FTurretAimGeometry()
+	: Actor_To_AimJoint( FVector::ZeroVector )
+	, ActorScale( FVector::OneVector )
+	, Kernel( TurretRotationCore::EAimKernel::Reference )
+{
+}
+
+FTurretAimGeometry::FTurretAimGeometry(
+	const FVector& InActor_To_AimJoint,
+	const FVector& AimJoint_To_BarrelStart,
+	const FVector& BarrelStart_To_BarrelEnd,
+	const FVector& InActorScale )
+	: Actor_To_AimJoint( InActor_To_AimJoint )
+	, ActorScale( InActorScale )
+	, Core( TurretRotationCore::TAimGeometry<float, FVector2D>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, InActorScale ) )
+	, Kernel( TurretRotationCore::ChooseAimKernel( Core ) )
+{
+}
+
+TurretRotationCore::EAimAccuracy FTurretAimGeometry::GetAccuracy()
+{
+	// Solves run on worker threads too (ATurretAimManager, the Offset Turret Aim AnimGraph node), so this can't be GetValueOnGameThread.
+	const int32 Accuracy = FMath::Clamp( CVarTurretAimAccuracy.GetValueOnAnyThread(), 0, 2 );
+	return static_cast<TurretRotationCore::EAimAccuracy>( Accuracy );
+}
+
+FTurretSolveSettings FTurretAimGeometry::GetSolveSettings()
+{
+	FTurretSolveSettings SolveSettings;
+	SolveSettings.Accuracy = GetAccuracy();
+	SolveSettings.bUseSpecializedKernels = UseSpecializedKernels();
+	return SolveSettings;
+}
+
+void FTurretAimGeometry::SetAccuracy( TurretRotationCore::EAimAccuracy Accuracy )
+{
+	CVarTurretAimAccuracy->Set( static_cast<int32>( Accuracy ), ECVF_SetByCode );
+}
+
+bool FTurretAimGeometry::UseSpecializedKernels()
+{
+	// Same as GetAccuracy, this is read on worker threads too.
+	return CVarTurretSpecializedKernels.GetValueOnAnyThread() != 0;
+}
+
+void FTurretAimGeometry::SetUseSpecializedKernels( bool bUseSpecializedKernels )
+{
+	CVarTurretSpecializedKernels->Set( bUseSpecializedKernels ? 1 : 0, ECVF_SetByCode );
+}
+
+FTurretAimGeometry FTurretAimGeometry::MakeFromLocations2D( const FVector2D& AimJointLocation2D, const FVector2D& BarrelStartLocation2D, const FVector2D& BarrelEndLocation2D )
+{
+	FTurretAimGeometry Result;
+	Result.Core = TurretRotationCore::TAimGeometry<float, FVector2D>::MakeFromLocations2D( AimJointLocation2D, BarrelStartLocation2D, BarrelEndLocation2D );
+	Result.Kernel = TurretRotationCore::ChooseAimKernel( Result.Core );
+	return Result;
+}
+
+FRotator FTurretAimGeometry::SolveForActor( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats ) const
+{
+	// The AimJoint's world transform is FTransform( Actor_To_AimJoint ) * ActorWorldTransform.  Once its scale is removed, it only has
+	// the Actor's rotation, so instead of building and inverting that transform we can just un-rotate the AimJoint_To_Target vector.
+	const FVector AimJointWorldLocation = ActorWorldTransform.TransformPosition( Actor_To_AimJoint );
+	const FVector Target_InAimJointSpace = ActorWorldTransform.GetRotation().UnrotateVector( TargetWorldLocation - AimJointWorldLocation );
+
+	return Solve( Target_InAimJointSpace, SolveSettings, SolveStats );
+}
+
+FTurretBallisticSolution FTurretAimGeometry::SolveBallisticForActor(
+	const FTransform& ActorWorldTransform,
+	const FVector& TargetWorldLocation,
+	const FVector& TargetVelocity,
+	const FVector& TargetAcceleration,
+	const FTurretBallisticSettings& Settings,
+	const FTurretSolveSettings& SolveSettings,
+	FTurretSolveStats* SolveStats ) const
+{
+	// Same as SolveForActor, every vector is un-rotated into AimJoint space.  Velocities/accelerations (and gravity) only need rotating.
+	const FQuat ActorRotation = ActorWorldTransform.GetRotation();
+	const FVector AimJointWorldLocation = ActorWorldTransform.TransformPosition( Actor_To_AimJoint );
+	const FVector Target_InAimJointSpace = ActorRotation.UnrotateVector( TargetWorldLocation - AimJointWorldLocation );
+	const FVector Gravity_InAimJointSpace = ActorRotation.UnrotateVector( FVector( 0.0f, 0.0f, Settings.GravityZ ) );
+
+	TurretRotationCore::TBallisticSettings<float> CoreSettings;
+	CoreSettings.MuzzleSpeed = Settings.MuzzleSpeed;
+	CoreSettings.Gravity = TurretRotationCore::TVector3<float>( Gravity_InAimJointSpace.X, Gravity_InAimJointSpace.Y, Gravity_InAimJointSpace.Z );
+	CoreSettings.bHighArc = Settings.bUseHighArc;
+	CoreSettings.MaxIterations = Settings.MaxIterations;
+	CoreSettings.TimeTolerance = Settings.TimeTolerance;
+	CoreSettings.Accuracy = SolveSettings.Accuracy;
+
+	const TurretRotationCore::TBallisticSolution<float> CoreSolution = TurretRotationCore::SolveBallistic(
+		Core,
+		Target_InAimJointSpace,
+		ActorRotation.UnrotateVector( TargetVelocity ),
+		ActorRotation.UnrotateVector( TargetAcceleration ),
+		CoreSettings,
+		SolveStats ? SolveStats->GetEvents() : nullptr );
+	if ( SolveStats )
+	{
+		SolveStats->AddSolve();
+	}
+
+	const FVector ImpactLocation_InAimJointSpace( CoreSolution.ImpactLocation.X, CoreSolution.ImpactLocation.Y, CoreSolution.ImpactLocation.Z );
+	const FVector MuzzleLocation_InAimJointSpace( CoreSolution.MuzzleLocation.X, CoreSolution.MuzzleLocation.Y, CoreSolution.MuzzleLocation.Z );
+
+	FTurretBallisticSolution Solution;
+	Solution.bHasSolution = CoreSolution.bHasSolution;
+	Solution.AimJointRotation = FRotator( CoreSolution.Angles.Pitch, CoreSolution.Angles.Yaw, 0.0f );
+	Solution.TimeOfFlight = CoreSolution.TimeOfFlight;
+	Solution.PredictedImpactLocation = AimJointWorldLocation + ActorRotation.RotateVector( ImpactLocation_InAimJointSpace );
+	Solution.MuzzleWorldLocation = AimJointWorldLocation + ActorRotation.RotateVector( MuzzleLocation_InAimJointSpace );
+	Solution.NumIterations = CoreSolution.NumIterations;
+	return Solution;
+}
+
+FRotator FTurretAimGeometry::SolveWithRatesForActor( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FVector& TargetRelativeVelocity, float LookAheadSeconds, FTurretAimRates& Out_Rates, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats ) const
+{
+	// Same as SolveForActor.  The velocity only needs un-rotating.
+	const FQuat ActorRotation = ActorWorldTransform.GetRotation();
+	const FVector AimJointWorldLocation = ActorWorldTransform.TransformPosition( Actor_To_AimJoint );
+	const FVector Target_InAimJointSpace = ActorRotation.UnrotateVector( TargetWorldLocation - AimJointWorldLocation );
+	const FVector TargetVelocity_InAimJointSpace = ActorRotation.UnrotateVector( TargetRelativeVelocity );
+
+	const TurretRotationCore::TAimAngles<float> Rates = TurretRotationCore::CalculateAimRates( Core, Target_InAimJointSpace, TargetVelocity_InAimJointSpace );
+	Out_Rates.AimJointRates = FRotator( Rates.Pitch, Rates.Yaw, 0.0f );
+
+	Out_Rates.AngularAcceleration = TurretRotationCore::EstimateAimAcceleration( Core, Target_InAimJointSpace, TargetVelocity_InAimJointSpace, Rates, LookAheadSeconds );
+
+	return Solve( Target_InAimJointSpace, SolveSettings, SolveStats );
+}
+
+FRotator FTurretAimGeometry::SolveForAimJoint( const FTransform& AimJointWorldTransform, const FVector& TargetWorldLocation, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats ) const
+{
+	// We're ignoring Scale since we only care about Rotation/Translation when finding the target's location relative to the AimJoint.
+	const FVector Target_InAimJointSpace = AimJointWorldTransform.GetRotation().UnrotateVector( TargetWorldLocation - AimJointWorldTransform.GetTranslation() );
+
+	return Solve( Target_InAimJointSpace, SolveSettings, SolveStats );
+}
+
+FRotator FTurretAimGeometry::Solve( const FVector& Target_InAimJointSpace, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats ) const
+{
+	const TurretRotationCore::EAimKernel SolveKernel = SolveSettings.bUseSpecializedKernels ? Kernel : TurretRotationCore::EAimKernel::Reference;
+	const TurretRotationCore::TAimAngles<float> Angles = TurretRotationCore::SolveWithKernel( SolveKernel, Core, Target_InAimJointSpace, SolveSettings.Accuracy, SolveStats ? SolveStats->GetEvents() : nullptr );
+	if ( SolveStats )
+	{
+		SolveStats->AddSolve();
+	}
+
+	return FRotator( Angles.Pitch, Angles.Yaw, 0.0f );
+}
+
+FQuat FTurretAimGeometry::SolveQuat( const FVector& Target_InAimJointSpace, FTurretSolveStats* SolveStats ) const
+{
+	const TurretRotationCore::TQuaternion<float> Quaternion = TurretRotationCore::MakeAimQuaternion( Core.SolveRotation( Target_InAimJointSpace, SolveStats ? SolveStats->GetEvents() : nullptr ) );
+	if ( SolveStats )
+	{
+		SolveStats->AddSolve();
+	}
+
+	return FQuat( Quaternion.X, Quaternion.Y, Quaternion.Z, Quaternion.W );
+}
+
+FQuat FTurretAimGeometry::SolveQuatForActor( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, FTurretSolveStats* SolveStats ) const
+{
+	// Same as SolveForActor.
+	const FVector AimJointWorldLocation = ActorWorldTransform.TransformPosition( Actor_To_AimJoint );
+	const FVector Target_InAimJointSpace = ActorWorldTransform.GetRotation().UnrotateVector( TargetWorldLocation - AimJointWorldLocation );
+
+	return SolveQuat( Target_InAimJointSpace, SolveStats );
+}
+
+FQuat FTurretAimGeometry::SolveQuatForAimJoint( const FMatrix& WorldToAimJoint, const FVector& TargetWorldLocation, FTurretSolveStats* SolveStats ) const
+{
+	return SolveQuat( WorldToAimJoint.TransformPosition( TargetWorldLocation ), SolveStats );
+}
+
+float FTurretAimGeometry::SolvePitch( const FVector2D& TargetLocation2D, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats ) const
+{
+	const TurretRotationCore::EAimKernel SolveKernel = SolveSettings.bUseSpecializedKernels ? Kernel : TurretRotationCore::EAimKernel::Reference;
+	const float Pitch = TurretRotationCore::SolvePitchWithKernel( SolveKernel, Core, TargetLocation2D, SolveSettings.Accuracy, SolveStats ? SolveStats->GetEvents() : nullptr );
+	if ( SolveStats )
+	{
+		SolveStats->AddSolve();
+	}
+
+	return Pitch;
+}
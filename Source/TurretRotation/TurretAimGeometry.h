@@ -0,0 +1,259 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TurretRotationCore.h"
+#include "TurretRotationKernels.h"
+#include "TurretRotationRates.h"
+#include "TurretBallisticAim.h"
+
+class FTurretSolveStats;
+
+/**
+ * The console variables that change how FTurretAimGeometry solves, read once (see FTurretAimGeometry::GetSolveSettings) so that a batch
+ * of solves doesn't read them for every turret, and every turret in the batch is solved the same way.
+ */
+struct FTurretSolveSettings
+{
+	/** How accurately the trig is done.  See TurretRotationCore::EAimAccuracy. */
+	TurretRotationCore::EAimAccuracy Accuracy;
+
+	/** If true, Solve/SolvePitch use the kernel picked for each geometry (see FTurretAimGeometry::GetKernel) instead of the general solve. */
+	bool bUseSpecializedKernels;
+
+	FTurretSolveSettings()
+		: Accuracy( TurretRotationCore::EAimAccuracy::Exact )
+		, bUseSpecializedKernels( true )
+	{
+	}
+};
+
+/**
+ * How fast the AimJoint turns to keep up with a moving target.  See FTurretAimGeometry::SolveWithRatesForActor.
+ */
+struct FTurretAimRates
+{
+	/** How fast the AimJoint's pitch/yaw turn, in degrees per second. */
+	FRotator AimJointRates;
+
+	/** How fast the rates change (the larger of the pitch/yaw) if the target keeps its velocity, in degrees per second squared. */
+	float AngularAcceleration;
+
+	FTurretAimRates()
+		: AimJointRates( FRotator::ZeroRotator )
+		, AngularAcceleration( 0.0f )
+	{
+	}
+};
+
+/**
+ * Everything about a turret that doesn't depend on the target.
+ *
+ * Most of the work in CalculateTurretPitch only depends on the AimJoint/BarrelStart/BarrelEnd, which don't change from frame to frame.
+ * This struct does that work once (when the turret is set up, or when the Actor's scale changes), so that solving for a target
+ * only costs one inverse transform, a couple of square roots, and the trig for the final yaw/pitch.
+ *
+ * The UTurretRotationFunctionLibrary functions are built on top of this, so both share the same implementation.
+ * The 2D part of the math lives in TurretRotationCore::TAimGeometry. This struct adds the Actor's transform on top of it.
+ *
+ * Solve and SolvePitch go through the specialized kernel picked for this geometry when it's made (see TurretRotationKernels.h), unless
+ * FTurretSolveSettings::bUseSpecializedKernels is false (TurretRotation.SpecializedKernels is 0).
+ *
+ * Every solve takes the FTurretSolveSettings to solve with, and an optional FTurretSolveStats to count itself in.  Callers solving many
+ * turrets should read the settings once (GetSolveSettings) and pass the same settings/stats to all of them, so the console variables are
+ * only read, and the stats only touched, once per batch.  Without stats, the solve isn't counted.
+ */
+struct TURRETROTATION_API FTurretAimGeometry
+{
+public:
+	/** Makes a geometry for a turret whose BarrelStart/BarrelEnd sit on top of the AimJoint.  Not very useful, but always valid. */
+	FTurretAimGeometry();
+
+	/**
+	 * Makes the geometry for a turret Actor.  The vectors are the same as the ones given to CalculateTurretRotation_ForActor.
+	 *
+	 * @param Actor_To_AimJoint			The vector from the Actor's location to the AimJoint's location (when the Actor is not Rotated/Scaled).
+	 * @param AimJoint_To_BarrelStart	The vector from the AimJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param BarrelStart_To_BarrelEnd	The vector from the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param ActorScale				The Actor's scale.  If this changes, then the geometry has to be made again.
+	 */
+	FTurretAimGeometry(
+		const FVector& Actor_To_AimJoint,
+		const FVector& AimJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& ActorScale = FVector::OneVector );
+
+	/**
+	 * Makes the geometry from AimJoint/BarrelStart/BarrelEnd locations that are already aligned on the "X-Z" plane (see CalculateTurretPitch).
+	 * Only SolvePitch can be used with a geometry made this way.
+	 *
+	 * @param AimJointLocation2D		Location of the AimJoint.
+	 * @param BarrelStartLocation2D		Location of the BarrelStart.
+	 * @param BarrelEndLocation2D		Location of the BarrelEnd.
+	 */
+	static FTurretAimGeometry MakeFromLocations2D( const FVector2D& AimJointLocation2D, const FVector2D& BarrelStartLocation2D, const FVector2D& BarrelEndLocation2D );
+
+	/**
+	 * Calculates the rotation for the AimJoint (relative to the Actor) so the turret's barrel points at the target.
+	 * Same as CalculateTurretRotation_ForActor.
+	 *
+	 * @param ActorWorldTransform	The Actor's world transform.  Its scale should match the ActorScale this geometry was made with.
+	 * @param TargetWorldLocation	The target's location in world space.
+	 * @param SolveSettings			How to solve (the accuracy, and whether to use the specialized kernel).  See GetSolveSettings.
+	 * @param SolveStats			Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FRotator SolveForActor( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Calculates the rotation for the AimJoint (relative to the Actor) so that a projectile fired from the BarrelEnd hits a moving target.
+	 * See TurretRotationBallistics.h.
+	 *
+	 * @param ActorWorldTransform		The Actor's world transform.  Its scale should match the ActorScale this geometry was made with.
+	 * @param TargetWorldLocation		The target's current location in world space.
+	 * @param TargetVelocity			The target's velocity in world space.
+	 * @param TargetAcceleration		The target's acceleration in world space.  Zero if unknown.
+	 * @param Settings					Muzzle speed, gravity, which arc to use, and the iteration cap.
+	 * @param SolveSettings				How to solve (the accuracy, and whether to use the specialized kernel).  See GetSolveSettings.
+	 * @param SolveStats				Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the solution, including whether there is one.
+	 */
+	FTurretBallisticSolution SolveBallisticForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& TargetWorldLocation,
+		const FVector& TargetVelocity,
+		const FVector& TargetAcceleration,
+		const FTurretBallisticSettings& Settings,
+		const FTurretSolveSettings& SolveSettings,
+		FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Same as SolveForActor, but also finds how fast the AimJoint has to turn to keep up with the target.  See TurretRotationRates.h.
+	 *
+	 * @param ActorWorldTransform		The Actor's world transform.  Its scale should match the ActorScale this geometry was made with.
+	 * @param TargetWorldLocation		The target's location in world space.
+	 * @param TargetRelativeVelocity	The target's velocity relative to the Actor, in world space.
+	 * @param LookAheadSeconds			How far ahead to look for how fast the rates change.  Should be the longest the aim is extrapolated for
+	 *									(the turret's MaxExtrapolationSeconds).  See TurretRotationCore::EstimateAimAcceleration.
+	 * @param Out_Rates					OUT - How fast the AimJoint turns, and how fast that changes.
+	 * @param SolveSettings				How to solve (the accuracy, and whether to use the specialized kernel).  See GetSolveSettings.
+	 * @param SolveStats				Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FRotator SolveWithRatesForActor( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, const FVector& TargetRelativeVelocity, float LookAheadSeconds, FTurretAimRates& Out_Rates, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Calculates the rotation for the AimJoint (relative to the Actor) so the turret's barrel points at the target.
+	 * Same as CalculateTurretRotation_ForAimJoint.
+	 *
+	 * @param AimJointWorldTransform	Transform that represents the AimJoint in world space.  Its scale is ignored.
+	 * @param TargetWorldLocation		The target's location in world space.
+	 * @param SolveSettings				How to solve (the accuracy, and whether to use the specialized kernel).  See GetSolveSettings.
+	 * @param SolveStats				Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FRotator SolveForAimJoint( const FTransform& AimJointWorldTransform, const FVector& TargetWorldLocation, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Calculates the rotation for the AimJoint so the turret's barrel points at the target.
+	 * This is the cheapest solve, since the target is already in AimJoint space.  Every other solve ends up here, and the trig is done
+	 * at SolveSettings.Accuracy.
+	 *
+	 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+	 * @param SolveSettings				How to solve (the accuracy, and whether to use the specialized kernel).  See GetSolveSettings.
+	 * @param SolveStats				Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FRotator Solve( const FVector& Target_InAimJointSpace, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Same as Solve, but returns a quaternion, without going through degrees or an FRotator (and without any trig).
+	 * Meant for callers that end up calling SetRelativeRotation( FQuat ) anyway.
+	 *
+	 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+	 * @param SolveStats				Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FQuat SolveQuat( const FVector& Target_InAimJointSpace, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Same as SolveForActor, but returns a quaternion.  See SolveQuat.
+	 *
+	 * @param ActorWorldTransform	The Actor's world transform.  Its scale should match the ActorScale this geometry was made with.
+	 * @param TargetWorldLocation	The target's location in world space.
+	 * @param SolveStats			Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FQuat SolveQuatForActor( const FTransform& ActorWorldTransform, const FVector& TargetWorldLocation, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Same as SolveForAimJoint, but takes a precomputed world to AimJoint matrix (which can be reused for every target, and for
+	 * every turret sharing the same AimJoint transform), and returns a quaternion.  See SolveQuat.
+	 *
+	 * @param WorldToAimJoint		Inverse of the AimJoint's world transform, without any scale (the inverse of its rotation/translation matrix).
+	 * @param TargetWorldLocation	The target's location in world space.
+	 * @param SolveStats			Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	FQuat SolveQuatForAimJoint( const FMatrix& WorldToAimJoint, const FVector& TargetWorldLocation, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * Same as Solve, but returns the sine/cosine of the yaw/pitch instead of degrees.  See TurretRotationCore::TAimGeometry::SolveRotation.
+	 *
+	 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+	 * @return Returns the yaw/pitch for the AimJoint, as sines/cosines.
+	 */
+	TurretRotationCore::TAimRotation<float> SolveSinCos( const FVector& Target_InAimJointSpace ) const { return Core.SolveRotation( Target_InAimJointSpace ); }
+
+	/**
+	 * Calculates the pitch for a target that is already aligned with the turret on the "X-Z" plane.  Same as CalculateTurretPitch.
+	 *
+	 * @param TargetLocation2D	Location of the Target, in the same space as the AimJoint/BarrelStart/BarrelEnd.
+	 * @param SolveSettings		How to solve (the accuracy, and whether to use the specialized kernel).  See GetSolveSettings.
+	 * @param SolveStats		Counts the solve (and its edge cases), if given.  See FTurretSolveStats.
+	 * @return Returns the pitch, or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the TargetLocation.
+	 */
+	float SolvePitch( const FVector2D& TargetLocation2D, const FTurretSolveSettings& SolveSettings, FTurretSolveStats* SolveStats = nullptr ) const;
+
+	/**
+	 * @return Returns how accurately the solves do their trig, from the TurretRotation.Accuracy console variable.
+	 * See TurretRotationCore::EAimAccuracy for the tiers and their error bounds.
+	 */
+	static TurretRotationCore::EAimAccuracy GetAccuracy();
+
+	/** @return Returns the settings to solve with, from the TurretRotation.* console variables.  Read this once per batch (or frame) of solves. */
+	static FTurretSolveSettings GetSolveSettings();
+
+	/** Changes the accuracy used by every solve (sets TurretRotation.Accuracy). */
+	static void SetAccuracy( TurretRotationCore::EAimAccuracy Accuracy );
+
+	/** @return Returns true if Solve/SolvePitch should use the specialized kernels, from the TurretRotation.SpecializedKernels console variable. */
+	static bool UseSpecializedKernels();
+
+	/** Turns the specialized kernels on/off for every solve (sets TurretRotation.SpecializedKernels). */
+	static void SetUseSpecializedKernels( bool bUseSpecializedKernels );
+
+	/** @return Returns the specialized kernel picked for this geometry.  Only used if FTurretSolveSettings::bUseSpecializedKernels is true. */
+	TurretRotationCore::EAimKernel GetKernel() const { return Kernel; }
+
+	/** @return Returns the vector from the Actor's location to the AimJoint's location (when the Actor is not Rotated/Scaled). */
+	const FVector& GetActorToAimJoint() const { return Actor_To_AimJoint; }
+
+	/** @return Returns the Actor scale that this geometry was made with. */
+	const FVector& GetActorScale() const { return ActorScale; }
+
+	/** @return Returns the engine-independent part of the geometry. */
+	const TurretRotationCore::TAimGeometry<float, FVector2D>& GetCore() const { return Core; }
+
+private:
+	/** The vector from the Actor's location to the AimJoint's location (when the Actor is not Rotated/Scaled). */
+	FVector Actor_To_AimJoint;
+
+	/** The Actor scale that the BarrelStart/BarrelEnd were scaled by. */
+	FVector ActorScale;
+
+	/** Everything on the "X-Z" plane.  The AimJoint is at the origin unless made with MakeFromLocations2D. */
+	TurretRotationCore::TAimGeometry<float, FVector2D> Core;
+
+	/** The solve that fits Core best, picked by TurretRotationCore::ChooseAimKernel whenever Core is made. */
+	TurretRotationCore::EAimKernel Kernel;
+};
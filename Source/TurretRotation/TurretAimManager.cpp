@@ -0,0 +1,680 @@
+#include "TurretAimManager.h"
+#include "TurretAimComponent.h"
+#include "TurretTargetComponent.h"
+#include "TurretRotation.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+
+DECLARE_CYCLE_STAT( TEXT( "Manager Tick" ), STAT_TurretManager_Tick, STATGROUP_TurretRotation );
+DECLARE_CYCLE_STAT( TEXT( "Async Solve" ), STAT_TurretManager_AsyncSolve, STATGROUP_TurretRotation );
+DECLARE_CYCLE_STAT( TEXT( "Wait For Async Solve" ), STAT_TurretManager_WaitForSolve, STATGROUP_TurretRotation );
+DECLARE_CYCLE_STAT( TEXT( "Apply Results" ), STAT_TurretManager_ApplyResults, STATGROUP_TurretRotation );
+DECLARE_CYCLE_STAT( TEXT( "Update Coverage" ), STAT_TurretManager_UpdateCoverage, STATGROUP_TurretRotation );
+
+
+static TAutoConsoleVariable<int32> CVarTurretManagerChunkSize(
+	TEXT( "TurretRotation.Manager.ChunkSize" ),
+	64,
+	TEXT( "Number of turrets solved by each ParallelFor task in ATurretAimManager." ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<int32> CVarTurretManagerSingleThreaded(
+	TEXT( "TurretRotation.Manager.SingleThreaded" ),
+	0,
+	TEXT( "If non-zero, ATurretAimManager solves every turret on the game thread instead of using ParallelFor." ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<int32> CVarTurretManagerAsyncMode(
+	TEXT( "TurretRotation.Manager.AsyncMode" ),
+	0,
+	TEXT( "How ATurretAimManager solves its turrets.\n" )
+	TEXT( " 0: During the manager's tick, on the game thread (default)\n" )
+	TEXT( " 1: In a task graph job, with the results applied later in the same frame (TG_PostUpdateWork)\n" )
+	TEXT( " 2: In a task graph job, with the results applied during the next frame (one frame of latency)" ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<int32> CVarTurretCoverageEnabled(
+	TEXT( "TurretRotation.Coverage.Enabled" ),
+	0,
+	TEXT( "If non-zero, ATurretAimManager keeps every turret in a coverage field, for \"which turrets can hit this point\" queries." ),
+	ECVF_Default );
+
+
+static void StartTurretCapture( const TArray<FString>& Args, UWorld* World )
+{
+	ATurretAimManager* Manager = ATurretAimManager::Get( World );
+	if ( !Manager )
+	{
+		UE_LOG( LogTurretRotation, Warning, TEXT( "Turret captures need a game world" ) );
+		return;
+	}
+
+	const FString Filename = Args.Num() > 0 ? Args[0] : FTurretCaptureReplay::GetDefaultFilename( FString::Printf( TEXT( "Capture-%s" ), *FDateTime::Now().ToString() ) );
+	if ( Manager->StartCapture( Filename ) )
+	{
+		UE_LOG( LogTurretRotation, Display, TEXT( "Capturing turrets to %s" ), *Filename );
+	}
+}
+
+static void StopTurretCapture( const TArray<FString>& Args, UWorld* World )
+{
+	if ( ATurretAimManager* Manager = ATurretAimManager::Get( World, /*bCreateIfMissing*/ false ) )
+	{
+		Manager->StopCapture();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs StartTurretCaptureCommand(
+	TEXT( "TurretRotation.Capture.Start" ),
+	TEXT( "Records every turret solve applied by ATurretAimManager to a capture file, for TurretRotation.Replay.  Usage: TurretRotation.Capture.Start [File]" ),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic( &StartTurretCapture ) );
+
+static FAutoConsoleCommandWithWorldAndArgs StopTurretCaptureCommand(
+	TEXT( "TurretRotation.Capture.Stop" ),
+	TEXT( "Finishes the capture started by TurretRotation.Capture.Start." ),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic( &StopTurretCapture ) );
+
+
+void FTurretAimManagerApplyTickFunction::ExecuteTick( float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent )
+{
+	if ( Manager && Manager->bApplyPendingInSameFrame )
+	{
+		Manager->CompletePendingSolve();
+	}
+}
+
+FString FTurretAimManagerApplyTickFunction::DiagnosticMessage()
+{
+	return Manager ? Manager->GetFullName() + TEXT( "[ApplyResults]" ) : TEXT( "ATurretAimManager[ApplyResults]" );
+}
+
+
+ATurretAimManager::ATurretAimManager()
+	: PendingBufferIndex( INDEX_NONE )
+	, bApplyPendingInSameFrame( false )
+	, NumSolvedLastTick( 0 )
+	, NumReusedLastTick( 0 )
+	, NumExtrapolatedLastTick( 0 )
+	, SolveWaitSecondsLastTick( 0.0 )
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	// Same tick group as UTurretAimComponent, so moving turrets over to the manager doesn't change when they aim.
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Late enough that the job has had plenty of time to run, but still before the frame is rendered.
+	ApplyTickFunction.bCanEverTick = true;
+	ApplyTickFunction.bStartWithTickEnabled = true;
+	ApplyTickFunction.TickGroup = TG_PostUpdateWork;
+}
+
+ATurretAimManager* ATurretAimManager::Get( UWorld* World, bool bCreateIfMissing )
+{
+	if ( !World || !World->IsGameWorld() )
+	{
+		return nullptr;
+	}
+
+	for ( TActorIterator<ATurretAimManager> It( World ); It; ++It )
+	{
+		if ( !It->IsPendingKill() )
+		{
+			return *It;
+		}
+	}
+
+	if ( !bCreateIfMissing )
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<ATurretAimManager>( SpawnParameters );
+}
+
+void ATurretAimManager::RegisterTurret( UTurretAimComponent* Turret )
+{
+	if ( Turret )
+	{
+		Turrets.AddUnique( Turret );
+	}
+}
+
+void ATurretAimManager::UnregisterTurret( UTurretAimComponent* Turret )
+{
+	Turrets.RemoveSwap( Turret );
+
+	int32 CoverageHandle = INDEX_NONE;
+	if ( CoverageHandles.RemoveAndCopyValue( Turret, CoverageHandle ) )
+	{
+		CoverageField.RemoveTurret( CoverageHandle );
+	}
+
+	// A pending result must never be applied to a turret that's going away.  The job reads SolvedTurrets too, so it has to finish first.
+	if ( PendingBufferIndex != INDEX_NONE )
+	{
+		WaitForSolveTask();
+
+		for ( UTurretAimComponent*& SolvedTurret : SolveBuffers[PendingBufferIndex].SolvedTurrets )
+		{
+			if ( SolvedTurret == Turret )
+			{
+				SolvedTurret = nullptr;
+			}
+		}
+	}
+}
+
+void ATurretAimManager::RegisterTarget( UTurretTargetComponent* Target )
+{
+	const AActor* Owner = Target ? Target->GetOwner() : nullptr;
+	if ( !Owner || Target->GetTargetGridHandle() != INDEX_NONE )
+	{
+		return;
+	}
+
+	// Tagging with the owner lets turrets skip their own Actor.
+	const int32 Handle = TargetGrid.AddTarget( Owner->GetActorLocation(), reinterpret_cast<UPTRINT>( Owner ) );
+	Target->SetTargetGridHandle( Handle );
+
+	TargetsByHandle.SetNumZeroed( TargetGrid.GetMaxHandles() );
+	TargetsByHandle[Handle] = Target;
+	Targets.Add( Target );
+}
+
+void ATurretAimManager::UnregisterTarget( UTurretTargetComponent* Target )
+{
+	if ( !Target || Target->GetTargetGridHandle() == INDEX_NONE )
+	{
+		return;
+	}
+
+	const int32 Handle = Target->GetTargetGridHandle();
+	TargetGrid.RemoveTarget( Handle );
+	TargetsByHandle[Handle] = nullptr;
+	Target->SetTargetGridHandle( INDEX_NONE );
+	Targets.RemoveSwap( Target );
+}
+
+void ATurretAimManager::RegisterActorTickFunctions( bool bRegister )
+{
+	Super::RegisterActorTickFunctions( bRegister );
+
+	if ( bRegister )
+	{
+		ApplyTickFunction.Manager = this;
+		ApplyTickFunction.SetTickFunctionEnable( true );
+		ApplyTickFunction.RegisterTickFunction( GetLevel() );
+		ApplyTickFunction.AddPrerequisite( this, PrimaryActorTick );
+	}
+	else if ( ApplyTickFunction.IsTickFunctionRegistered() )
+	{
+		ApplyTickFunction.UnRegisterTickFunction();
+	}
+}
+
+void ATurretAimManager::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	// The turrets are going away, so finish the job (it may still be reading the buffers) and drop its results.
+	WaitForSolveTask();
+	PendingBufferIndex = INDEX_NONE;
+	StopCapture();
+
+	Super::EndPlay( EndPlayReason );
+}
+
+void ATurretAimManager::BeginDestroy()
+{
+	WaitForSolveTask();
+	PendingBufferIndex = INDEX_NONE;
+	StopCapture();
+
+	Super::BeginDestroy();
+}
+
+void ATurretAimManager::Tick( float DeltaSeconds )
+{
+	SCOPE_CYCLE_COUNTER( STAT_TurretManager_Tick );
+	TURRETROTATION_TRACE_SCOPE( TurretManager_Tick );
+
+	Super::Tick( DeltaSeconds );
+
+	SolveWaitSecondsLastTick = 0.0;
+
+	// Console variables can only be read on the game thread, so read them here for the job.
+	const int32 AsyncMode = CVarTurretManagerAsyncMode.GetValueOnGameThread();
+	const int32 ChunkSize = FMath::Max( 1, CVarTurretManagerChunkSize.GetValueOnGameThread() );
+	const bool bForceSingleThreaded = CVarTurretManagerSingleThreaded.GetValueOnGameThread() != 0;
+
+	UpdateTargets();
+	AcquireTargets();
+
+	const bool bScheduled = FTurretAimScheduler::IsEnabled();
+	if ( bScheduled )
+	{
+		Scheduler.Schedule( GetWorld(), Turrets, ScheduledTurrets );
+	}
+
+	// Fill in whichever buffer isn't pending.  With one frame of latency, last frame's job may still be running at this point.
+	const int32 BufferIndex = ( PendingBufferIndex == 0 ) ? 1 : 0;
+	FTurretSolveBuffer& Buffer = SolveBuffers[BufferIndex];
+	GatherTurrets( Buffer, bScheduled );
+
+	// After the gather, so turrets that were solved have up to date geometry.
+	UpdateCoverage();
+
+	// Last frame's results have to be applied before this frame's, and before the next job can start.
+	CompletePendingSolve();
+
+	if ( AsyncMode <= 0 )
+	{
+		SolveTurrets( Buffer, ChunkSize, bForceSingleThreaded );
+		ApplyResults( Buffer );
+		return;
+	}
+
+	PendingBufferIndex = BufferIndex;
+	bApplyPendingInSameFrame = ( AsyncMode == 1 );
+
+	// The job only touches its own buffer, so the game thread is free to carry on until the results are needed.
+	FTurretSolveBuffer* BufferToSolve = &Buffer;
+	SolveTask = FFunctionGraphTask::CreateAndDispatchWhenReady( [BufferToSolve, ChunkSize, bForceSingleThreaded]()
+	{
+		SolveTurrets( *BufferToSolve, ChunkSize, bForceSingleThreaded );
+	}, GET_STATID( STAT_TurretManager_AsyncSolve ), nullptr, ENamedThreads::AnyThread );
+}
+
+void ATurretAimManager::CompletePendingSolve()
+{
+	if ( PendingBufferIndex == INDEX_NONE )
+	{
+		return;
+	}
+
+	WaitForSolveTask();
+
+	const int32 BufferIndex = PendingBufferIndex;
+	PendingBufferIndex = INDEX_NONE;
+	bApplyPendingInSameFrame = false;
+
+	ApplyResults( SolveBuffers[BufferIndex] );
+}
+
+void ATurretAimManager::WaitForSolveTask()
+{
+	if ( !SolveTask.IsValid() )
+	{
+		return;
+	}
+
+	if ( !SolveTask->IsComplete() )
+	{
+		SCOPE_CYCLE_COUNTER( STAT_TurretManager_WaitForSolve );
+		TURRETROTATION_TRACE_SCOPE( TurretManager_WaitForSolve );
+
+		const double StartTime = FPlatformTime::Seconds();
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes( SolveTask, ENamedThreads::GameThread );
+		SolveWaitSecondsLastTick += FPlatformTime::Seconds() - StartTime;
+	}
+
+	SolveTask = nullptr;
+}
+
+void ATurretAimManager::UpdateTargets()
+{
+	for ( UTurretTargetComponent* Target : Targets )
+	{
+		const AActor* Owner = Target ? Target->GetOwner() : nullptr;
+		if ( Owner && TargetGrid.IsValidTarget( Target->GetTargetGridHandle() ) )
+		{
+			TargetGrid.UpdateTarget( Target->GetTargetGridHandle(), Owner->GetActorLocation() );
+		}
+	}
+}
+
+void ATurretAimManager::AcquireTargets()
+{
+	AcquiringTurrets.Reset();
+	AcquisitionQueries.Reset();
+
+	for ( UTurretAimComponent* Turret : Turrets )
+	{
+		const AActor* Owner = Turret ? Turret->GetOwner() : nullptr;
+		if ( Owner && Turret->ShouldAcquireTarget() )
+		{
+			AcquiringTurrets.Add( Turret );
+			AcquisitionQueries.Add( Turret->MakeTargetQuery( Owner->GetActorTransform() ) );
+		}
+	}
+
+	if ( AcquiringTurrets.Num() == 0 )
+	{
+		return;
+	}
+
+	AcquiredTargets.SetNumUninitialized( AcquiringTurrets.Num(), /*bAllowShrinking*/ false );
+
+	const bool bForceSingleThreaded = CVarTurretManagerSingleThreaded.GetValueOnGameThread() != 0;
+	TargetGrid.FindNearestTargets( AcquisitionQueries, AcquiredTargets, bForceSingleThreaded );
+
+	for ( int32 Index = 0; Index < AcquiringTurrets.Num(); ++Index )
+	{
+		const int32 Handle = AcquiredTargets[Index];
+		const UTurretTargetComponent* Target = Handle != INDEX_NONE ? TargetsByHandle[Handle] : nullptr;
+		AcquiringTurrets[Index]->TargetActor = Target ? Target->GetOwner() : nullptr;
+	}
+}
+
+int32 ATurretAimManager::GetCoverageHandle( const UTurretAimComponent* Turret ) const
+{
+	const int32* Handle = CoverageHandles.Find( const_cast<UTurretAimComponent*>( Turret ) );
+	return Handle ? *Handle : INDEX_NONE;
+}
+
+void ATurretAimManager::UpdateCoverage()
+{
+	if ( CVarTurretCoverageEnabled.GetValueOnGameThread() == 0 )
+	{
+		if ( CoverageHandles.Num() > 0 )
+		{
+			CoverageField.Reset();
+			CoverageHandles.Reset();
+		}
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER( STAT_TurretManager_UpdateCoverage );
+	TURRETROTATION_TRACE_SCOPE( TurretManager_UpdateCoverage );
+
+	CoverageTurretsToAdd.Reset();
+	CoverageEntriesToAdd.Reset();
+	CoverageHandlesToUpdate.Reset();
+	CoverageEntriesToUpdate.Reset();
+
+	for ( UTurretAimComponent* Turret : Turrets )
+	{
+		const AActor* Owner = Turret ? Turret->GetOwner() : nullptr;
+		const int32* Handle = CoverageHandles.Find( Turret );
+
+		// Turrets whose geometry couldn't be read can't hit anything.
+		if ( !Owner || !Turret->HasValidGeometry() )
+		{
+			if ( Handle )
+			{
+				CoverageField.RemoveTurret( *Handle );
+				CoverageHandles.Remove( Turret );
+			}
+			continue;
+		}
+
+		if ( Handle )
+		{
+			CoverageHandlesToUpdate.Add( *Handle );
+			CoverageEntriesToUpdate.Add( Turret->MakeCoverageTurret( Owner->GetActorTransform() ) );
+		}
+		else
+		{
+			CoverageTurretsToAdd.Add( Turret );
+			CoverageEntriesToAdd.Add( Turret->MakeCoverageTurret( Owner->GetActorTransform() ) );
+		}
+	}
+
+	// Most turrets don't change from one frame to the next, so most of this is just comparing.
+	const bool bForceSingleThreaded = CVarTurretManagerSingleThreaded.GetValueOnGameThread() != 0;
+	CoverageField.UpdateTurrets( CoverageHandlesToUpdate, CoverageEntriesToUpdate, bForceSingleThreaded );
+
+	if ( CoverageTurretsToAdd.Num() > 0 )
+	{
+		CoverageField.AddTurrets( CoverageEntriesToAdd, AddedCoverageHandles, bForceSingleThreaded );
+		for ( int32 Index = 0; Index < CoverageTurretsToAdd.Num(); ++Index )
+		{
+			CoverageHandles.Add( CoverageTurretsToAdd[Index], AddedCoverageHandles[Index] );
+		}
+	}
+}
+
+void ATurretAimManager::GatherTurrets( FTurretSolveBuffer& Buffer, bool bScheduled )
+{
+	const int32 NumTurrets = Turrets.Num();
+
+	Buffer.SolvedTurrets.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.Geometries.SetNum( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.ActorWorldTransforms.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.TargetWorldLocations.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.AimJointRotations.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.UsesBallisticAim.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.TargetWorldVelocities.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.BallisticSettings.SetNum( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.BallisticSolutions.SetNum( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.SolvesWithRates.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.TargetRelativeVelocities.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.MaxExtrapolationSeconds.SetNumUninitialized( NumTurrets, /*bAllowShrinking*/ false );
+	Buffer.AimRates.SetNum( NumTurrets, /*bAllowShrinking*/ false );
+
+	Buffer.GatherTime = GetWorld()->GetTimeSeconds();
+	Buffer.SolveSeconds = 0.0;
+	Buffer.bScheduled = bScheduled;
+
+	NumSolvedLastTick = 0;
+	NumReusedLastTick = 0;
+	NumExtrapolatedLastTick = 0;
+
+	for ( int32 Index = 0; Index < NumTurrets; ++Index )
+	{
+		UTurretAimComponent* Turret = Turrets[Index];
+
+		// Reading the geometry again (if the scale or mesh changed) touches components, so it has to happen here on the game thread.
+		const AActor* Owner = Turret ? Turret->GetOwner() : nullptr;
+		if ( !Owner || ( bScheduled && !ScheduledTurrets[Index] ) || !Turret->ShouldSolveLocally() || !Turret->PrepareGeometry() )
+		{
+			Buffer.SolvedTurrets[Index] = nullptr;
+			continue;
+		}
+
+		const FTransform ActorWorldTransform = Owner->GetActorTransform();
+		const FVector TargetWorldLocation = Turret->GetTargetWorldLocation();
+		if ( Turret->TryReuseLastSolve( ActorWorldTransform, TargetWorldLocation ) )
+		{
+			if ( bScheduled )
+			{
+				FTurretAimScheduler::HoldLastSolve( *Turret, Buffer.GatherTime );
+			}
+
+			Buffer.SolvedTurrets[Index] = nullptr;
+			++NumReusedLastTick;
+			continue;
+		}
+
+		if ( Turret->TryExtrapolateAim( ActorWorldTransform, TargetWorldLocation ) )
+		{
+			// Counts as a solve for the scheduler, since the turret is already as close as its bUseExtrapolation allows.
+			Turret->GetScheduleState().RecordSolve( Buffer.GatherTime, Turret->GetAimJointRotation() );
+
+			Buffer.SolvedTurrets[Index] = nullptr;
+			++NumExtrapolatedLastTick;
+			continue;
+		}
+
+		Buffer.SolvedTurrets[Index] = Turret;
+		Buffer.Geometries[Index] = Turret->GetGeometry();
+		Buffer.ActorWorldTransforms[Index] = ActorWorldTransform;
+		Buffer.TargetWorldLocations[Index] = TargetWorldLocation;
+		Buffer.UsesBallisticAim[Index] = Turret->bUseBallisticAim;
+		if ( Turret->bUseBallisticAim )
+		{
+			Buffer.TargetWorldVelocities[Index] = Turret->GetTargetWorldVelocity();
+			Buffer.BallisticSettings[Index] = Turret->BallisticSettings;
+		}
+		Buffer.SolvesWithRates[Index] = Turret->UsesExtrapolation() || ( bScheduled && !Turret->bUseBallisticAim );
+		if ( Buffer.SolvesWithRates[Index] )
+		{
+			Buffer.TargetRelativeVelocities[Index] = Turret->GetTargetRelativeVelocity();
+			Buffer.MaxExtrapolationSeconds[Index] = Turret->MaxExtrapolationSeconds;
+		}
+		++NumSolvedLastTick;
+	}
+}
+
+void ATurretAimManager::SolveTurrets( FTurretSolveBuffer& Buffer, int32 ChunkSize, bool bForceSingleThreaded )
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumTurrets = Buffer.SolvedTurrets.Num();
+	const int32 NumChunks = FMath::DivideAndRoundUp( NumTurrets, ChunkSize );
+
+	// Read once, instead of by every solve, so every turret is solved the same way this frame.
+	const FTurretSolveSettings SolveSettings = FTurretAimGeometry::GetSolveSettings();
+
+	// Each chunk only reads from the input buffers and only writes to its own range of AimJointRotations/AimRates/BallisticSolutions,
+	// so no locking is needed.
+	ParallelFor( NumChunks, [&Buffer, &SolveSettings, NumTurrets, ChunkSize]( int32 ChunkIndex )
+	{
+		const int32 StartIndex = ChunkIndex * ChunkSize;
+		const int32 EndIndex = FMath::Min( StartIndex + ChunkSize, NumTurrets );
+
+		// One per chunk, so the stats are only touched once per chunk (and never by two threads at once).
+		FTurretSolveStats SolveStats;
+		for ( int32 Index = StartIndex; Index < EndIndex; ++Index )
+		{
+			if ( !Buffer.SolvedTurrets[Index] )
+			{
+				continue;
+			}
+
+			if ( Buffer.UsesBallisticAim[Index] )
+			{
+				Buffer.BallisticSolutions[Index] = Buffer.Geometries[Index].SolveBallisticForActor(
+					Buffer.ActorWorldTransforms[Index],
+					Buffer.TargetWorldLocations[Index],
+					Buffer.TargetWorldVelocities[Index],
+					FVector::ZeroVector,
+					Buffer.BallisticSettings[Index],
+					SolveSettings,
+					&SolveStats );
+				Buffer.AimJointRotations[Index] = Buffer.BallisticSolutions[Index].AimJointRotation;
+			}
+			else if ( Buffer.SolvesWithRates[Index] )
+			{
+				Buffer.AimJointRotations[Index] = Buffer.Geometries[Index].SolveWithRatesForActor(
+					Buffer.ActorWorldTransforms[Index],
+					Buffer.TargetWorldLocations[Index],
+					Buffer.TargetRelativeVelocities[Index],
+					Buffer.MaxExtrapolationSeconds[Index],
+					/*out*/ Buffer.AimRates[Index],
+					SolveSettings,
+					&SolveStats );
+			}
+			else
+			{
+				Buffer.AimJointRotations[Index] = Buffer.Geometries[Index].SolveForActor( Buffer.ActorWorldTransforms[Index], Buffer.TargetWorldLocations[Index], SolveSettings, &SolveStats );
+			}
+		}
+	}, bForceSingleThreaded );
+
+	Buffer.SolveSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+void ATurretAimManager::ApplyResults( FTurretSolveBuffer& Buffer )
+{
+	SCOPE_CYCLE_COUNTER( STAT_TurretManager_ApplyResults );
+	TURRETROTATION_TRACE_SCOPE( TurretManager_ApplyResults );
+
+	int32 NumApplied = 0;
+	for ( int32 Index = 0; Index < Buffer.SolvedTurrets.Num(); ++Index )
+	{
+		if ( UTurretAimComponent* Turret = Buffer.SolvedTurrets[Index] )
+		{
+			if ( Buffer.UsesBallisticAim[Index] )
+			{
+				Turret->SetLastBallisticSolution( Buffer.BallisticSolutions[Index] );
+			}
+
+			if ( Buffer.SolvesWithRates[Index] )
+			{
+				Turret->ApplySolveWithRates(
+					Buffer.GatherTime,
+					Buffer.ActorWorldTransforms[Index],
+					Buffer.TargetWorldLocations[Index],
+					Buffer.TargetRelativeVelocities[Index],
+					Buffer.AimJointRotations[Index],
+					Buffer.AimRates[Index] );
+			}
+			else
+			{
+				Turret->ApplySolve( Buffer.ActorWorldTransforms[Index], Buffer.TargetWorldLocations[Index], Buffer.AimJointRotations[Index] );
+			}
+
+			// Always kept up to date, so the scheduler knows how stale every turret is right away if it's turned on.
+			Turret->GetScheduleState().RecordSolve( Buffer.GatherTime, Buffer.AimJointRotations[Index] );
+			++NumApplied;
+		}
+	}
+
+	if ( Buffer.bScheduled )
+	{
+		Scheduler.ReportSolve( NumApplied, Buffer.SolveSeconds );
+	}
+
+	if ( CaptureWriter.IsValid() )
+	{
+		CaptureResults( Buffer );
+	}
+}
+
+bool ATurretAimManager::StartCapture( const FString& Filename )
+{
+	StopCapture();
+
+	TUniquePtr<FTurretCaptureWriter> Writer = MakeUnique<FTurretCaptureWriter>();
+	if ( !Writer->Open( Filename ) )
+	{
+		return false;
+	}
+
+	CaptureWriter = MoveTemp( Writer );
+	return true;
+}
+
+void ATurretAimManager::StopCapture()
+{
+	if ( !CaptureWriter.IsValid() )
+	{
+		return;
+	}
+
+	CaptureWriter->Close();
+	UE_LOG( LogTurretRotation, Display, TEXT( "Captured %d frames of turrets (%.1f MB)" ), CaptureWriter->GetNumFrames(), CaptureWriter->GetNumBytesWritten() / ( 1024.0 * 1024.0 ) );
+	CaptureWriter.Reset();
+}
+
+void ATurretAimManager::CaptureResults( const FTurretSolveBuffer& Buffer )
+{
+	CaptureWriter->BeginFrame( GFrameCounter, GetWorld()->GetDeltaSeconds() );
+
+	for ( int32 Index = 0; Index < Buffer.SolvedTurrets.Num(); ++Index )
+	{
+		// Ballistic solves aren't something CalculateTurretRotation_ForActor can replay.
+		const UTurretAimComponent* Turret = Buffer.SolvedTurrets[Index];
+		if ( !Turret || Buffer.UsesBallisticAim[Index] )
+		{
+			continue;
+		}
+
+		CaptureWriter->AddTurret(
+			Turret->GetUniqueID(),
+			Buffer.ActorWorldTransforms[Index],
+			Buffer.Geometries[Index].GetActorToAimJoint(),
+			Turret->GetAimJointToBarrelStart(),
+			Turret->GetBarrelStartToBarrelEnd(),
+			Buffer.TargetWorldLocations[Index],
+			Buffer.AimJointRotations[Index] );
+	}
+
+	CaptureWriter->EndFrame();
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "TurretAimGeometry.h"
+#include "TurretTargetGrid.h"
+#include "TurretCoverageField.h"
+#include "TurretAimCapture.h"
+#include "TurretAimScheduler.h"
+#include "TurretAimManager.generated.h"
+
+class UTurretAimComponent;
+class UTurretTargetComponent;
+class ATurretAimManager;
+
+/**
+ * Everything the manager needs to solve the turrets, copied out of the turrets on the game thread.  All of the arrays are indexed the same way.
+ * The manager keeps two of these, so one can be filled in while the other is still being solved (see TurretRotation.Manager.AsyncMode).
+ */
+struct FTurretSolveBuffer
+{
+	/**
+	 * Turrets that don't need to be solved this frame (they couldn't be solved, their incremental solve reused the last result, or they extrapolated)
+	 * have a null entry in SolvedTurrets.
+	 */
+	TArray<UTurretAimComponent*> SolvedTurrets;
+	TArray<FTurretAimGeometry> Geometries;
+	TArray<FTransform> ActorWorldTransforms;
+	TArray<FVector> TargetWorldLocations;
+	TArray<FRotator> AimJointRotations;
+
+	/** Whether each turret has bUseBallisticAim.  The other ballistic buffers are only filled in where this is true. */
+	TArray<bool> UsesBallisticAim;
+	TArray<FVector> TargetWorldVelocities;
+	TArray<FTurretBallisticSettings> BallisticSettings;
+	TArray<FTurretBallisticSolution> BallisticSolutions;
+
+	/**
+	 * Whether each turret is solved with its rates, because it uses bUseExtrapolation, or because the scheduler may extrapolate it while
+	 * it's deferred.  The other extrapolation buffers are only filled in where this is true.
+	 */
+	TArray<bool> SolvesWithRates;
+	TArray<FVector> TargetRelativeVelocities;
+	TArray<float> MaxExtrapolationSeconds;
+	TArray<FTurretAimRates> AimRates;
+
+	/** World time (in seconds) when the inputs were gathered. */
+	double GatherTime = 0.0;
+
+	/** How long SolveTurrets took (wall time). */
+	double SolveSeconds = 0.0;
+
+	/** True if the turrets were picked by FTurretAimScheduler, so the solve time should be reported back to it. */
+	bool bScheduled = false;
+};
+
+/**
+ * Second tick function for ATurretAimManager, that applies the results of an asynchronous solve later in the same frame.
+ */
+USTRUCT()
+struct FTurretAimManagerApplyTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	FTurretAimManagerApplyTickFunction()
+		: Manager( nullptr )
+	{
+	}
+
+	ATurretAimManager* Manager;
+
+	// FTickFunction interface
+	virtual void ExecuteTick( float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent ) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTurretAimManagerApplyTickFunction> : public TStructOpsTypeTraitsBase2<FTurretAimManagerApplyTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Updates every registered turret in the world with a single tick.
+ *
+ * When each UTurretAimComponent ticks on its own, N turrets cost N tick function dispatches, and the transforms/geometry they read
+ * are scattered all over memory.  Instead, the manager gathers every turret's Actor transform, target location, and geometry into
+ * contiguous buffers, solves them in chunks across the worker threads with ParallelFor, and then writes all of the rotations back.
+ *
+ * The manager also keeps track of every UTurretTargetComponent in a spatial hash (FTurretTargetGrid).  Before solving, turrets with
+ * bAutoAcquireTarget pick the nearest target within their range and arc from it, all in one parallel batch.
+ *
+ * There is one manager per world.  It is spawned the first time a turret (or target) asks for it (see Get).
+ *
+ * The chunk size and a single-threaded fallback are controlled by the TurretRotation.Manager.ChunkSize and
+ * TurretRotation.Manager.SingleThreaded console variables, so scaling across cores can be measured at runtime.
+ *
+ * TurretRotation.Manager.AsyncMode moves the solve off of the game thread:
+ *   0 - The solve runs during the manager's tick, and the game thread waits for it (the default).
+ *   1 - The manager's tick takes a snapshot of every turret and target, and starts a task graph job to solve it.  The results are
+ *       applied in TG_PostUpdateWork, later in the same frame, so the game thread can do other work in the meantime.
+ *   2 - Same as 1, but the results are applied at the start of the manager's tick in the next frame (one frame of latency).  This gives
+ *       the job a whole frame to finish, so the game thread should almost never have to wait for it.
+ * Any time the game thread does have to wait, it's counted by the "Wait For Async Solve" stat (stat TurretRotation).
+ *
+ * With TurretRotation.Scheduler.Enabled, only the turrets picked by FTurretAimScheduler are solved each frame, within a time budget.
+ * The rest are extrapolated (if they can be seen) until their turn comes.
+ *
+ * With TurretRotation.Coverage.Enabled, the manager also keeps every turret in an FTurretCoverageField, so AI can ask which turrets can
+ * hit a point (or whether a region is safe) without solving anything.  See GetCoverageField.
+ *
+ * TurretRotation.Capture.Start / TurretRotation.Capture.Stop record every solve the manager applies to a file, to be replayed later
+ * (see TurretAimCapture.h).
+ */
+UCLASS( NotPlaceable, Transient )
+class TURRETROTATION_API ATurretAimManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATurretAimManager();
+
+	/**
+	 * Finds the manager for the given world, spawning one if needed.
+	 *
+	 * @param World				The world to find the manager for.
+	 * @param bCreateIfMissing	If false, then a new manager won't be spawned when the world doesn't have one.
+	 * @return Returns the world's manager, or nullptr if the world isn't a game world.
+	 */
+	static ATurretAimManager* Get( UWorld* World, bool bCreateIfMissing = true );
+
+	/** Adds a turret to be updated every tick.  Registering the same turret twice does nothing. */
+	void RegisterTurret( UTurretAimComponent* Turret );
+
+	/** Stops updating the given turret. */
+	void UnregisterTurret( UTurretAimComponent* Turret );
+
+	/** Adds a target that turrets with bAutoAcquireTarget can pick.  Registering the same target twice does nothing. */
+	void RegisterTarget( UTurretTargetComponent* Target );
+
+	/** Stops the given target from being picked. */
+	void UnregisterTarget( UTurretTargetComponent* Target );
+
+	/** @return Returns the spatial hash of every registered target. */
+	const FTurretTargetGrid& GetTargetGrid() const { return TargetGrid; }
+
+	/**
+	 * @return Returns the coverage field of every registered turret, using each turret's yaw/pitch limits and its acquisition range.
+	 * Only kept up to date while TurretRotation.Coverage.Enabled is set.  Refreshed during the manager's tick, so it can be queried from
+	 * any thread outside of it.
+	 */
+	const FTurretCoverageField& GetCoverageField() const { return CoverageField; }
+
+	/** @return Returns the coverage field handle of the given turret, or INDEX_NONE if it isn't in the coverage field. */
+	int32 GetCoverageHandle( const UTurretAimComponent* Turret ) const;
+
+	/** @return Returns the number of registered turrets. */
+	int32 GetNumTurrets() const { return Turrets.Num(); }
+
+	/** @return Returns how many turrets were solved during the last tick. */
+	int32 GetNumSolvedLastTick() const { return NumSolvedLastTick; }
+
+	/** @return Returns how many turrets skipped solving during the last tick, because their incremental solve could reuse the last result. */
+	int32 GetNumReusedLastTick() const { return NumReusedLastTick; }
+
+	/** @return Returns how many turrets skipped solving during the last tick, because they could extrapolate their last solve (see bUseExtrapolation). */
+	int32 GetNumExtrapolatedLastTick() const { return NumExtrapolatedLastTick; }
+
+	/** @return Returns how long (in seconds) the game thread waited for the asynchronous solve during the last frame. */
+	double GetSolveWaitSecondsLastTick() const { return SolveWaitSecondsLastTick; }
+
+	/** @return Returns the scheduler's tiers, budget overruns, and staleness.  Only updated while TurretRotation.Scheduler.Enabled is set. */
+	const FTurretSchedulerStats& GetSchedulerStats() const { return Scheduler.GetStats(); }
+
+	/**
+	 * Starts recording every solve the manager applies (except ballistic ones) to a capture file, until StopCapture.
+	 *
+	 * @param Filename	The capture file.  Replaced if it already exists.
+	 * @return Returns false if the file couldn't be created.
+	 */
+	bool StartCapture( const FString& Filename );
+
+	/** Finishes the capture file, if there is one. */
+	void StopCapture();
+
+	/** @return Returns true between StartCapture and StopCapture. */
+	bool IsCapturing() const { return CaptureWriter.IsValid(); }
+
+	/**
+	 * Waits for any pending asynchronous solve, and applies its results.  Called by the manager itself at the right point in the frame,
+	 * but can be called at any other time to make sure every turret is up to date.
+	 */
+	void CompletePendingSolve();
+
+	// AActor interface
+	virtual void Tick( float DeltaSeconds ) override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+	virtual void BeginDestroy() override;
+
+protected:
+	virtual void RegisterActorTickFunctions( bool bRegister ) override;
+
+	/** Moves every registered target to its owner's current location in the TargetGrid.  Runs on the game thread. */
+	void UpdateTargets();
+
+	/** Picks the nearest valid target for every turret with bAutoAcquireTarget, using the TargetGrid. */
+	void AcquireTargets();
+
+	/**
+	 * Adds, moves, bakes, and removes turrets in the CoverageField, so it matches the registered turrets.  Runs on the game thread.
+	 * Empties the CoverageField when TurretRotation.Coverage.Enabled isn't set.
+	 */
+	void UpdateCoverage();
+
+	/**
+	 * Copies every turret's inputs into the given buffer.  Runs on the game thread.
+	 *
+	 * @param Buffer		The buffer to fill in.
+	 * @param bScheduled	If true, only the turrets picked by the scheduler (ScheduledTurrets) are solved.
+	 */
+	void GatherTurrets( FTurretSolveBuffer& Buffer, bool bScheduled );
+
+	/**
+	 * Solves every turret in the buffer, splitting the work across worker threads.  Safe to call from any thread, since it only touches the buffer.
+	 *
+	 * @param Buffer				The turrets to solve.
+	 * @param ChunkSize				Number of turrets solved by each ParallelFor task.
+	 * @param bForceSingleThreaded	If true, every turret is solved on the calling thread.
+	 */
+	static void SolveTurrets( FTurretSolveBuffer& Buffer, int32 ChunkSize, bool bForceSingleThreaded );
+
+	/** Applies the solved rotations to every turret's AimJoint.  Runs on the game thread. */
+	void ApplyResults( FTurretSolveBuffer& Buffer );
+
+	/** Records the solves in the buffer to the CaptureWriter.  Runs on the game thread. */
+	void CaptureResults( const FTurretSolveBuffer& Buffer );
+
+	/** Blocks the game thread until the asynchronous solve (if any) is done, and counts how long that took. */
+	void WaitForSolveTask();
+
+	/** Every registered turret. */
+	UPROPERTY( Transient )
+	TArray<UTurretAimComponent*> Turrets;
+
+	/** Every registered target. */
+	UPROPERTY( Transient )
+	TArray<UTurretTargetComponent*> Targets;
+
+	/** The same targets as above, indexed by their TargetGrid handle. */
+	TArray<UTurretTargetComponent*> TargetsByHandle;
+
+	FTurretTargetGrid TargetGrid;
+
+	/** Buffers for AcquireTargets, all indexed the same way. */
+	TArray<UTurretAimComponent*> AcquiringTurrets;
+	TArray<FTurretTargetQuery> AcquisitionQueries;
+	TArray<int32> AcquiredTargets;
+
+	/** Every turret's reachability, with TurretRotation.Coverage.Enabled. */
+	FTurretCoverageField CoverageField;
+
+	/** The CoverageField handle of every turret in it. */
+	TMap<UTurretAimComponent*, int32> CoverageHandles;
+
+	/** Buffers for UpdateCoverage.  The turrets to add are indexed like CoverageEntriesToAdd, and the handles like CoverageEntriesToUpdate. */
+	TArray<UTurretAimComponent*> CoverageTurretsToAdd;
+	TArray<FTurretCoverageTurret> CoverageEntriesToAdd;
+	TArray<int32> CoverageHandlesToUpdate;
+	TArray<FTurretCoverageTurret> CoverageEntriesToUpdate;
+	TArray<int32> AddedCoverageHandles;
+
+	/** Picks which turrets are solved each frame, with TurretRotation.Scheduler.Enabled. */
+	FTurretAimScheduler Scheduler;
+
+	/** Whether each turret was picked by the Scheduler this frame.  Indexed like Turrets. */
+	TArray<bool> ScheduledTurrets;
+
+	/** Double buffered solve inputs/results. */
+	FTurretSolveBuffer SolveBuffers[2];
+
+	/** The buffer being solved asynchronously (or waiting to be applied), or INDEX_NONE. */
+	int32 PendingBufferIndex;
+
+	/** If true, then the pending buffer is applied by ApplyTickFunction this frame, otherwise at the start of the next tick. */
+	bool bApplyPendingInSameFrame;
+
+	/** The asynchronous solve of the pending buffer. */
+	FGraphEventRef SolveTask;
+
+	/** Applies asynchronous results in TG_PostUpdateWork. */
+	FTurretAimManagerApplyTickFunction ApplyTickFunction;
+
+	/** Set between StartCapture and StopCapture. */
+	TUniquePtr<FTurretCaptureWriter> CaptureWriter;
+
+	/** Counters from the last tick. */
+	int32 NumSolvedLastTick;
+	int32 NumReusedLastTick;
+	int32 NumExtrapolatedLastTick;
+	double SolveWaitSecondsLastTick;
+
+	friend struct FTurretAimManagerApplyTickFunction;
+};
@@ -0,0 +1,319 @@
+#include "TurretAimReplication.h"
+#include "TurretRotation.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+
+/** Lets the TurretRotationCore serialization write to an FBitWriter. */
+struct FTurretAimBitWriter
+{
+	FBitWriter& Writer;
+
+	explicit FTurretAimBitWriter( FBitWriter& InWriter ) : Writer( InWriter ) {}
+
+	void WriteBits( unsigned int Value, int NumBits )
+	{
+		uint32 Bits = Value;
+		Writer.SerializeBits( &Bits, NumBits );
+	}
+};
+
+/** Lets the TurretRotationCore serialization read from an FBitReader. */
+struct FTurretAimBitReader
+{
+	FBitReader& Reader;
+
+	explicit FTurretAimBitReader( FBitReader& InReader ) : Reader( InReader ) {}
+
+	unsigned int ReadBits( int NumBits )
+	{
+		uint32 Bits = 0;
+		Reader.SerializeBits( &Bits, NumBits );
+		return Bits;
+	}
+
+	bool IsOverflowed() const { return Reader.IsError(); }
+};
+
+/** The snapshot last sent to a connection.  The next update is written relative to it (or to an older one, if that packet was lost). */
+class FTurretAimNetBaseState : public INetDeltaBaseState
+{
+public:
+	FTurretAimNetBaseState()
+		: SnapshotId( 0 )
+		, NumUpdatesSinceFullSnapshot( 0 )
+	{
+	}
+
+	virtual bool IsStateEqual( INetDeltaBaseState* OtherState ) override
+	{
+		const FTurretAimNetBaseState* Other = static_cast<const FTurretAimNetBaseState*>( OtherState );
+		return Quantization == Other->Quantization && Items == Other->Items;
+	}
+
+	uint16 SnapshotId;
+	int32 NumUpdatesSinceFullSnapshot;
+	TurretRotationCore::FAimQuantization Quantization;
+	TArray<TurretRotationCore::FAimSnapshotItem> Items;
+};
+
+
+
+FTurretAimNetState::FTurretAimNetState()
+	: QuantizedYaw( 0 )
+	, QuantizedPitch( 0 )
+	, YawBits( 12 )
+	, PitchBits( 12 )
+{
+}
+
+void FTurretAimNetState::SetRotation( const FRotator& AimJointRotation, int32 InYawBits, int32 InPitchBits )
+{
+	YawBits = static_cast<uint8>( FMath::Clamp( InYawBits, MinBits, MaxBits ) );
+	PitchBits = static_cast<uint8>( FMath::Clamp( InPitchBits, MinBits, MaxBits ) );
+	QuantizedYaw = static_cast<uint16>( TurretRotationCore::QuantizeAngle( AimJointRotation.Yaw, YawBits ) );
+	QuantizedPitch = static_cast<uint16>( TurretRotationCore::QuantizeAngle( AimJointRotation.Pitch, PitchBits ) );
+}
+
+FRotator FTurretAimNetState::GetRotation() const
+{
+	return FRotator(
+		TurretRotationCore::DequantizeAngle<float>( QuantizedPitch, PitchBits ),
+		TurretRotationCore::DequantizeAngle<float>( QuantizedYaw, YawBits ),
+		0.0f );
+}
+
+bool FTurretAimNetState::NetSerialize( FArchive& Ar, UPackageMap* Map, bool& bOutSuccess )
+{
+	// The bit counts are sent as 0-7 over MinBits, in 3 bits each.
+	uint32 YawBitsCode = Ar.IsSaving() ? uint32( YawBits - MinBits ) : 0;
+	uint32 PitchBitsCode = Ar.IsSaving() ? uint32( PitchBits - MinBits ) : 0;
+	Ar.SerializeBits( &YawBitsCode, 3 );
+	Ar.SerializeBits( &PitchBitsCode, 3 );
+
+	if ( Ar.IsLoading() )
+	{
+		YawBits = static_cast<uint8>( FMath::Min<int32>( MinBits + YawBitsCode, MaxBits ) );
+		PitchBits = static_cast<uint8>( FMath::Min<int32>( MinBits + PitchBitsCode, MaxBits ) );
+	}
+
+	uint32 Yaw = Ar.IsSaving() ? QuantizedYaw : 0;
+	uint32 Pitch = Ar.IsSaving() ? QuantizedPitch : 0;
+	Ar.SerializeBits( &Yaw, YawBits );
+	Ar.SerializeBits( &Pitch, PitchBits );
+
+	if ( Ar.IsLoading() )
+	{
+		QuantizedYaw = static_cast<uint16>( Yaw );
+		QuantizedPitch = static_cast<uint16>( Pitch );
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+
+
+FTurretAimNetArray::FTurretAimNetArray()
+	: YawBits( 12 )
+	, PitchBits( 12 )
+	, SmallDeltaBits( 5 )
+	, FullSnapshotInterval( 150 )
+	, NextSnapshotId( 1 )
+{
+}
+
+TurretRotationCore::FAimQuantization FTurretAimNetArray::GetQuantization() const
+{
+	return TurretRotationCore::FAimQuantization(
+		FMath::Clamp( YawBits, FTurretAimNetState::MinBits, FTurretAimNetState::MaxBits ),
+		FMath::Clamp( PitchBits, FTurretAimNetState::MinBits, FTurretAimNetState::MaxBits ),
+		FMath::Clamp( SmallDeltaBits, 2, 8 ) );
+}
+
+void FTurretAimNetArray::SetAim( int32 TurretId, const FRotator& AimJointRotation )
+{
+	const TurretRotationCore::FAimQuantization Quantization = GetQuantization();
+	if ( Quantization != ItemsQuantization )
+	{
+		for ( TurretRotationCore::FAimSnapshotItem& Item : Items )
+		{
+			const TurretRotationCore::TAimAngles<double> Angles = TurretRotationCore::DequantizeAim<double>( Item.Aim, ItemsQuantization );
+			Item.Aim = TurretRotationCore::QuantizeAim( Angles, Quantization );
+		}
+		ItemsQuantization = Quantization;
+	}
+
+	const TurretRotationCore::FQuantizedAim Aim(
+		TurretRotationCore::QuantizeAngle( AimJointRotation.Yaw, Quantization.YawBits ),
+		TurretRotationCore::QuantizeAngle( AimJointRotation.Pitch, Quantization.PitchBits ) );
+
+	const int32 Index = FindItemIndex( TurretId );
+	if ( Index >= 0 )
+	{
+		Items[Index].Aim = Aim;
+	}
+	else
+	{
+		Items.Insert( TurretRotationCore::FAimSnapshotItem( static_cast<uint32>( TurretId ), Aim ), -Index - 1 );
+	}
+}
+
+bool FTurretAimNetArray::RemoveAim( int32 TurretId )
+{
+	const int32 Index = FindItemIndex( TurretId );
+	if ( Index < 0 )
+	{
+		return false;
+	}
+
+	Items.RemoveAt( Index );
+	return true;
+}
+
+bool FTurretAimNetArray::GetAim( int32 TurretId, FRotator& Out_AimJointRotation ) const
+{
+	const int32 Index = FindItemIndex( TurretId );
+	if ( Index < 0 )
+	{
+		return false;
+	}
+
+	const TurretRotationCore::TAimAngles<float> Angles = TurretRotationCore::DequantizeAim<float>( Items[Index].Aim, ItemsQuantization );
+	Out_AimJointRotation = FRotator( Angles.Pitch, Angles.Yaw, 0.0f );
+	return true;
+}
+
+int32 FTurretAimNetArray::FindItemIndex( int32 TurretId ) const
+{
+	const uint32 Id = static_cast<uint32>( TurretId );
+
+	int32 Low = 0;
+	int32 High = Items.Num();
+	while ( Low < High )
+	{
+		const int32 Middle = ( Low + High ) / 2;
+		if ( Items[Middle].Id < Id )
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	return ( Low < Items.Num() && Items[Low].Id == Id ) ? Low : -Low - 1;
+}
+
+bool FTurretAimNetArray::NetDeltaSerialize( FNetDeltaSerializeInfo& DeltaParms )
+{
+	if ( DeltaParms.Writer )
+	{
+		return WriteDelta( DeltaParms );
+	}
+
+	if ( DeltaParms.Reader )
+	{
+		return ReadDelta( DeltaParms );
+	}
+
+	// There are no object references to map.
+	return false;
+}
+
+bool FTurretAimNetArray::WriteDelta( FNetDeltaSerializeInfo& DeltaParms )
+{
+	const FTurretAimNetBaseState* OldState = static_cast<const FTurretAimNetBaseState*>( DeltaParms.OldState );
+
+	// The base state is the last snapshot sent to this connection, or the one before a lost packet (the replication system puts it back
+	// when the packet is NAK'd), so the client has it unless some other update got lost in between.  That's what the snapshot IDs are for.
+	if ( OldState && OldState->Quantization == ItemsQuantization && OldState->Items == Items )
+	{
+		return false;
+	}
+
+	const bool bSendFullSnapshot = !OldState
+		|| OldState->Quantization != ItemsQuantization
+		|| ( FullSnapshotInterval > 0 && OldState->NumUpdatesSinceFullSnapshot + 1 >= FullSnapshotInterval );
+
+	FTurretAimNetBaseState* NewState = new FTurretAimNetBaseState();
+	NewState->SnapshotId = NextSnapshotId++;
+	NewState->NumUpdatesSinceFullSnapshot = bSendFullSnapshot ? 0 : OldState->NumUpdatesSinceFullSnapshot + 1;
+	NewState->Quantization = ItemsQuantization;
+	NewState->Items = Items;
+	*DeltaParms.NewState = MakeShareable( NewState );
+
+	FTurretAimBitWriter Writer( *DeltaParms.Writer );
+	Writer.WriteBits( NewState->SnapshotId, 16 );
+	Writer.WriteBits( bSendFullSnapshot ? 0 : 1, 1 );
+	if ( !bSendFullSnapshot )
+	{
+		TurretRotationCore::WritePackedUInt( Writer, uint16( NewState->SnapshotId - OldState->SnapshotId ) );
+	}
+
+	Writer.WriteBits( ItemsQuantization.YawBits - 1, 4 );
+	Writer.WriteBits( ItemsQuantization.PitchBits - 1, 4 );
+	Writer.WriteBits( ItemsQuantization.SmallDeltaBits - 1, 3 );
+
+	const TurretRotationCore::FAimSnapshotItem* BaseItems = bSendFullSnapshot ? nullptr : OldState->Items.GetData();
+	const int32 NumBaseItems = bSendFullSnapshot ? 0 : OldState->Items.Num();
+	TurretRotationCore::WriteAimSnapshotDelta( Writer, BaseItems, NumBaseItems, Items.GetData(), Items.Num(), ItemsQuantization );
+	return true;
+}
+
+bool FTurretAimNetArray::ReadDelta( FNetDeltaSerializeInfo& DeltaParms )
+{
+	FTurretAimBitReader Reader( *DeltaParms.Reader );
+
+	const uint16 SnapshotId = static_cast<uint16>( Reader.ReadBits( 16 ) );
+	const bool bHasBase = Reader.ReadBits( 1 ) != 0;
+	const uint16 BaseSnapshotId = bHasBase ? static_cast<uint16>( SnapshotId - TurretRotationCore::ReadPackedUInt( Reader ) ) : 0;
+
+	TurretRotationCore::FAimQuantization Quantization;
+	Quantization.YawBits = Reader.ReadBits( 4 ) + 1;
+	Quantization.PitchBits = Reader.ReadBits( 4 ) + 1;
+	Quantization.SmallDeltaBits = Reader.ReadBits( 3 ) + 1;
+
+	const FReceivedSnapshot* BaseSnapshot = nullptr;
+	if ( bHasBase )
+	{
+		BaseSnapshot = ReceivedSnapshots.FindByPredicate( [BaseSnapshotId]( const FReceivedSnapshot& Snapshot ) { return Snapshot.SnapshotId == BaseSnapshotId; } );
+	}
+
+	// The update has to be read all the way through even when it can't be applied, so the properties after it are read correctly.
+	TArray<TurretRotationCore::FAimSnapshotItem> NewItems;
+	NewItems.Reserve( BaseSnapshot ? BaseSnapshot->Items.Num() : Items.Num() );
+
+	const bool bValid = TurretRotationCore::ReadAimSnapshotDelta(
+		Reader,
+		BaseSnapshot ? BaseSnapshot->Items.GetData() : nullptr,
+		BaseSnapshot ? BaseSnapshot->Items.Num() : 0,
+		Quantization,
+		[&NewItems]( const TurretRotationCore::FAimSnapshotItem& Item ) { NewItems.Add( Item ); } );
+
+	if ( Reader.IsOverflowed() )
+	{
+		return false;
+	}
+
+	if ( ( bHasBase && !BaseSnapshot ) || !bValid )
+	{
+		// The server will go back to a snapshot we have once it hears about the lost packet, or send a full one.
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Skipped turret aim update %d, relative to snapshot %d." ), SnapshotId, BaseSnapshotId );
+		return true;
+	}
+
+	Items = MoveTemp( NewItems );
+	ItemsQuantization = Quantization;
+
+	if ( ReceivedSnapshots.Num() >= NumReceivedSnapshots )
+	{
+		ReceivedSnapshots.RemoveAt( 0, ReceivedSnapshots.Num() - NumReceivedSnapshots + 1, /*bAllowShrinking*/ false );
+	}
+
+	FReceivedSnapshot& Snapshot = ReceivedSnapshots[ReceivedSnapshots.AddDefaulted()];
+	Snapshot.SnapshotId = SnapshotId;
+	Snapshot.Items = Items;
+	return true;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "TurretRotationNet.h"
+#include "TurretAimReplication.generated.h"
+
+/** How a UTurretAimComponent's aim gets to clients. */
+UENUM( BlueprintType )
+enum class ETurretAimReplication : uint8
+{
+	/** Nothing is replicated.  Clients aim the turret themselves, from whatever target they have. */
+	None,
+
+	/** The server's solved yaw/pitch are replicated (quantized, see FTurretAimNetState), and clients don't solve at all. */
+	Angles,
+
+	/** The TargetActor/TargetLocation are replicated, and clients solve for them locally. */
+	Target,
+
+	/**
+	 * Target while aiming at TargetLocation or at a replicated TargetActor (since the client knows where those are, and they are only
+	 * sent when they change), and Angles while aiming at an Actor that clients don't have.
+	 */
+	Auto,
+};
+
+/**
+ * A turret's yaw/pitch, quantized for replication.
+ *
+ * NetSerialize writes YawBits + PitchBits + 6 bits (the bit counts go along, so clients don't need the same settings), instead of
+ * the 35 bits a compressed FRotator usually takes.  Since the comparison is done on the quantized values, it also isn't sent again
+ * when the aim only moved by less than a step.
+ */
+USTRUCT( BlueprintType )
+struct TURRETROTATION_API FTurretAimNetState
+{
+	GENERATED_BODY()
+
+public:
+	FTurretAimNetState();
+
+	/**
+	 * Quantizes a new rotation.
+	 *
+	 * @param AimJointRotation	The AimJoint's rotation (relative to the Actor).  Roll is ignored.
+	 * @param InYawBits			Bits for the yaw (10 to 16).
+	 * @param InPitchBits		Bits for the pitch (10 to 16).
+	 */
+	void SetRotation( const FRotator& AimJointRotation, int32 InYawBits, int32 InPitchBits );
+
+	/** @return Returns the quantized rotation. */
+	FRotator GetRotation() const;
+
+	bool NetSerialize( FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess );
+
+	bool operator==( const FTurretAimNetState& Other ) const
+	{
+		return QuantizedYaw == Other.QuantizedYaw && QuantizedPitch == Other.QuantizedPitch && YawBits == Other.YawBits && PitchBits == Other.PitchBits;
+	}
+
+	/** Smallest and largest supported bit counts. */
+	static const int32 MinBits = 10;
+	static const int32 MaxBits = 16;
+
+private:
+	uint16 QuantizedYaw;
+	uint16 QuantizedPitch;
+	uint8 YawBits;
+	uint8 PitchBits;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTurretAimNetState> : public TStructOpsTypeTraitsBase2<FTurretAimNetState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+/**
+ * The quantized aims of many turrets, replicated as a delta.  Use this instead of replicating each turret's FTurretAimNetState when
+ * one replicated Actor owns a lot of turrets (a fortress, a battleship, a game-specific turret manager): add a replicated property of
+ * this type, call SetAim/RemoveAim on the server, and read GetAim/GetItems on clients (in its RepNotify, for example).
+ *
+ * Each update only has the turrets whose quantized aim changed since the last snapshot this connection acknowledged, and their angles
+ * are sent as small deltas from it (see TurretRotationCore::WriteAimSnapshotDelta).  Every update names the snapshot it's relative to,
+ * and clients keep the last few snapshots they applied, so a dropped packet never leaves a client adding deltas to the wrong base.
+ * Updates that refer to a snapshot the client doesn't have are skipped, and a full snapshot is sent every FullSnapshotInterval updates
+ * so a connection can't stay stuck.
+ */
+USTRUCT()
+struct TURRETROTATION_API FTurretAimNetArray
+{
+	GENERATED_BODY()
+
+public:
+	FTurretAimNetArray();
+
+	/** Bits for each turret's yaw (10 to 16).  Only used on the server; clients get it with every update. */
+	UPROPERTY( EditAnywhere, Category = "Turret|Replication", meta = ( ClampMin = "10", ClampMax = "16" ) )
+	int32 YawBits;
+
+	/** Bits for each turret's pitch (10 to 16). */
+	UPROPERTY( EditAnywhere, Category = "Turret|Replication", meta = ( ClampMin = "10", ClampMax = "16" ) )
+	int32 PitchBits;
+
+	/** Bits for an angle that only moved a few steps (2 to 8).  Bigger moves are sent in full. */
+	UPROPERTY( EditAnywhere, Category = "Turret|Replication", meta = ( ClampMin = "2", ClampMax = "8" ) )
+	int32 SmallDeltaBits;
+
+	/** Every this many updates (per connection), the whole snapshot is sent instead of a delta.  0 to never do it. */
+	UPROPERTY( EditAnywhere, Category = "Turret|Replication", meta = ( ClampMin = "0" ) )
+	int32 FullSnapshotInterval;
+
+	/**
+	 * Sets the aim of a turret, adding it if needed.
+	 *
+	 * @param TurretId			Any ID, as long as each turret keeps its own.  Small IDs that are close together are cheaper to send.
+	 * @param AimJointRotation	The AimJoint's rotation (relative to the Actor).  Roll is ignored.
+	 */
+	void SetAim( int32 TurretId, const FRotator& AimJointRotation );
+
+	/** @return Returns true if the turret was there, and has been removed. */
+	bool RemoveAim( int32 TurretId );
+
+	/**
+	 * @param TurretId					The turret's ID.
+	 * @param Out_AimJointRotation		OUT - The turret's quantized aim.
+	 * @return Returns true if the turret was found.
+	 */
+	bool GetAim( int32 TurretId, FRotator& Out_AimJointRotation ) const;
+
+	/** @return Returns every turret, sorted by ID. */
+	const TArray<TurretRotationCore::FAimSnapshotItem>& GetItems() const { return Items; }
+
+	/** @return Returns the quantization that SetAim uses. */
+	TurretRotationCore::FAimQuantization GetQuantization() const;
+
+	bool NetDeltaSerialize( FNetDeltaSerializeInfo& DeltaParms );
+
+	/** Number of snapshots that clients keep to apply deltas to. */
+	static const int32 NumReceivedSnapshots = 16;
+
+private:
+	/** Writes the difference between the connection's base snapshot and Items. */
+	bool WriteDelta( FNetDeltaSerializeInfo& DeltaParms );
+
+	/** Reads an update, and replaces Items if it could be applied. */
+	bool ReadDelta( FNetDeltaSerializeInfo& DeltaParms );
+
+	/** @return Returns the index of the turret in Items, or the index to insert it at (as a negative number minus one) if it isn't there. */
+	int32 FindItemIndex( int32 TurretId ) const;
+
+	/** Every turret, sorted by ID. */
+	TArray<TurretRotationCore::FAimSnapshotItem> Items;
+
+	/** The quantization that the aims in Items are in.  Changes to YawBits/PitchBits only apply once the items are quantized again. */
+	TurretRotationCore::FAimQuantization ItemsQuantization;
+
+	/** Server: ID for the next snapshot sent to any connection.  Snapshot IDs are 16 bits on the wire. */
+	uint16 NextSnapshotId;
+
+	/** A snapshot that a client applied, that later updates can be relative to. */
+	struct FReceivedSnapshot
+	{
+		uint16 SnapshotId;
+		TArray<TurretRotationCore::FAimSnapshotItem> Items;
+	};
+
+	/** Client: the last NumReceivedSnapshots snapshots applied, oldest first. */
+	TArray<FReceivedSnapshot> ReceivedSnapshots;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTurretAimNetArray> : public TStructOpsTypeTraitsBase2<FTurretAimNetArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
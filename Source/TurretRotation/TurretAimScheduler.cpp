@@ -0,0 +1,327 @@
+#include "TurretAimScheduler.h"
+#include "TurretAimComponent.h"
+#include "TurretRotation.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+
+DECLARE_CYCLE_STAT( TEXT( "Scheduler" ), STAT_TurretScheduler_Schedule, STATGROUP_TurretRotation );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Scheduled Solves" ), STAT_TurretScheduler_Scheduled, STATGROUP_TurretRotation );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Deferred Solves" ), STAT_TurretScheduler_Deferred, STATGROUP_TurretRotation );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Budget Overruns" ), STAT_TurretScheduler_Overruns, STATGROUP_TurretRotation );
+DECLARE_FLOAT_COUNTER_STAT( TEXT( "Staleness Critical (ms)" ), STAT_TurretScheduler_StalenessCritical, STATGROUP_TurretRotation );
+DECLARE_FLOAT_COUNTER_STAT( TEXT( "Staleness Visible (ms)" ), STAT_TurretScheduler_StalenessVisible, STATGROUP_TurretRotation );
+DECLARE_FLOAT_COUNTER_STAT( TEXT( "Staleness Background (ms)" ), STAT_TurretScheduler_StalenessBackground, STATGROUP_TurretRotation );
+
+
+static TAutoConsoleVariable<int32> CVarTurretSchedulerEnabled(
+	TEXT( "TurretRotation.Scheduler.Enabled" ),
+	0,
+	TEXT( "If non-zero, ATurretAimManager only solves the turrets picked by FTurretAimScheduler each frame, instead of every turret." ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<float> CVarTurretSchedulerBudgetMs(
+	TEXT( "TurretRotation.Scheduler.BudgetMs" ),
+	0.5f,
+	TEXT( "How many milliseconds per frame the scheduled turrets can take to solve.  0 or less means no budget.\n" )
+	TEXT( "Critical turrets are always solved, even if they alone take longer than this; the other tiers get whatever is left." ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<float> CVarTurretSchedulerVisibleHz(
+	TEXT( "TurretRotation.Scheduler.VisibleHz" ),
+	30.0f,
+	TEXT( "How many times per second turrets in the Visible tier are solved.  0 or less means every frame." ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<float> CVarTurretSchedulerBackgroundHz(
+	TEXT( "TurretRotation.Scheduler.BackgroundHz" ),
+	10.0f,
+	TEXT( "How many times per second turrets in the Background tier are solved.  0 or less means every frame." ),
+	ECVF_Default );
+
+static TAutoConsoleVariable<float> CVarTurretSchedulerNearDistance(
+	TEXT( "TurretRotation.Scheduler.NearDistance" ),
+	3000.0f,
+	TEXT( "Turrets within this distance of a viewer count as near, whether or not they were rendered." ),
+	ECVF_Default );
+
+
+namespace
+{
+	/** How long ago (in seconds) a turret has to have been rendered to count as visible. */
+	const float RecentlyRenderedTolerance = 0.2f;
+
+	/** How quickly the estimated cost of a solve follows the measured one. */
+	const double SolveCostSmoothing = 0.1;
+
+	/** @return Returns the time between solves for a tier, from its rate in Hz. */
+	double GetTierInterval( ETurretUpdateTier Tier )
+	{
+		float Hz = 0.0f;
+		switch ( Tier )
+		{
+		case ETurretUpdateTier::Visible:		Hz = CVarTurretSchedulerVisibleHz.GetValueOnGameThread(); break;
+		case ETurretUpdateTier::Background:		Hz = CVarTurretSchedulerBackgroundHz.GetValueOnGameThread(); break;
+		default:								break;
+		}
+
+		return ( Hz > 0.0f ) ? ( 1.0 / Hz ) : 0.0;
+	}
+}
+
+
+FTurretScheduleState::FTurretScheduleState()
+	: Tier( ETurretUpdateTier::Critical )
+	, Significance( 0.0f )
+	, LastSolveTime( -1.0 )
+	, LastSolvedRotation( FRotator::ZeroRotator )
+{
+}
+
+void FTurretScheduleState::RecordSolve( double Time, const FRotator& AimJointRotation )
+{
+	LastSolveTime = Time;
+	LastSolvedRotation = AimJointRotation;
+}
+
+
+FTurretSchedulerStats::FTurretSchedulerStats()
+	: NumDeferred( 0 )
+	, NumBudgetOverruns( 0 )
+	, LastSolveSeconds( 0.0 )
+	, EstimatedSecondsPerSolve( 1.e-6 )
+{
+	FMemory::Memzero( Tiers );
+}
+
+
+FTurretAimScheduler::FTurretAimScheduler()
+{
+}
+
+bool FTurretAimScheduler::IsEnabled()
+{
+	return CVarTurretSchedulerEnabled.GetValueOnGameThread() != 0;
+}
+
+void FTurretAimScheduler::Schedule( UWorld* World, TArrayView<UTurretAimComponent* const> Turrets, TArray<bool>& Out_ShouldSolve )
+{
+	SCOPE_CYCLE_COUNTER( STAT_TurretScheduler_Schedule );
+	TURRETROTATION_TRACE_SCOPE( TurretScheduler_Schedule );
+
+	const int32 NumTurrets = Turrets.Num();
+	Out_ShouldSolve.Reset( NumTurrets );
+	Out_ShouldSolve.AddZeroed( NumTurrets );
+
+	Candidates.Reset();
+	FMemory::Memzero( Stats.Tiers );
+	Stats.NumDeferred = 0;
+
+	if ( !World )
+	{
+		return;
+	}
+
+	const double Time = World->GetTimeSeconds();
+	const double DeltaSeconds = World->GetDeltaSeconds();
+	const float NearDistance = FMath::Max( 1.0f, CVarTurretSchedulerNearDistance.GetValueOnGameThread() );
+
+	double TierIntervals[static_cast<int32>( ETurretUpdateTier::Count )];
+	for ( int32 TierIndex = 0; TierIndex < static_cast<int32>( ETurretUpdateTier::Count ); ++TierIndex )
+	{
+		TierIntervals[TierIndex] = GetTierInterval( static_cast<ETurretUpdateTier>( TierIndex ) );
+	}
+
+	// Every player's view point counts, so this works the same for split screen and on servers.
+	ViewerLocations.Reset();
+	for ( FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It )
+	{
+		if ( const APlayerController* PlayerController = It->Get() )
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint( /*out*/ ViewLocation, /*out*/ ViewRotation );
+			ViewerLocations.Add( ViewLocation );
+		}
+	}
+
+	double StalenessSums[static_cast<int32>( ETurretUpdateTier::Count )] = {};
+	int32 NumStale[static_cast<int32>( ETurretUpdateTier::Count )] = {};
+	int32 NumCritical = 0;
+
+	for ( int32 Index = 0; Index < NumTurrets; ++Index )
+	{
+		UTurretAimComponent* Turret = Turrets[Index];
+		const AActor* Owner = Turret ? Turret->GetOwner() : nullptr;
+		if ( !Owner || !Turret->ShouldSolveLocally() )
+		{
+			continue;
+		}
+
+		const FVector TurretLocation = Owner->GetActorLocation();
+
+		float NearestViewerDistanceSquared = MAX_flt;
+		for ( const FVector& ViewerLocation : ViewerLocations )
+		{
+			NearestViewerDistanceSquared = FMath::Min( NearestViewerDistanceSquared, FVector::DistSquared( TurretLocation, ViewerLocation ) );
+		}
+
+		const bool bIsNear = NearestViewerDistanceSquared <= FMath::Square( NearDistance );
+		const bool bIsVisible = Owner->WasRecentlyRendered( RecentlyRenderedTolerance );
+		const bool bHasTargetInRange = Turret->TargetActor
+			&& FVector::DistSquared( TurretLocation, Turret->TargetActor->GetActorLocation() ) <= FMath::Square( Turret->AcquisitionMaxRange );
+
+		FTurretScheduleState& State = Turret->GetScheduleState();
+		if ( Turret->bIsFiring || ( bHasTargetInRange && ( bIsNear || bIsVisible ) ) )
+		{
+			State.Tier = ETurretUpdateTier::Critical;
+		}
+		else if ( bIsNear || bIsVisible || bHasTargetInRange )
+		{
+			State.Tier = ETurretUpdateTier::Visible;
+		}
+		else
+		{
+			State.Tier = ETurretUpdateTier::Background;
+		}
+
+		// 1 right next to a viewer, falling off to 0.5 at NearDistance, and towards 0 past that.
+		State.Significance = ViewerLocations.Num() > 0 ? 1.0f / ( 1.0f + ( FMath::Sqrt( NearestViewerDistanceSquared ) / NearDistance ) ) : 0.0f;
+
+		const int32 TierIndex = static_cast<int32>( State.Tier );
+		++Stats.Tiers[TierIndex].NumTurrets;
+
+		const bool bIsCritical = ( State.Tier == ETurretUpdateTier::Critical );
+		if ( !State.HasSolve() )
+		{
+			Candidates.Add( { Index, MAX_flt, bIsCritical } );
+			NumCritical += bIsCritical ? 1 : 0;
+			continue;
+		}
+
+		// Due once it's within half a frame of its interval, so a 30 Hz tier at 60 fps really is solved every other frame.
+		const double Interval = TierIntervals[TierIndex];
+		const double Staleness = State.GetStaleness( Time );
+		if ( Staleness >= Interval - ( 0.5 * DeltaSeconds ) )
+		{
+			const double Overdue = Staleness / FMath::Max( Interval, FMath::Max( DeltaSeconds, double( SMALL_NUMBER ) ) );
+			Candidates.Add( { Index, static_cast<float>( Overdue * ( 1.0 + State.Significance ) ), bIsCritical } );
+			NumCritical += bIsCritical ? 1 : 0;
+		}
+	}
+
+	// Pick as many of the most urgent turrets as should fit in the budget.  Critical turrets are always picked, and use up the budget
+	// first, so they're never deferred (even if they don't all fit).
+	const float BudgetMs = CVarTurretSchedulerBudgetMs.GetValueOnGameThread();
+	int32 NumToSolve = Candidates.Num();
+	if ( BudgetMs > 0.0f && Candidates.Num() > 0 )
+	{
+		NumToSolve = FMath::Clamp( FMath::FloorToInt( static_cast<float>( ( BudgetMs / 1000.0 ) / Stats.EstimatedSecondsPerSolve ) ), 1, Candidates.Num() );
+		NumToSolve = FMath::Max( NumToSolve, NumCritical );
+	}
+
+	if ( NumToSolve < Candidates.Num() )
+	{
+		Candidates.Sort( []( const FCandidate& A, const FCandidate& B )
+		{
+			if ( A.bIsCritical != B.bIsCritical )
+			{
+				return A.bIsCritical;
+			}
+			return A.Urgency > B.Urgency;
+		} );
+	}
+
+	for ( int32 CandidateIndex = 0; CandidateIndex < NumToSolve; ++CandidateIndex )
+	{
+		const int32 TurretIndex = Candidates[CandidateIndex].TurretIndex;
+		Out_ShouldSolve[TurretIndex] = true;
+		++Stats.Tiers[static_cast<int32>( Turrets[TurretIndex]->GetScheduleState().Tier )].NumScheduled;
+	}
+
+	Stats.NumDeferred = Candidates.Num() - NumToSolve;
+
+	// Everything that isn't being solved holds (or, if someone can see it, extrapolates) its last aim.
+	for ( int32 Index = 0; Index < NumTurrets; ++Index )
+	{
+		UTurretAimComponent* Turret = Turrets[Index];
+		const AActor* Owner = Turret ? Turret->GetOwner() : nullptr;
+		if ( Out_ShouldSolve[Index] || !Owner || !Turret->ShouldSolveLocally() )
+		{
+			continue;
+		}
+
+		const FTurretScheduleState& State = Turret->GetScheduleState();
+		if ( !State.HasSolve() )
+		{
+			continue;
+		}
+
+		const int32 TierIndex = static_cast<int32>( State.Tier );
+		StalenessSums[TierIndex] += State.GetStaleness( Time );
+		++NumStale[TierIndex];
+
+		// The same prediction as bUseExtrapolation, but without its error threshold, since there's no solve to fall back on this frame.
+		const FTurretAimExtrapolation& Extrapolation = Turret->GetAimExtrapolation();
+		if ( Extrapolation.HasSolve() && Owner->WasRecentlyRendered( RecentlyRenderedTolerance ) )
+		{
+			const double LastSolveTime = Extrapolation.GetLastSolveTime();
+			const FRotator ExtrapolatedRotation = Extrapolation.Extrapolate( FMath::Clamp( Time, LastSolveTime, LastSolveTime + Turret->MaxExtrapolationSeconds ) );
+			if ( !ExtrapolatedRotation.Equals( Turret->GetAimJointRotation(), KINDA_SMALL_NUMBER ) )
+			{
+				Turret->ApplyAimJointRotation( ExtrapolatedRotation );
+			}
+		}
+	}
+
+	for ( int32 TierIndex = 0; TierIndex < static_cast<int32>( ETurretUpdateTier::Count ); ++TierIndex )
+	{
+		Stats.Tiers[TierIndex].AverageStalenessSeconds = NumStale[TierIndex] > 0 ? StalenessSums[TierIndex] / NumStale[TierIndex] : 0.0;
+	}
+
+	INC_DWORD_STAT_BY( STAT_TurretScheduler_Scheduled, NumToSolve );
+	INC_DWORD_STAT_BY( STAT_TurretScheduler_Deferred, Stats.NumDeferred );
+	SET_FLOAT_STAT( STAT_TurretScheduler_StalenessCritical, Stats.Tiers[static_cast<int32>( ETurretUpdateTier::Critical )].AverageStalenessSeconds * 1000.0 );
+	SET_FLOAT_STAT( STAT_TurretScheduler_StalenessVisible, Stats.Tiers[static_cast<int32>( ETurretUpdateTier::Visible )].AverageStalenessSeconds * 1000.0 );
+	SET_FLOAT_STAT( STAT_TurretScheduler_StalenessBackground, Stats.Tiers[static_cast<int32>( ETurretUpdateTier::Background )].AverageStalenessSeconds * 1000.0 );
+}
+
+void FTurretAimScheduler::ReportSolve( int32 NumSolved, double SolveSeconds )
+{
+	Stats.LastSolveSeconds = SolveSeconds;
+
+	if ( NumSolved > 0 )
+	{
+		const double SecondsPerSolve = SolveSeconds / NumSolved;
+		Stats.EstimatedSecondsPerSolve = FMath::Lerp( Stats.EstimatedSecondsPerSolve, SecondsPerSolve, SolveCostSmoothing );
+	}
+
+	const float BudgetMs = CVarTurretSchedulerBudgetMs.GetValueOnGameThread();
+	if ( BudgetMs > 0.0f && SolveSeconds * 1000.0 > BudgetMs )
+	{
+		++Stats.NumBudgetOverruns;
+		INC_DWORD_STAT( STAT_TurretScheduler_Overruns );
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Turret solve took %.3f ms for %d turrets, over the %.3f ms budget." ), SolveSeconds * 1000.0, NumSolved, BudgetMs );
+	}
+}
+
+void FTurretAimScheduler::HoldLastSolve( UTurretAimComponent& Turret, double Time )
+{
+	FTurretScheduleState& State = Turret.GetScheduleState();
+	if ( !State.HasSolve() )
+	{
+		return;
+	}
+
+	// Nothing changed since the last solve, so its rates are out of date.  Forgetting them stops the extrapolation.
+	const FRotator LastSolvedRotation = State.GetLastSolvedRotation();
+	State.RecordSolve( Time, LastSolvedRotation );
+	Turret.GetAimExtrapolation().Invalidate();
+
+	if ( !Turret.GetAimJointRotation().Equals( LastSolvedRotation, KINDA_SMALL_NUMBER ) )
+	{
+		Turret.ApplyAimJointRotation( LastSolvedRotation );
+	}
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+
+class UTurretAimComponent;
+class UWorld;
+
+/** How often FTurretAimScheduler wants a turret solved. */
+enum class ETurretUpdateTier : uint8
+{
+	/** Firing, or has a target in range while a viewer is close by (or can see it).  Solved every frame, even past the budget. */
+	Critical,
+
+	/** Can be seen, has a viewer close by, or has a target in range.  Solved at TurretRotation.Scheduler.VisibleHz. */
+	Visible,
+
+	/** Everything else.  Solved at TurretRotation.Scheduler.BackgroundHz. */
+	Background,
+
+	Count
+};
+
+/**
+ * What the scheduler knows about one turret.  Kept on the UTurretAimComponent, so it doesn't have to follow the turret around the
+ * manager's arrays.
+ */
+struct TURRETROTATION_API FTurretScheduleState
+{
+public:
+	FTurretScheduleState();
+
+	/**
+	 * Remembers a new solve, so the scheduler knows how stale the turret is.
+	 *
+	 * @param Time					World time (in seconds) of the inputs that were solved for.
+	 * @param AimJointRotation		The result of the solve.
+	 */
+	void RecordSolve( double Time, const FRotator& AimJointRotation );
+
+	/** @return Returns true if the turret was solved at least once. */
+	bool HasSolve() const { return LastSolveTime >= 0.0; }
+
+	/** @return Returns the result of the last solve. */
+	const FRotator& GetLastSolvedRotation() const { return LastSolvedRotation; }
+
+	/** @return Returns how long ago (in seconds) the turret was last solved. */
+	double GetStaleness( double Time ) const { return Time - LastSolveTime; }
+
+	/** Tier and significance from the last FTurretAimScheduler::Schedule. */
+	ETurretUpdateTier Tier;
+	float Significance;
+
+private:
+	/** World time of the last solve.  Negative if there wasn't one. */
+	double LastSolveTime;
+
+	FRotator LastSolvedRotation;
+};
+
+/** Counters for one ETurretUpdateTier, from the last FTurretAimScheduler::Schedule. */
+struct FTurretSchedulerTierStats
+{
+	int32 NumTurrets;
+	int32 NumScheduled;
+
+	/** Average time (in seconds) since the turrets in this tier were last solved, for the ones that weren't solved this frame. */
+	double AverageStalenessSeconds;
+};
+
+/** Counters from FTurretAimScheduler. */
+struct FTurretSchedulerStats
+{
+	FTurretSchedulerStats();
+
+	FTurretSchedulerTierStats Tiers[static_cast<int32>( ETurretUpdateTier::Count )];
+
+	/** Turrets that were due, but didn't fit in the budget and were carried over to a later frame.  Never includes Critical turrets. */
+	int32 NumDeferred;
+
+	/** Number of solves (since the scheduler was made) that took longer than the budget. */
+	int32 NumBudgetOverruns;
+
+	/** How long (in seconds) the last scheduled solve took, and how long one solve is expected to take. */
+	double LastSolveSeconds;
+	double EstimatedSecondsPerSolve;
+};
+
+/**
+ * Decides which of ATurretAimManager's turrets are solved each frame, when TurretRotation.Scheduler.Enabled is set.
+ *
+ * Every turret gets a tier (see ETurretUpdateTier) from how close it is to the nearest viewer (any player's view point), whether it
+ * was rendered recently, whether its TargetActor is within its AcquisitionMaxRange, and its bIsFiring flag.  Each tier has its own
+ * update rate, so a turret is only due once it has gone that long without a solve.
+ *
+ * Due turrets are ranked by how overdue they are (staleness over the tier's interval), weighted by their significance (how close the
+ * nearest viewer is).  Critical turrets are always picked, and the rest only as many as fit in what's left of
+ * TurretRotation.Scheduler.BudgetMs of solving.  The cost of a solve is measured from the previous frames, so the budget follows the
+ * hardware (and the thread count).  The ones that don't fit are carried over, and since they keep getting more overdue, every turret is eventually
+ * solved.  If the Critical turrets alone take longer than the budget, the budget is overrun (see FTurretSchedulerStats::NumBudgetOverruns)
+ * rather than letting a firing turret fall behind.
+ *
+ * Turrets that were recently rendered, but aren't solved this frame, are moved along the rates of their last solve (the same
+ * prediction as bUseExtrapolation, see FTurretAimExtrapolation) so they keep turning smoothly, for up to their MaxExtrapolationSeconds.
+ * Ones that nobody can see, and ballistic turrets (which have no rates), just keep their last aim.
+ *
+ * Everything is reported in STATGROUP_TurretRotation (stat TurretRotation) and through GetStats.
+ */
+class TURRETROTATION_API FTurretAimScheduler
+{
+public:
+	FTurretAimScheduler();
+
+	/** @return Returns true if the manager should use the scheduler (TurretRotation.Scheduler.Enabled). */
+	static bool IsEnabled();
+
+	/**
+	 * Ranks the turrets, picks the ones to solve this frame, and extrapolates the visible ones that weren't picked.  Must be called on the game thread.
+	 *
+	 * @param World				The world the turrets are in.  Used for the viewers and the time.
+	 * @param Turrets			Every turret.  Null entries, and turrets that don't solve locally, are never picked.
+	 * @param Out_ShouldSolve	OUT - Whether each turret should be solved this frame.
+	 */
+	void Schedule( UWorld* World, TArrayView<UTurretAimComponent* const> Turrets, TArray<bool>& Out_ShouldSolve );
+
+	/**
+	 * Counts how long the turrets picked by Schedule took to solve.  Used to work out how many turrets fit in the budget.
+	 *
+	 * @param NumSolved			Number of turrets that were solved.
+	 * @param SolveSeconds		How long the solve took (wall time, however many threads it was split across).
+	 */
+	void ReportSolve( int32 NumSolved, double SolveSeconds );
+
+	/**
+	 * Makes the turret hold its last solved aim.  For turrets picked by Schedule whose incremental solve found nothing had changed,
+	 * since they may have been extrapolated past it.
+	 *
+	 * @param Turret		The turret.
+	 * @param Time			World time (in seconds) of the inputs that would have been solved for.
+	 */
+	static void HoldLastSolve( UTurretAimComponent& Turret, double Time );
+
+	/** @return Returns the counters from the last Schedule/ReportSolve. */
+	const FTurretSchedulerStats& GetStats() const { return Stats; }
+
+private:
+	/** Every viewer's location, gathered at the start of Schedule. */
+	TArray<FVector> ViewerLocations;
+
+	/** Due turrets, and how urgently they need a solve. */
+	struct FCandidate
+	{
+		int32 TurretIndex;
+		float Urgency;
+
+		/** Critical turrets are picked before everything else, whatever the budget. */
+		bool bIsCritical;
+	};
+	TArray<FCandidate> Candidates;
+
+	FTurretSchedulerStats Stats;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TurretBallisticAim.generated.h"
+
+/**
+ * Settings for lead aiming with projectiles that fall under gravity.  See TurretRotationBallistics.h for how the solve works.
+ */
+USTRUCT( BlueprintType )
+struct TURRETROTATION_API FTurretBallisticSettings
+{
+	GENERATED_BODY()
+
+public:
+	FTurretBallisticSettings()
+		: MuzzleSpeed( 5000.0f )
+		, GravityZ( -980.0f )
+		, bUseHighArc( false )
+		, MaxIterations( 6 )
+		, TimeTolerance( 0.001f )
+	{
+	}
+
+	/** Speed of the projectile when it leaves the muzzle. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic", meta = ( ClampMin = "0.0" ) )
+	float MuzzleSpeed;
+
+	/** Gravity along the world's "Z" axis.  Usually the world's GetGravityZ().  Zero for projectiles that fly straight. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic" )
+	float GravityZ;
+
+	/** If true, then the high (mortar-like) arc is used instead of the low (faster, flatter) arc. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic" )
+	bool bUseHighArc;
+
+	/** Upper limit on the number of iterations.  Each iteration costs a bit more than a regular solve. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic", meta = ( ClampMin = "1", ClampMax = "16" ) )
+	int32 MaxIterations;
+
+	/** The solve stops early once the flight time is known to within this many seconds. */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret|Ballistic", meta = ( ClampMin = "0.0" ) )
+	float TimeTolerance;
+};
+
+/**
+ * The result of a ballistic (lead aim) solve.
+ */
+USTRUCT( BlueprintType )
+struct TURRETROTATION_API FTurretBallisticSolution
+{
+	GENERATED_BODY()
+
+public:
+	FTurretBallisticSolution()
+		: bHasSolution( false )
+		, AimJointRotation( FRotator::ZeroRotator )
+		, TimeOfFlight( 0.0f )
+		, PredictedImpactLocation( FVector::ZeroVector )
+		, MuzzleWorldLocation( FVector::ZeroVector )
+		, NumIterations( 0 )
+	{
+	}
+
+	/**
+	 * False if the projectile can't reach the target, or the solve didn't converge within MaxIterations.
+	 * If the target is out of range, then AimJointRotation still points the barrel at the target's predicted location.
+	 */
+	UPROPERTY( BlueprintReadOnly, Category = "Turret|Ballistic" )
+	bool bHasSolution;
+
+	/** The new rotation for the AimJoint (relative to the Actor). */
+	UPROPERTY( BlueprintReadOnly, Category = "Turret|Ballistic" )
+	FRotator AimJointRotation;
+
+	/** How long (in seconds) the projectile takes to reach the target. */
+	UPROPERTY( BlueprintReadOnly, Category = "Turret|Ballistic" )
+	float TimeOfFlight;
+
+	/** Where (in world space) the target is predicted to be when the projectile arrives. */
+	UPROPERTY( BlueprintReadOnly, Category = "Turret|Ballistic" )
+	FVector PredictedImpactLocation;
+
+	/** Where (in world space) the muzzle will be once the AimJoint is rotated.  This is where the projectile should be spawned. */
+	UPROPERTY( BlueprintReadOnly, Category = "Turret|Ballistic" )
+	FVector MuzzleWorldLocation;
+
+	/** How many iterations the solve used. */
+	UPROPERTY( BlueprintReadOnly, Category = "Turret|Ballistic" )
+	int32 NumIterations;
+};
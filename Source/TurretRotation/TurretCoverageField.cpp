@@ -0,0 +1,345 @@
+#include "TurretCoverageField.h"
+#include "TurretRotation.h"
+#include "Async/ParallelFor.h"
+
+
+DECLARE_CYCLE_STAT( TEXT( "Coverage Bake" ), STAT_TurretCoverage_Bake, STATGROUP_TurretRotation );
+
+namespace
+{
+	/** Turrets that would be listed in more cells than this (a huge MaxRange compared to the CellSize) are checked by every query instead. */
+	const int32 MaxCellsPerTurret = 4096;
+}
+
+FTurretCoverageTurret::FTurretCoverageTurret()
+	: ActorWorldTransform( FTransform::Identity )
+{
+}
+
+FTurretCoverageField::FTurretCoverageField( float InCellSize )
+	: CellSize( FMath::Max( InCellSize, 1.0f ) )
+	, InverseCellSize( 1.0f / FMath::Max( InCellSize, 1.0f ) )
+{
+	Reset();
+}
+
+void FTurretCoverageField::Reset()
+{
+	Turrets.Reset();
+	FreeHandles.Reset();
+	Cells.Reset();
+	WideTurrets.Reset();
+}
+
+int32 FTurretCoverageField::AddTurret( const FTurretCoverageTurret& Turret )
+{
+	TArray<int32> Handles;
+	AddTurrets( TArrayView<const FTurretCoverageTurret>( &Turret, 1 ), Handles, /*bForceSingleThread*/ true );
+	return Handles[0];
+}
+
+void FTurretCoverageField::AddTurrets( TArrayView<const FTurretCoverageTurret> NewTurrets, TArray<int32>& Out_Handles, bool bForceSingleThread )
+{
+	Out_Handles.Reset( NewTurrets.Num() );
+	for ( const FTurretCoverageTurret& NewTurret : NewTurrets )
+	{
+		const int32 Handle = FreeHandles.Num() > 0 ? FreeHandles.Pop( /*bAllowShrinking*/ false ) : Turrets.AddDefaulted();
+
+		FBakedTurret& Turret = Turrets[Handle];
+		Turret.Source = NewTurret;
+		Turret.bInUse = true;
+		Out_Handles.Add( Handle );
+	}
+
+	BakeTurrets( Out_Handles, bForceSingleThread );
+
+	for ( const int32 Handle : Out_Handles )
+	{
+		AddToCells( Handle );
+	}
+}
+
+int32 FTurretCoverageField::UpdateTurrets( TArrayView<const int32> Handles, TArrayView<const FTurretCoverageTurret> NewTurrets, bool bForceSingleThread )
+{
+	check( Handles.Num() == NewTurrets.Num() );
+
+	HandlesToBake.Reset();
+	int32 NumChanged = 0;
+
+	for ( int32 Index = 0; Index < Handles.Num(); ++Index )
+	{
+		const int32 Handle = Handles[Index];
+		const FTurretCoverageTurret& NewTurret = NewTurrets[Index];
+		check( IsValidTurret( Handle ) );
+
+		FBakedTurret& Turret = Turrets[Handle];
+		const bool bSameShape = HasSameShape( Turret.Source, NewTurret );
+		if ( bSameShape && Turret.Source.ActorWorldTransform.Equals( NewTurret.ActorWorldTransform ) )
+		{
+			continue;
+		}
+
+		RemoveFromCells( Handle );
+		Turret.Source = NewTurret;
+		++NumChanged;
+
+		if ( bSameShape )
+		{
+			// The baked coverage is relative to the AimJoint, so moving the turret doesn't change it.
+			PlaceTurret( Turret, NewTurret.ActorWorldTransform );
+			AddToCells( Handle );
+		}
+		else
+		{
+			HandlesToBake.Add( Handle );
+		}
+	}
+
+	BakeTurrets( HandlesToBake, bForceSingleThread );
+
+	for ( const int32 Handle : HandlesToBake )
+	{
+		AddToCells( Handle );
+	}
+
+	return NumChanged;
+}
+
+void FTurretCoverageField::RemoveTurret( int32 Handle )
+{
+	check( IsValidTurret( Handle ) );
+
+	RemoveFromCells( Handle );
+	Turrets[Handle].bInUse = false;
+	FreeHandles.Add( Handle );
+}
+
+FIntPoint FTurretCoverageField::GetCell( const FVector& Location ) const
+{
+	return FIntPoint( FMath::FloorToInt( Location.X * InverseCellSize ), FMath::FloorToInt( Location.Y * InverseCellSize ) );
+}
+
+bool FTurretCoverageField::HasSameShape( const FTurretCoverageTurret& First, const FTurretCoverageTurret& Second )
+{
+	const TurretRotationCore::TAimGeometry<float, FVector2D>& FirstCore = First.Geometry.GetCore();
+	const TurretRotationCore::TAimGeometry<float, FVector2D>& SecondCore = Second.Geometry.GetCore();
+
+	return First.Geometry.GetActorToAimJoint() == Second.Geometry.GetActorToAimJoint()
+		&& FirstCore.GetAimJointLocation2D() == SecondCore.GetAimJointLocation2D()
+		&& FirstCore.GetBarrelStartLocation2D() == SecondCore.GetBarrelStartLocation2D()
+		&& FirstCore.GetBarrelEndLocation2D() == SecondCore.GetBarrelEndLocation2D()
+		&& First.Limits.MinRange == Second.Limits.MinRange
+		&& First.Limits.MaxRange == Second.Limits.MaxRange
+		&& First.Limits.HalfArcDegrees == Second.Limits.HalfArcDegrees
+		&& First.Limits.MinPitchDegrees == Second.Limits.MinPitchDegrees
+		&& First.Limits.MaxPitchDegrees == Second.Limits.MaxPitchDegrees;
+}
+
+void FTurretCoverageField::PlaceTurret( FBakedTurret& Turret, const FTransform& ActorWorldTransform )
+{
+	Turret.AimJointWorldLocation = ActorWorldTransform.TransformPosition( Turret.Source.Geometry.GetActorToAimJoint() );
+	Turret.ActorRotation = ActorWorldTransform.GetRotation();
+
+	// The yaw arc is relative to the Actor, so it only lines up with the "X-Y" plane when the Actor is upright.
+	const bool bUpright = Turret.ActorRotation.GetUpVector().Z >= 0.9999f;
+	const FVector Forward = Turret.ActorRotation.GetForwardVector();
+	Turret.Forward2D = bUpright ? FVector2D( Forward.X, Forward.Y ).GetSafeNormal() : FVector2D::ZeroVector;
+}
+
+void FTurretCoverageField::BakeTurrets( TArrayView<const int32> Handles, bool bForceSingleThread )
+{
+	if ( Handles.Num() == 0 )
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER( STAT_TurretCoverage_Bake );
+	TURRETROTATION_TRACE_SCOPE( TurretCoverage_Bake );
+
+	// Each bake is a few dozen root solves, so a handful of turrets per task is plenty.
+	const int32 NumHandles = Handles.Num();
+	const int32 ChunkSize = 8;
+	const int32 NumChunks = FMath::DivideAndRoundUp( NumHandles, ChunkSize );
+
+	// Every task only writes to its own turrets, and nothing here touches the cells.
+	ParallelFor( NumChunks, [this, &Handles, NumHandles, ChunkSize]( int32 ChunkIndex )
+	{
+		const int32 StartIndex = ChunkIndex * ChunkSize;
+		const int32 EndIndex = FMath::Min( StartIndex + ChunkSize, NumHandles );
+
+		for ( int32 Index = StartIndex; Index < EndIndex; ++Index )
+		{
+			FBakedTurret& Turret = Turrets[Handles[Index]];
+			Turret.Coverage.Initialize( Turret.Source.Geometry.GetCore(), Turret.Source.Limits );
+			PlaceTurret( Turret, Turret.Source.ActorWorldTransform );
+		}
+	}, bForceSingleThread );
+}
+
+void FTurretCoverageField::AddToCells( int32 Handle )
+{
+	FBakedTurret& Turret = Turrets[Handle];
+
+	const float MaxRange = FMath::Max( Turret.Source.Limits.MaxRange, 0.0f );
+	const FVector Extent( MaxRange, MaxRange, 0.0f );
+	Turret.MinCell = GetCell( Turret.AimJointWorldLocation - Extent );
+	Turret.MaxCell = GetCell( Turret.AimJointWorldLocation + Extent );
+
+	const int64 NumCells = int64( Turret.MaxCell.X - Turret.MinCell.X + 1 ) * int64( Turret.MaxCell.Y - Turret.MinCell.Y + 1 );
+	Turret.bWide = NumCells > MaxCellsPerTurret;
+	if ( Turret.bWide )
+	{
+		WideTurrets.Add( Handle );
+		return;
+	}
+
+	// Only list the turret in the cells it might actually reach, which skips the cells behind turrets with a narrow yaw arc.
+	for ( int32 CellY = Turret.MinCell.Y; CellY <= Turret.MaxCell.Y; ++CellY )
+	{
+		for ( int32 CellX = Turret.MinCell.X; CellX <= Turret.MaxCell.X; ++CellX )
+		{
+			const FBox CellBox(
+				FVector( CellX * CellSize, CellY * CellSize, Turret.AimJointWorldLocation.Z - MaxRange ),
+				FVector( ( CellX + 1 ) * CellSize, ( CellY + 1 ) * CellSize, Turret.AimJointWorldLocation.Z + MaxRange ) );
+
+			if ( MayCoverRegion( Turret, CellBox ) )
+			{
+				Cells.FindOrAdd( FIntPoint( CellX, CellY ) ).Add( Handle );
+			}
+		}
+	}
+}
+
+void FTurretCoverageField::RemoveFromCells( int32 Handle )
+{
+	const FBakedTurret& Turret = Turrets[Handle];
+	if ( Turret.bWide )
+	{
+		WideTurrets.RemoveSingleSwap( Handle, /*bAllowShrinking*/ false );
+		return;
+	}
+
+	for ( int32 CellY = Turret.MinCell.Y; CellY <= Turret.MaxCell.Y; ++CellY )
+	{
+		for ( int32 CellX = Turret.MinCell.X; CellX <= Turret.MaxCell.X; ++CellX )
+		{
+			if ( TArray<int32>* Entries = Cells.Find( FIntPoint( CellX, CellY ) ) )
+			{
+				Entries->RemoveSingleSwap( Handle, /*bAllowShrinking*/ false );
+			}
+		}
+	}
+}
+
+bool FTurretCoverageField::MayCoverRegion( const FBakedTurret& Turret, const FBox& WorldRegion )
+{
+	return TurretRotationCore::MayCoverRegion( Turret.Source.Limits, Turret.AimJointWorldLocation, Turret.Forward2D, WorldRegion.Min, WorldRegion.Max );
+}
+
+bool FTurretCoverageField::CanTurretHit( int32 Handle, const FVector& WorldLocation ) const
+{
+	const FBakedTurret& Turret = Turrets[Handle];
+	return Turret.Coverage.CanHit( Turret.ActorRotation.UnrotateVector( WorldLocation - Turret.AimJointWorldLocation ) );
+}
+
+void FTurretCoverageField::FindTurretsThatCanHit( const FVector& WorldLocation, TArray<int32>& Out_Handles ) const
+{
+	Out_Handles.Reset();
+
+	if ( const TArray<int32>* Entries = Cells.Find( GetCell( WorldLocation ) ) )
+	{
+		for ( const int32 Handle : *Entries )
+		{
+			if ( CanTurretHit( Handle, WorldLocation ) )
+			{
+				Out_Handles.Add( Handle );
+			}
+		}
+	}
+
+	for ( const int32 Handle : WideTurrets )
+	{
+		if ( CanTurretHit( Handle, WorldLocation ) )
+		{
+			Out_Handles.Add( Handle );
+		}
+	}
+}
+
+bool FTurretCoverageField::IsLocationCovered( const FVector& WorldLocation ) const
+{
+	if ( const TArray<int32>* Entries = Cells.Find( GetCell( WorldLocation ) ) )
+	{
+		for ( const int32 Handle : *Entries )
+		{
+			if ( CanTurretHit( Handle, WorldLocation ) )
+			{
+				return true;
+			}
+		}
+	}
+
+	for ( const int32 Handle : WideTurrets )
+	{
+		if ( CanTurretHit( Handle, WorldLocation ) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FTurretCoverageField::IsRegionSafe( const FBox& WorldRegion ) const
+{
+	// A turret is listed in every cell it might reach, so the turrets listed in the cells under the region are the only ones to check.
+	// Turrets listed in several of them are checked more than once, which is cheaper than keeping track of them.
+	const FIntPoint MinCell = GetCell( WorldRegion.Min );
+	const FIntPoint MaxCell = GetCell( WorldRegion.Max );
+	for ( int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY )
+	{
+		for ( int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX )
+		{
+			if ( const TArray<int32>* Entries = Cells.Find( FIntPoint( CellX, CellY ) ) )
+			{
+				for ( const int32 Handle : *Entries )
+				{
+					if ( MayCoverRegion( Turrets[Handle], WorldRegion ) )
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	for ( const int32 Handle : WideTurrets )
+	{
+		if ( MayCoverRegion( Turrets[Handle], WorldRegion ) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FTurretCoverageField::FindTurretsThatCanHit_BruteForce( const FVector& WorldLocation, TArray<int32>& Out_Handles ) const
+{
+	Out_Handles.Reset();
+
+	for ( int32 Handle = 0; Handle < Turrets.Num(); ++Handle )
+	{
+		const FBakedTurret& Turret = Turrets[Handle];
+		if ( !Turret.bInUse )
+		{
+			continue;
+		}
+
+		const FVector Target_InAimJointSpace = Turret.ActorRotation.UnrotateVector( WorldLocation - Turret.AimJointWorldLocation );
+		if ( TurretRotationCore::TAimCoverage<float, FVector2D>::CanHit_Solve( Turret.Source.Geometry.GetCore(), Turret.Source.Limits, Target_InAimJointSpace ) )
+		{
+			Out_Handles.Add( Handle );
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "TurretAimGeometry.h"
+#include "TurretRotationCoverage.h"
+
+/**
+ * Everything the coverage field needs to know about one turret.
+ */
+struct TURRETROTATION_API FTurretCoverageTurret
+{
+public:
+	FTurretCoverageTurret();
+
+	/** The turret Actor's world transform. */
+	FTransform ActorWorldTransform;
+
+	/** The turret's geometry.  Its ActorScale should match the ActorWorldTransform's scale. */
+	FTurretAimGeometry Geometry;
+
+	/** Range, yaw arc (relative to the Actor), and pitch limits. */
+	TurretRotationCore::TAimLimits<float> Limits;
+};
+
+/**
+ * Answers "which turrets can hit this point?" and "is this region safe from every turret?" for AI, without solving anything.
+ *
+ * Every turret's reachability is baked into a TurretRotationCore::TAimCoverage (see TurretRotationCoverage.h), so checking one turret
+ * against a point costs a transform and a table lookup.  Turrets are also bucketed into square cells across the "X-Y" plane, in every
+ * cell that they might be able to reach (within MaxRange and the yaw arc), so a point query only checks the turrets listed in the
+ * point's cell, instead of every turret.  Turrets whose MaxRange would put them in thousands of cells are checked by every query instead.
+ *
+ * The bake only depends on a turret's geometry and limits, so a turret that just moved only moves between cells.  Turrets that do need
+ * baking (new ones, or ones whose geometry or limits changed) are baked in parallel.
+ *
+ * Line of sight isn't part of the field, since it depends on everything else in the level.  Trace against the turrets the field returns.
+ *
+ * Queries don't modify anything, so any number of them can run in parallel, as long as no turret is added, updated, or removed at the same time.
+ */
+class TURRETROTATION_API FTurretCoverageField
+{
+public:
+	/**
+	 * @param InCellSize	Size of each cell.  Around the typical MaxRange works well.
+	 */
+	explicit FTurretCoverageField( float InCellSize = 4000.0f );
+
+	/**
+	 * Adds turrets, baking them in parallel.
+	 *
+	 * @param NewTurrets			The turrets to add.
+	 * @param Out_Handles			OUT - Each turret's handle.  Handles of removed turrets are reused.
+	 * @param bForceSingleThread	If true, every turret is baked on the calling thread.
+	 */
+	void AddTurrets( TArrayView<const FTurretCoverageTurret> NewTurrets, TArray<int32>& Out_Handles, bool bForceSingleThread = false );
+
+	/**
+	 * Adds one turret.
+	 *
+	 * @param Turret	The turret to add.
+	 * @return Returns the turret's handle.
+	 */
+	int32 AddTurret( const FTurretCoverageTurret& Turret );
+
+	/**
+	 * Brings turrets up to date.  Turrets that didn't change are skipped, turrets that only moved are moved between cells, and the rest
+	 * are baked again, in parallel.
+	 *
+	 * @param Handles				The turrets to update.
+	 * @param NewTurrets			Their new transforms, geometries, and limits.  Indexed like Handles.
+	 * @param bForceSingleThread	If true, every turret is baked on the calling thread.
+	 * @return Returns the number of turrets that moved or were baked again.
+	 */
+	int32 UpdateTurrets( TArrayView<const int32> Handles, TArrayView<const FTurretCoverageTurret> NewTurrets, bool bForceSingleThread = false );
+
+	/** Removes a turret.  Its handle may be given out again by AddTurret. */
+	void RemoveTurret( int32 Handle );
+
+	/** Removes every turret, and forgets every cell. */
+	void Reset();
+
+	/** @return Returns true if the handle belongs to a turret that hasn't been removed. */
+	bool IsValidTurret( int32 Handle ) const { return Turrets.IsValidIndex( Handle ) && Turrets[Handle].bInUse; }
+
+	/** @return Returns the number of turrets. */
+	int32 GetNumTurrets() const { return Turrets.Num() - FreeHandles.Num(); }
+
+	/** @return Returns the transform, geometry, and limits the turret was last baked or moved with. */
+	const FTurretCoverageTurret& GetTurret( int32 Handle ) const { return Turrets[Handle].Source; }
+
+	float GetCellSize() const { return CellSize; }
+
+	/**
+	 * @param Handle			The turret.
+	 * @param WorldLocation		The point, in world space.
+	 * @return Returns true if the turret can aim at the point (ignoring line of sight).
+	 */
+	bool CanTurretHit( int32 Handle, const FVector& WorldLocation ) const;
+
+	/**
+	 * Finds every turret that can aim at the point (ignoring line of sight).
+	 *
+	 * @param WorldLocation		The point, in world space.
+	 * @param Out_Handles		OUT - The turrets' handles.  Emptied first.
+	 */
+	void FindTurretsThatCanHit( const FVector& WorldLocation, TArray<int32>& Out_Handles ) const;
+
+	/** @return Returns true if at least one turret can aim at the point (ignoring line of sight). */
+	bool IsLocationCovered( const FVector& WorldLocation ) const;
+
+	/**
+	 * Checks if a whole region is out of reach of every turret.  This is conservative: only the range and the yaw arc are checked, so
+	 * a region that is only safe because of pitch limits is reported as covered, but a region reported as safe always is.
+	 *
+	 * @param WorldRegion	The region, in world space.
+	 * @return Returns true if no turret can aim at any point in the region.
+	 */
+	bool IsRegionSafe( const FBox& WorldRegion ) const;
+
+	/**
+	 * Same as FindTurretsThatCanHit, but solves every turret (see TurretRotationCore::TAimCoverage::CanHit_Solve).  Only useful for testing
+	 * and benchmarking against FindTurretsThatCanHit.
+	 */
+	void FindTurretsThatCanHit_BruteForce( const FVector& WorldLocation, TArray<int32>& Out_Handles ) const;
+
+private:
+	struct FBakedTurret
+	{
+		/** What the turret was baked or moved with. */
+		FTurretCoverageTurret Source;
+
+		FVector AimJointWorldLocation;
+		FQuat ActorRotation;
+
+		/** The Actor's forward on the "X-Y" plane, for IsRegionSafe.  Zero if the yaw arc can't be checked on the "X-Y" plane. */
+		FVector2D Forward2D;
+
+		TurretRotationCore::TAimCoverage<float, FVector2D> Coverage;
+
+		/** Every cell the turret is listed in is within these bounds. */
+		FIntPoint MinCell;
+		FIntPoint MaxCell;
+
+		/** True if the turret reaches too many cells to list it in each of them, so it's in WideTurrets instead. */
+		bool bWide;
+
+		bool bInUse;
+	};
+
+	/** @return Returns the cell holding the given location. */
+	FIntPoint GetCell( const FVector& Location ) const;
+
+	/** @return Returns true if the two turrets have the same geometry and limits, so only their transforms can differ. */
+	static bool HasSameShape( const FTurretCoverageTurret& First, const FTurretCoverageTurret& Second );
+
+	/** Works out everything about the turret that depends on its transform.  Doesn't touch the cells. */
+	static void PlaceTurret( FBakedTurret& Turret, const FTransform& ActorWorldTransform );
+
+	/** Bakes the coverage of every turret in Handles, in parallel. */
+	void BakeTurrets( TArrayView<const int32> Handles, bool bForceSingleThread );
+
+	/** Lists the turret in every cell it might reach. */
+	void AddToCells( int32 Handle );
+
+	/** Takes the turret out of every cell it was listed in. */
+	void RemoveFromCells( int32 Handle );
+
+	/**
+	 * @param Turret		The turret.
+	 * @param WorldRegion	The region, in world space.
+	 * @return Returns false if the turret can't possibly aim at any point in the region (see IsRegionSafe and TurretRotationCore::MayCoverRegion).
+	 */
+	static bool MayCoverRegion( const FBakedTurret& Turret, const FBox& WorldRegion );
+
+	float CellSize;
+	float InverseCellSize;
+
+	TArray<FBakedTurret> Turrets;
+	TArray<int32> FreeHandles;
+
+	/** Handles of the turrets that might reach each cell. */
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Handles of the turrets that every query checks, since their MaxRange covers too many cells. */
+	TArray<int32> WideTurrets;
+
+	/** Scratch for the turrets that need baking in UpdateTurrets. */
+	TArray<int32> HandlesToBake;
+};
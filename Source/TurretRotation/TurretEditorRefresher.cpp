@@ -0,0 +1,140 @@
+#include "TurretEditorRefresher.h"
+
+#if WITH_EDITOR
+
+#include "TurretAimComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+
+FTurretEditorRefresher* FTurretEditorRefresher::Instance = nullptr;
+
+FTurretEditorRefresher* FTurretEditorRefresher::Get()
+{
+	return Instance;
+}
+
+void FTurretEditorRefresher::SetInstance( FTurretEditorRefresher* Refresher )
+{
+	Instance = Refresher;
+}
+
+void FTurretEditorRefresher::RegisterTurret( UTurretAimComponent* Turret )
+{
+	if ( !Turret )
+	{
+		return;
+	}
+
+	// The turret may already be registered under its old target.
+	UnregisterTurret( Turret );
+
+	const TWeakObjectPtr<UTurretAimComponent> WeakTurret = Turret;
+	TurretsByTarget.Add( Turret->TargetActor, WeakTurret );
+	TargetByTurret.Add( WeakTurret, Turret->TargetActor );
+
+	DirtyTurrets.Add( WeakTurret );
+}
+
+void FTurretEditorRefresher::UnregisterTurret( UTurretAimComponent* Turret )
+{
+	const TWeakObjectPtr<UTurretAimComponent> WeakTurret = Turret;
+
+	TWeakObjectPtr<AActor> OldTarget;
+	if ( TargetByTurret.RemoveAndCopyValue( WeakTurret, OldTarget ) )
+	{
+		TurretsByTarget.RemoveSingle( OldTarget, WeakTurret );
+	}
+
+	DirtyTurrets.Remove( WeakTurret );
+}
+
+void FTurretEditorRefresher::RequestRefresh( AActor* TurretActor )
+{
+	if ( !TurretActor )
+	{
+		return;
+	}
+
+	TInlineComponentArray<UTurretAimComponent*> Turrets;
+	TurretActor->GetComponents( Turrets );
+
+	if ( Turrets.Num() == 0 )
+	{
+		DirtyConstructionScriptActors.Add( TurretActor );
+		return;
+	}
+
+	for ( UTurretAimComponent* Turret : Turrets )
+	{
+		DirtyTurrets.Add( Turret );
+	}
+}
+
+void FTurretEditorRefresher::OnActorMoved( AActor* MovedActor )
+{
+	MarkDependentsDirty( MovedActor );
+}
+
+void FTurretEditorRefresher::MarkDependentsDirty( AActor* MovedActor )
+{
+	if ( !MovedActor )
+	{
+		return;
+	}
+
+	// Turrets aiming at the Actor.
+	TArray<TWeakObjectPtr<UTurretAimComponent>, TInlineAllocator<16>> Dependents;
+	TurretsByTarget.MultiFind( MovedActor, Dependents );
+	for ( const TWeakObjectPtr<UTurretAimComponent>& Dependent : Dependents )
+	{
+		DirtyTurrets.Add( Dependent );
+	}
+
+	// The Actor might be a turret itself.
+	TInlineComponentArray<UTurretAimComponent*> OwnTurrets;
+	MovedActor->GetComponents( OwnTurrets );
+	for ( UTurretAimComponent* OwnTurret : OwnTurrets )
+	{
+		DirtyTurrets.Add( OwnTurret );
+	}
+}
+
+void FTurretEditorRefresher::Tick( float DeltaTime )
+{
+	// Swap the pending sets out first, in case updating a turret causes more requests.
+	TSet<TWeakObjectPtr<UTurretAimComponent>> TurretsToUpdate = MoveTemp( DirtyTurrets );
+	TSet<TWeakObjectPtr<AActor>> ActorsToRerun = MoveTemp( DirtyConstructionScriptActors );
+	DirtyTurrets.Reset();
+	DirtyConstructionScriptActors.Reset();
+
+	for ( const TWeakObjectPtr<UTurretAimComponent>& WeakTurret : TurretsToUpdate )
+	{
+		if ( UTurretAimComponent* Turret = WeakTurret.Get() )
+		{
+			Turret->UpdateAim();
+		}
+	}
+
+	for ( const TWeakObjectPtr<AActor>& WeakActor : ActorsToRerun )
+	{
+		AActor* Actor = WeakActor.Get();
+		UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+		if ( World && World->WorldType == EWorldType::Editor )
+		{
+			Actor->RerunConstructionScripts();
+		}
+	}
+}
+
+bool FTurretEditorRefresher::IsTickable() const
+{
+	return DirtyTurrets.Num() > 0 || DirtyConstructionScriptActors.Num() > 0;
+}
+
+TStatId FTurretEditorRefresher::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( FTurretEditorRefresher, STATGROUP_Tickables );
+}
+
+#endif // WITH_EDITOR
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_EDITOR
+
+#include "Tickable.h"
+
+class AActor;
+class UTurretAimComponent;
+
+/**
+ * Keeps turrets aimed at their targets while things are being moved around in the editor.
+ *
+ * ForceExecuteConstructionScript reruns the whole construction script, which destroys and recreates every component on the turret.
+ * That's fine for a handful of turrets, but with a few hundred turrets watching one target, dragging the target becomes unusable.
+ *
+ * Instead, this tracks which UTurretAimComponents depend on which target Actors.  Moving a target (or a turret) only marks the
+ * affected turrets as dirty, and once per editor tick every dirty turret is re-aimed.  Only the AimJoint's rotation is recalculated
+ * and applied; nothing is recreated.
+ *
+ * Turrets without a UTurretAimComponent can still use RequestRefresh.  Those fall back to rerunning the construction script, but
+ * still at most once per editor tick, no matter how many times they're requested.
+ *
+ * The TurretRotationEditor module owns the refresher: it creates it in StartupModule, binds OnActorMoved to GEngine, and unbinds and
+ * destroys it again in ShutdownModule.  Nothing is left to static destruction.
+ */
+class TURRETROTATION_API FTurretEditorRefresher : public FTickableGameObject
+{
+public:
+	/** @return Returns the refresher owned by the TurretRotationEditor module, or nullptr if that module isn't loaded (e.g. in commandlets). */
+	static FTurretEditorRefresher* Get();
+
+	/**
+	 * Sets the refresher that Get returns.  Only the TurretRotationEditor module should call this.
+	 *
+	 * @param Refresher		The module's refresher, or nullptr once it's being destroyed.
+	 */
+	static void SetInstance( FTurretEditorRefresher* Refresher );
+
+	/** Starts tracking the given turret (and its TargetActor).  Call this again whenever the turret's TargetActor changes. */
+	void RegisterTurret( UTurretAimComponent* Turret );
+
+	/** Stops tracking the given turret. */
+	void UnregisterTurret( UTurretAimComponent* Turret );
+
+	/**
+	 * Asks for the given turret Actor to be re-aimed during the next editor tick.
+	 * Actors with UTurretAimComponents only have their aim updated.  Other Actors have their construction script rerun.
+	 *
+	 * @param TurretActor	The turret to refresh.
+	 */
+	void RequestRefresh( AActor* TurretActor );
+
+	/** Bound to GEngine->OnActorMoved by the TurretRotationEditor module. */
+	void OnActorMoved( AActor* MovedActor );
+
+	// FTickableGameObject interface
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableInEditor() const override { return true; }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Marks every turret that aims at (or belongs to) the given Actor as dirty. */
+	void MarkDependentsDirty( AActor* MovedActor );
+
+	/** Every tracked turret, keyed by the Actor it aims at. */
+	TMultiMap<TWeakObjectPtr<AActor>, TWeakObjectPtr<UTurretAimComponent>> TurretsByTarget;
+
+	/** The Actor that each tracked turret is currently registered under in TurretsByTarget. */
+	TMap<TWeakObjectPtr<UTurretAimComponent>, TWeakObjectPtr<AActor>> TargetByTurret;
+
+	/** Turrets that need their aim updated during the next tick. */
+	TSet<TWeakObjectPtr<UTurretAimComponent>> DirtyTurrets;
+
+	/** Turret Actors (without a UTurretAimComponent) that need their construction script rerun during the next tick. */
+	TSet<TWeakObjectPtr<AActor>> DirtyConstructionScriptActors;
+
+	/** The refresher that Get returns. */
+	static FTurretEditorRefresher* Instance;
+};
+
+#endif // WITH_EDITOR
@@ -0,0 +1,215 @@
+#include "TurretInstancedAimComponent.h"
+#include "TurretRotation.h"
+#include "GameFramework/Actor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+
+DECLARE_CYCLE_STAT( TEXT( "Instanced Turrets Update Aim" ), STAT_TurretInstanced_UpdateAim, STATGROUP_TurretRotation );
+DECLARE_CYCLE_STAT( TEXT( "Instanced Turrets Upload" ), STAT_TurretInstanced_Upload, STATGROUP_TurretRotation );
+
+namespace
+{
+	/** New turrets aim at a point this far in front of their AimJoint, until they're given a target. */
+	const float DefaultTargetDistance = 100000.0f;
+}
+
+UTurretInstancedAimComponent::UTurretInstancedAimComponent()
+	: BaseInstancesName( TEXT( "BaseInstances" ) )
+	, BarrelInstancesName( TEXT( "BarrelInstances" ) )
+	, Actor_To_AimJoint( FVector::ZeroVector )
+	, AimJoint_To_BarrelStart( FVector::ZeroVector )
+	, BarrelStart_To_BarrelEnd( FVector::ForwardVector )
+	, TargetActor( nullptr )
+	, BaseInstances( nullptr )
+	, BarrelInstances( nullptr )
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+
+	// Same as UTurretAimComponent: targets usually move during PrePhysics/DuringPhysics, so aim once they're done.
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UTurretInstancedAimComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	BaseInstances = FindInstances( BaseInstancesName );
+	BarrelInstances = FindInstances( BarrelInstancesName );
+}
+
+void UTurretInstancedAimComponent::TickComponent( float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction )
+{
+	Super::TickComponent( DeltaTime, TickType, ThisTickFunction );
+
+	UpdateAim();
+}
+
+int32 UTurretInstancedAimComponent::AddTurret( const FTransform& TurretWorldTransform )
+{
+	const int32 TurretIndex = TurretWorldTransforms.Add( TurretWorldTransform );
+	Geometries.Add( FTurretAimGeometry( Actor_To_AimJoint, AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, TurretWorldTransform.GetScale3D() ) );
+	AimJointRotations.Add( FRotator::ZeroRotator );
+
+	const FVector AimJointWorldLocation = TurretWorldTransform.TransformPosition( Actor_To_AimJoint );
+	TargetWorldLocations.Add( AimJointWorldLocation + ( TurretWorldTransform.GetRotation().GetForwardVector() * DefaultTargetDistance ) );
+
+	// The instances start out with no rotation, which matches AimJointRotations.  Composed the same way as UpdateInstances.
+	const FTransform AimJointWorldTransform( TurretWorldTransform.GetRotation(), AimJointWorldLocation, TurretWorldTransform.GetScale3D() );
+	for ( UInstancedStaticMeshComponent* Instances : { BaseInstances, BarrelInstances } )
+	{
+		if ( Instances )
+		{
+			const int32 InstanceIndex = Instances->AddInstanceWorldSpace( AimJointWorldTransform );
+			ensureMsgf( InstanceIndex == TurretIndex, TEXT( "%s should only have the instances added by %s." ), *Instances->GetName(), *GetName() );
+		}
+	}
+
+	return TurretIndex;
+}
+
+void UTurretInstancedAimComponent::ClearTurrets()
+{
+	TurretWorldTransforms.Reset();
+	Geometries.Reset();
+	TargetWorldLocations.Reset();
+	AimJointRotations.Reset();
+
+	for ( UInstancedStaticMeshComponent* Instances : { BaseInstances, BarrelInstances } )
+	{
+		if ( Instances )
+		{
+			Instances->ClearInstances();
+		}
+	}
+}
+
+void UTurretInstancedAimComponent::SetTurretTarget( int32 TurretIndex, const FVector& TargetWorldLocation )
+{
+	if ( TargetWorldLocations.IsValidIndex( TurretIndex ) )
+	{
+		TargetWorldLocations[TurretIndex] = TargetWorldLocation;
+	}
+}
+
+FRotator UTurretInstancedAimComponent::GetTurretAimRotation( int32 TurretIndex ) const
+{
+	return AimJointRotations.IsValidIndex( TurretIndex ) ? AimJointRotations[TurretIndex] : FRotator::ZeroRotator;
+}
+
+void UTurretInstancedAimComponent::UpdateAim()
+{
+	SCOPE_CYCLE_COUNTER( STAT_TurretInstanced_UpdateAim );
+	TURRETROTATION_TRACE_SCOPE( TurretInstanced_UpdateAim );
+
+	const int32 NumTurrets = TurretWorldTransforms.Num();
+	if ( NumTurrets == 0 )
+	{
+		return;
+	}
+
+	const bool bHasTargetActor = ( TargetActor != nullptr );
+	const FVector SharedTargetWorldLocation = bHasTargetActor ? TargetActor->GetActorLocation() : FVector::ZeroVector;
+
+	// Same as CalculateTurretRotations_ForActors, except that the geometry is already made, so only the target has to be moved into
+	// AimJoint space.
+	Scratch.Reset( NumTurrets );
+	for ( int32 Index = 0; Index < NumTurrets; ++Index )
+	{
+		const FTransform& TurretWorldTransform = TurretWorldTransforms[Index];
+		const FTurretAimGeometry& Geometry = Geometries[Index];
+
+		const FVector AimJointWorldLocation = TurretWorldTransform.TransformPosition( Geometry.GetActorToAimJoint() );
+		const FVector& TargetWorldLocation = bHasTargetActor ? SharedTargetWorldLocation : TargetWorldLocations[Index];
+		const FVector Target_InAimJointSpace = TurretWorldTransform.GetRotation().UnrotateVector( TargetWorldLocation - AimJointWorldLocation );
+
+		// The geometry's "X-Z" plane locations are already scaled by the turret's scale.
+		const FVector2D& BarrelStart2D = Geometry.GetCore().GetBarrelStartLocation2D();
+		const FVector2D& BarrelEnd2D = Geometry.GetCore().GetBarrelEndLocation2D();
+		Scratch.SetTurret( Index, FVector( BarrelStart2D.X, 0.0f, BarrelStart2D.Y ), FVector( BarrelEnd2D.X, 0.0f, BarrelEnd2D.Y ), Target_InAimJointSpace );
+	}
+
+	FTurretRotationBatchKernel::Solve( Scratch, FTurretAimGeometry::GetSolveSettings() );
+
+	SCOPE_CYCLE_COUNTER( STAT_TurretInstanced_Upload );
+
+	// Turrets that are still aiming at the same place (the solve is deterministic) keep their instances as they are.
+	bool bMovedAnyInstance = false;
+	for ( int32 Index = 0; Index < NumTurrets; ++Index )
+	{
+		const FRotator NewAimJointRotation = FRotator( Scratch.Pitch[Index], Scratch.Yaw[Index], 0.0f );
+		if ( NewAimJointRotation == AimJointRotations[Index] )
+		{
+			continue;
+		}
+
+		AimJointRotations[Index] = NewAimJointRotation;
+		UpdateInstances( Index, NewAimJointRotation );
+		bMovedAnyInstance = true;
+	}
+
+	// One render state update for every instance that moved, instead of one per instance.
+	if ( bMovedAnyInstance )
+	{
+		for ( UInstancedStaticMeshComponent* Instances : { BaseInstances, BarrelInstances } )
+		{
+			if ( Instances )
+			{
+				Instances->MarkRenderStateDirty();
+			}
+		}
+	}
+}
+
+void UTurretInstancedAimComponent::UpdateInstances( int32 TurretIndex, const FRotator& AimJointRotation )
+{
+	const FTransform& TurretWorldTransform = TurretWorldTransforms[TurretIndex];
+	const FQuat TurretWorldRotation = TurretWorldTransform.GetRotation();
+	const FVector AimJointWorldLocation = TurretWorldTransform.TransformPosition( Geometries[TurretIndex].GetActorToAimJoint() );
+
+	// Placed at the AimJoint, with the rotation and scale composed separately, so the turret's scale is applied along the instance's
+	// own axes (like FTurretAimGeometry does to the barrel), and never goes through the matrix path that FTransform::operator* takes for
+	// negative scales.
+	if ( BaseInstances )
+	{
+		const FTransform BaseWorldTransform( TurretWorldRotation * FRotator( 0.0f, AimJointRotation.Yaw, 0.0f ).Quaternion(), AimJointWorldLocation, TurretWorldTransform.GetScale3D() );
+		BaseInstances->UpdateInstanceTransform( TurretIndex, BaseWorldTransform, /*bWorldSpace*/ true, /*bMarkRenderStateDirty*/ false, /*bTeleport*/ true );
+	}
+
+	if ( BarrelInstances )
+	{
+		const FTransform BarrelWorldTransform( TurretWorldRotation * AimJointRotation.Quaternion(), AimJointWorldLocation, TurretWorldTransform.GetScale3D() );
+		BarrelInstances->UpdateInstanceTransform( TurretIndex, BarrelWorldTransform, /*bWorldSpace*/ true, /*bMarkRenderStateDirty*/ false, /*bTeleport*/ true );
+	}
+}
+
+UInstancedStaticMeshComponent* UTurretInstancedAimComponent::FindInstances( FName Name ) const
+{
+	AActor* Owner = GetOwner();
+	if ( !Owner || Name == NAME_None )
+	{
+		return nullptr;
+	}
+
+	TInlineComponentArray<UInstancedStaticMeshComponent*> InstancedComponents;
+	Owner->GetComponents( InstancedComponents );
+
+	for ( UInstancedStaticMeshComponent* InstancedComponent : InstancedComponents )
+	{
+		if ( InstancedComponent->GetFName() != Name )
+		{
+			continue;
+		}
+
+		if ( InstancedComponent->IsA<UHierarchicalInstancedStaticMeshComponent>() )
+		{
+			UE_LOG( LogTurretRotation, Warning, TEXT( "%s: %s is a hierarchical instanced mesh component, which would rebuild its cluster tree every time a turret turns.  Use an instanced mesh component instead." ), *GetName(), *Name.ToString() );
+			return nullptr;
+		}
+
+		return InstancedComponent;
+	}
+
+	return nullptr;
+}
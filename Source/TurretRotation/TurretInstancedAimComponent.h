@@ -0,0 +1,140 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TurretAimGeometry.h"
+#include "TurretRotationBatch.h"
+#include "TurretInstancedAimComponent.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ * Aims a lot of identical turrets that have no Actor (or components) of their own.
+ *
+ * Every turret is just an entry in a few compact arrays (its world transform, its FTurretAimGeometry, its target and its last aim),
+ * and is drawn as one instance in each of the owner's UInstancedStaticMeshComponents:
+ *	- BaseInstancesName: the part that only turns left/right (the yaw), like the turret's ring.
+ *	- BarrelInstancesName: the part that also tilts up/down (the full AimJoint rotation), like the barrel.
+ * Both meshes are expected to have their pivot at the AimJoint.  Either one can be left empty.
+ *
+ * Every tick, all of the turrets are moved into AimJoint space, solved by FTurretRotationBatchKernel, and the instances whose aim
+ * changed are moved in one pass, with a single render state update at the end.  Instance i of each mesh component belongs to turret i,
+ * so the mesh components shouldn't have any other instances.
+ *
+ * 4.17 has no per-instance custom data, so the aim is uploaded as instance transforms rather than as yaw/pitch for a material to read.
+ * That's also why UHierarchicalInstancedStaticMeshComponents aren't supported: in 4.17, moving one of their instances invalidates the
+ * whole cluster tree, so every turret that turns would rebuild it.  FindInstances ignores them.
+ *
+ * Each instance is scaled by its turret's scale along its own (aimed) axes, the same way FTurretAimGeometry scales the barrel, so with
+ * a non-uniform scale the drawn barrel still ends where the solve expects it to.  Negative scales aren't supported.
+ */
+UCLASS( ClassGroup=(Turret), meta=(BlueprintSpawnableComponent) )
+class TURRETROTATION_API UTurretInstancedAimComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTurretInstancedAimComponent();
+
+	/** Name of the owner's instanced mesh component that is turned by the yaw only. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FName BaseInstancesName;
+
+	/** Name of the owner's instanced mesh component that is turned by the full AimJoint rotation (yaw and pitch). */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FName BarrelInstancesName;
+
+	/** The vector from a turret's location to its AimJoint's location (when the turret is not Rotated/Scaled).  Shared by every turret. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FVector Actor_To_AimJoint;
+
+	/** The vector from the AimJoint to the BarrelStart (when the turret is not Rotated/Scaled).  Shared by every turret. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FVector AimJoint_To_BarrelStart;
+
+	/** The vector from the BarrelStart to the BarrelEnd (when the turret is not Rotated/Scaled).  Shared by every turret. */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = "Turret" )
+	FVector BarrelStart_To_BarrelEnd;
+
+	/** If set, every turret aims at this Actor.  Otherwise each turret aims at its own target (see SetTurretTarget). */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = "Turret" )
+	AActor* TargetActor;
+
+	/**
+	 * Adds a turret, along with its instances in the base/barrel mesh components.  The turret starts out aiming straight ahead.
+	 * Turrets don't move once they're added.  Changing the Actor_To_AimJoint/AimJoint_To_BarrelStart/BarrelStart_To_BarrelEnd only
+	 * affects turrets added afterwards.
+	 *
+	 * @param TurretWorldTransform	The turret's world transform (what would be the turret Actor's transform).
+	 * @return Returns the index of the new turret.
+	 */
+	UFUNCTION( BlueprintCallable, Category = "Turret" )
+	int32 AddTurret( const FTransform& TurretWorldTransform );
+
+	/** Removes every turret, along with every instance in the base/barrel mesh components. */
+	UFUNCTION( BlueprintCallable, Category = "Turret" )
+	void ClearTurrets();
+
+	/**
+	 * Sets where a turret aims when there is no TargetActor.
+	 *
+	 * @param TurretIndex			Index of the turret (from AddTurret).
+	 * @param TargetWorldLocation	The location (in world space) to aim at.
+	 */
+	UFUNCTION( BlueprintCallable, Category = "Turret" )
+	void SetTurretTarget( int32 TurretIndex, const FVector& TargetWorldLocation );
+
+	/** @return Returns the number of turrets. */
+	UFUNCTION( BlueprintPure, Category = "Turret" )
+	int32 GetNumTurrets() const { return TurretWorldTransforms.Num(); }
+
+	/**
+	 * @param TurretIndex	Index of the turret (from AddTurret).
+	 * @return Returns the last rotation of the turret's AimJoint (relative to the turret).
+	 */
+	UFUNCTION( BlueprintPure, Category = "Turret" )
+	FRotator GetTurretAimRotation( int32 TurretIndex ) const;
+
+	/** Solves every turret for its current target and moves the instances right away, instead of waiting for the next tick. */
+	UFUNCTION( BlueprintCallable, Category = "Turret" )
+	void UpdateAim();
+
+	// UActorComponent interface
+	virtual void OnRegister() override;
+	virtual void TickComponent( float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
+
+protected:
+	/**
+	 * Finds an instanced mesh component on the owner.
+	 *
+	 * @param Name	Name of the component.
+	 * @return Returns the component, or nullptr if Name is None or the owner has no instanced mesh component with that name.  Hierarchical
+	 *		   instanced mesh components are never returned.
+	 */
+	UInstancedStaticMeshComponent* FindInstances( FName Name ) const;
+
+	/**
+	 * Moves the base/barrel instances of one turret.  The render state isn't updated (see UpdateAim).
+	 *
+	 * @param TurretIndex		Index of the turret.
+	 * @param AimJointRotation	The rotation of the turret's AimJoint (relative to the turret).
+	 */
+	void UpdateInstances( int32 TurretIndex, const FRotator& AimJointRotation );
+
+	/** The instances turned by the yaw. */
+	UPROPERTY( Transient )
+	UInstancedStaticMeshComponent* BaseInstances;
+
+	/** The instances turned by the yaw and pitch. */
+	UPROPERTY( Transient )
+	UInstancedStaticMeshComponent* BarrelInstances;
+
+	/** Per turret data.  Element i of each array belongs to turret i. */
+	TArray<FTransform> TurretWorldTransforms;
+	TArray<FTurretAimGeometry> Geometries;
+	TArray<FVector> TargetWorldLocations;
+	TArray<FRotator> AimJointRotations;
+
+	/** Kept around so solving doesn't allocate every tick. */
+	FTurretRotationBatchScratch Scratch;
+};
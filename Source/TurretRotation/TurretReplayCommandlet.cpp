@@ -0,0 +1,46 @@
+#include "TurretReplayCommandlet.h"
+#include "TurretAimCapture.h"
+#include "TurretRotation.h"
+
+
+UTurretReplayCommandlet::UTurretReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UTurretReplayCommandlet::Main( const FString& Params )
+{
+	FString Filename;
+	FParse::Value( *Params, TEXT( "File=" ), Filename );
+
+	float MaxDeviationDegrees = 0.01f;
+	FParse::Value( *Params, TEXT( "MaxDeviation=" ), MaxDeviationDegrees );
+
+	if ( FParse::Param( *Params, TEXT( "Synthetic" ) ) )
+	{
+		int32 NumTurrets = 2000;
+		int32 NumFrames = 600;
+		FParse::Value( *Params, TEXT( "Turrets=" ), NumTurrets );
+		FParse::Value( *Params, TEXT( "Frames=" ), NumFrames );
+
+		if ( Filename.IsEmpty() )
+		{
+			Filename = FTurretCaptureReplay::GetDefaultFilename( TEXT( "Synthetic" ) );
+		}
+
+		if ( !FTurretCaptureReplay::WriteSyntheticCapture( Filename, FMath::Max( 1, NumTurrets ), FMath::Max( 1, NumFrames ) ) )
+		{
+			return 1;
+		}
+	}
+	else if ( Filename.IsEmpty() )
+	{
+		UE_LOG( LogTurretRotation, Error, TEXT( "Usage: -run=TurretReplay -File=<capture> [-MaxDeviation=0.01], or -run=TurretReplay -Synthetic [-File=<capture>] [-Turrets=2000] [-Frames=600]" ) );
+		return 1;
+	}
+
+	return FTurretCaptureReplay::RunAndLog( Filename, MaxDeviationDegrees ) ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TurretReplayCommandlet.generated.h"
+
+/**
+ * Replays a turret capture headless (see TurretAimCapture.h), so the solver can be measured on build machines and Linux servers without
+ * a GPU or a level:
+ *
+ *   UE4Editor-Cmd TurretRotation.uproject -run=TurretReplay -File=<capture> [-MaxDeviation=0.01] -nullrhi
+ *   UE4Editor-Cmd TurretRotation.uproject -run=TurretReplay -Synthetic [-Turrets=2000] [-Frames=600] -nullrhi
+ *
+ * -Synthetic writes a made up capture first (see FTurretCaptureReplay::WriteSyntheticCapture), to -File if given.
+ * Returns 0 if every replayed solve is within MaxDeviation degrees of the capture.
+ */
+UCLASS()
+class UTurretReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTurretReplayCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main( const FString& Params ) override;
+};
@@ -1,4 +1,11 @@
-#include "TurretRotation.h"
-#include "Modules/ModuleManager.h"
-
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, TurretRotation, "TurretRotation" );
+#include "TurretRotation.h"
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, TurretRotation, "TurretRotation" );
+
+DEFINE_LOG_CATEGORY( LogTurretRotation );
+
+DEFINE_STAT( STAT_TurretRotation_Solves );
+DEFINE_STAT( STAT_TurretRotation_TargetClamps );
+DEFINE_STAT( STAT_TurretRotation_FailedRoots );
+DEFINE_STAT( STAT_TurretRotation_BothDistancesNegative );
@@ -1,4 +1,99 @@
-#pragma once
-
-#include "CoreMinimal.h"
-
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TurretRotationCore.h"
+
+DECLARE_LOG_CATEGORY_EXTERN( LogTurretRotation, Log, All );
+
+DECLARE_STATS_GROUP( TEXT( "TurretRotation" ), STATGROUP_TurretRotation, STATCAT_Advanced );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN( TEXT( "Solves" ), STAT_TurretRotation_Solves, STATGROUP_TurretRotation, TURRETROTATION_API );
+DECLARE_DWORD_COUNTER_STAT_EXTERN( TEXT( "Target Clamps" ), STAT_TurretRotation_TargetClamps, STATGROUP_TurretRotation, TURRETROTATION_API );
+DECLARE_DWORD_COUNTER_STAT_EXTERN( TEXT( "Failed Roots" ), STAT_TurretRotation_FailedRoots, STATGROUP_TurretRotation, TURRETROTATION_API );
+DECLARE_DWORD_COUNTER_STAT_EXTERN( TEXT( "Both Distances Negative" ), STAT_TurretRotation_BothDistancesNegative, STATGROUP_TurretRotation, TURRETROTATION_API );
+
+/**
+ * A CPU scope for Unreal Insights, on engine versions that have it, or a named event for external profilers on versions that only
+ * have those.  Compiles to nothing in shipping builds.
+ */
+#if !UE_BUILD_SHIPPING && defined( TRACE_CPUPROFILER_EVENT_SCOPE )
+	#define TURRETROTATION_TRACE_SCOPE( Name ) TRACE_CPUPROFILER_EVENT_SCOPE( Name )
+#elif !UE_BUILD_SHIPPING && defined( SCOPED_NAMED_EVENT )
+	#define TURRETROTATION_TRACE_SCOPE( Name ) SCOPED_NAMED_EVENT( Name, FColor::Orange )
+#else
+	#define TURRETROTATION_TRACE_SCOPE( Name )
+#endif
+
+/**
+ * Counts solves and the edge cases they ran into (see TurretRotationCore::EAimSolveEvent), and adds them to the STATGROUP_TurretRotation
+ * counters when it goes out of scope, so a batch of solves only touches the stats once.
+ *
+ *		FTurretSolveStats SolveStats;
+ *		Core.Solve( Target_InAimJointSpace, Accuracy, SolveStats.GetEvents() );
+ *		SolveStats.AddSolve();
+ *
+ * FTurretAimGeometry's solves (and the C++ versions of the UTurretRotationFunctionLibrary solves) take one to count themselves in, so
+ * batch callers make one per batch (or per ParallelFor chunk) and hand it to every solve.
+ *
+ * Without STATS (so in shipping builds), GetEvents returns nullptr and everything else is empty.
+ */
+class FTurretSolveStats
+{
+public:
+#if STATS
+	FTurretSolveStats()
+		: Events( TurretRotationCore::EAimSolveEvent::None )
+		, NumSolves( 0 )
+		, NumTargetClamps( 0 )
+		, NumFailedRoots( 0 )
+		, NumBothDistancesNegative( 0 )
+	{
+	}
+
+	~FTurretSolveStats()
+	{
+		INC_DWORD_STAT_BY( STAT_TurretRotation_Solves, NumSolves );
+
+		// The edge cases are rare, so don't send stat messages for them unless they happened.
+		if ( NumTargetClamps | NumFailedRoots | NumBothDistancesNegative )
+		{
+			INC_DWORD_STAT_BY( STAT_TurretRotation_TargetClamps, NumTargetClamps );
+			INC_DWORD_STAT_BY( STAT_TurretRotation_FailedRoots, NumFailedRoots );
+			INC_DWORD_STAT_BY( STAT_TurretRotation_BothDistancesNegative, NumBothDistancesNegative );
+		}
+	}
+
+	/** @return Returns where the next solve should add its events. */
+	uint32* GetEvents() { return &Events; }
+
+	/** Counts a solve, with the events it added to GetEvents. */
+	void AddSolve()
+	{
+		AddSolves( 1,
+			( Events & TurretRotationCore::EAimSolveEvent::TargetClamped ) ? 1 : 0,
+			( Events & TurretRotationCore::EAimSolveEvent::NoRoots ) ? 1 : 0,
+			( Events & TurretRotationCore::EAimSolveEvent::BothDistancesNegative ) ? 1 : 0 );
+		Events = TurretRotationCore::EAimSolveEvent::None;
+	}
+
+	/** Counts solves whose edge cases were counted some other way (by FTurretRotationBatchKernel, for example). */
+	void AddSolves( uint32 InNumSolves, uint32 InNumTargetClamps, uint32 InNumFailedRoots, uint32 InNumBothDistancesNegative )
+	{
+		NumSolves += InNumSolves;
+		NumTargetClamps += InNumTargetClamps;
+		NumFailedRoots += InNumFailedRoots;
+		NumBothDistancesNegative += InNumBothDistancesNegative;
+	}
+
+private:
+	uint32 Events;
+	uint32 NumSolves;
+	uint32 NumTargetClamps;
+	uint32 NumFailedRoots;
+	uint32 NumBothDistancesNegative;
+#else
+	uint32* GetEvents() { return nullptr; }
+	void AddSolve() {}
+	void AddSolves( uint32, uint32, uint32, uint32 ) {}
+#endif
+};
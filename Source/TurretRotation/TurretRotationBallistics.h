@@ -0,0 +1,307 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+
+/**
+ * Lead aiming for turrets that fire projectiles under gravity at moving targets, without any engine dependencies.
+ *
+ * The solve alternates between two steps:
+ *   1. Given where the muzzle is, find the launch direction that hits the target's predicted location after the current flight time
+ *      (the classic "angle of reach" equation, with the choice of the low or the high arc).
+ *   2. Aim the offset barrel along that launch direction (TAimGeometry::Solve), which moves the muzzle, and find the new flight time.
+ *
+ * Each iteration costs one TAimGeometry::Solve plus a handful of square roots and one Sin/Cos pair, and the number of iterations is
+ * capped, so the worst case cost of a solve is known up front.
+ *
+ * Everything is in AimJoint space (relative to the unrotated AimJoint), same as TAimGeometry::Solve.
+ */
+namespace TurretRotationCore
+{
+	// 3D vector helpers, only needed by the ballistics.
+
+	template<typename ScalarType>
+	inline TVector3<ScalarType> Add3D( const TVector3<ScalarType>& A, const TVector3<ScalarType>& B ) { return TVector3<ScalarType>( A.X + B.X, A.Y + B.Y, A.Z + B.Z ); }
+
+	template<typename ScalarType>
+	inline TVector3<ScalarType> Subtract3D( const TVector3<ScalarType>& A, const TVector3<ScalarType>& B ) { return TVector3<ScalarType>( A.X - B.X, A.Y - B.Y, A.Z - B.Z ); }
+
+	template<typename ScalarType>
+	inline TVector3<ScalarType> Scale3D( const TVector3<ScalarType>& A, ScalarType Scale ) { return TVector3<ScalarType>( A.X * Scale, A.Y * Scale, A.Z * Scale ); }
+
+	template<typename ScalarType>
+	inline ScalarType Dot3D( const TVector3<ScalarType>& A, const TVector3<ScalarType>& B ) { return ( A.X * B.X ) + ( A.Y * B.Y ) + ( A.Z * B.Z ); }
+
+	template<typename ScalarType>
+	inline ScalarType Size3D( const TVector3<ScalarType>& A ) { return std::sqrt( Dot3D( A, A ) ); }
+
+	/** Everything about the projectile, and how hard to try. */
+	template<typename ScalarType>
+	struct TBallisticSettings
+	{
+		/** Speed of the projectile when it leaves the muzzle. */
+		ScalarType MuzzleSpeed;
+
+		/** Gravity's acceleration, in AimJoint space (so (0, 0, -980) for an unrotated turret with the engine's default gravity). */
+		TVector3<ScalarType> Gravity;
+
+		/** If true, then the high arc (mortar-like) is used instead of the low arc (the faster, flatter one). */
+		bool bHighArc;
+
+		/** Upper limit on the number of iterations.  Each one costs about as much as a regular solve. */
+		int MaxIterations;
+
+		/** The solve stops early once the flight time is known to within this many seconds. */
+		ScalarType TimeTolerance;
+
+		/** How accurately to do the trig in each iteration's TAimGeometry::Solve. */
+		EAimAccuracy Accuracy;
+
+		TBallisticSettings()
+			: MuzzleSpeed( 0 )
+			, Gravity( 0, 0, 0 )
+			, bHighArc( false )
+			, MaxIterations( 6 )
+			, TimeTolerance( ScalarType( 0.001 ) )
+			, Accuracy( EAimAccuracy::Exact )
+		{
+		}
+	};
+
+	/** The result of SolveBallistic. */
+	template<typename ScalarType>
+	struct TBallisticSolution
+	{
+		/** Yaw/Pitch for the AimJoint. */
+		TAimAngles<ScalarType> Angles;
+
+		/** Where the target is predicted to be when the projectile arrives (AimJoint space). */
+		TVector3<ScalarType> ImpactLocation;
+
+		/** Where the muzzle (BarrelEnd) ends up once the AimJoint is rotated by Angles (AimJoint space). */
+		TVector3<ScalarType> MuzzleLocation;
+
+		/** How long the projectile takes to reach ImpactLocation, in seconds. */
+		ScalarType TimeOfFlight;
+
+		/** How many iterations were used. */
+		int NumIterations;
+
+		/**
+		 * False if the projectile can't reach the target (it's too far for the MuzzleSpeed), the settings are invalid, or the solve didn't
+		 * converge within MaxIterations.  If the target is out of range, then Angles aim straight at the target's predicted location, so
+		 * the turret still tracks it.  If the solve didn't converge, then Angles are from the last iteration.
+		 *
+		 * Not converging is rare, and mostly happens with high arcs that end up close to vertical.  There, a small change in the muzzle's
+		 * location swings the yaw a lot, so the muzzle (and the flight time) keep moving around.
+		 */
+		bool bHasSolution;
+	};
+
+	/**
+	 * Finds the launch direction for a projectile to travel the given displacement.
+	 *
+	 * With "x" as the horizontal distance and "y" as the vertical distance (both relative to gravity), the launch angle is:
+	 *   tan(Angle) = ( s^2 -/+ sqrt( s^4 - g*( g*x^2 + 2*y*s^2 ) ) ) / ( g*x )
+	 * where "-" is the low arc and "+" is the high arc.  See https://en.wikipedia.org/wiki/Projectile_motion#Angle_%CE%B8_required_to_hit_coordinate_(x,_y)
+	 *
+	 * @param Displacement			Vector from the muzzle to where the projectile should land.
+	 * @param Settings				Muzzle speed, gravity, and which arc to use.
+	 * @param Out_LaunchDirection	OUT - Normalized launch direction.
+	 * @param Out_TimeOfFlight		OUT - How long the projectile takes to travel the Displacement.
+	 * @return Returns true if the projectile can travel the Displacement, otherwise false (it's out of range).
+	 */
+	template<typename ScalarType>
+	inline bool CalculateBallisticLaunch( const TVector3<ScalarType>& Displacement, const TBallisticSettings<ScalarType>& Settings, TVector3<ScalarType>& Out_LaunchDirection, ScalarType& Out_TimeOfFlight )
+	{
+		const ScalarType SmallNumber = TConstants<ScalarType>::SmallNumber();
+		const ScalarType Speed = Settings.MuzzleSpeed;
+		const ScalarType Distance = Size3D( Displacement );
+		if ( Speed <= SmallNumber || Distance <= SmallNumber )
+		{
+			return false;
+		}
+
+		const ScalarType GravitySize = Size3D( Settings.Gravity );
+		if ( GravitySize <= SmallNumber )
+		{
+			// No gravity means the projectile just flies straight.
+			Out_LaunchDirection = Scale3D( Displacement, ScalarType( 1 ) / Distance );
+			Out_TimeOfFlight = Distance / Speed;
+			return true;
+		}
+
+		// Split the displacement into the part along "up" (against gravity) and the horizontal part.
+		const TVector3<ScalarType> Up = Scale3D( Settings.Gravity, ScalarType( -1 ) / GravitySize );
+		const ScalarType y = Dot3D( Displacement, Up );
+		const TVector3<ScalarType> Horizontal = Subtract3D( Displacement, Scale3D( Up, y ) );
+		const ScalarType x = Size3D( Horizontal );
+
+		const ScalarType g = GravitySize;
+		const ScalarType SpeedSquared = Speed * Speed;
+
+		if ( x <= SmallNumber * Distance )
+		{
+			// Straight up or straight down.  Going up, the low arc reaches the target on the way up, and the high arc on the way down.
+			const ScalarType Radicand = SpeedSquared - ( 2 * g * y );
+			if ( Radicand < 0 )
+			{
+				return false;
+			}
+
+			const ScalarType Radical = std::sqrt( Radicand );
+			Out_LaunchDirection = y >= 0 ? Up : Scale3D( Up, ScalarType( -1 ) );
+			Out_TimeOfFlight = y >= 0
+				? ( ( Settings.bHighArc ? ( Speed + Radical ) : ( Speed - Radical ) ) / g )
+				: ( ( Radical - Speed ) / g );
+			return true;
+		}
+
+		const ScalarType Radicand = ( SpeedSquared * SpeedSquared ) - ( g * ( ( g * x * x ) + ( 2 * y * SpeedSquared ) ) );
+		if ( Radicand < 0 )
+		{
+			return false;
+		}
+
+		const ScalarType Radical = std::sqrt( Radicand );
+		const ScalarType TanAngle = ( Settings.bHighArc ? ( SpeedSquared + Radical ) : ( SpeedSquared - Radical ) ) / ( g * x );
+
+		// cos = 1 / sqrt( 1 + tan^2 ), and sin = tan * cos, so no trig is needed.
+		const ScalarType CosAngle = ScalarType( 1 ) / std::sqrt( ScalarType( 1 ) + ( TanAngle * TanAngle ) );
+		const ScalarType SinAngle = TanAngle * CosAngle;
+
+		Out_LaunchDirection = Add3D( Scale3D( Horizontal, CosAngle / x ), Scale3D( Up, SinAngle ) );
+		Out_TimeOfFlight = x / ( Speed * CosAngle );
+		return true;
+	}
+
+	/**
+	 * Calculates where the muzzle (BarrelEnd) is once the AimJoint is rotated by the given angles.
+	 *
+	 * @param Geometry	The turret.  The AimJoint is expected to be at the origin (see TAimGeometry::MakeFromActorVectors).
+	 * @param Angles	Yaw/Pitch of the AimJoint.
+	 * @return Returns the muzzle's location in AimJoint space.
+	 */
+	template<typename ScalarType, typename Vector2Type>
+	inline TVector3<ScalarType> CalculateMuzzleLocation( const TAimGeometry<ScalarType, Vector2Type>& Geometry, const TAimAngles<ScalarType>& Angles )
+	{
+		const ScalarType DegreesToRadians = ScalarType( 1 ) / TConstants<ScalarType>::RadiansToDegrees();
+		const ScalarType PitchRadians = Angles.Pitch * DegreesToRadians;
+		const ScalarType YawRadians = Angles.Yaw * DegreesToRadians;
+
+		// The BarrelEnd sits on the "X-Z" plane, so pitch rotates it on that plane, and then yaw swings it around "Z".
+		const Vector2Type& BarrelEnd2D = Geometry.GetBarrelEndLocation2D();
+		const ScalarType SinPitch = std::sin( PitchRadians );
+		const ScalarType CosPitch = std::cos( PitchRadians );
+		const ScalarType PitchedX = ( ScalarType( BarrelEnd2D.X ) * CosPitch ) - ( ScalarType( BarrelEnd2D.Y ) * SinPitch );
+		const ScalarType PitchedZ = ( ScalarType( BarrelEnd2D.X ) * SinPitch ) + ( ScalarType( BarrelEnd2D.Y ) * CosPitch );
+
+		return TVector3<ScalarType>( PitchedX * std::cos( YawRadians ), PitchedX * std::sin( YawRadians ), PitchedZ );
+	}
+
+	/**
+	 * Calculates the yaw/pitch for the AimJoint so a projectile fired from the muzzle hits a moving target.
+	 *
+	 * @param Geometry				The turret.  The AimJoint is expected to be at the origin (see TAimGeometry::MakeFromActorVectors).
+	 * @param TargetLocation		The target's current location, in AimJoint space.
+	 * @param TargetVelocity		The target's velocity, in AimJoint space.
+	 * @param TargetAcceleration	The target's acceleration, in AimJoint space.  Zero if unknown.
+	 * @param Settings				Muzzle speed, gravity, which arc to use, and the iteration cap.
+	 * @param Out_Events			OUT (optional) - The edge cases that any of the iterations ran into (see EAimSolveEvent) are added to this.
+	 * @return Returns the solution.  See TBallisticSolution::bHasSolution for what happens when there is no solution.
+	 */
+	template<typename ScalarType, typename Vector2Type, typename Vector3Type>
+	inline TBallisticSolution<ScalarType> SolveBallistic(
+		const TAimGeometry<ScalarType, Vector2Type>& Geometry,
+		const Vector3Type& TargetLocation,
+		const Vector3Type& TargetVelocity,
+		const Vector3Type& TargetAcceleration,
+		const TBallisticSettings<ScalarType>& Settings,
+		unsigned int* Out_Events = nullptr )
+	{
+		typedef TVector3<ScalarType> FVector3;
+
+		const FVector3 P = FVector3( ScalarType( TargetLocation.X ), ScalarType( TargetLocation.Y ), ScalarType( TargetLocation.Z ) );
+		const FVector3 V = FVector3( ScalarType( TargetVelocity.X ), ScalarType( TargetVelocity.Y ), ScalarType( TargetVelocity.Z ) );
+		const FVector3 HalfA = FVector3( ScalarType( TargetAcceleration.X ) / 2, ScalarType( TargetAcceleration.Y ) / 2, ScalarType( TargetAcceleration.Z ) / 2 );
+
+		TBallisticSolution<ScalarType> Result;
+		Result.NumIterations = 0;
+		Result.bHasSolution = false;
+
+		// Start by aiming straight at the target, which gives a first guess for the muzzle location and the flight time.
+		Result.Angles = Geometry.Solve( P, Settings.Accuracy, Out_Events );
+		Result.MuzzleLocation = CalculateMuzzleLocation( Geometry, Result.Angles );
+		Result.ImpactLocation = P;
+		Result.TimeOfFlight = Settings.MuzzleSpeed > TConstants<ScalarType>::SmallNumber()
+			? Size3D( Subtract3D( P, Result.MuzzleLocation ) ) / Settings.MuzzleSpeed
+			: ScalarType( 0 );
+
+		// The flight time is found with the secant method on f(t) = FlightTimeToPredictedLocation(t) - t.  Plain fixed-point iteration
+		// (just using the new flight time as the next guess) converges slowly for the high arc, since its long flight times give the
+		// target more time to move.
+		ScalarType PreviousGuess = 0;
+		ScalarType PreviousError = 0;
+		bool bHasPreviousGuess = false;
+
+		const int MaxIterations = std::max( 1, Settings.MaxIterations );
+		for ( int Iteration = 0; Iteration < MaxIterations; ++Iteration )
+		{
+			Result.NumIterations = Iteration + 1;
+
+			// Where the target will be once the projectile gets there.
+			const ScalarType t = Result.TimeOfFlight;
+			const FVector3 PredictedLocation = Add3D( P, Add3D( Scale3D( V, t ), Scale3D( HalfA, t * t ) ) );
+			const FVector3 Muzzle_To_Predicted = Subtract3D( PredictedLocation, Result.MuzzleLocation );
+
+			FVector3 LaunchDirection;
+			ScalarType NewTimeOfFlight = 0;
+			if ( !CalculateBallisticLaunch( Muzzle_To_Predicted, Settings, /*out*/ LaunchDirection, /*out*/ NewTimeOfFlight ) )
+			{
+				// Out of range.  Keep tracking the predicted location so the turret doesn't just freeze.
+				Result.Angles = Geometry.Solve( PredictedLocation, Settings.Accuracy, Out_Events );
+				Result.MuzzleLocation = CalculateMuzzleLocation( Geometry, Result.Angles );
+				Result.ImpactLocation = PredictedLocation;
+				Result.bHasSolution = false;
+				return Result;
+			}
+
+			// Aim the barrel's line through a point along the launch direction.  Once the AimJoint rotates, the muzzle moves a little, which
+			// tilts the barrel away from the launch direction by about (muzzle movement / distance to the point).  So the point is placed as
+			// far away as the projectile travels (which is never closer than the target), and that error stays tiny.
+			const ScalarType AimPointDistance = std::max( Size3D( Muzzle_To_Predicted ), Settings.MuzzleSpeed * NewTimeOfFlight ) + Size3D( Result.MuzzleLocation );
+			const FVector3 AimPoint = Add3D( Result.MuzzleLocation, Scale3D( LaunchDirection, AimPointDistance ) );
+
+			const FVector3 PreviousMuzzleLocation = Result.MuzzleLocation;
+			Result.Angles = Geometry.Solve( AimPoint, Settings.Accuracy, Out_Events );
+			Result.MuzzleLocation = CalculateMuzzleLocation( Geometry, Result.Angles );
+
+			// The barrel only points exactly along the launch direction if the muzzle didn't move, so that has to settle down too.
+			// "Settled" for the muzzle means it moved less than the projectile travels in TimeTolerance.
+			const ScalarType Error = NewTimeOfFlight - t;
+			const ScalarType MuzzleMovement = Size3D( Subtract3D( Result.MuzzleLocation, PreviousMuzzleLocation ) );
+			if ( std::abs( Error ) <= Settings.TimeTolerance && MuzzleMovement <= Settings.MuzzleSpeed * Settings.TimeTolerance )
+			{
+				Result.bHasSolution = true;
+				break;
+			}
+
+			ScalarType NextGuess = NewTimeOfFlight;
+			const ScalarType ErrorDelta = Error - PreviousError;
+			if ( bHasPreviousGuess && std::abs( ErrorDelta ) > TConstants<ScalarType>::SmallNumber() )
+			{
+				NextGuess = t - ( Error * ( t - PreviousGuess ) / ErrorDelta );
+			}
+
+			PreviousGuess = t;
+			PreviousError = Error;
+			bHasPreviousGuess = true;
+
+			// A bad secant step can overshoot to a negative time, which is never right.
+			Result.TimeOfFlight = NextGuess > 0 ? NextGuess : NewTimeOfFlight;
+		}
+
+		const ScalarType t = Result.TimeOfFlight;
+		Result.ImpactLocation = Add3D( P, Add3D( Scale3D( V, t ), Scale3D( HalfA, t * t ) ) );
+		return Result;
+	}
+}
@@ -0,0 +1,92 @@
+#include "TurretRotationBatch.h"
+#include "TurretAimGeometry.h"
+#include "TurretRotation.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Batch Kernel Solve" ), STAT_TurretRotation_BatchSolve, STATGROUP_TurretRotation );
+
+namespace
+{
+	/** The lanes type for TurretRotationCore::SolveAimBatch, on VectorRegister (SSE on x64, NEON on ARM). */
+	struct FVectorRegisterLanes
+	{
+		typedef VectorRegister RegisterType;
+
+		static FORCEINLINE VectorRegister Load( const float* Values )												{ return VectorLoadAligned( Values ); }
+		static FORCEINLINE void Store( const VectorRegister& Value, float* Out_Values )								{ VectorStoreAligned( Value, Out_Values ); }
+		static FORCEINLINE VectorRegister Set( float Value )															{ return VectorSetFloat1( Value ); }
+		static FORCEINLINE VectorRegister Add( const VectorRegister& A, const VectorRegister& B )						{ return VectorAdd( A, B ); }
+		static FORCEINLINE VectorRegister Subtract( const VectorRegister& A, const VectorRegister& B )				{ return VectorSubtract( A, B ); }
+		static FORCEINLINE VectorRegister Multiply( const VectorRegister& A, const VectorRegister& B )				{ return VectorMultiply( A, B ); }
+		static FORCEINLINE VectorRegister MultiplyAdd( const VectorRegister& A, const VectorRegister& B, const VectorRegister& C ) { return VectorMultiplyAdd( A, B, C ); }
+		static FORCEINLINE VectorRegister Min( const VectorRegister& A, const VectorRegister& B )						{ return VectorMin( A, B ); }
+		static FORCEINLINE VectorRegister Max( const VectorRegister& A, const VectorRegister& B )						{ return VectorMax( A, B ); }
+		static FORCEINLINE VectorRegister Negate( const VectorRegister& A )											{ return VectorNegate( A ); }
+		static FORCEINLINE VectorRegister Abs( const VectorRegister& A )												{ return VectorAbs( A ); }
+		static FORCEINLINE VectorRegister ReciprocalSqrt( const VectorRegister& A )									{ return VectorReciprocalSqrtAccurate( A ); }
+		static FORCEINLINE VectorRegister Reciprocal( const VectorRegister& A )										{ return VectorReciprocalAccurate( A ); }
+		static FORCEINLINE VectorRegister CompareGT( const VectorRegister& A, const VectorRegister& B )				{ return VectorCompareGT( A, B ); }
+		static FORCEINLINE VectorRegister CompareGE( const VectorRegister& A, const VectorRegister& B )				{ return VectorCompareGE( A, B ); }
+		static FORCEINLINE VectorRegister Select( const VectorRegister& Mask, const VectorRegister& A, const VectorRegister& B ) { return VectorSelect( Mask, A, B ); }
+		static FORCEINLINE VectorRegister And( const VectorRegister& MaskA, const VectorRegister& MaskB )			{ return VectorBitwiseAnd( MaskA, MaskB ); }
+		static FORCEINLINE uint32 MaskBits( const VectorRegister& Mask )												{ return static_cast<uint32>( VectorMaskBits( Mask ) ); }
+	};
+}
+
+void FTurretRotationBatchScratch::Reset( int32 InNumTurrets )
+{
+	NumTurrets = InNumTurrets;
+	const int32 NumPadded = Align( InNumTurrets, TURRET_BATCH_WIDTH );
+
+	FAlignedFloatArray* AllArrays[] = { &TargetX, &TargetY, &TargetZ, &BarrelStartX, &BarrelStartZ, &BarrelEndX, &BarrelEndZ, &Yaw, &Pitch };
+	for ( FAlignedFloatArray* Array : AllArrays )
+	{
+		Array->SetNumUninitialized( NumPadded, /*bAllowShrinking*/ false );
+	}
+
+	// A turret with its barrel pointing straight down the X axis, and a target sitting right in front of it.
+	for ( int32 Index = InNumTurrets; Index < NumPadded; ++Index )
+	{
+		SetTurret( Index, FVector::ZeroVector, FVector::ForwardVector, FVector::ForwardVector );
+	}
+}
+
+void FTurretRotationBatchScratch::SetTurret( int32 Index, const FVector& BarrelStart_InAimJointSpace, const FVector& BarrelEnd_InAimJointSpace, const FVector& Target_InAimJointSpace )
+{
+	TargetX[Index] = Target_InAimJointSpace.X;
+	TargetY[Index] = Target_InAimJointSpace.Y;
+	TargetZ[Index] = Target_InAimJointSpace.Z;
+
+	BarrelStartX[Index] = BarrelStart_InAimJointSpace.X;
+	BarrelStartZ[Index] = BarrelStart_InAimJointSpace.Z;
+	BarrelEndX[Index] = BarrelEnd_InAimJointSpace.X;
+	BarrelEndZ[Index] = BarrelEnd_InAimJointSpace.Z;
+}
+
+void FTurretRotationBatchKernel::Solve( FTurretRotationBatchScratch& Scratch, const FTurretSolveSettings& SolveSettings )
+{
+	SCOPE_CYCLE_COUNTER( STAT_TurretRotation_BatchSolve );
+	TURRETROTATION_TRACE_SCOPE( TurretBatchKernel_Solve );
+
+	TurretRotationCore::FAimBatch Batch;
+	Batch.TargetX = Scratch.TargetX.GetData();
+	Batch.TargetY = Scratch.TargetY.GetData();
+	Batch.TargetZ = Scratch.TargetZ.GetData();
+	Batch.BarrelStartX = Scratch.BarrelStartX.GetData();
+	Batch.BarrelStartZ = Scratch.BarrelStartZ.GetData();
+	Batch.BarrelEndX = Scratch.BarrelEndX.GetData();
+	Batch.BarrelEndZ = Scratch.BarrelEndZ.GetData();
+	Batch.Yaw = Scratch.Yaw.GetData();
+	Batch.Pitch = Scratch.Pitch.GetData();
+	Batch.NumTurrets = Scratch.NumTurrets;
+	Batch.NumPadded = Scratch.Yaw.Num();
+
+#if STATS
+	TurretRotationCore::FAimBatchEvents Events;
+	TurretRotationCore::SolveAimBatch<FVectorRegisterLanes>( Batch, SolveSettings.Accuracy, &Events );
+
+	FTurretSolveStats SolveStats;
+	SolveStats.AddSolves( Scratch.NumTurrets, Events.NumTargetClamps, Events.NumFailedRoots, Events.NumBothDistancesNegative );
+#else
+	TurretRotationCore::SolveAimBatch<FVectorRegisterLanes>( Batch, SolveSettings.Accuracy );
+#endif
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "TurretRotationBatchKernel.h"
+
+struct FTurretSolveSettings;
+
+/** How many turrets the batched kernel solves at once.  See AIM_BATCH_WIDTH. */
+#define TURRET_BATCH_WIDTH AIM_BATCH_WIDTH
+
+/**
+ * The batched kernel is expected to match the scalar CalculateTurretRotation_ForActor within this many degrees (at the same TurretRotation.Accuracy).
+ * See AIM_BATCH_TOLERANCE_DEGREES, which the standalone "Batch" tests check.
+ */
+#define TURRET_BATCH_TOLERANCE_DEGREES float( AIM_BATCH_TOLERANCE_DEGREES )
+
+/**
+ * Structure-of-arrays scratch data for the batched turret solve.
+ * Everything is stored in AimJoint space, and every array is padded up to a multiple of TURRET_BATCH_WIDTH so
+ * the kernel never needs a scalar "tail" loop.
+ */
+struct TURRETROTATION_API FTurretRotationBatchScratch
+{
+	typedef TArray<float, TAlignedHeapAllocator<16>> FAlignedFloatArray;
+
+	FAlignedFloatArray TargetX;
+	FAlignedFloatArray TargetY;
+	FAlignedFloatArray TargetZ;
+
+	// The pitch is a 2D problem on the "X-Z" plane, so only X and Z are needed for the BarrelStart/BarrelEnd.
+	FAlignedFloatArray BarrelStartX;
+	FAlignedFloatArray BarrelStartZ;
+	FAlignedFloatArray BarrelEndX;
+	FAlignedFloatArray BarrelEndZ;
+
+	FAlignedFloatArray Yaw;
+	FAlignedFloatArray Pitch;
+
+	/** Number of turrets actually stored (the arrays may be a little bigger because of padding). */
+	int32 NumTurrets = 0;
+
+	/**
+	 * Resizes every array for the given number of turrets.
+	 * Padding lanes are filled with a harmless turret so they never produce NaNs.
+	 */
+	void Reset( int32 InNumTurrets );
+
+	/**
+	 * Stores one turret.  Every vector is expected to already be in AimJoint space (see CalculateTurretRotation_ForAimJoint).
+	 *
+	 * @param Index							Index of the turret.
+	 * @param BarrelStart_InAimJointSpace	Location of the BarrelStart relative to the AimJoint.
+	 * @param BarrelEnd_InAimJointSpace		Location of the BarrelEnd relative to the AimJoint.
+	 * @param Target_InAimJointSpace		Location of the Target relative to the AimJoint.
+	 */
+	void SetTurret( int32 Index, const FVector& BarrelStart_InAimJointSpace, const FVector& BarrelEnd_InAimJointSpace, const FVector& Target_InAimJointSpace );
+};
+
+/**
+ * SIMD version of the yaw/pitch solve done by CalculateTurretYaw and CalculateTurretPitch.
+ * Runs TurretRotationCore::SolveAimBatch on VectorRegister, TURRET_BATCH_WIDTH turrets per pass.  With TurretRotation.Accuracy at Fast or
+ * Approximate, the Atan2 polynomial runs on VectorRegister too; at Exact, the final Atan2/Acos are done one lane at a time with the same
+ * calls as the scalar solve (see TurretRotationBatchKernel.h).  Every turret goes through the same general solve, so
+ * FTurretSolveSettings::bUseSpecializedKernels doesn't apply here.
+ */
+struct TURRETROTATION_API FTurretRotationBatchKernel
+{
+	/**
+	 * Solves every turret stored in the scratch data, writing the results to Scratch.Yaw and Scratch.Pitch (in degrees).
+	 *
+	 * @param Scratch			Turrets to solve, already in AimJoint space.
+	 * @param SolveSettings		How to solve (only the accuracy is used).  Read once for the whole batch, see FTurretAimGeometry::GetSolveSettings.
+	 */
+	static void Solve( FTurretRotationBatchScratch& Scratch, const FTurretSolveSettings& SolveSettings );
+};
@@ -0,0 +1,372 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+
+/**
+ * The batched version of TAimGeometry::Solve, without any engine dependencies: AIM_BATCH_WIDTH turrets per pass, stored as a
+ * structure of arrays in AimJoint space.
+ *
+ * SolveAimBatch is written once against a "lanes" type, which supplies the register type and the handful of ops the solve needs (see
+ * FPortableAimLanes for the full list).  The engine plugs VectorRegister in (FTurretRotationBatchKernel), and the standalone tests and
+ * benchmarks use FPortableAimLanes, so both run exactly the same math.  Branches become masks: every lane computes everything, and
+ * Select picks the result the scalar code would have returned.
+ *
+ * How the trig is done depends on the EAimAccuracy:
+ *   - Fast and Approximate run the same minimax Atan2 polynomial as the scalar solve (TAtan2Coefficients), AIM_BATCH_WIDTH lanes at a
+ *     time, for both the yaw and the pitch.  Nothing is done one lane at a time.
+ *   - Exact is the only tier that leaves the registers: the yaw and pitch are finished one lane at a time with std::atan2/std::acos, the
+ *     same calls the scalar solve makes.  Everything before the trig (the target push out, the quadratic, the normalizations) is still
+ *     done AIM_BATCH_WIDTH lanes at a time.
+ */
+
+/** How many turrets SolveAimBatch solves per pass.  VectorRegister is 4 floats wide (SSE on x64, NEON on ARM). */
+#define AIM_BATCH_WIDTH 4
+
+/**
+ * Largest difference (in degrees) between SolveAimBatch and TAimGeometry::Solve, at the same EAimAccuracy, in float.
+ * Most of the difference comes from Acos in the Exact tier, which is badly conditioned near 0 and 180 degrees, so tiny float
+ * differences in the dot product turn into a few hundredths of a degree.
+ */
+#define AIM_BATCH_TOLERANCE_DEGREES 0.05
+
+namespace TurretRotationCore
+{
+	/**
+	 * AIM_BATCH_WIDTH floats, with every op done as a plain loop over the lanes.  Masks hold -1 (set) or 0 (clear) in each lane.
+	 *
+	 * This is the lanes type for anywhere VectorRegister isn't available (the standalone tests and benchmarks), and it documents the
+	 * ops SolveAimBatch expects from any other lanes type.
+	 */
+	struct FPortableAimLanes
+	{
+		struct RegisterType
+		{
+			float Lanes[AIM_BATCH_WIDTH];
+		};
+
+		/** @return Returns the AIM_BATCH_WIDTH floats starting at Values (which is aligned to AIM_BATCH_WIDTH floats). */
+		static RegisterType Load( const float* Values )
+		{
+			RegisterType Result;
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane ) { Result.Lanes[Lane] = Values[Lane]; }
+			return Result;
+		}
+
+		/** Stores every lane to the AIM_BATCH_WIDTH floats starting at Out_Values (which is aligned to AIM_BATCH_WIDTH floats). */
+		static void Store( const RegisterType& Value, float* Out_Values )
+		{
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane ) { Out_Values[Lane] = Value.Lanes[Lane]; }
+		}
+
+		/** @return Returns Value in every lane. */
+		static RegisterType Set( float Value )
+		{
+			RegisterType Result;
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane ) { Result.Lanes[Lane] = Value; }
+			return Result;
+		}
+
+		static RegisterType Add( const RegisterType& A, const RegisterType& B )			{ return Apply( A, B, []( float X, float Y ) { return X + Y; } ); }
+		static RegisterType Subtract( const RegisterType& A, const RegisterType& B )	{ return Apply( A, B, []( float X, float Y ) { return X - Y; } ); }
+		static RegisterType Multiply( const RegisterType& A, const RegisterType& B )	{ return Apply( A, B, []( float X, float Y ) { return X * Y; } ); }
+		static RegisterType Min( const RegisterType& A, const RegisterType& B )			{ return Apply( A, B, []( float X, float Y ) { return std::min( X, Y ); } ); }
+		static RegisterType Max( const RegisterType& A, const RegisterType& B )			{ return Apply( A, B, []( float X, float Y ) { return std::max( X, Y ); } ); }
+		static RegisterType Negate( const RegisterType& A )								{ return Apply( A, A, []( float X, float ) { return -X; } ); }
+		static RegisterType Abs( const RegisterType& A )								{ return Apply( A, A, []( float X, float ) { return std::abs( X ); } ); }
+		static RegisterType ReciprocalSqrt( const RegisterType& A )						{ return Apply( A, A, []( float X, float ) { return 1.0f / std::sqrt( X ); } ); }
+		static RegisterType Reciprocal( const RegisterType& A )							{ return Apply( A, A, []( float X, float ) { return 1.0f / X; } ); }
+
+		/** @return Returns ( A * B ) + C. */
+		static RegisterType MultiplyAdd( const RegisterType& A, const RegisterType& B, const RegisterType& C ) { return Add( Multiply( A, B ), C ); }
+
+		static RegisterType CompareGT( const RegisterType& A, const RegisterType& B )	{ return Apply( A, B, []( float X, float Y ) { return MakeMask( X > Y ); } ); }
+		static RegisterType CompareGE( const RegisterType& A, const RegisterType& B )	{ return Apply( A, B, []( float X, float Y ) { return MakeMask( X >= Y ); } ); }
+
+		/** @return Returns A in the lanes where Mask is set, and B in the others. */
+		static RegisterType Select( const RegisterType& Mask, const RegisterType& A, const RegisterType& B )
+		{
+			RegisterType Result;
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane ) { Result.Lanes[Lane] = IsSet( Mask.Lanes[Lane] ) ? A.Lanes[Lane] : B.Lanes[Lane]; }
+			return Result;
+		}
+
+		/** @return Returns the lanes set in both masks. */
+		static RegisterType And( const RegisterType& MaskA, const RegisterType& MaskB )
+		{
+			return Apply( MaskA, MaskB, []( float X, float Y ) { return MakeMask( IsSet( X ) && IsSet( Y ) ); } );
+		}
+
+		/** @return Returns one bit per lane (lane 0 in the lowest bit), set if the lane is set in Mask. */
+		static unsigned int MaskBits( const RegisterType& Mask )
+		{
+			unsigned int Bits = 0;
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane ) { Bits |= IsSet( Mask.Lanes[Lane] ) ? ( 1u << Lane ) : 0u; }
+			return Bits;
+		}
+
+	private:
+		/** A set mask lane is -1, so it has its sign bit set, which is the bit VectorMaskBits reads. */
+		static float MakeMask( bool bSet ) { return bSet ? -1.0f : 0.0f; }
+		static bool IsSet( float MaskLane ) { return MaskLane < 0.0f; }
+
+		template<typename FunctionType>
+		static RegisterType Apply( const RegisterType& A, const RegisterType& B, FunctionType Function )
+		{
+			RegisterType Result;
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane ) { Result.Lanes[Lane] = Function( A.Lanes[Lane], B.Lanes[Lane] ); }
+			return Result;
+		}
+	};
+
+	/**
+	 * Structure-of-arrays view of the turrets for SolveAimBatch.  Every array holds NumPadded floats (a multiple of AIM_BATCH_WIDTH,
+	 * aligned to AIM_BATCH_WIDTH floats), and everything is in AimJoint space, so the AimJoint is always at the origin.
+	 */
+	struct FAimBatch
+	{
+		const float* TargetX;
+		const float* TargetY;
+		const float* TargetZ;
+
+		// The pitch is a 2D problem on the "X-Z" plane, so only X and Z are needed for the BarrelStart/BarrelEnd.
+		const float* BarrelStartX;
+		const float* BarrelStartZ;
+		const float* BarrelEndX;
+		const float* BarrelEndZ;
+
+		/** OUT - Yaw of every turret, in degrees. */
+		float* Yaw;
+
+		/** OUT - Pitch of every turret, in degrees. */
+		float* Pitch;
+
+		/** Number of real turrets.  The lanes after them are padding, and aren't counted in FAimBatchEvents. */
+		int NumTurrets;
+
+		/** Size of every array. */
+		int NumPadded;
+	};
+
+	/** How many of the real turrets in a SolveAimBatch ran into each EAimSolveEvent. */
+	struct FAimBatchEvents
+	{
+		unsigned int NumTargetClamps;
+		unsigned int NumFailedRoots;
+		unsigned int NumBothDistancesNegative;
+
+		FAimBatchEvents()
+			: NumTargetClamps( 0 )
+			, NumFailedRoots( 0 )
+			, NumBothDistancesNegative( 0 )
+		{
+		}
+	};
+
+	/** @return Returns the square root of every lane, with 0 (instead of NaN) for the lanes that are 0. */
+	template<typename LanesType>
+	inline typename LanesType::RegisterType LanesSafeSqrt( const typename LanesType::RegisterType& Value )
+	{
+		const typename LanesType::RegisterType NonZeroValue = LanesType::Max( Value, LanesType::Set( 1.e-30f ) );
+		return LanesType::Multiply( Value, LanesType::ReciprocalSqrt( NonZeroValue ) );
+	}
+
+	/** Same as GetSafeNormal2D, for every lane. */
+	template<typename LanesType>
+	inline void LanesSafeNormal2D( typename LanesType::RegisterType& InOut_X, typename LanesType::RegisterType& InOut_Y )
+	{
+		typedef typename LanesType::RegisterType RegisterType;
+
+		const RegisterType Zero = LanesType::Set( 0.0f );
+		const RegisterType SmallNumber = LanesType::Set( TConstants<float>::SmallNumber() );
+		const RegisterType SizeSquared = LanesType::MultiplyAdd( InOut_X, InOut_X, LanesType::Multiply( InOut_Y, InOut_Y ) );
+		const RegisterType bCanNormalize = LanesType::CompareGT( SizeSquared, SmallNumber );
+		const RegisterType InverseSize = LanesType::ReciprocalSqrt( LanesType::Max( SizeSquared, SmallNumber ) );
+
+		InOut_X = LanesType::Select( bCanNormalize, LanesType::Multiply( InOut_X, InverseSize ), Zero );
+		InOut_Y = LanesType::Select( bCanNormalize, LanesType::Multiply( InOut_Y, InverseSize ), Zero );
+	}
+
+	/** @return Returns the number of lanes set in Mask, ignoring any lanes not in LaneBits. */
+	template<typename LanesType>
+	inline unsigned int LanesCount( const typename LanesType::RegisterType& Mask, unsigned int LaneBits )
+	{
+		const unsigned int Bits = LanesType::MaskBits( Mask ) & LaneBits;
+		unsigned int Count = 0;
+		for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane )
+		{
+			Count += ( Bits >> Lane ) & 1u;
+		}
+		return Count;
+	}
+
+	/**
+	 * Same as PolynomialAtan2, for every lane.  The division becomes a reciprocal, and the octant unfolding becomes selects.
+	 *
+	 * @return Returns the angle (in radians) of (X, Y) in every lane.
+	 */
+	template<typename LanesType, int NumCoefficients>
+	inline typename LanesType::RegisterType LanesPolynomialAtan2( const typename LanesType::RegisterType& Y, const typename LanesType::RegisterType& X, const float ( &Coefficients )[NumCoefficients] )
+	{
+		typedef typename LanesType::RegisterType RegisterType;
+
+		const RegisterType Zero = LanesType::Set( 0.0f );
+		const RegisterType AbsX = LanesType::Abs( X );
+		const RegisterType AbsY = LanesType::Abs( Y );
+		const RegisterType MaxXY = LanesType::Max( AbsX, AbsY );
+
+		// Where X and Y are both 0, the Min is 0 too, so dividing by 1 instead gives the 0 that PolynomialAtan2 returns.
+		const RegisterType SafeMaxXY = LanesType::Select( LanesType::CompareGT( MaxXY, Zero ), MaxXY, LanesType::Set( 1.0f ) );
+		const RegisterType Z = LanesType::Multiply( LanesType::Min( AbsX, AbsY ), LanesType::Reciprocal( SafeMaxXY ) );
+		const RegisterType ZSquared = LanesType::Multiply( Z, Z );
+
+		RegisterType Result = LanesType::Set( Coefficients[NumCoefficients - 1] );
+		for ( int Index = NumCoefficients - 2; Index >= 0; --Index )
+		{
+			Result = LanesType::MultiplyAdd( Result, ZSquared, LanesType::Set( Coefficients[Index] ) );
+		}
+		Result = LanesType::Multiply( Result, Z );
+
+		const RegisterType Pi = LanesType::Set( TConstants<float>::Pi() );
+		const RegisterType HalfPi = LanesType::Set( TConstants<float>::Pi() / 2 );
+		Result = LanesType::Select( LanesType::CompareGT( AbsY, AbsX ), LanesType::Subtract( HalfPi, Result ), Result );
+		Result = LanesType::Select( LanesType::CompareGT( Zero, X ), LanesType::Subtract( Pi, Result ), Result );
+		return LanesType::Select( LanesType::CompareGT( Zero, Y ), LanesType::Negate( Result ), Result );
+	}
+
+	/** @return Returns LanesPolynomialAtan2 at the given accuracy (which can't be Exact), in degrees. */
+	template<typename LanesType>
+	inline typename LanesType::RegisterType LanesAtan2Degrees( const typename LanesType::RegisterType& Y, const typename LanesType::RegisterType& X, EAimAccuracy Accuracy )
+	{
+		const typename LanesType::RegisterType Radians = ( Accuracy == EAimAccuracy::Fast )
+			? LanesPolynomialAtan2<LanesType>( Y, X, TAtan2Coefficients<float>::Fast )
+			: LanesPolynomialAtan2<LanesType>( Y, X, TAtan2Coefficients<float>::Approximate );
+		return LanesType::Multiply( Radians, LanesType::Set( TConstants<float>::RadiansToDegrees() ) );
+	}
+
+	/**
+	 * Solves every turret in the batch, the same as TAimGeometry::Solve (within AIM_BATCH_TOLERANCE_DEGREES), writing Batch.Yaw and
+	 * Batch.Pitch.  See the top of this file for how each EAimAccuracy does its trig.
+	 *
+	 * @param Batch			Turrets to solve, in AimJoint space.
+	 * @param Accuracy		How accurately to do the trig.
+	 * @param Out_Events	OUT (optional) - How many of the real turrets ran into each edge case.  Added to, not reset.
+	 */
+	template<typename LanesType>
+	inline void SolveAimBatch( const FAimBatch& Batch, EAimAccuracy Accuracy, FAimBatchEvents* Out_Events = nullptr )
+	{
+		typedef typename LanesType::RegisterType RegisterType;
+
+		// This is the same math as TAimGeometry::Solve (and the functions it calls).  Since the AimJoint is always at the origin, all of
+		// the "J" terms drop out of the quadratic.
+		const RegisterType Zero = LanesType::Set( 0.0f );
+		const RegisterType One = LanesType::Set( 1.0f );
+		const RegisterType Two = LanesType::Set( 2.0f );
+		const RegisterType Four = LanesType::Set( 4.0f );
+		const RegisterType SmallNumber = LanesType::Set( TConstants<float>::SmallNumber() );
+		const RegisterType MinimumDistance_MaxTolerance = LanesType::Set( 3.0f );
+		const RegisterType MinimumDistance_TolerancePercent = LanesType::Set( 0.01f );
+
+		alignas( 16 ) float LaneDotProducts[AIM_BATCH_WIDTH];
+		alignas( 16 ) float LaneRotationSigns[AIM_BATCH_WIDTH];
+
+		for ( int Index = 0; Index < Batch.NumPadded; Index += AIM_BATCH_WIDTH )
+		{
+			const RegisterType TargetX = LanesType::Load( Batch.TargetX + Index );
+			const RegisterType TargetY = LanesType::Load( Batch.TargetY + Index );
+			const RegisterType TargetZ = LanesType::Load( Batch.TargetZ + Index );
+			const RegisterType StartX = LanesType::Load( Batch.BarrelStartX + Index );
+			const RegisterType StartZ = LanesType::Load( Batch.BarrelStartZ + Index );
+			const RegisterType EndX = LanesType::Load( Batch.BarrelEndX + Index );
+			const RegisterType EndZ = LanesType::Load( Batch.BarrelEndZ + Index );
+
+			// Rotating the target by the inverse of the yaw just moves it onto the "X-Z" plane, so its new X is its distance across the "X-Y" plane.
+			RegisterType Target2DX = LanesSafeSqrt<LanesType>( LanesType::MultiplyAdd( TargetX, TargetX, LanesType::Multiply( TargetY, TargetY ) ) );
+			RegisterType Target2DY = TargetZ;
+
+			// CalculateNearestValidTargetLocation2D
+			const RegisterType StartDistance = LanesSafeSqrt<LanesType>( LanesType::MultiplyAdd( StartX, StartX, LanesType::Multiply( StartZ, StartZ ) ) );
+			const RegisterType EndDistance = LanesSafeSqrt<LanesType>( LanesType::MultiplyAdd( EndX, EndX, LanesType::Multiply( EndZ, EndZ ) ) );
+			RegisterType MinimumDistance = LanesType::Min( StartDistance, EndDistance );
+			MinimumDistance = LanesType::Add( MinimumDistance, LanesType::Min( MinimumDistance_MaxTolerance, LanesType::Multiply( MinimumDistance_TolerancePercent, MinimumDistance ) ) );
+
+			RegisterType TargetDistanceSquared = LanesType::MultiplyAdd( Target2DX, Target2DX, LanesType::Multiply( Target2DY, Target2DY ) );
+			const RegisterType bTargetTooClose = LanesType::CompareGT( LanesType::Multiply( MinimumDistance, MinimumDistance ), TargetDistanceSquared );
+			const RegisterType bTargetCanNormalize = LanesType::CompareGT( TargetDistanceSquared, SmallNumber );
+			const RegisterType PushOutScale = LanesType::Select( bTargetCanNormalize, LanesType::Multiply( MinimumDistance, LanesType::ReciprocalSqrt( LanesType::Max( TargetDistanceSquared, SmallNumber ) ) ), Zero );
+			Target2DX = LanesType::Select( bTargetTooClose, LanesType::Multiply( Target2DX, PushOutScale ), Target2DX );
+			Target2DY = LanesType::Select( bTargetTooClose, LanesType::Multiply( Target2DY, PushOutScale ), Target2DY );
+			TargetDistanceSquared = LanesType::MultiplyAdd( Target2DX, Target2DX, LanesType::Multiply( Target2DY, Target2DY ) );
+
+			// CalculateQuadraticCoefficients
+			RegisterType RayX = LanesType::Subtract( EndX, StartX );
+			RegisterType RayY = LanesType::Subtract( EndZ, StartZ );
+			LanesSafeNormal2D<LanesType>( RayX, RayY );
+
+			const RegisterType A = LanesType::MultiplyAdd( RayX, RayX, LanesType::Multiply( RayY, RayY ) );
+			const RegisterType B = LanesType::Multiply( Two, LanesType::MultiplyAdd( StartX, RayX, LanesType::Multiply( StartZ, RayY ) ) );
+			const RegisterType C = LanesType::Subtract( LanesType::MultiplyAdd( StartX, StartX, LanesType::Multiply( StartZ, StartZ ) ), TargetDistanceSquared );
+
+			// CalculateQuadraticRoots
+			const RegisterType Denominator = LanesType::Multiply( Two, A );
+			const RegisterType RadicalInput = LanesType::Subtract( LanesType::Multiply( B, B ), LanesType::Multiply( Four, LanesType::Multiply( A, C ) ) );
+			const RegisterType bRootsWereFound = LanesType::And( LanesType::CompareGT( LanesType::Abs( Denominator ), SmallNumber ), LanesType::CompareGE( RadicalInput, Zero ) );
+
+			const RegisterType Radical = LanesSafeSqrt<LanesType>( LanesType::Max( RadicalInput, Zero ) );
+			const RegisterType InverseDenominator = LanesType::Reciprocal( LanesType::Select( bRootsWereFound, Denominator, One ) );
+			const RegisterType NegativeB = LanesType::Negate( B );
+			const RegisterType FirstDistance = LanesType::Multiply( LanesType::Subtract( NegativeB, Radical ), InverseDenominator );
+			const RegisterType SecondDistance = LanesType::Multiply( LanesType::Add( NegativeB, Radical ), InverseDenominator );
+
+			// SelectBestRayDistance
+			const RegisterType bBothDistancesNegative = LanesType::And( LanesType::CompareGT( Zero, FirstDistance ), LanesType::CompareGT( Zero, SecondDistance ) );
+			const RegisterType BarrelRayDistance = LanesType::Select( bBothDistancesNegative, LanesType::Min( FirstDistance, SecondDistance ), LanesType::Max( FirstDistance, SecondDistance ) );
+
+			if ( Out_Events )
+			{
+				// The padding lanes at the end aren't real turrets, so they shouldn't show up in the counts.
+				const int NumRealLanes = std::min( Batch.NumTurrets - Index, AIM_BATCH_WIDTH );
+				const unsigned int RealLaneBits = NumRealLanes > 0 ? ( 1u << NumRealLanes ) - 1 : 0u;
+				Out_Events->NumTargetClamps += LanesCount<LanesType>( bTargetTooClose, RealLaneBits );
+				Out_Events->NumFailedRoots += std::max( NumRealLanes, 0 ) - LanesCount<LanesType>( bRootsWereFound, RealLaneBits );
+				Out_Events->NumBothDistancesNegative += LanesCount<LanesType>( LanesType::And( bBothDistancesNegative, bRootsWereFound ), RealLaneBits );
+			}
+
+			// CalculateAngleToRotateFromFirstVectorToSecondVector
+			RegisterType ScaledBarrelEndX = LanesType::MultiplyAdd( RayX, BarrelRayDistance, StartX );
+			RegisterType ScaledBarrelEndY = LanesType::MultiplyAdd( RayY, BarrelRayDistance, StartZ );
+			LanesSafeNormal2D<LanesType>( ScaledBarrelEndX, ScaledBarrelEndY );
+			LanesSafeNormal2D<LanesType>( Target2DX, Target2DY );
+
+			RegisterType DotProduct = LanesType::MultiplyAdd( ScaledBarrelEndX, Target2DX, LanesType::Multiply( ScaledBarrelEndY, Target2DY ) );
+			DotProduct = LanesType::Min( LanesType::Max( DotProduct, LanesType::Negate( One ) ), One );
+
+			// ShouldTurnCounterClockwiseToMeet: the dot product with the FirstVector rotated by 90 degrees is just the 2D cross product.
+			const RegisterType CrossProduct = LanesType::Subtract( LanesType::Multiply( ScaledBarrelEndX, Target2DY ), LanesType::Multiply( ScaledBarrelEndY, Target2DX ) );
+
+			// If no roots were found, the pitch is 0.  Acos( 1 ) and Atan2( 0, 1 ) are both 0, so that's what the failed lanes get.
+			DotProduct = LanesType::Select( bRootsWereFound, DotProduct, One );
+			const RegisterType SafeCrossProduct = LanesType::Select( bRootsWereFound, CrossProduct, Zero );
+
+			if ( Accuracy != EAimAccuracy::Exact )
+			{
+				LanesType::Store( LanesAtan2Degrees<LanesType>( TargetY, TargetX, Accuracy ), Batch.Yaw + Index );
+
+				// A zero vector (which the exact path turns into a 90 degree turn) is the only way to get a zero Cross and Dot.
+				const RegisterType bNonZeroVector = LanesType::CompareGT( LanesType::Add( LanesType::Abs( SafeCrossProduct ), LanesType::Abs( DotProduct ) ), Zero );
+				const RegisterType Pitch = LanesAtan2Degrees<LanesType>( SafeCrossProduct, DotProduct, Accuracy );
+				LanesType::Store( LanesType::Select( bNonZeroVector, Pitch, LanesType::Set( 90.0f ) ), Batch.Pitch + Index );
+				continue;
+			}
+
+			// Exact: std::atan2 and std::acos have no lane-wide version, so they're done one lane at a time.
+			LanesType::Store( DotProduct, LaneDotProducts );
+			LanesType::Store( LanesType::Select( LanesType::CompareGE( SafeCrossProduct, Zero ), One, LanesType::Negate( One ) ), LaneRotationSigns );
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane )
+			{
+				const int TurretIndex = Index + Lane;
+				Batch.Yaw[TurretIndex] = std::atan2( Batch.TargetY[TurretIndex], Batch.TargetX[TurretIndex] ) * TConstants<float>::RadiansToDegrees();
+				Batch.Pitch[TurretIndex] = LaneRotationSigns[Lane] * std::acos( LaneDotProducts[Lane] ) * TConstants<float>::RadiansToDegrees();
+			}
+		}
+	}
+}
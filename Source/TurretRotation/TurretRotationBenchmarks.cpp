@@ -0,0 +1,1546 @@
+#include "TurretRotation.h"
+#include "TurretRotationCore.h"
+#include "TurretRotationKernels.h"
+#include "TurretRotationBallistics.h"
+#include "TurretRotationNet.h"
+#include "TurretRotationRates.h"
+#include "TurretRotationChain.h"
+#include "TurretTargetGrid.h"
+#include "TurretCoverageField.h"
+#include "TurretAimExtrapolation.h"
+#include "TurretRotationBatch.h"
+#include "TurretAimGeometry.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+/**
+ * Micro-benchmarks for the turret math, run from the console:
+ *
+ *   TurretRotation.Bench.Solve [NumTurrets]
+ *   TurretRotation.Bench.Quat [NumTurrets]
+ *   TurretRotation.Bench.Accuracy [NumTurrets]
+ *   TurretRotation.Bench.Kernels [NumTurrets]
+ *   TurretRotation.Bench.Batch [NumTurrets]
+ *   TurretRotation.Bench.Ballistic [NumTurrets]
+ *   TurretRotation.Bench.Acquire [NumTurrets NumTargets]
+ *   TurretRotation.Bench.Net [NumTurrets]
+ *   TurretRotation.Bench.Coverage [NumTurrets NumQueries]
+ *   TurretRotation.Bench.Rates [NumTurrets]
+ *   TurretRotation.Bench.Chain [NumTurrets]
+ *
+ * Except for Batch, Acquire, Coverage, and Rates (which also measure FTurretRotationBatchKernel, FTurretTargetGrid, FTurretCoverageField,
+ * and FTurretAimExtrapolation), these only use TurretRotationCore, so they measure the math itself and nothing else.
+ * They run in any build, including a headless Linux game/server started with -nullrhi.
+ */
+namespace TurretRotationBenchmarks
+{
+	/** One set of benchmark inputs: every turret has its own geometry and target. */
+	template<typename ScalarType>
+	struct TBenchmarkInputs
+	{
+		typedef TurretRotationCore::TVector3<ScalarType> FVector3;
+
+		TArray<TurretRotationCore::TAimGeometry<ScalarType>> Geometries;
+		TArray<FVector3> Targets_InAimJointSpace;
+	};
+
+	/** Turrets sized like the demo turrets, aiming at targets a few meters to a few hundred meters away. */
+	template<typename ScalarType>
+	static void MakeTypicalInputs( int32 NumTurrets, FRandomStream& Random, TBenchmarkInputs<ScalarType>& Out_Inputs )
+	{
+		typedef typename TBenchmarkInputs<ScalarType>::FVector3 FVector3;
+
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const FVector3 AimJoint_To_BarrelStart( Random.FRandRange( 0.0f, 50.0f ), 0, Random.FRandRange( -50.0f, 50.0f ) );
+			const FVector3 BarrelStart_To_BarrelEnd( Random.FRandRange( 50.0f, 300.0f ), 0, Random.FRandRange( -20.0f, 20.0f ) );
+			const FVector3 ActorScale( 1, 1, 1 );
+			Out_Inputs.Geometries.Add( TurretRotationCore::TAimGeometry<ScalarType>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale ) );
+
+			const FVector Direction = Random.VRand();
+			const float Distance = Random.FRandRange( 500.0f, 50000.0f );
+			Out_Inputs.Targets_InAimJointSpace.Add( FVector3( Direction.X * Distance, Direction.Y * Distance, Direction.Z * Distance ) );
+		}
+	}
+
+	/**
+	 * The edge cases: targets closer than the barrel (clamped), targets sitting right on the AimJoint, zero-length barrels (no roots),
+	 * and targets straight above/below the AimJoint.
+	 */
+	template<typename ScalarType>
+	static void MakeDegenerateInputs( int32 NumTurrets, FRandomStream& Random, TBenchmarkInputs<ScalarType>& Out_Inputs )
+	{
+		typedef typename TBenchmarkInputs<ScalarType>::FVector3 FVector3;
+
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const bool bZeroLengthBarrel = ( Index % 4 ) == 0;
+			const FVector3 AimJoint_To_BarrelStart( 40, 0, 30 );
+			const FVector3 BarrelStart_To_BarrelEnd = bZeroLengthBarrel ? FVector3( 0, 0, 0 ) : FVector3( 150, 0, 0 );
+			const FVector3 ActorScale( 1, 1, 1 );
+			Out_Inputs.Geometries.Add( TurretRotationCore::TAimGeometry<ScalarType>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale ) );
+
+			switch ( Index % 3 )
+			{
+			case 0:		Out_Inputs.Targets_InAimJointSpace.Add( FVector3( 0, 0, 0 ) ); break;
+			case 1:		Out_Inputs.Targets_InAimJointSpace.Add( FVector3( 0, 0, Random.FRandRange( -1000.0f, 1000.0f ) ) ); break;
+			default:	Out_Inputs.Targets_InAimJointSpace.Add( FVector3( Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ) ) ); break;
+			}
+		}
+	}
+
+	/** @return Returns the average cost of one solve, in nanoseconds. */
+	template<typename ScalarType>
+	static double RunSolveBenchmark( const TBenchmarkInputs<ScalarType>& Inputs, int32 NumRepeats )
+	{
+		const int32 NumTurrets = Inputs.Geometries.Num();
+		ScalarType Checksum = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int32 Index = 0; Index < NumTurrets; ++Index )
+			{
+				const TurretRotationCore::TAimAngles<ScalarType> Angles = Inputs.Geometries[Index].Solve( Inputs.Targets_InAimJointSpace[Index] );
+				Checksum += Angles.Pitch + Angles.Yaw;
+			}
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		// Log the checksum so the compiler can't throw the solves away.
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), double( Checksum ) );
+
+		return ( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTurrets * NumRepeats );
+	}
+
+	template<typename ScalarType>
+	static void RunSolveBenchmarks( const TCHAR* ScalarName, int32 NumTurrets )
+	{
+		FRandomStream Random( 1234 );
+
+		TBenchmarkInputs<ScalarType> TypicalInputs;
+		MakeTypicalInputs( 1024, Random, TypicalInputs );
+
+		TBenchmarkInputs<ScalarType> DegenerateInputs;
+		MakeDegenerateInputs( 1024, Random, DegenerateInputs );
+
+		// The large set doesn't fit in cache, so it also measures the cost of streaming the geometry in.
+		TBenchmarkInputs<ScalarType> LargeInputs;
+		MakeTypicalInputs( NumTurrets, Random, LargeInputs );
+
+		const int32 SmallSetRepeats = 1000;
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] Typical:    %.1f ns/solve" ), ScalarName, RunSolveBenchmark( TypicalInputs, SmallSetRepeats ) );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] Degenerate: %.1f ns/solve" ), ScalarName, RunSolveBenchmark( DegenerateInputs, SmallSetRepeats ) );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] Large (%d): %.1f ns/solve" ), ScalarName, NumTurrets, RunSolveBenchmark( LargeInputs, 1 ) );
+	}
+
+	static void BenchmarkSolve( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 1000000;
+
+		RunSolveBenchmarks<float>( TEXT( "float" ), NumTurrets );
+		RunSolveBenchmarks<double>( TEXT( "double" ), NumTurrets );
+	}
+
+	static FAutoConsoleCommand BenchmarkSolveCommand(
+		TEXT( "TurretRotation.Bench.Solve" ),
+		TEXT( "Measures the cost of TurretRotationCore's solve for typical, degenerate, and large input sets.  Usage: TurretRotation.Bench.Solve [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkSolve ) );
+
+	/** The old way to get a quaternion: solve for degrees, then convert them the same way FRotator::Quaternion does. */
+	template<typename ScalarType>
+	static TurretRotationCore::TQuaternion<ScalarType> SolveQuaternionFromAngles( const TurretRotationCore::TAimGeometry<ScalarType>& Geometry, const TurretRotationCore::TVector3<ScalarType>& Target_InAimJointSpace )
+	{
+		const TurretRotationCore::TAimAngles<ScalarType> Angles = Geometry.Solve( Target_InAimJointSpace );
+
+		const ScalarType DegreesToHalfRadians = TurretRotationCore::TConstants<ScalarType>::Pi() / ScalarType( 360 );
+		const ScalarType SP = std::sin( Angles.Pitch * DegreesToHalfRadians );
+		const ScalarType CP = std::cos( Angles.Pitch * DegreesToHalfRadians );
+		const ScalarType SY = std::sin( Angles.Yaw * DegreesToHalfRadians );
+		const ScalarType CY = std::cos( Angles.Yaw * DegreesToHalfRadians );
+
+		TurretRotationCore::TQuaternion<ScalarType> Result;
+		Result.X = SP * SY;
+		Result.Y = -SP * CY;
+		Result.Z = CP * SY;
+		Result.W = CP * CY;
+		return Result;
+	}
+
+	/** @return Returns the average cost (in nanoseconds) of getting one quaternion, either from the angles or from SolveRotation. */
+	template<typename ScalarType>
+	static double RunQuaternionBenchmark( const TBenchmarkInputs<ScalarType>& Inputs, int32 NumRepeats, bool bFromAngles )
+	{
+		const int32 NumTurrets = Inputs.Geometries.Num();
+		ScalarType Checksum = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int32 Index = 0; Index < NumTurrets; ++Index )
+			{
+				const TurretRotationCore::TQuaternion<ScalarType> Quaternion = bFromAngles
+					? SolveQuaternionFromAngles( Inputs.Geometries[Index], Inputs.Targets_InAimJointSpace[Index] )
+					: TurretRotationCore::MakeAimQuaternion( Inputs.Geometries[Index].SolveRotation( Inputs.Targets_InAimJointSpace[Index] ) );
+				Checksum += Quaternion.X + Quaternion.W;
+			}
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), double( Checksum ) );
+
+		return ( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTurrets * NumRepeats );
+	}
+
+	/**
+	 * Measures how far (in degrees) the float quaternions from both paths end up from a double precision reference.
+	 *
+	 * @param Inputs				The turrets to measure.
+	 * @param Out_AnglesError		OUT - The largest error when converting the angles to a quaternion.
+	 * @param Out_RotationError		OUT - The largest error with SolveRotation and MakeAimQuaternion.
+	 */
+	static void MeasureQuaternionError( const TBenchmarkInputs<float>& Inputs, double& Out_AnglesError, double& Out_RotationError )
+	{
+		typedef TurretRotationCore::TVector2<double> FVector2d;
+
+		Out_AnglesError = 0.0;
+		Out_RotationError = 0.0;
+
+		for ( int32 Index = 0; Index < Inputs.Geometries.Num(); ++Index )
+		{
+			const TurretRotationCore::TAimGeometry<float>& Geometry = Inputs.Geometries[Index];
+			const TurretRotationCore::TVector3<float>& Target = Inputs.Targets_InAimJointSpace[Index];
+
+			const TurretRotationCore::TAimGeometry<double> Geometry_Double = TurretRotationCore::TAimGeometry<double>::MakeFromLocations2D(
+				FVector2d( Geometry.GetAimJointLocation2D().X, Geometry.GetAimJointLocation2D().Y ),
+				FVector2d( Geometry.GetBarrelStartLocation2D().X, Geometry.GetBarrelStartLocation2D().Y ),
+				FVector2d( Geometry.GetBarrelEndLocation2D().X, Geometry.GetBarrelEndLocation2D().Y ) );
+			const TurretRotationCore::TQuaternion<double> Reference = SolveQuaternionFromAngles( Geometry_Double, TurretRotationCore::TVector3<double>( Target.X, Target.Y, Target.Z ) );
+
+			// Measuring with the distance between the quaternions (instead of an Acos of their dot product) keeps float rounding from
+			// showing up as hundredths of a degree.
+			auto AngleToReference = [&Reference]( const TurretRotationCore::TQuaternion<float>& Quaternion )
+			{
+				const double Sign = ( ( Quaternion.X * Reference.X ) + ( Quaternion.Y * Reference.Y ) + ( Quaternion.Z * Reference.Z ) + ( Quaternion.W * Reference.W ) ) < 0.0 ? -1.0 : 1.0;
+				const FVector4 Delta( Quaternion.X - ( Sign * Reference.X ), Quaternion.Y - ( Sign * Reference.Y ), Quaternion.Z - ( Sign * Reference.Z ), Quaternion.W - ( Sign * Reference.W ) );
+				return FMath::RadiansToDegrees( 4.0 * FMath::Asin( FMath::Min( 1.0f, Delta.Size() * 0.5f ) ) );
+			};
+
+			Out_AnglesError = FMath::Max( Out_AnglesError, double( AngleToReference( SolveQuaternionFromAngles( Geometry, Target ) ) ) );
+			Out_RotationError = FMath::Max( Out_RotationError, double( AngleToReference( TurretRotationCore::MakeAimQuaternion( Geometry.SolveRotation( Target ) ) ) ) );
+		}
+	}
+
+	static void BenchmarkQuat( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 4096;
+		const int32 NumRepeats = FMath::Max( 1, 4000000 / NumTurrets );
+
+		FRandomStream Random( 1234 );
+		TBenchmarkInputs<float> Inputs;
+		MakeTypicalInputs( NumTurrets, Random, Inputs );
+
+		TBenchmarkInputs<double> Inputs_Double;
+		MakeTypicalInputs( NumTurrets, Random, Inputs_Double );
+
+		UE_LOG( LogTurretRotation, Display, TEXT( "[float] Angles -> Quat: %.1f ns, SolveRotation -> Quat: %.1f ns" ),
+			RunQuaternionBenchmark( Inputs, NumRepeats, /*bFromAngles*/ true ),
+			RunQuaternionBenchmark( Inputs, NumRepeats, /*bFromAngles*/ false ) );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[double] Angles -> Quat: %.1f ns, SolveRotation -> Quat: %.1f ns" ),
+			RunQuaternionBenchmark( Inputs_Double, NumRepeats, /*bFromAngles*/ true ),
+			RunQuaternionBenchmark( Inputs_Double, NumRepeats, /*bFromAngles*/ false ) );
+
+		double AnglesError = 0.0;
+		double RotationError = 0.0;
+		MeasureQuaternionError( Inputs, AnglesError, RotationError );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[float] Largest error against double: Angles -> Quat %.2e degrees, SolveRotation -> Quat %.2e degrees" ), AnglesError, RotationError );
+	}
+
+	static FAutoConsoleCommand BenchmarkQuatCommand(
+		TEXT( "TurretRotation.Bench.Quat" ),
+		TEXT( "Measures solving straight to a quaternion (SolveRotation) against solving for degrees and converting them.  Usage: TurretRotation.Bench.Quat [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkQuat ) );
+
+	/**
+	 * Times one accuracy tier.  The tiers' error bounds are checked by the Accuracy tests in Source/TurretRotationStandalone.
+	 *
+	 * @return Returns the average cost of one solve, in nanoseconds.
+	 */
+	static double RunAccuracyTier( TurretRotationCore::EAimAccuracy Accuracy, const TBenchmarkInputs<float>& TimingInputs )
+	{
+		const int32 NumTimedTurrets = TimingInputs.Geometries.Num();
+		const int32 NumRepeats = 1000;
+		float Checksum = 0.0f;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int32 Index = 0; Index < NumTimedTurrets; ++Index )
+			{
+				const TurretRotationCore::TAimAngles<float> Angles = TimingInputs.Geometries[Index].Solve( TimingInputs.Targets_InAimJointSpace[Index], Accuracy );
+				Checksum += Angles.Pitch + Angles.Yaw;
+			}
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), Checksum );
+
+		return ( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTimedTurrets * NumRepeats );
+	}
+
+	static void BenchmarkAccuracy( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 1024;
+
+		FRandomStream Random( 1234 );
+		TBenchmarkInputs<float> TimingInputs;
+		MakeTypicalInputs( NumTurrets, Random, TimingInputs );
+
+		const auto LogTier = [&TimingInputs]( TurretRotationCore::EAimAccuracy Accuracy, const TCHAR* AccuracyName )
+		{
+			UE_LOG( LogTurretRotation, Display, TEXT( "[%s] %.1f ns/solve (documented error bound %.2e degrees)" ),
+				AccuracyName,
+				RunAccuracyTier( Accuracy, TimingInputs ),
+				TurretRotationCore::GetMaxAngleErrorDegrees( Accuracy ) );
+		};
+
+		LogTier( TurretRotationCore::EAimAccuracy::Exact, TEXT( "Exact" ) );
+		LogTier( TurretRotationCore::EAimAccuracy::Fast, TEXT( "Fast" ) );
+		LogTier( TurretRotationCore::EAimAccuracy::Approximate, TEXT( "Approximate" ) );
+	}
+
+	static FAutoConsoleCommand BenchmarkAccuracyCommand(
+		TEXT( "TurretRotation.Bench.Accuracy" ),
+		TEXT( "Times every TurretRotation.Accuracy tier (the error bounds are checked by the standalone tests).  Usage: TurretRotation.Bench.Accuracy [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkAccuracy ) );
+
+	/**
+	 * Turrets shaped for one of the specialized kernels, with the same sizes as MakeTypicalInputs.  Every 8th target is an edge case
+	 * (right on the AimJoint, straight above/below it, or just in front of the BarrelStart).
+	 */
+	static void MakeKernelInputs( TurretRotationCore::EAimKernel Kernel, bool bUniformScale, int32 NumTurrets, FRandomStream& Random, TBenchmarkInputs<float>& Out_Inputs )
+	{
+		typedef TBenchmarkInputs<float>::FVector3 FVector3;
+
+		const bool bBarrelAlongX = ( Kernel == TurretRotationCore::EAimKernel::BarrelAlongX || Kernel == TurretRotationCore::EAimKernel::BarrelAlongX_NoOffset );
+		const bool bNoVerticalOffset = ( Kernel == TurretRotationCore::EAimKernel::AnyBarrel_NoOffset || Kernel == TurretRotationCore::EAimKernel::BarrelAlongX_NoOffset );
+
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			// Offsets/slopes are kept away from 0, so that ChooseAimKernel can't pick a more specialized kernel than the one being tested.
+			const float OffsetZ = ( Random.FRand() < 0.5f ? -1.0f : 1.0f ) * Random.FRandRange( 5.0f, 50.0f );
+			const float BarrelZ = ( Random.FRand() < 0.5f ? -1.0f : 1.0f ) * Random.FRandRange( 5.0f, 20.0f );
+			const FVector3 AimJoint_To_BarrelStart( Random.FRandRange( 0.0f, 50.0f ), 0, bNoVerticalOffset ? 0.0f : OffsetZ );
+			const FVector3 BarrelStart_To_BarrelEnd( Random.FRandRange( 50.0f, 300.0f ), 0, bBarrelAlongX ? 0.0f : BarrelZ );
+
+			const float UniformScale = Random.FRandRange( 0.5f, 2.0f );
+			const FVector3 ActorScale = bUniformScale
+				? FVector3( UniformScale, UniformScale, UniformScale )
+				: FVector3( Random.FRandRange( 0.5f, 2.0f ), Random.FRandRange( 0.5f, 2.0f ), Random.FRandRange( 0.5f, 2.0f ) );
+
+			const TurretRotationCore::TAimGeometry<float> Geometry = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale );
+			Out_Inputs.Geometries.Add( Geometry );
+
+			if ( ( Index % 8 ) == 0 )
+			{
+				const TurretRotationCore::TVector2<float>& BarrelStart = Geometry.GetBarrelStartLocation2D();
+				switch ( ( Index / 8 ) % 3 )
+				{
+				case 0:		Out_Inputs.Targets_InAimJointSpace.Add( FVector3( 0, 0, 0 ) ); break;
+				case 1:		Out_Inputs.Targets_InAimJointSpace.Add( FVector3( 0, 0, Random.FRandRange( -1000.0f, 1000.0f ) ) ); break;
+				default:	Out_Inputs.Targets_InAimJointSpace.Add( FVector3( BarrelStart.X + 1.0f, 0, BarrelStart.Y ) ); break;
+				}
+			}
+			else
+			{
+				const FVector Direction = Random.VRand();
+				const float Distance = FMath::Pow( 10.0f, Random.FRandRange( 1.0f, 5.0f ) );
+				Out_Inputs.Targets_InAimJointSpace.Add( FVector3( Direction.X * Distance, Direction.Y * Distance, Direction.Z * Distance ) );
+			}
+		}
+	}
+
+	/** @return Returns the average cost of one solve through SolveWithKernel (the same way FTurretAimGeometry::Solve does it), in nanoseconds. */
+	static double RunKernelTiming( const TBenchmarkInputs<float>& Inputs, TurretRotationCore::EAimKernel Kernel, TurretRotationCore::EAimAccuracy Accuracy, int32 NumRepeats )
+	{
+		const int32 NumTurrets = Inputs.Geometries.Num();
+		float Checksum = 0.0f;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int32 Index = 0; Index < NumTurrets; ++Index )
+			{
+				const TurretRotationCore::TAimAngles<float> Angles = TurretRotationCore::SolveWithKernel( Kernel, Inputs.Geometries[Index], Inputs.Targets_InAimJointSpace[Index], Accuracy );
+				Checksum += Angles.Pitch + Angles.Yaw;
+			}
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), Checksum );
+
+		return ( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTurrets * NumRepeats );
+	}
+
+	/**
+	 * Times one specialized kernel against the general solve.  That the kernel matches the general solve (and that ChooseAimKernel picks
+	 * it) is checked by the Kernels tests in Source/TurretRotationStandalone.
+	 */
+	static void RunKernelBenchmark( TurretRotationCore::EAimKernel Kernel, int32 NumTurrets )
+	{
+		FRandomStream Random( 1357 );
+		TBenchmarkInputs<float> TimingInputs;
+		MakeKernelInputs( Kernel, true, NumTurrets, Random, TimingInputs );
+
+		const int32 NumRepeats = 1000;
+		const double ExactReferenceNs = RunKernelTiming( TimingInputs, TurretRotationCore::EAimKernel::Reference, TurretRotationCore::EAimAccuracy::Exact, NumRepeats );
+		const double ExactKernelNs = RunKernelTiming( TimingInputs, Kernel, TurretRotationCore::EAimAccuracy::Exact, NumRepeats );
+		const double FastReferenceNs = RunKernelTiming( TimingInputs, TurretRotationCore::EAimKernel::Reference, TurretRotationCore::EAimAccuracy::Fast, NumRepeats );
+		const double FastKernelNs = RunKernelTiming( TimingInputs, Kernel, TurretRotationCore::EAimAccuracy::Fast, NumRepeats );
+
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] Exact: %.1f -> %.1f ns/solve (%.2fx), Fast: %.1f -> %.1f ns/solve (%.2fx)" ),
+			ANSI_TO_TCHAR( TurretRotationCore::GetAimKernelName( Kernel ) ),
+			ExactReferenceNs, ExactKernelNs, ExactReferenceNs / FMath::Max( ExactKernelNs, 1.e-3 ),
+			FastReferenceNs, FastKernelNs, FastReferenceNs / FMath::Max( FastKernelNs, 1.e-3 ) );
+	}
+
+	static void BenchmarkKernels( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 1024;
+
+		RunKernelBenchmark( TurretRotationCore::EAimKernel::AnyBarrel, NumTurrets );
+		RunKernelBenchmark( TurretRotationCore::EAimKernel::AnyBarrel_NoOffset, NumTurrets );
+		RunKernelBenchmark( TurretRotationCore::EAimKernel::BarrelAlongX, NumTurrets );
+		RunKernelBenchmark( TurretRotationCore::EAimKernel::BarrelAlongX_NoOffset, NumTurrets );
+	}
+
+	static FAutoConsoleCommand BenchmarkKernelsCommand(
+		TEXT( "TurretRotation.Bench.Kernels" ),
+		TEXT( "Times every specialized solver kernel against the general solve (the standalone tests check that they match).  Usage: TurretRotation.Bench.Kernels [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkKernels ) );
+
+	/**
+	 * Times FTurretRotationBatchKernel (on VectorRegister) against the general scalar solve, on the same turrets and at the same accuracy.
+	 * That the two match within TURRET_BATCH_TOLERANCE_DEGREES is checked by the Batch tests in Source/TurretRotationStandalone.
+	 */
+	static void RunBatchBenchmark( const TBenchmarkInputs<float>& Inputs, TurretRotationCore::EAimAccuracy Accuracy, const TCHAR* AccuracyName )
+	{
+		const int32 NumTurrets = Inputs.Geometries.Num();
+		const int32 NumRepeats = 1000;
+
+		FTurretRotationBatchScratch Scratch;
+		Scratch.Reset( NumTurrets );
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const TurretRotationCore::TAimGeometry<float>& Geometry = Inputs.Geometries[Index];
+			const TurretRotationCore::TVector3<float>& Target = Inputs.Targets_InAimJointSpace[Index];
+			Scratch.SetTurret( Index,
+				FVector( Geometry.GetBarrelStartLocation2D().X, 0.0f, Geometry.GetBarrelStartLocation2D().Y ),
+				FVector( Geometry.GetBarrelEndLocation2D().X, 0.0f, Geometry.GetBarrelEndLocation2D().Y ),
+				FVector( Target.X, Target.Y, Target.Z ) );
+		}
+
+		FTurretSolveSettings SolveSettings;
+		SolveSettings.Accuracy = Accuracy;
+
+		const double ScalarNs = RunKernelTiming( Inputs, TurretRotationCore::EAimKernel::Reference, Accuracy, NumRepeats );
+
+		float Checksum = 0.0f;
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			FTurretRotationBatchKernel::Solve( Scratch, SolveSettings );
+			Checksum += Scratch.Yaw[Repeat % NumTurrets] + Scratch.Pitch[Repeat % NumTurrets];
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), Checksum );
+
+		const double BatchNs = ( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTurrets * NumRepeats );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] Scalar: %.1f ns/solve, Batch: %.1f ns/solve (%.2fx)" ),
+			AccuracyName, ScalarNs, BatchNs, ScalarNs / FMath::Max( BatchNs, 1.e-3 ) );
+	}
+
+	static void BenchmarkBatch( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 1024;
+
+		FRandomStream Random( 1234 );
+		TBenchmarkInputs<float> TimingInputs;
+		MakeTypicalInputs( NumTurrets, Random, TimingInputs );
+
+		RunBatchBenchmark( TimingInputs, TurretRotationCore::EAimAccuracy::Exact, TEXT( "Exact" ) );
+		RunBatchBenchmark( TimingInputs, TurretRotationCore::EAimAccuracy::Fast, TEXT( "Fast" ) );
+		RunBatchBenchmark( TimingInputs, TurretRotationCore::EAimAccuracy::Approximate, TEXT( "Approximate" ) );
+	}
+
+	static FAutoConsoleCommand BenchmarkBatchCommand(
+		TEXT( "TurretRotation.Bench.Batch" ),
+		TEXT( "Times the SIMD batched solve against the scalar solve at every TurretRotation.Accuracy (the standalone tests check that they match).  Usage: TurretRotation.Bench.Batch [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkBatch ) );
+
+	/**
+	 * Measures the ballistic solve for one arc, and how many iterations it needed.  That its projectiles hit their targets is checked by
+	 * the Ballistics tests in Source/TurretRotationStandalone.
+	 */
+	static void RunBallisticBenchmark( const TBenchmarkInputs<float>& Inputs, bool bHighArc )
+	{
+		typedef TBenchmarkInputs<float>::FVector3 FVector3;
+
+		const int32 NumTurrets = Inputs.Geometries.Num();
+		FRandomStream Random( 4321 );
+
+		TArray<FVector3> TargetVelocities;
+		TargetVelocities.Reserve( NumTurrets );
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			TargetVelocities.Add( FVector3( Random.FRandRange( -600.0f, 600.0f ), Random.FRandRange( -600.0f, 600.0f ), Random.FRandRange( -50.0f, 50.0f ) ) );
+		}
+
+		TurretRotationCore::TBallisticSettings<float> Settings;
+		Settings.MuzzleSpeed = 8000.0f;
+		Settings.Gravity = FVector3( 0.0f, 0.0f, -980.0f );
+		Settings.bHighArc = bHighArc;
+
+		const FVector3 NoAcceleration( 0.0f, 0.0f, 0.0f );
+		int64 NumIterations = 0;
+		int32 NumSolutions = 0;
+		float Checksum = 0.0f;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const TurretRotationCore::TBallisticSolution<float> Solution = TurretRotationCore::SolveBallistic(
+				Inputs.Geometries[Index], Inputs.Targets_InAimJointSpace[Index], TargetVelocities[Index], NoAcceleration, Settings );
+
+			NumIterations += Solution.NumIterations;
+			NumSolutions += Solution.bHasSolution ? 1 : 0;
+			Checksum += Solution.Angles.Pitch + Solution.Angles.Yaw;
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), Checksum );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s arc] %.1f ns/solve, %.2f iterations/solve, %d/%d with a solution" ),
+			bHighArc ? TEXT( "High" ) : TEXT( "Low" ),
+			( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTurrets ),
+			double( NumIterations ) / FMath::Max( 1, NumTurrets ),
+			NumSolutions,
+			NumTurrets );
+	}
+
+	static void BenchmarkBallistic( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 100000;
+
+		FRandomStream Random( 1234 );
+		TBenchmarkInputs<float> Inputs;
+		MakeTypicalInputs( NumTurrets, Random, Inputs );
+
+		RunBallisticBenchmark( Inputs, /*bHighArc*/ false );
+		RunBallisticBenchmark( Inputs, /*bHighArc*/ true );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[Plain solve] %.1f ns/solve" ), RunSolveBenchmark( Inputs, 1 ) );
+	}
+
+	static FAutoConsoleCommand BenchmarkBallisticCommand(
+		TEXT( "TurretRotation.Bench.Ballistic" ),
+		TEXT( "Measures the cost of the ballistic (lead aim) solve against the plain solve.  Usage: TurretRotation.Bench.Ballistic [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkBallistic ) );
+
+	/**
+	 * Times target acquisition with FTurretTargetGrid against checking every target, and makes sure both pick the same targets.
+	 * The turrets and targets are spread over a 200m x 200m area (so the density goes up with the counts), and every turret has a 50m
+	 * range and a random arc.
+	 */
+	static void RunAcquireBenchmark( int32 NumTurrets, int32 NumTargets )
+	{
+		FRandomStream Random( 1234 );
+		const float MapHalfSize = 10000.0f;
+
+		auto RandomLocation = [&Random, MapHalfSize]()
+		{
+			return FVector( Random.FRandRange( -MapHalfSize, MapHalfSize ), Random.FRandRange( -MapHalfSize, MapHalfSize ), Random.FRandRange( 0.0f, 500.0f ) );
+		};
+
+		TArray<FVector> TargetLocations;
+		for ( int32 Index = 0; Index < NumTargets; ++Index )
+		{
+			TargetLocations.Add( RandomLocation() );
+		}
+
+		TArray<FTurretTargetQuery> Queries;
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			FTurretTargetQuery Query;
+			Query.Origin = RandomLocation();
+			Query.Forward = FVector( Random.FRandRange( -1.0f, 1.0f ), Random.FRandRange( -1.0f, 1.0f ), 0.0f );
+			Query.MinRange = 200.0f;
+			Query.MaxRange = 5000.0f;
+			Query.HalfArcDegrees = Random.FRandRange( 30.0f, 180.0f );
+			Queries.Add( Query );
+		}
+
+		FTurretTargetGrid Grid( 1000.0f );
+
+		double StartTime = FPlatformTime::Seconds();
+		for ( const FVector& Location : TargetLocations )
+		{
+			Grid.AddTarget( Location );
+		}
+		const double BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Every target moves a little, like it would during a frame.  Only some of them cross into a different cell.
+		StartTime = FPlatformTime::Seconds();
+		for ( int32 Handle = 0; Handle < NumTargets; ++Handle )
+		{
+			TargetLocations[Handle] += FVector( Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ), 0.0f );
+			Grid.UpdateTarget( Handle, TargetLocations[Handle] );
+		}
+		const double UpdateSeconds = FPlatformTime::Seconds() - StartTime;
+
+		TArray<int32> GridResults;
+		GridResults.SetNumUninitialized( NumTurrets );
+
+		StartTime = FPlatformTime::Seconds();
+		Grid.FindNearestTargets( Queries, GridResults, /*bForceSingleThread*/ true );
+		const double GridSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		Grid.FindNearestTargets( Queries, GridResults, /*bForceSingleThread*/ false );
+		const double ParallelGridSeconds = FPlatformTime::Seconds() - StartTime;
+
+		TArray<int32> BruteForceResults;
+		BruteForceResults.SetNumUninitialized( NumTurrets );
+
+		StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			BruteForceResults[Index] = Grid.FindNearestTarget_BruteForce( Queries[Index] );
+		}
+		const double BruteForceSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Ties (two targets at exactly the same distance) could pick different targets, so compare distances instead of handles.
+		int32 NumMismatches = 0;
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const int32 GridResult = GridResults[Index];
+			const int32 BruteForceResult = BruteForceResults[Index];
+			if ( GridResult == BruteForceResult )
+			{
+				continue;
+			}
+
+			const bool bBothFound = GridResult != INDEX_NONE && BruteForceResult != INDEX_NONE;
+			if ( !bBothFound || !FMath::IsNearlyEqual(
+				FVector::DistSquared( Grid.GetTargetLocation( GridResult ), Queries[Index].Origin ),
+				FVector::DistSquared( Grid.GetTargetLocation( BruteForceResult ), Queries[Index].Origin ) ) )
+			{
+				++NumMismatches;
+			}
+		}
+
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%d turrets x %d targets] Build: %.3f ms, Update: %.3f ms" ), NumTurrets, NumTargets, BuildSeconds * 1000.0, UpdateSeconds * 1000.0 );
+		UE_LOG( LogTurretRotation, Display, TEXT( "    Grid: %.3f ms (%.3f ms with ParallelFor), Brute force: %.3f ms, Speedup: %.1fx, Mismatches: %d" ),
+			GridSeconds * 1000.0,
+			ParallelGridSeconds * 1000.0,
+			BruteForceSeconds * 1000.0,
+			BruteForceSeconds / FMath::Max( GridSeconds, 1.e-9 ),
+			NumMismatches );
+	}
+
+	static void BenchmarkAcquire( const TArray<FString>& Args )
+	{
+		if ( Args.Num() >= 2 )
+		{
+			RunAcquireBenchmark( FMath::Max( 1, FCString::Atoi( *Args[0] ) ), FMath::Max( 1, FCString::Atoi( *Args[1] ) ) );
+			return;
+		}
+
+		RunAcquireBenchmark( 1000, 1000 );
+		RunAcquireBenchmark( 5000, 5000 );
+	}
+
+	static FAutoConsoleCommand BenchmarkAcquireCommand(
+		TEXT( "TurretRotation.Bench.Acquire" ),
+		TEXT( "Measures target acquisition with FTurretTargetGrid against brute force, at 1k x 1k and 5k x 5k by default.  Usage: TurretRotation.Bench.Acquire [NumTurrets NumTargets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkAcquire ) );
+
+	/** One recorded frame: every turret's ID and exact aim, in ID order. */
+	struct FRecordedAimFrame
+	{
+		TArray<uint32> TurretIds;
+		TArray<TurretRotationCore::TAimAngles<double>> Angles;
+	};
+
+	/**
+	 * Records a few seconds of turrets aiming at 30 Hz: a quarter of them have a target that doesn't move, half track targets driving
+	 * past at up to 15 m/s, and a quarter sit on something that's turning.  Every frame, a few turrets are destroyed and replaced by
+	 * new ones (with new IDs).
+	 */
+	static void RecordAimSequence( int32 NumTurrets, int32 NumFrames, TArray<FRecordedAimFrame>& Out_Frames )
+	{
+		typedef TurretRotationCore::TVector3<double> FVector3;
+
+		struct FRecordedTurret
+		{
+			uint32 Id;
+			TurretRotationCore::TAimGeometry<double> Geometry;
+			FVector3 TargetLocation;
+			FVector3 TargetVelocity;
+			double YawRate;
+		};
+
+		FRandomStream Random( 1234 );
+		uint32 NextId = 1;
+
+		auto MakeTurret = [&Random, &NextId]()
+		{
+			FRecordedTurret Turret;
+			Turret.Id = NextId++;
+			Turret.Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors(
+				FVector3( Random.FRandRange( 0.0f, 50.0f ), 0, Random.FRandRange( -50.0f, 50.0f ) ),
+				FVector3( Random.FRandRange( 50.0f, 300.0f ), 0, Random.FRandRange( -20.0f, 20.0f ) ),
+				FVector3( 1, 1, 1 ) );
+
+			const float Direction = Random.FRandRange( -PI, PI );
+			const float Distance = Random.FRandRange( 1000.0f, 20000.0f );
+			Turret.TargetLocation = FVector3( FMath::Cos( Direction ) * Distance, FMath::Sin( Direction ) * Distance, Random.FRandRange( -500.0f, 2000.0f ) );
+			Turret.TargetVelocity = FVector3();
+			Turret.YawRate = 0.0;
+
+			const float Kind = Random.FRand();
+			if ( Kind >= 0.25f && Kind < 0.75f )
+			{
+				const float Heading = Random.FRandRange( -PI, PI );
+				const float Speed = Random.FRandRange( 100.0f, 1500.0f );
+				Turret.TargetVelocity = FVector3( FMath::Cos( Heading ) * Speed, FMath::Sin( Heading ) * Speed, 0 );
+			}
+			else if ( Kind >= 0.75f )
+			{
+				Turret.YawRate = FMath::DegreesToRadians( Random.FRandRange( 10.0f, 45.0f ) );
+			}
+			return Turret;
+		};
+
+		TArray<FRecordedTurret> Turrets;
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			Turrets.Add( MakeTurret() );
+		}
+
+		const double DeltaSeconds = 1.0 / 30.0;
+		for ( int32 Frame = 0; Frame < NumFrames; ++Frame )
+		{
+			for ( FRecordedTurret& Turret : Turrets )
+			{
+				if ( Random.FRand() < 0.002f )
+				{
+					Turret = MakeTurret();
+				}
+			}
+
+			// New turrets get higher IDs, so sort to keep the snapshot in ID order.
+			Turrets.Sort( []( const FRecordedTurret& A, const FRecordedTurret& B ) { return A.Id < B.Id; } );
+
+			FRecordedAimFrame& RecordedFrame = Out_Frames[Out_Frames.AddDefaulted()];
+			const double Time = Frame * DeltaSeconds;
+			for ( const FRecordedTurret& Turret : Turrets )
+			{
+				const FVector3 Target(
+					Turret.TargetLocation.X + ( Turret.TargetVelocity.X * Time ),
+					Turret.TargetLocation.Y + ( Turret.TargetVelocity.Y * Time ),
+					Turret.TargetLocation.Z );
+
+				// The turret turning one way is the same as the target going around it the other way.
+				const double Cos = std::cos( -Turret.YawRate * Time );
+				const double Sin = std::sin( -Turret.YawRate * Time );
+				const FVector3 Target_InAimJointSpace( ( Target.X * Cos ) - ( Target.Y * Sin ), ( Target.X * Sin ) + ( Target.Y * Cos ), Target.Z );
+
+				RecordedFrame.TurretIds.Add( Turret.Id );
+				RecordedFrame.Angles.Add( Turret.Geometry.Solve( Target_InAimJointSpace ) );
+			}
+		}
+	}
+
+	/**
+	 * Replays a recorded sequence through each way of replicating it, and counts the bits:
+	 *   FRotator		- Each turret's rotation as a compressed FRotator (35 bits), whenever it changed at all.
+	 *   NetState		- Each turret's FTurretAimNetState (Bits * 2 + 6), whenever its quantized aim changed.
+	 *   NetArray		- One FTurretAimNetArray update per frame, including the header, with a full snapshot every 150 frames.
+	 *
+	 * Each NetArray update is also read back (by a reader that only has what it read so far), to time the decode.  That the decode gives
+	 * back the exact same snapshot is checked by the Net tests in Source/TurretRotationStandalone.
+	 */
+	static void RunNetBenchmark( const TArray<FRecordedAimFrame>& Frames, int32 NumBits, int32 SmallDeltaBits )
+	{
+		const TurretRotationCore::FAimQuantization Quantization( NumBits, NumBits, SmallDeltaBits );
+		const int32 HeaderBits = 16 + 1 + 4 + 11;
+		const int32 FullSnapshotInterval = 150;
+
+		TMap<uint32, TurretRotationCore::TAimAngles<double>> LastAngles;
+		TMap<uint32, TurretRotationCore::FQuantizedAim> LastQuantizedAims;
+		TArray<TurretRotationCore::FAimSnapshotItem> SentItems;
+		TArray<TurretRotationCore::FAimSnapshotItem> ReceivedItems;
+
+		int64 RotatorBits = 0;
+		int64 NetStateBits = 0;
+		int64 NetArrayBits = 0;
+		double MaxErrorDegrees = 0.0;
+		double EncodeSeconds = 0.0;
+		double DecodeSeconds = 0.0;
+
+		for ( int32 FrameIndex = 0; FrameIndex < Frames.Num(); ++FrameIndex )
+		{
+			const FRecordedAimFrame& Frame = Frames[FrameIndex];
+
+			TArray<TurretRotationCore::FAimSnapshotItem> Items;
+			Items.Reserve( Frame.TurretIds.Num() );
+			for ( int32 Index = 0; Index < Frame.TurretIds.Num(); ++Index )
+			{
+				const uint32 Id = Frame.TurretIds[Index];
+				const TurretRotationCore::TAimAngles<double>& Angles = Frame.Angles[Index];
+				const TurretRotationCore::FQuantizedAim Aim = TurretRotationCore::QuantizeAim( Angles, Quantization );
+				Items.Add( TurretRotationCore::FAimSnapshotItem( Id, Aim ) );
+
+				const TurretRotationCore::TAimAngles<double> Dequantized = TurretRotationCore::DequantizeAim<double>( Aim, Quantization );
+				MaxErrorDegrees = FMath::Max( MaxErrorDegrees, double( FMath::Abs( FRotator::NormalizeAxis( float( Dequantized.Yaw - Angles.Yaw ) ) ) ) );
+				MaxErrorDegrees = FMath::Max( MaxErrorDegrees, double( FMath::Abs( FRotator::NormalizeAxis( float( Dequantized.Pitch - Angles.Pitch ) ) ) ) );
+
+				const TurretRotationCore::TAimAngles<double>* PreviousAngles = LastAngles.Find( Id );
+				if ( !PreviousAngles || float( PreviousAngles->Yaw ) != float( Angles.Yaw ) || float( PreviousAngles->Pitch ) != float( Angles.Pitch ) )
+				{
+					RotatorBits += 35;
+				}
+				LastAngles.Add( Id, Angles );
+
+				const TurretRotationCore::FQuantizedAim* PreviousAim = LastQuantizedAims.Find( Id );
+				if ( !PreviousAim || *PreviousAim != Aim )
+				{
+					NetStateBits += ( NumBits * 2 ) + 6;
+				}
+				LastQuantizedAims.Add( Id, Aim );
+			}
+
+			const bool bFullSnapshot = ( FrameIndex % FullSnapshotInterval ) == 0;
+			const TArray<TurretRotationCore::FAimSnapshotItem> NoItems;
+			const TArray<TurretRotationCore::FAimSnapshotItem>& BaseItems = bFullSnapshot ? NoItems : SentItems;
+
+			double StartTime = FPlatformTime::Seconds();
+			TurretRotationCore::TBitWriter<> Writer;
+			const int32 NumEntries = TurretRotationCore::WriteAimSnapshotDelta( Writer, BaseItems.GetData(), BaseItems.Num(), Items.GetData(), Items.Num(), Quantization );
+			EncodeSeconds += FPlatformTime::Seconds() - StartTime;
+
+			if ( NumEntries > 0 || bFullSnapshot )
+			{
+				NetArrayBits += HeaderBits + Writer.GetNumBits();
+			}
+
+			const TArray<TurretRotationCore::FAimSnapshotItem>& ReceiverBaseItems = bFullSnapshot ? NoItems : ReceivedItems;
+			TArray<TurretRotationCore::FAimSnapshotItem> DecodedItems;
+			DecodedItems.Reserve( Items.Num() );
+
+			StartTime = FPlatformTime::Seconds();
+			TurretRotationCore::TBitReader<> Reader( Writer.GetBytes(), Writer.GetNumBits() );
+			TurretRotationCore::ReadAimSnapshotDelta( Reader, ReceiverBaseItems.GetData(), ReceiverBaseItems.Num(), Quantization,
+				[&DecodedItems]( const TurretRotationCore::FAimSnapshotItem& Item ) { DecodedItems.Add( Item ); } );
+			DecodeSeconds += FPlatformTime::Seconds() - StartTime;
+
+			SentItems = MoveTemp( Items );
+			ReceivedItems = MoveTemp( DecodedItems );
+		}
+
+		const double Seconds = Frames.Num() / 30.0;
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%d bits, small deltas %d bits] Max error: %.4f degrees, FRotator: %.0f kbit/s, NetState: %.0f kbit/s, NetArray: %.0f kbit/s (%.1fx less than FRotator)" ),
+			NumBits,
+			SmallDeltaBits,
+			MaxErrorDegrees,
+			RotatorBits / Seconds / 1000.0,
+			NetStateBits / Seconds / 1000.0,
+			NetArrayBits / Seconds / 1000.0,
+			double( RotatorBits ) / FMath::Max<int64>( NetArrayBits, 1 ) );
+		UE_LOG( LogTurretRotation, Display, TEXT( "    Encode: %.3f ms/frame, Decode: %.3f ms/frame" ),
+			EncodeSeconds * 1000.0 / FMath::Max( 1, Frames.Num() ),
+			DecodeSeconds * 1000.0 / FMath::Max( 1, Frames.Num() ) );
+	}
+
+	static void BenchmarkNet( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 4000;
+
+		TArray<FRecordedAimFrame> Frames;
+		RecordAimSequence( NumTurrets, 300, Frames );
+
+		RunNetBenchmark( Frames, 10, 4 );
+		RunNetBenchmark( Frames, 12, 5 );
+		RunNetBenchmark( Frames, 14, 6 );
+		RunNetBenchmark( Frames, 16, 6 );
+	}
+
+	static FAutoConsoleCommand BenchmarkNetCommand(
+		TEXT( "TurretRotation.Bench.Net" ),
+		TEXT( "Measures the bandwidth of the quantized turret aim replication over a recorded sequence (10 seconds at 30 Hz), and times the encode/decode.  Usage: TurretRotation.Bench.Net [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkNet ) );
+
+	/**
+	 * Checks if the field and the brute force solve are allowed to disagree about a turret hitting a point: when the point is right at
+	 * one of the turret's limits (within AIM_COVERAGE_TOLERANCE_DEGREES of a pitch limit or of the yaw arc, or right at a range).
+	 */
+	static bool IsAtCoverageLimit( const FTurretCoverageTurret& Turret, const FVector& WorldLocation )
+	{
+		const FVector AimJointWorldLocation = Turret.ActorWorldTransform.TransformPosition( Turret.Geometry.GetActorToAimJoint() );
+		const FVector Target_InAimJointSpace = Turret.ActorWorldTransform.GetRotation().UnrotateVector( WorldLocation - AimJointWorldLocation );
+
+		float Pitch = 0.0f;
+		TurretRotationCore::TAimCoverage<float, FVector2D>::CanHit_Solve( Turret.Geometry.GetCore(), Turret.Limits, Target_InAimJointSpace, &Pitch );
+
+		const float Tolerance = AIM_COVERAGE_TOLERANCE_DEGREES;
+		const float Yaw = FMath::RadiansToDegrees( FMath::Atan2( Target_InAimJointSpace.Y, Target_InAimJointSpace.X ) );
+		const float Distance = Target_InAimJointSpace.Size();
+		const float RangeTolerance = FMath::Max( 1.0f, Distance * 1.e-4f );
+
+		return FMath::Abs( Pitch - Turret.Limits.MinPitchDegrees ) <= Tolerance
+			|| FMath::Abs( Pitch - Turret.Limits.MaxPitchDegrees ) <= Tolerance
+			|| ( Turret.Limits.HalfArcDegrees < 180.0f && FMath::Abs( FMath::Abs( Yaw ) - Turret.Limits.HalfArcDegrees ) <= Tolerance )
+			|| FMath::Abs( Distance - Turret.Limits.MinRange ) <= RangeTolerance
+			|| FMath::Abs( Distance - Turret.Limits.MaxRange ) <= RangeTolerance
+			|| FMath::Abs( Distance - Turret.Geometry.GetCore().GetMinimumTargetDistance() ) <= RangeTolerance;
+	}
+
+	/** @return Returns how many turrets are in one list but not the other, leaving out the ones that are allowed to disagree (see IsAtCoverageLimit). */
+	static int32 CountCoverageMismatches( const FTurretCoverageField& Field, const FVector& WorldLocation, const TArray<int32>& First, const TArray<int32>& Second )
+	{
+		int32 NumMismatches = 0;
+		for ( int32 Pass = 0; Pass < 2; ++Pass )
+		{
+			const TArray<int32>& Handles = ( Pass == 0 ) ? First : Second;
+			const TArray<int32>& Others = ( Pass == 0 ) ? Second : First;
+			for ( const int32 Handle : Handles )
+			{
+				if ( !Others.Contains( Handle ) && !IsAtCoverageLimit( Field.GetTurret( Handle ), WorldLocation ) )
+				{
+					++NumMismatches;
+				}
+			}
+		}
+		return NumMismatches;
+	}
+
+	/**
+	 * Turrets scattered over a map, about a tenth of them tilted (so their yaw arc isn't on the "X-Y" plane), with a mix of ranges, arcs,
+	 * and pitch limits.  Measures baking them, moving a tenth of them, and point queries against solving every turret, and checks
+	 * that regions reported as safe really are.  The Coverage tests in Source/TurretRotationStandalone assert the same two checks.
+	 */
+	static void RunCoverageBenchmark( int32 NumTurrets, int32 NumQueries )
+	{
+		FRandomStream Random( 19 );
+
+		// About the same number of turrets in reach of each point, no matter how many turrets there are.
+		const float MapHalfSize = 40000.0f * FMath::Sqrt( NumTurrets / 2000.0f );
+		auto RandomLocation = [&Random, MapHalfSize]( float MinZ, float MaxZ )
+		{
+			return FVector( Random.FRandRange( -MapHalfSize, MapHalfSize ), Random.FRandRange( -MapHalfSize, MapHalfSize ), Random.FRandRange( MinZ, MaxZ ) );
+		};
+
+		TArray<FTurretCoverageTurret> Turrets;
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const bool bTilted = Random.FRand() < 0.1f;
+			const FRotator Rotation( bTilted ? Random.FRandRange( -20.0f, 20.0f ) : 0.0f, Random.FRandRange( -180.0f, 180.0f ), bTilted ? Random.FRandRange( -20.0f, 20.0f ) : 0.0f );
+
+			FTurretCoverageTurret Turret;
+			Turret.ActorWorldTransform = FTransform( Rotation, RandomLocation( 0.0f, 300.0f ) );
+			Turret.Geometry = FTurretAimGeometry(
+				FVector( 0.0f, 0.0f, Random.FRandRange( 100.0f, 200.0f ) ),
+				FVector( Random.FRandRange( 0.0f, 50.0f ), 0.0f, Random.FRandRange( -50.0f, 50.0f ) ),
+				FVector( Random.FRandRange( 50.0f, 300.0f ), 0.0f, Random.FRandRange( -20.0f, 20.0f ) ),
+				FVector::OneVector );
+			Turret.Limits.MinRange = Random.FRandRange( 0.0f, 300.0f );
+			Turret.Limits.MaxRange = Random.FRandRange( 2000.0f, 6000.0f );
+			Turret.Limits.HalfArcDegrees = Random.FRand() < 0.25f ? 180.0f : Random.FRandRange( 30.0f, 170.0f );
+			if ( Random.FRand() < 0.75f )
+			{
+				Turret.Limits.MinPitchDegrees = Random.FRandRange( -30.0f, -5.0f );
+				Turret.Limits.MaxPitchDegrees = Random.FRandRange( 20.0f, 85.0f );
+			}
+			Turrets.Add( Turret );
+		}
+
+		TArray<FVector> QueryLocations;
+		for ( int32 Index = 0; Index < NumQueries; ++Index )
+		{
+			QueryLocations.Add( RandomLocation( -500.0f, 3000.0f ) );
+		}
+
+		TArray<int32> Handles;
+
+		FTurretCoverageField SingleThreadedField;
+		double StartTime = FPlatformTime::Seconds();
+		SingleThreadedField.AddTurrets( Turrets, Handles, /*bForceSingleThread*/ true );
+		const double BakeSeconds = FPlatformTime::Seconds() - StartTime;
+
+		FTurretCoverageField Field;
+		StartTime = FPlatformTime::Seconds();
+		Field.AddTurrets( Turrets, Handles, /*bForceSingleThread*/ false );
+		const double ParallelBakeSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// A tenth of the turrets drive somewhere else, and everything else stays put.
+		for ( int32 Index = 0; Index < NumTurrets; Index += 10 )
+		{
+			Turrets[Index].ActorWorldTransform.AddToTranslation( FVector( Random.FRandRange( -500.0f, 500.0f ), Random.FRandRange( -500.0f, 500.0f ), 0.0f ) );
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		const int32 NumMoved = Field.UpdateTurrets( Handles, Turrets );
+		const double MoveSeconds = FPlatformTime::Seconds() - StartTime;
+
+		TArray<TArray<int32>> FieldResults;
+		FieldResults.SetNum( NumQueries );
+
+		int32 NumHits = 0;
+		StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumQueries; ++Index )
+		{
+			Field.FindTurretsThatCanHit( QueryLocations[Index], FieldResults[Index] );
+			NumHits += FieldResults[Index].Num();
+		}
+		const double FieldSeconds = FPlatformTime::Seconds() - StartTime;
+
+		TArray<TArray<int32>> BruteForceResults;
+		BruteForceResults.SetNum( NumQueries );
+
+		StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumQueries; ++Index )
+		{
+			Field.FindTurretsThatCanHit_BruteForce( QueryLocations[Index], BruteForceResults[Index] );
+		}
+		const double BruteForceSeconds = FPlatformTime::Seconds() - StartTime;
+
+		int32 NumMismatches = 0;
+		for ( int32 Index = 0; Index < NumQueries; ++Index )
+		{
+			NumMismatches += CountCoverageMismatches( Field, QueryLocations[Index], FieldResults[Index], BruteForceResults[Index] );
+		}
+
+		// Every point in a region reported as safe has to be out of reach of every turret.
+		const int32 NumRegions = FMath::Max( 1, NumQueries / 10 );
+		const int32 NumSamplesPerRegion = 16;
+		int32 NumSafeRegions = 0;
+		int32 NumUnsafeSamples = 0;
+		double RegionSeconds = 0.0;
+		TArray<int32> SampleResults;
+		for ( int32 Index = 0; Index < NumRegions; ++Index )
+		{
+			const FVector Center = RandomLocation( 0.0f, 500.0f );
+			const FVector Extent( Random.FRandRange( 100.0f, 1500.0f ), Random.FRandRange( 100.0f, 1500.0f ), Random.FRandRange( 100.0f, 500.0f ) );
+			const FBox Region( Center - Extent, Center + Extent );
+
+			StartTime = FPlatformTime::Seconds();
+			const bool bSafe = Field.IsRegionSafe( Region );
+			RegionSeconds += FPlatformTime::Seconds() - StartTime;
+
+			if ( !bSafe )
+			{
+				continue;
+			}
+
+			++NumSafeRegions;
+			for ( int32 Sample = 0; Sample < NumSamplesPerRegion; ++Sample )
+			{
+				const FVector Location = FMath::RandPointInBox( Region );
+				Field.FindTurretsThatCanHit_BruteForce( Location, SampleResults );
+				NumUnsafeSamples += CountCoverageMismatches( Field, Location, SampleResults, TArray<int32>() );
+			}
+		}
+
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%d turrets x %d queries] Bake: %.3f ms (%.3f ms with ParallelFor), Move %d: %.3f ms" ),
+			NumTurrets, NumQueries, BakeSeconds * 1000.0, ParallelBakeSeconds * 1000.0, NumMoved, MoveSeconds * 1000.0 );
+		UE_LOG( LogTurretRotation, Display, TEXT( "    Field: %.1f ns/query (%.1f turrets hit each), Brute force: %.1f ns/query, Speedup: %.1fx, %s (%d mismatches)" ),
+			FieldSeconds * 1.e9 / NumQueries,
+			double( NumHits ) / NumQueries,
+			BruteForceSeconds * 1.e9 / NumQueries,
+			BruteForceSeconds / FMath::Max( FieldSeconds, 1.e-9 ),
+			NumMismatches == 0 ? TEXT( "passed" ) : TEXT( "FAILED" ),
+			NumMismatches );
+		UE_LOG( LogTurretRotation, Display, TEXT( "    Regions: %.1f ns/query, %d of %d safe, %s (%d reachable samples)" ),
+			RegionSeconds * 1.e9 / NumRegions,
+			NumSafeRegions,
+			NumRegions,
+			NumUnsafeSamples == 0 ? TEXT( "passed" ) : TEXT( "FAILED" ),
+			NumUnsafeSamples );
+	}
+
+	static void BenchmarkCoverage( const TArray<FString>& Args )
+	{
+		if ( Args.Num() >= 2 )
+		{
+			RunCoverageBenchmark( FMath::Max( 1, FCString::Atoi( *Args[0] ) ), FMath::Max( 1, FCString::Atoi( *Args[1] ) ) );
+			return;
+		}
+
+		RunCoverageBenchmark( 1000, 5000 );
+		RunCoverageBenchmark( 5000, 2000 );
+	}
+
+	static FAutoConsoleCommand BenchmarkCoverageCommand(
+		TEXT( "TurretRotation.Bench.Coverage" ),
+		TEXT( "Measures baking and querying FTurretCoverageField against solving every turret, at 1k turrets x 5k queries and 5k x 2k by default.  Usage: TurretRotation.Bench.Coverage [NumTurrets NumQueries]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkCoverage ) );
+
+	/** Times CalculateAimRates against the solve.  Its accuracy is checked by the standalone tests (the Rates group). */
+	static void RunRatesTimingBenchmark( int32 NumTurrets )
+	{
+		TBenchmarkInputs<float> Inputs;
+		FRandomStream Random( 1234 );
+		MakeTypicalInputs( NumTurrets, Random, Inputs );
+
+		TArray<TurretRotationCore::TVector3<float>> TargetVelocities;
+		TargetVelocities.Reserve( NumTurrets );
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			TargetVelocities.Add( TurretRotationCore::TVector3<float>( Random.FRandRange( -1500.0f, 1500.0f ), Random.FRandRange( -1500.0f, 1500.0f ), Random.FRandRange( -300.0f, 300.0f ) ) );
+		}
+
+		float Checksum = 0.0f;
+		const double StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			const TurretRotationCore::TAimAngles<float> Rates = TurretRotationCore::CalculateAimRates( Inputs.Geometries[Index], Inputs.Targets_InAimJointSpace[Index], TargetVelocities[Index] );
+			Checksum += Rates.Pitch + Rates.Yaw;
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		UE_LOG( LogTurretRotation, Verbose, TEXT( "Checksum: %f" ), Checksum );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[Rates] %.1f ns/rates (solve: %.1f ns/solve)" ),
+			( ( EndTime - StartTime ) * 1.e9 ) / FMath::Max( 1, NumTurrets ),
+			RunSolveBenchmark( Inputs, 1 ) );
+	}
+
+	/** How a simulated target moves in RunExtrapolationBenchmark. */
+	struct FSimulatedTarget
+	{
+		/** 0: straight line, 1: circling, 2: zig-zag (turning around every ZigZagSeconds). */
+		int32 Kind;
+		FVector Start;
+		FVector Velocity;
+		float CircleRadius;
+		float CircleRate;
+
+		void GetLocationAndVelocity( float Time, FVector& Out_Location, FVector& Out_Velocity ) const
+		{
+			const float ZigZagSeconds = 2.0f;
+
+			switch ( Kind )
+			{
+			case 1:
+				Out_Location = Start + FVector( FMath::Cos( CircleRate * Time ), FMath::Sin( CircleRate * Time ), 0.0f ) * CircleRadius;
+				Out_Velocity = FVector( -FMath::Sin( CircleRate * Time ), FMath::Cos( CircleRate * Time ), 0.0f ) * ( CircleRadius * CircleRate );
+				break;
+
+			case 2:
+			{
+				// Back and forth along the same line.
+				const float Phase = FMath::Fmod( Time, 2.0f * ZigZagSeconds );
+				const bool bForward = Phase < ZigZagSeconds;
+				Out_Location = Start + Velocity * ( bForward ? Phase : ( 2.0f * ZigZagSeconds - Phase ) );
+				Out_Velocity = bForward ? Velocity : -Velocity;
+				break;
+			}
+
+			default:
+				Out_Location = Start + Velocity * Time;
+				Out_Velocity = Velocity;
+				break;
+			}
+		}
+	};
+
+	/**
+	 * Simulates turrets tracking moving targets at 60 Hz for 10 seconds with FTurretAimExtrapolation, and compares every frame's aim
+	 * against solving every frame.  A third of the targets drive past in a straight line, a third circle at 10 to 60 m, and a third
+	 * zig-zag (so their velocity flips without warning).
+	 */
+	static void RunExtrapolationBenchmark( int32 NumTurrets, float MaxErrorDegrees, float MaxSeconds )
+	{
+		FRandomStream Random( 77 );
+
+		TArray<FTurretAimGeometry> Geometries;
+		TArray<FTransform> ActorWorldTransforms;
+		TArray<FSimulatedTarget> Targets;
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			Geometries.Add( FTurretAimGeometry(
+				FVector( 0.0f, 0.0f, 100.0f ),
+				FVector( Random.FRandRange( 0.0f, 50.0f ), 0.0f, Random.FRandRange( -50.0f, 50.0f ) ),
+				FVector( Random.FRandRange( 50.0f, 300.0f ), 0.0f, Random.FRandRange( -20.0f, 20.0f ) ) ) );
+			ActorWorldTransforms.Add( FTransform( FRotator( 0.0f, Random.FRandRange( -180.0f, 180.0f ), 0.0f ), FVector::ZeroVector ) );
+
+			FSimulatedTarget Target;
+			Target.Kind = Index % 3;
+			const float Heading = Random.FRandRange( -PI, PI );
+			const float Speed = Random.FRandRange( 300.0f, 2000.0f );
+			Target.Velocity = FVector( FMath::Cos( Heading ), FMath::Sin( Heading ), 0.0f ) * Speed;
+			Target.Start = FVector( Random.FRandRange( -8000.0f, 8000.0f ), Random.FRandRange( -8000.0f, 8000.0f ), Random.FRandRange( 0.0f, 1500.0f ) );
+			Target.CircleRadius = Random.FRandRange( 1000.0f, 6000.0f );
+			Target.CircleRate = Speed / Target.CircleRadius;
+			Targets.Add( Target );
+		}
+
+		TArray<FTurretAimExtrapolation> Extrapolations;
+		Extrapolations.SetNum( NumTurrets );
+
+		const int32 NumFrames = 600;
+		const float DeltaSeconds = 1.0f / 60.0f;
+		TArray<float> Errors;
+		Errors.Reserve( NumTurrets * NumFrames );
+		int64 NumSolves = 0;
+		double SolveSeconds = 0.0;
+		double ExtrapolateSeconds = 0.0;
+		const FTurretSolveSettings SolveSettings = FTurretAimGeometry::GetSolveSettings();
+
+		for ( int32 Frame = 0; Frame < NumFrames; ++Frame )
+		{
+			const float Time = Frame * DeltaSeconds;
+			for ( int32 Index = 0; Index < NumTurrets; ++Index )
+			{
+				FVector TargetWorldLocation;
+				FVector TargetVelocity;
+				Targets[Index].GetLocationAndVelocity( Time, TargetWorldLocation, TargetVelocity );
+
+				FRotator AimJointRotation;
+				double StartTime = FPlatformTime::Seconds();
+				const bool bExtrapolated = Extrapolations[Index].TryExtrapolate( Time, ActorWorldTransforms[Index], TargetWorldLocation, MaxErrorDegrees, MaxSeconds, /*out*/ AimJointRotation );
+				ExtrapolateSeconds += FPlatformTime::Seconds() - StartTime;
+
+				if ( !bExtrapolated )
+				{
+					StartTime = FPlatformTime::Seconds();
+					FTurretAimRates Rates;
+					AimJointRotation = Geometries[Index].SolveWithRatesForActor( ActorWorldTransforms[Index], TargetWorldLocation, TargetVelocity, MaxSeconds, /*out*/ Rates, SolveSettings );
+					Extrapolations[Index].RecordSolve( Time, ActorWorldTransforms[Index], TargetWorldLocation, TargetVelocity, AimJointRotation, Rates );
+					SolveSeconds += FPlatformTime::Seconds() - StartTime;
+					++NumSolves;
+				}
+
+				const FRotator Exact = Geometries[Index].SolveForActor( ActorWorldTransforms[Index], TargetWorldLocation, SolveSettings );
+				Errors.Add( FMath::Max( FMath::Abs( FRotator::NormalizeAxis( AimJointRotation.Yaw - Exact.Yaw ) ), FMath::Abs( AimJointRotation.Pitch - Exact.Pitch ) ) );
+			}
+		}
+
+		Errors.Sort();
+		const int64 NumAims = int64( NumTurrets ) * NumFrames;
+		UE_LOG( LogTurretRotation, Display, TEXT( "[Threshold %.2f degrees, %.2f s] Solved %.1f%% of aims (%.1fx fewer solves), error p50 %.4f, p99 %.4f, max %.4f degrees, %.3f ms/frame (solving every frame: ~%.3f ms/frame)" ),
+			MaxErrorDegrees,
+			MaxSeconds,
+			100.0 * NumSolves / FMath::Max<int64>( 1, NumAims ),
+			double( NumAims ) / FMath::Max<int64>( 1, NumSolves ),
+			Errors[Errors.Num() / 2],
+			Errors[( Errors.Num() * 99 ) / 100],
+			Errors.Last(),
+			( SolveSeconds + ExtrapolateSeconds ) * 1000.0 / NumFrames,
+			SolveSeconds * 1000.0 / FMath::Max<int64>( 1, NumSolves ) * NumTurrets );
+	}
+
+	static void BenchmarkRates( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 2000;
+
+		RunRatesTimingBenchmark( 100000 );
+
+		RunExtrapolationBenchmark( NumTurrets, 0.05f, 0.5f );
+		RunExtrapolationBenchmark( NumTurrets, 0.1f, 0.25f );
+		RunExtrapolationBenchmark( NumTurrets, 0.1f, 0.5f );
+		RunExtrapolationBenchmark( NumTurrets, 0.25f, 0.5f );
+	}
+
+	static FAutoConsoleCommand BenchmarkRatesCommand(
+		TEXT( "TurretRotation.Bench.Rates" ),
+		TEXT( "Times the analytic yaw/pitch rates, and measures how many solves FTurretAimExtrapolation saves (and the error it adds) for turrets tracking moving targets.  Usage: TurretRotation.Bench.Rates [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkRates ) );
+
+	typedef TurretRotationCore::TVector3<double> FChainVector;
+
+	/** One yaw ring/pitch/sub-barrel turret for RunChainBenchmark, and its target (in YawJoint space). */
+	struct FChainBenchmarkTurret
+	{
+		FChainVector YawJoint_To_PitchJoint;
+		FChainVector PitchJoint_To_BarrelStart;
+		FChainVector BarrelStart_To_BarrelEnd;
+		FChainVector PitchJoint_To_SubPitchJoint;
+		FChainVector SubPitchJoint_To_SubBarrelStart;
+		FChainVector SubBarrelStart_To_SubBarrelEnd;
+		FChainVector Target_InYawJointSpace;
+	};
+
+	static FChainVector AddChainVectors( const FChainVector& A, const FChainVector& B ) { return FChainVector( A.X + B.X, A.Y + B.Y, A.Z + B.Z ); }
+	static FChainVector SubtractChainVectors( const FChainVector& A, const FChainVector& B ) { return FChainVector( A.X - B.X, A.Y - B.Y, A.Z - B.Z ); }
+	static FChainVector ScaleChainVector( const FChainVector& A, double Scale ) { return FChainVector( A.X * Scale, A.Y * Scale, A.Z * Scale ); }
+	static double DotChainVectors( const FChainVector& A, const FChainVector& B ) { return ( A.X * B.X ) + ( A.Y * B.Y ) + ( A.Z * B.Z ); }
+	static FChainVector CrossChainVectors( const FChainVector& A, const FChainVector& B )
+	{
+		return FChainVector( ( A.Y * B.Z ) - ( A.Z * B.Y ), ( A.Z * B.X ) - ( A.X * B.Z ), ( A.X * B.Y ) - ( A.Y * B.X ) );
+	}
+
+	/** Yaw turns "X" towards "Y" (around "Z"). */
+	static FChainVector YawChainVector( const FChainVector& A, double YawDegrees )
+	{
+		const double Sin = std::sin( FMath::DegreesToRadians( YawDegrees ) );
+		const double Cos = std::cos( FMath::DegreesToRadians( YawDegrees ) );
+		return FChainVector( ( A.X * Cos ) - ( A.Y * Sin ), ( A.X * Sin ) + ( A.Y * Cos ), A.Z );
+	}
+
+	/** Pitch turns "X" towards "Z" (around "-Y"). */
+	static FChainVector PitchChainVector( const FChainVector& A, double PitchDegrees )
+	{
+		const double Sin = std::sin( FMath::DegreesToRadians( PitchDegrees ) );
+		const double Cos = std::cos( FMath::DegreesToRadians( PitchDegrees ) );
+		return FChainVector( ( A.X * Cos ) - ( A.Z * Sin ), A.Y, ( A.X * Sin ) + ( A.Z * Cos ) );
+	}
+
+	/** Forward kinematics: moves a point on the (pitched) PitchJoint into YawJoint space. */
+	static FChainVector PitchJointToYawJointSpace( const FChainBenchmarkTurret& Turret, const TurretRotationCore::TChainAngles<double>& Angles, const FChainVector& Point )
+	{
+		return YawChainVector( AddChainVectors( Turret.YawJoint_To_PitchJoint, PitchChainVector( Point, Angles.Pitch ) ), Angles.Yaw );
+	}
+
+	/** Forward kinematics: moves a point on the (pitched) SubPitchJoint into YawJoint space. */
+	static FChainVector SubPitchJointToYawJointSpace( const FChainBenchmarkTurret& Turret, const TurretRotationCore::TChainAngles<double>& Angles, const FChainVector& Point )
+	{
+		return PitchJointToYawJointSpace( Turret, Angles, AddChainVectors( Turret.PitchJoint_To_SubPitchJoint, PitchChainVector( Point, Angles.SubPitch ) ) );
+	}
+
+	/**
+	 * @param BarrelStart	The BarrelStart, in YawJoint space.
+	 * @param BarrelEnd		The BarrelEnd, in YawJoint space.
+	 * @param Target		The target, in YawJoint space.
+	 * @return Returns the point on the barrel's ray (from the BarrelStart, through the BarrelEnd, and on) closest to the target.
+	 */
+	static FChainVector CalculateClosestPointOnBarrel( const FChainVector& BarrelStart, const FChainVector& BarrelEnd, const FChainVector& Target )
+	{
+		const FChainVector BarrelRay = SubtractChainVectors( BarrelEnd, BarrelStart );
+		const double BarrelLengthSquared = FMath::Max( DotChainVectors( BarrelRay, BarrelRay ), 1.e-12 );
+		const double RayDistance = FMath::Max( DotChainVectors( SubtractChainVectors( Target, BarrelStart ), BarrelRay ) / BarrelLengthSquared, 0.0 );
+		return AddChainVectors( BarrelStart, ScaleChainVector( BarrelRay, RayDistance ) );
+	}
+
+	/** @return Returns how far the target is from the barrel's ray (0 means the barrel points straight at it). */
+	static double CalculateMissDistance( const FChainVector& BarrelStart, const FChainVector& BarrelEnd, const FChainVector& Target )
+	{
+		const FChainVector Miss = SubtractChainVectors( Target, CalculateClosestPointOnBarrel( BarrelStart, BarrelEnd, Target ) );
+		return std::sqrt( DotChainVectors( Miss, Miss ) );
+	}
+
+	/** @return Returns how far the target is from the barrel's ray, and from the sub-barrel's (if bSubBarrel), after posing the chain. */
+	static double CalculateChainMissDistance( const FChainBenchmarkTurret& Turret, const TurretRotationCore::TChainAngles<double>& Angles, bool bSubBarrel )
+	{
+		const FChainVector& Target = Turret.Target_InYawJointSpace;
+		double MissDistance = CalculateMissDistance(
+			PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_BarrelStart ),
+			PitchJointToYawJointSpace( Turret, Angles, AddChainVectors( Turret.PitchJoint_To_BarrelStart, Turret.BarrelStart_To_BarrelEnd ) ),
+			Target );
+
+		if ( bSubBarrel )
+		{
+			MissDistance = FMath::Max( MissDistance, CalculateMissDistance(
+				SubPitchJointToYawJointSpace( Turret, Angles, Turret.SubPitchJoint_To_SubBarrelStart ),
+				SubPitchJointToYawJointSpace( Turret, Angles, AddChainVectors( Turret.SubPitchJoint_To_SubBarrelStart, Turret.SubBarrelStart_To_SubBarrelEnd ) ),
+				Target ) );
+		}
+
+		return MissDistance;
+	}
+
+	/**
+	 * One CCD step: turns a joint around its axis so the direction from the joint to the effector lines up with the direction from the
+	 * joint to the target, as seen along the axis.
+	 *
+	 * @return Returns the angle (in degrees) to add to the joint.
+	 */
+	static double CalculateCCDStepDegrees( const FChainVector& JointLocation, const FChainVector& Axis, const FChainVector& Effector, const FChainVector& Target )
+	{
+		const FChainVector Joint_To_Effector = SubtractChainVectors( Effector, JointLocation );
+		const FChainVector Joint_To_Target = SubtractChainVectors( Target, JointLocation );
+		const FChainVector Effector_OnPlane = SubtractChainVectors( Joint_To_Effector, ScaleChainVector( Axis, DotChainVectors( Joint_To_Effector, Axis ) ) );
+		const FChainVector Target_OnPlane = SubtractChainVectors( Joint_To_Target, ScaleChainVector( Axis, DotChainVectors( Joint_To_Target, Axis ) ) );
+		return FMath::RadiansToDegrees( std::atan2( DotChainVectors( Axis, CrossChainVectors( Effector_OnPlane, Target_OnPlane ) ), DotChainVectors( Effector_OnPlane, Target_OnPlane ) ) );
+	}
+
+	/**
+	 * Reference solver: cyclic coordinate descent, the usual iterative IK for chains like this.  The effector of each barrel is the point
+	 * on its ray closest to the target, and every pass turns the joints from the end of the chain back to the YawJoint.  The pitches are
+	 * limited to +/- 90 degrees, like a real turret, or CCD happily flips the barrel over the top for targets behind it.
+	 *
+	 * @param Turret			The turret and its target.
+	 * @param bSubBarrel		If true, the sub-barrel is aimed too.
+	 * @param Tolerance			Stops once both barrels miss by less than this.
+	 * @param MaxIterations		Stops after this many passes, even if the barrels still miss.
+	 * @param Out_Iterations	OUT - The number of passes it took.
+	 * @return Returns the angles (in degrees) for each joint.
+	 */
+	static TurretRotationCore::TChainAngles<double> SolveChainCCD( const FChainBenchmarkTurret& Turret, bool bSubBarrel, double Tolerance, int32 MaxIterations, int32& Out_Iterations )
+	{
+		const FChainVector& Target = Turret.Target_InYawJointSpace;
+		const FChainVector BarrelEnd_InPitchJointSpace = AddChainVectors( Turret.PitchJoint_To_BarrelStart, Turret.BarrelStart_To_BarrelEnd );
+		const FChainVector SubBarrelEnd_InSubPitchJointSpace = AddChainVectors( Turret.SubPitchJoint_To_SubBarrelStart, Turret.SubBarrelStart_To_SubBarrelEnd );
+
+		// Start out facing the target, which is the usual warm start (and keeps CCD from getting stuck on the pitch limits).
+		TurretRotationCore::TChainAngles<double> Angles;
+		Angles.Yaw = FMath::RadiansToDegrees( std::atan2( Target.Y, Target.X ) );
+		Angles.Pitch = 0.0;
+		Angles.SubPitch = 0.0;
+
+		for ( Out_Iterations = 0; Out_Iterations < MaxIterations; ++Out_Iterations )
+		{
+			if ( CalculateChainMissDistance( Turret, Angles, bSubBarrel ) < Tolerance )
+			{
+				break;
+			}
+
+			// Pitching turns around "-Y" of the yawed turret, wherever the joint is.
+			const FChainVector PitchAxis = YawChainVector( FChainVector( 0.0, -1.0, 0.0 ), Angles.Yaw );
+
+			if ( bSubBarrel )
+			{
+				const FChainVector SubEffector = CalculateClosestPointOnBarrel(
+					SubPitchJointToYawJointSpace( Turret, Angles, Turret.SubPitchJoint_To_SubBarrelStart ),
+					SubPitchJointToYawJointSpace( Turret, Angles, SubBarrelEnd_InSubPitchJointSpace ),
+					Target );
+				Angles.SubPitch = FMath::Clamp( Angles.SubPitch + CalculateCCDStepDegrees( PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_SubPitchJoint ), PitchAxis, SubEffector, Target ), -90.0, 90.0 );
+			}
+
+			const FChainVector PitchEffector = CalculateClosestPointOnBarrel(
+				PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_BarrelStart ),
+				PitchJointToYawJointSpace( Turret, Angles, BarrelEnd_InPitchJointSpace ),
+				Target );
+			Angles.Pitch = FMath::Clamp( Angles.Pitch + CalculateCCDStepDegrees( YawChainVector( Turret.YawJoint_To_PitchJoint, Angles.Yaw ), PitchAxis, PitchEffector, Target ), -90.0, 90.0 );
+
+			const FChainVector YawEffector = CalculateClosestPointOnBarrel(
+				PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_BarrelStart ),
+				PitchJointToYawJointSpace( Turret, Angles, BarrelEnd_InPitchJointSpace ),
+				Target );
+			Angles.Yaw += CalculateCCDStepDegrees( FChainVector( 0.0, 0.0, 0.0 ), FChainVector( 0.0, 0.0, 1.0 ), YawEffector, Target );
+		}
+
+		return Angles;
+	}
+
+	/**
+	 * Vehicle-like turrets: a yaw ring with the PitchJoint up to half a meter up/forward and to the side of it, a barrel (also offset to the
+	 * side), and a sub-barrel on the side of the PitchJoint, at the same lateral offset as the barrel.  Targets are 10 to 300 meters away.
+	 */
+	static void MakeChainInputs( int32 NumTurrets, FRandomStream& Random, TArray<FChainBenchmarkTurret>& Out_Turrets )
+	{
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			FChainBenchmarkTurret Turret;
+			Turret.YawJoint_To_PitchJoint = FChainVector( Random.FRandRange( -50.0f, 50.0f ), Random.FRandRange( -40.0f, 40.0f ), Random.FRandRange( 20.0f, 60.0f ) );
+			Turret.PitchJoint_To_BarrelStart = FChainVector( Random.FRandRange( 10.0f, 60.0f ), Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ) );
+			Turret.BarrelStart_To_BarrelEnd = FChainVector( Random.FRandRange( 100.0f, 400.0f ), 0.0, Random.FRandRange( -10.0f, 10.0f ) );
+			Turret.PitchJoint_To_SubPitchJoint = FChainVector( Random.FRandRange( -20.0f, 20.0f ), Turret.PitchJoint_To_BarrelStart.Y, Random.FRandRange( -30.0f, 30.0f ) );
+			Turret.SubPitchJoint_To_SubBarrelStart = FChainVector( Random.FRandRange( 0.0f, 30.0f ), 0.0, Random.FRandRange( -10.0f, 10.0f ) );
+			Turret.SubBarrelStart_To_SubBarrelEnd = FChainVector( Random.FRandRange( 30.0f, 100.0f ), 0.0, Random.FRandRange( -5.0f, 5.0f ) );
+
+			const FVector Direction = Random.VRand();
+			const float Distance = Random.FRandRange( 1000.0f, 30000.0f );
+			Turret.Target_InYawJointSpace = FChainVector( Direction.X * Distance, Direction.Y * Distance, FMath::Abs( Direction.Z ) * Distance * 0.5f );
+
+			Out_Turrets.Add( Turret );
+		}
+	}
+
+	/** @return Returns the turret's chain, with or without its sub-barrel. */
+	static TurretRotationCore::TAimChain<double> MakeBenchmarkChain( const FChainBenchmarkTurret& Turret, bool bSubBarrel )
+	{
+		const FChainVector ActorScale( 1.0, 1.0, 1.0 );
+		TurretRotationCore::TAimChain<double> Chain = TurretRotationCore::TAimChain<double>::MakeFromActorVectors(
+			Turret.YawJoint_To_PitchJoint,
+			Turret.PitchJoint_To_BarrelStart,
+			Turret.BarrelStart_To_BarrelEnd,
+			ActorScale );
+
+		if ( bSubBarrel )
+		{
+			Chain.SetSubBarrel( Turret.PitchJoint_To_SubPitchJoint, Turret.SubPitchJoint_To_SubBarrelStart, Turret.SubBarrelStart_To_SubBarrelEnd, ActorScale );
+		}
+
+		return Chain;
+	}
+
+	/** Times TAimChain against SolveChainCCD.  Its accuracy is checked by the standalone tests (the Chain group). */
+	static void RunChainBenchmark( int32 NumTurrets, bool bSubBarrel )
+	{
+		FRandomStream Random( 2468 );
+		TArray<FChainBenchmarkTurret> Turrets;
+		MakeChainInputs( NumTurrets, Random, Turrets );
+
+		TArray<TurretRotationCore::TAimChain<double>> Chains;
+		Chains.Reserve( NumTurrets );
+		for ( const FChainBenchmarkTurret& Turret : Turrets )
+		{
+			Chains.Add( MakeBenchmarkChain( Turret, bSubBarrel ) );
+		}
+
+		// Closed form.
+		TArray<TurretRotationCore::TChainAngles<double>> ClosedFormAngles;
+		ClosedFormAngles.SetNum( NumTurrets );
+		int32 NumEdgeCases = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			unsigned int Events = 0;
+			ClosedFormAngles[Index] = Chains[Index].Solve( Turrets[Index].Target_InYawJointSpace, TurretRotationCore::EAimAccuracy::Exact, &Events );
+			NumEdgeCases += ( Events != 0 ) ? 1 : 0;
+		}
+		const double ClosedFormSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Reference IK.
+		const double Tolerance = 0.01;
+		const int32 MaxIterations = 100;
+		TArray<TurretRotationCore::TChainAngles<double>> CCDAngles;
+		TArray<int32> CCDIterations;
+		CCDAngles.SetNum( NumTurrets );
+		CCDIterations.SetNum( NumTurrets );
+		StartTime = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			CCDAngles[Index] = SolveChainCCD( Turrets[Index], bSubBarrel, Tolerance, MaxIterations, /*out*/ CCDIterations[Index] );
+		}
+		const double CCDSeconds = FPlatformTime::Seconds() - StartTime;
+
+		int32 NumConverged = 0;
+		int64 TotalIterations = 0;
+		for ( int32 Index = 0; Index < NumTurrets; ++Index )
+		{
+			TotalIterations += CCDIterations[Index];
+			NumConverged += ( CCDIterations[Index] < MaxIterations ) ? 1 : 0;
+		}
+
+		const double ClosedFormNanoseconds = ( ClosedFormSeconds * 1.e9 ) / FMath::Max( 1, NumTurrets );
+		const double CCDNanoseconds = ( CCDSeconds * 1.e9 ) / FMath::Max( 1, NumTurrets );
+		const TCHAR* ChainName = bSubBarrel ? TEXT( "Chain + SubBarrel" ) : TEXT( "Chain" );
+
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] Closed form: %.1f ns/solve (%d edge cases)" ),
+			ChainName,
+			ClosedFormNanoseconds,
+			NumEdgeCases );
+		UE_LOG( LogTurretRotation, Display, TEXT( "[%s] CCD (tolerance %.2f units): %.1f ns/solve (%.1fx the closed form), %.1f passes on average, %.1f%% converged" ),
+			ChainName,
+			Tolerance,
+			CCDNanoseconds,
+			CCDNanoseconds / FMath::Max( ClosedFormNanoseconds, 1.e-3 ),
+			double( TotalIterations ) / FMath::Max( 1, NumTurrets ),
+			100.0 * NumConverged / FMath::Max( 1, NumTurrets ) );
+	}
+
+	static void BenchmarkChain( const TArray<FString>& Args )
+	{
+		const int32 NumTurrets = Args.Num() > 0 ? FMath::Max( 1, FCString::Atoi( *Args[0] ) ) : 10000;
+
+		RunChainBenchmark( NumTurrets, false );
+		RunChainBenchmark( NumTurrets, true );
+	}
+
+	static FAutoConsoleCommand BenchmarkChainCommand(
+		TEXT( "TurretRotation.Bench.Chain" ),
+		TEXT( "Measures the closed form yaw ring/pitch/sub-barrel solve (TAimChain) against iterative CCD IK.  Usage: TurretRotation.Bench.Chain [NumTurrets]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkChain ) );
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+
+/**
+ * Closed form solve for turrets where the yaw and the pitch are separate joints, without any engine dependencies.
+ *
+ * The chain is a YawJoint (which only yaws, relative to the Actor), a PitchJoint offset from it (which only pitches, relative to the
+ * YawJoint), the barrel offset from the PitchJoint, and optionally a SubPitchJoint offset from the PitchJoint with its own sub-barrel
+ * (which only pitches, relative to the PitchJoint).  Each joint only turns around one axis, so each stage is solved on its own, in order:
+ *
+ * Yaw		- Pitching never moves anything sideways, so the barrel stays at the same lateral offset L (its Y, in YawJoint space) from
+ *			  the "X-Z" plane of the YawJoint.  The barrel can only pass through a target at horizontal distance r if the YawJoint turns
+ *			  the point ( sqrt( r^2 - L^2 ), L ) onto it, so
+ *			    Yaw = atan2( Ty, Tx ) - atan2( L, sqrt( r^2 - L^2 ) )
+ *			  which is done as one Atan2 by rotating ( Tx, Ty ) back by the second angle.  With L = 0, this is CalculateTurretYaw.
+ * Pitch	- Once yawed, the target is at ( sqrt( r^2 - L^2 ), Tz ) on the YawJoint's "X-Z" plane, which is the same problem as the single
+ *			  AimJoint, so TAimGeometry::SolvePitch (the quadratic) solves it with the PitchJoint as the AimJoint.
+ * SubPitch	- The sub target is moved onto the same plane, then into the (pitched) PitchJoint's frame, and TAimGeometry::SolvePitch solves
+ *			  the sub-barrel with the SubPitchJoint as the AimJoint.  The result is relative to the PitchJoint.
+ *
+ * With the YawJoint and PitchJoint at the same location, and no lateral offset, this is exactly TAimGeometry::Solve.
+ *
+ * Like TAimGeometry, the barrels are assumed to point along the "X-Z" plane (the Y of BarrelStart_To_BarrelEnd is ignored).  The
+ * sub-barrel's own lateral offset is ignored, since the yaw is already taken by the main barrel.
+ */
+namespace TurretRotationCore
+{
+	/** Yaw for the YawJoint (relative to the Actor), pitch for the PitchJoint (relative to the YawJoint), and pitch for the SubPitchJoint
+	 * (relative to the PitchJoint), in degrees. */
+	template<typename ScalarType>
+	struct TChainAngles
+	{
+		ScalarType Yaw;
+		ScalarType Pitch;
+		ScalarType SubPitch;
+	};
+
+	/**
+	 * Everything about a yaw ring/pitch/sub-barrel chain that doesn't depend on the target.
+	 * Positions are in YawJoint space (relative to the unrotated YawJoint), and already scaled by the Actor's scale.
+	 */
+	template<typename ScalarType, typename Vector2Type = TVector2<ScalarType>>
+	class TAimChain
+	{
+	public:
+		/** Makes a chain where every joint sits on top of the YawJoint.  Not very useful, but always valid. */
+		TAimChain()
+			: PitchJointLocation2D( 0, 0 )
+			, LateralOffset( 0 )
+			, LateralOffsetSquared( 0 )
+			, SubPitchJointLocation2D( 0, 0 )
+			, bHasSubBarrel( false )
+		{
+		}
+
+		/**
+		 * Makes the chain from the vectors given to CalculateTurretChainRotation_ForActor.
+		 *
+		 * @param YawJoint_To_PitchJoint		The vector from the YawJoint to the PitchJoint (when the Actor is not Rotated/Scaled).
+		 * @param PitchJoint_To_BarrelStart		The vector from the PitchJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+		 * @param BarrelStart_To_BarrelEnd		The vector from the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+		 * @param ActorScale					The Actor's scale.
+		 */
+		template<typename Vector3Type>
+		static TAimChain MakeFromActorVectors(
+			const Vector3Type& YawJoint_To_PitchJoint,
+			const Vector3Type& PitchJoint_To_BarrelStart,
+			const Vector3Type& BarrelStart_To_BarrelEnd,
+			const Vector3Type& ActorScale )
+		{
+			TAimChain Result;
+			Result.PitchJointLocation2D = Vector2Type( YawJoint_To_PitchJoint.X * ActorScale.X, YawJoint_To_PitchJoint.Z * ActorScale.Z );
+
+			// Pitching turns around "Y", so it can't change how far the barrel is to the side of the YawJoint.
+			Result.LateralOffset = ScalarType( ( YawJoint_To_PitchJoint.Y + PitchJoint_To_BarrelStart.Y ) * ActorScale.Y );
+			Result.LateralOffsetSquared = Result.LateralOffset * Result.LateralOffset;
+
+			// In PitchJoint space, the PitchJoint is the AimJoint of a regular single joint turret.
+			Result.PitchGeometry = TAimGeometry<ScalarType, Vector2Type>::MakeFromActorVectors( PitchJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale );
+			return Result;
+		}
+
+		/**
+		 * Adds a sub-barrel (a secondary weapon that pitches on its own, on top of the PitchJoint).
+		 *
+		 * @param PitchJoint_To_SubPitchJoint			The vector from the PitchJoint to the SubPitchJoint (when the Actor is not Rotated/Scaled).
+		 * @param SubPitchJoint_To_SubBarrelStart		The vector from the SubPitchJoint to the SubBarrelStart (when the Actor is not Rotated/Scaled).
+		 * @param SubBarrelStart_To_SubBarrelEnd		The vector from the SubBarrelStart to the SubBarrelEnd (when the Actor is not Rotated/Scaled).
+		 * @param ActorScale							The Actor's scale.
+		 */
+		template<typename Vector3Type>
+		void SetSubBarrel(
+			const Vector3Type& PitchJoint_To_SubPitchJoint,
+			const Vector3Type& SubPitchJoint_To_SubBarrelStart,
+			const Vector3Type& SubBarrelStart_To_SubBarrelEnd,
+			const Vector3Type& ActorScale )
+		{
+			SubPitchJointLocation2D = Vector2Type( PitchJoint_To_SubPitchJoint.X * ActorScale.X, PitchJoint_To_SubPitchJoint.Z * ActorScale.Z );
+			SubPitchGeometry = TAimGeometry<ScalarType, Vector2Type>::MakeFromActorVectors( SubPitchJoint_To_SubBarrelStart, SubBarrelStart_To_SubBarrelEnd, ActorScale );
+			bHasSubBarrel = true;
+		}
+
+		/**
+		 * Calculates the yaw/pitch/sub-pitch so the barrel points at the target, and the sub-barrel (if any) points at the sub target.
+		 *
+		 * @param Target_InYawJointSpace		The target's location relative to the (unrotated) YawJoint.
+		 * @param SubTarget_InYawJointSpace		The sub-barrel's target location relative to the (unrotated) YawJoint.  Ignored without a sub-barrel.
+		 * @param Accuracy						How accurately to do the trig.
+		 * @param Out_Events					OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns the angles (in degrees) for each joint.  SubPitch is 0 without a sub-barrel.
+		 */
+		template<typename Vector3Type>
+		TChainAngles<ScalarType> Solve(
+			const Vector3Type& Target_InYawJointSpace,
+			const Vector3Type& SubTarget_InYawJointSpace,
+			EAimAccuracy Accuracy = EAimAccuracy::Exact,
+			unsigned int* Out_Events = nullptr ) const
+		{
+			const ScalarType TargetX = ScalarType( Target_InYawJointSpace.X );
+			const ScalarType TargetY = ScalarType( Target_InYawJointSpace.Y );
+			const ScalarType TargetZ = ScalarType( Target_InYawJointSpace.Z );
+
+			TChainAngles<ScalarType> Result;
+			Result.SubPitch = 0;
+
+			// Yaw stage.  Where the barrel crosses the target's circle around the YawJoint, once the YawJoint is turned.
+			const ScalarType HorizontalDistanceSquared = ( TargetX * TargetX ) + ( TargetY * TargetY );
+			ScalarType AlignedX;
+			if ( HorizontalDistanceSquared > LateralOffsetSquared )
+			{
+				AlignedX = std::sqrt( HorizontalDistanceSquared - LateralOffsetSquared );
+			}
+			else
+			{
+				// Inside the circle that the barrel sweeps, so no yaw can reach the target.  Get as close as possible, which is turning
+				// the barrel's closest point towards it.
+				AlignedX = 0;
+				if ( LateralOffset != 0 && Out_Events )
+				{
+					*Out_Events |= EAimSolveEvent::TargetClamped;
+				}
+			}
+
+			// ( Cos(Yaw), Sin(Yaw) ) * r^2 is ( Tx, Ty ) rotated back by the angle of ( AlignedX, L ), which is a complex multiply by its conjugate.
+			const ScalarType CosYaw_Scaled = ( TargetX * AlignedX ) + ( TargetY * LateralOffset );
+			const ScalarType SinYaw_Scaled = ( TargetY * AlignedX ) - ( TargetX * LateralOffset );
+			Result.Yaw = Atan2( SinYaw_Scaled, CosYaw_Scaled, Accuracy ) * TConstants<ScalarType>::RadiansToDegrees();
+
+			// Pitch stage.  Same as the single AimJoint, with the PitchJoint as the AimJoint.
+			const Vector2Type Target_InPitchJointSpace2D = Vector2Type( AlignedX - PitchJointLocation2D.X, TargetZ - PitchJointLocation2D.Y );
+			if ( !bHasSubBarrel )
+			{
+				Result.Pitch = PitchGeometry.SolvePitch( Target_InPitchJointSpace2D, Accuracy, Out_Events );
+				return Result;
+			}
+
+			// The sub-barrel needs the sine/cosine of the pitch too, so use the same vectors for both.
+			ScalarType SinPitch = 0;
+			ScalarType CosPitch = 1;
+			Vector2Type PitchJoint_To_ScaledBarrelEnd;
+			Vector2Type PitchJoint_To_Target;
+			if ( PitchGeometry.CalculatePitchVectors( Target_InPitchJointSpace2D, /*out*/ PitchJoint_To_ScaledBarrelEnd, /*out*/ PitchJoint_To_Target, Out_Events ) )
+			{
+				Result.Pitch = CalculateAngleToRotateFromFirstVectorToSecondVector( PitchJoint_To_ScaledBarrelEnd, PitchJoint_To_Target, Accuracy );
+				CalculateSinCosToRotateFromFirstVectorToSecondVector( PitchJoint_To_ScaledBarrelEnd, PitchJoint_To_Target, /*out*/ SinPitch, /*out*/ CosPitch );
+			}
+			else
+			{
+				Result.Pitch = 0;
+			}
+
+			// SubPitch stage.  Un-yaw the sub target onto the YawJoint's "X-Z" plane (dropping whatever is left to the side of it), then
+			// un-pitch it into PitchJoint space.
+			const ScalarType SubTargetX = ScalarType( SubTarget_InYawJointSpace.X );
+			const ScalarType SubTargetY = ScalarType( SubTarget_InYawJointSpace.Y );
+			const ScalarType SubTargetZ = ScalarType( SubTarget_InYawJointSpace.Z );
+
+			ScalarType CosYaw = 1;
+			ScalarType SinYaw = 0;
+			const ScalarType YawScale = ( CosYaw_Scaled * CosYaw_Scaled ) + ( SinYaw_Scaled * SinYaw_Scaled );
+			if ( YawScale > TConstants<ScalarType>::SmallNumber() )
+			{
+				const ScalarType InverseYawScale = 1 / std::sqrt( YawScale );
+				CosYaw = CosYaw_Scaled * InverseYawScale;
+				SinYaw = SinYaw_Scaled * InverseYawScale;
+			}
+
+			const ScalarType SubX_InPitchJointSpace = ( ( SubTargetX * CosYaw ) + ( SubTargetY * SinYaw ) ) - PitchJointLocation2D.X;
+			const ScalarType SubZ_InPitchJointSpace = SubTargetZ - PitchJointLocation2D.Y;
+
+			// A positive pitch turns "X" towards "Z", so un-pitching turns the other way.
+			const Vector2Type SubTarget_InSubPitchJointSpace2D = Vector2Type(
+				( ( SubX_InPitchJointSpace * CosPitch ) + ( SubZ_InPitchJointSpace * SinPitch ) ) - SubPitchJointLocation2D.X,
+				( ( SubZ_InPitchJointSpace * CosPitch ) - ( SubX_InPitchJointSpace * SinPitch ) ) - SubPitchJointLocation2D.Y );
+
+			Result.SubPitch = SubPitchGeometry.SolvePitch( SubTarget_InSubPitchJointSpace2D, Accuracy, Out_Events );
+			return Result;
+		}
+
+		/** Same as Solve, with the sub-barrel (if any) aiming at the same target as the barrel. */
+		template<typename Vector3Type>
+		TChainAngles<ScalarType> Solve( const Vector3Type& Target_InYawJointSpace, EAimAccuracy Accuracy = EAimAccuracy::Exact, unsigned int* Out_Events = nullptr ) const
+		{
+			return Solve( Target_InYawJointSpace, Target_InYawJointSpace, Accuracy, Out_Events );
+		}
+
+		const Vector2Type& GetPitchJointLocation2D() const { return PitchJointLocation2D; }
+		ScalarType GetLateralOffset() const { return LateralOffset; }
+		const TAimGeometry<ScalarType, Vector2Type>& GetPitchGeometry() const { return PitchGeometry; }
+		const Vector2Type& GetSubPitchJointLocation2D() const { return SubPitchJointLocation2D; }
+		const TAimGeometry<ScalarType, Vector2Type>& GetSubPitchGeometry() const { return SubPitchGeometry; }
+		bool HasSubBarrel() const { return bHasSubBarrel; }
+
+	private:
+		/** The PitchJoint on the YawJoint's "X-Z" plane. */
+		Vector2Type PitchJointLocation2D;
+
+		/** How far the barrel is to the side ("Y") of the YawJoint. */
+		ScalarType LateralOffset;
+		ScalarType LateralOffsetSquared;
+
+		/** The barrel, with the PitchJoint as the AimJoint. */
+		TAimGeometry<ScalarType, Vector2Type> PitchGeometry;
+
+		/** The SubPitchJoint on the PitchJoint's "X-Z" plane. */
+		Vector2Type SubPitchJointLocation2D;
+
+		/** The sub-barrel, with the SubPitchJoint as the AimJoint. */
+		TAimGeometry<ScalarType, Vector2Type> SubPitchGeometry;
+
+		bool bHasSubBarrel;
+	};
+}
@@ -0,0 +1,818 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+/**
+ * Largest error (in degrees) that the Fast/Approximate accuracy tiers (see TurretRotationCore::EAimAccuracy) add to each of the yaw and
+ * the pitch.  The polynomials themselves are within 9.6e-5 and 3.5e-2 degrees of atan over the whole domain, and float rounding in the
+ * rest of the solve adds a little on top of that.
+ */
+#define AIM_ACCURACY_FAST_MAX_ERROR_DEGREES 0.0002
+#define AIM_ACCURACY_APPROXIMATE_MAX_ERROR_DEGREES 0.036
+
+/**
+ * The turret math, without any engine dependencies.
+ *
+ * Everything in here is header-only and templated on the scalar type (float/double) and on the vector types, so it can be compiled
+ * and benchmarked outside of the engine.  Vector types only need public X/Y (and Z for 3D) members and a constructor taking the
+ * components, so FVector/FVector2D work just as well as TVector3/TVector2 below.
+ *
+ * UTurretRotationFunctionLibrary and FTurretAimGeometry are thin adapters over this.
+ */
+namespace TurretRotationCore
+{
+	/** Constants matching the engine's SMALL_NUMBER and PI. */
+	template<typename ScalarType>
+	struct TConstants
+	{
+		static ScalarType SmallNumber() { return ScalarType( 1.e-8 ); }
+		static ScalarType Pi() { return ScalarType( 3.1415926535897932 ); }
+		static ScalarType RadiansToDegrees() { return ScalarType( 180.0 ) / Pi(); }
+	};
+
+	/** Minimal 2D vector, for when there is no engine vector type around. */
+	template<typename ScalarType>
+	struct TVector2
+	{
+		ScalarType X;
+		ScalarType Y;
+
+		TVector2() : X( 0 ), Y( 0 ) {}
+		TVector2( ScalarType InX, ScalarType InY ) : X( InX ), Y( InY ) {}
+	};
+
+	/** Minimal 3D vector, for when there is no engine vector type around. */
+	template<typename ScalarType>
+	struct TVector3
+	{
+		ScalarType X;
+		ScalarType Y;
+		ScalarType Z;
+
+		TVector3() : X( 0 ), Y( 0 ), Z( 0 ) {}
+		TVector3( ScalarType InX, ScalarType InY, ScalarType InZ ) : X( InX ), Y( InY ), Z( InZ ) {}
+	};
+
+	/**
+	 * How accurately the trig in the yaw/pitch solve is done.
+	 *
+	 * Exact		- std::atan2/std::acos, same as always.
+	 * Fast			- The pitch comes from one Atan2 of the 2D cross/dot products (instead of two normalizations, an Acos, and a sign test),
+	 *				  and Atan2 is a degree 11 minimax polynomial.  Within AIM_ACCURACY_FAST_MAX_ERROR_DEGREES of Exact.
+	 * Approximate	- Same as Fast, but with a degree 5 minimax polynomial.  Within AIM_ACCURACY_APPROXIMATE_MAX_ERROR_DEGREES of Exact.
+	 *
+	 * The square roots are the same in every tier, since they're single instructions on every platform we care about.
+	 */
+	enum class EAimAccuracy : unsigned char
+	{
+		Exact,
+		Fast,
+		Approximate,
+	};
+
+	/**
+	 * Edge cases that a solve can run into, as bit flags.  The solve functions take an optional pointer that they OR these into, which
+	 * the engine module turns into the STATGROUP_TurretRotation counters.  The flags are only written in the branches that handle the
+	 * edge cases, so passing nullptr costs nothing on the common path.
+	 */
+	namespace EAimSolveEvent
+	{
+		enum Type : unsigned int
+		{
+			None					= 0,
+
+			/** CalculateNearestValidTargetLocation2D pushed a target that was too close to the AimJoint out to a valid location. */
+			TargetClamped			= 1 << 0,
+
+			/** CalculateQuadraticRoots found no roots, so there's no BarrelRayDistance and the pitch is 0. */
+			NoRoots					= 1 << 1,
+
+			/** Both roots were behind the BarrelStart, and SelectBestRayDistance had to pick the "less behind" one. */
+			BothDistancesNegative	= 1 << 2,
+		};
+	}
+
+	/** @return Returns the documented maximum Atan2 error (in degrees) of the given tier. */
+	inline double GetMaxAngleErrorDegrees( EAimAccuracy Accuracy )
+	{
+		switch ( Accuracy )
+		{
+		case EAimAccuracy::Fast:		return AIM_ACCURACY_FAST_MAX_ERROR_DEGREES;
+		case EAimAccuracy::Approximate:	return AIM_ACCURACY_APPROXIMATE_MAX_ERROR_DEGREES;
+		default:						return 0.0;
+		}
+	}
+
+	/** Yaw/Pitch for the AimJoint, in degrees. */
+	template<typename ScalarType>
+	struct TAimAngles
+	{
+		ScalarType Pitch;
+		ScalarType Yaw;
+	};
+
+	/**
+	 * Yaw/Pitch for the AimJoint, as the sine/cosine of each angle instead of degrees.
+	 * See TAimGeometry::SolveRotation.  Callers that only need a quaternion (or a rotation matrix) can skip the inverse trig entirely.
+	 */
+	template<typename ScalarType>
+	struct TAimRotation
+	{
+		ScalarType SinPitch;
+		ScalarType CosPitch;
+		ScalarType SinYaw;
+		ScalarType CosYaw;
+	};
+
+	/** Minimal quaternion, laid out like FQuat. */
+	template<typename ScalarType>
+	struct TQuaternion
+	{
+		ScalarType X;
+		ScalarType Y;
+		ScalarType Z;
+		ScalarType W;
+	};
+
+	// 2D vector helpers.  These are free functions (instead of operators) so that any vector type with X/Y members can be used.
+
+	template<typename Vector2Type>
+	inline Vector2Type Add2D( const Vector2Type& A, const Vector2Type& B ) { return Vector2Type( A.X + B.X, A.Y + B.Y ); }
+
+	template<typename Vector2Type>
+	inline Vector2Type Subtract2D( const Vector2Type& A, const Vector2Type& B ) { return Vector2Type( A.X - B.X, A.Y - B.Y ); }
+
+	template<typename Vector2Type, typename ScalarType>
+	inline Vector2Type Scale2D( const Vector2Type& A, ScalarType Scale ) { return Vector2Type( A.X * Scale, A.Y * Scale ); }
+
+	template<typename Vector2Type>
+	inline auto Dot2D( const Vector2Type& A, const Vector2Type& B ) -> decltype( A.X ) { return ( A.X * B.X ) + ( A.Y * B.Y ); }
+
+	template<typename Vector2Type>
+	inline auto Cross2D( const Vector2Type& A, const Vector2Type& B ) -> decltype( A.X ) { return ( A.X * B.Y ) - ( A.Y * B.X ); }
+
+	template<typename Vector2Type>
+	inline auto SizeSquared2D( const Vector2Type& A ) -> decltype( A.X ) { return Dot2D( A, A ); }
+
+	template<typename Vector2Type>
+	inline auto Size2D( const Vector2Type& A ) -> decltype( A.X ) { return std::sqrt( SizeSquared2D( A ) ); }
+
+	/** Same as FVector2D::GetSafeNormal: returns a zero vector if the vector is too small to normalize. */
+	template<typename Vector2Type>
+	inline Vector2Type GetSafeNormal2D( const Vector2Type& A )
+	{
+		typedef decltype( A.X ) ScalarType;
+
+		const ScalarType SquareSum = SizeSquared2D( A );
+		if ( SquareSum > TConstants<ScalarType>::SmallNumber() )
+		{
+			return Scale2D( A, ScalarType( 1 ) / std::sqrt( SquareSum ) );
+		}
+
+		return Vector2Type( 0, 0 );
+	}
+
+	/**
+	 * Atan2 from an odd minimax polynomial for atan on [0, 1].  The other octants are folded onto that range, so the error is the same
+	 * everywhere.  Atan2( 0, 0 ) is 0, same as std::atan2.
+	 *
+	 * @param Y				Y component.
+	 * @param X				X component.
+	 * @param Coefficients	Coefficients of z, z^3, z^5, ...
+	 * @return Returns the angle (in radians) of (X, Y).
+	 */
+	template<typename ScalarType, int NumCoefficients>
+	inline ScalarType PolynomialAtan2( ScalarType Y, ScalarType X, const ScalarType ( &Coefficients )[NumCoefficients] )
+	{
+		const ScalarType AbsX = std::abs( X );
+		const ScalarType AbsY = std::abs( Y );
+		const ScalarType MaxXY = std::max( AbsX, AbsY );
+		if ( MaxXY <= 0 )
+		{
+			return 0;
+		}
+
+		const ScalarType Z = std::min( AbsX, AbsY ) / MaxXY;
+		const ScalarType ZSquared = Z * Z;
+
+		ScalarType Result = Coefficients[NumCoefficients - 1];
+		for ( int Index = NumCoefficients - 2; Index >= 0; --Index )
+		{
+			Result = ( Result * ZSquared ) + Coefficients[Index];
+		}
+		Result *= Z;
+
+		// Unfold the octant.
+		const ScalarType HalfPi = TConstants<ScalarType>::Pi() / 2;
+		Result = ( AbsY > AbsX ) ? ( HalfPi - Result ) : Result;
+		Result = ( X < 0 ) ? ( TConstants<ScalarType>::Pi() - Result ) : Result;
+		return ( Y < 0 ) ? -Result : Result;
+	}
+
+	/**
+	 * The PolynomialAtan2 coefficients for the Fast and Approximate tiers.  Shared with the batched solve (see TurretRotationBatchKernel.h),
+	 * so both round the same way.  Fitted with Lawson's algorithm; max errors are 1.7e-6 and 6.1e-4 radians.
+	 */
+	template<typename ScalarType>
+	struct TAtan2Coefficients
+	{
+		static const ScalarType Fast[6];
+		static const ScalarType Approximate[3];
+	};
+
+	template<typename ScalarType>
+	const ScalarType TAtan2Coefficients<ScalarType>::Fast[6] = {
+		ScalarType( 0.999977219 ), ScalarType( -0.332622827 ), ScalarType( 0.193540371 ),
+		ScalarType( -0.116426469 ), ScalarType( 0.052647336 ), ScalarType( -0.011719130 ) };
+
+	template<typename ScalarType>
+	const ScalarType TAtan2Coefficients<ScalarType>::Approximate[3] = {
+		ScalarType( 0.995357948 ), ScalarType( -0.288690199 ), ScalarType( 0.079339001 ) };
+
+	/**
+	 * Atan2 at the given accuracy.  See EAimAccuracy.
+	 *
+	 * @return Returns the angle (in radians) of (X, Y).
+	 */
+	template<typename ScalarType>
+	inline ScalarType Atan2( ScalarType Y, ScalarType X, EAimAccuracy Accuracy )
+	{
+		switch ( Accuracy )
+		{
+		case EAimAccuracy::Fast:		return PolynomialAtan2( Y, X, TAtan2Coefficients<ScalarType>::Fast );
+		case EAimAccuracy::Approximate:	return PolynomialAtan2( Y, X, TAtan2Coefficients<ScalarType>::Approximate );
+		default:						return std::atan2( Y, X );
+		}
+	}
+
+	/**
+	 * In Unreal, Z is "up", and the "X-Y" plane makes up the horizontal plane.
+	 * This calculates the yaw, or the angle across the "X-Y" plane, for the AimJoint to rotate until it is aligned with the target location.
+	 *
+	 * @param AimJointLocation	Location of the AimJoint.
+	 * @param TargetLocation	Location of the target.
+	 * @param Accuracy			How accurately to do the trig.
+	 * @return Returns the yaw (in degrees) needed to align the AimJoint (and the turret) with the target location.
+	 */
+	template<typename ScalarType, typename Vector3Type>
+	inline ScalarType CalculateTurretYaw( const Vector3Type& AimJointLocation, const Vector3Type& TargetLocation, EAimAccuracy Accuracy = EAimAccuracy::Exact )
+	{
+		// Atan2 will give us the angle (in radians) that corresponds to AimJoint_To_Target.
+		// See https://en.wikipedia.org/wiki/Atan2
+		const ScalarType AimJoint_To_Target_X = ScalarType( TargetLocation.X - AimJointLocation.X );
+		const ScalarType AimJoint_To_Target_Y = ScalarType( TargetLocation.Y - AimJointLocation.Y );
+
+		return Atan2( AimJoint_To_Target_Y, AimJoint_To_Target_X, Accuracy ) * TConstants<ScalarType>::RadiansToDegrees();
+	}
+
+	/**
+	 * Calculates the quadratic roots for TAimGeometry::CalculateBarrelRayDistance.
+	 * See https://en.wikipedia.org/wiki/Quadratic_equation
+	 *
+	 * @param A			Quadratic coefficient "a"
+	 * @param B			Quadratic coefficient "b"
+	 * @param C			Quadratic coefficient "c"
+	 * @param Out_X1	OUT - Quadratic root "x1"
+	 * @param Out_X2	OUT - Quadratic root "x2"
+	 * @return Returns true if the roots could be found, otherwise false.
+	 */
+	template<typename ScalarType>
+	inline bool CalculateQuadraticRoots( ScalarType A, ScalarType B, ScalarType C, ScalarType& Out_X1, ScalarType& Out_X2 )
+	{
+		const ScalarType Denominator = 2 * A;
+		if ( std::abs( Denominator ) <= TConstants<ScalarType>::SmallNumber() )
+		{
+			return false;
+		}
+
+		const ScalarType RadicalInput = ( B * B ) - ( 4 * A * C );
+		if ( RadicalInput < 0 )
+		{
+			return false;
+		}
+
+		const ScalarType Radical = std::sqrt( RadicalInput );
+
+		Out_X1 = ( ( -B ) - Radical ) / Denominator;
+		Out_X2 = ( ( -B ) + Radical ) / Denominator;
+
+		return true;
+	}
+
+	/**
+	 * Given two ray distances, this selects the best one (the one in front of BarrelStart).
+	 *
+	 * @param FirstDistance		First ray distance
+	 * @param SecondDistance	Second ray distance
+	 * @param Out_Events		OUT (optional) - EAimSolveEvent::BothDistancesNegative is added if both distances are negative.
+	 * @return Returns the best ray distance (the one in front of BarrelStart).
+	 */
+	template<typename ScalarType>
+	inline ScalarType SelectBestRayDistance( ScalarType FirstDistance, ScalarType SecondDistance, unsigned int* Out_Events = nullptr )
+	{
+		if ( FirstDistance < 0 && SecondDistance < 0 )
+		{
+			if ( Out_Events )
+			{
+				*Out_Events |= EAimSolveEvent::BothDistancesNegative;
+			}
+
+			// I'm not sure if this case ever occurs, but just in case.
+			// Both distances are "behind" the BarrelStart, which is odd, so just pick whichever one is "less behind" the BarrelStart.
+			return std::min( FirstDistance, SecondDistance );
+		}
+
+		// Else just return the largest value.  This may just select between a positive/negative value.
+		// A positive value is "in front of" BarrelStart, which is what we want.
+		return std::max( FirstDistance, SecondDistance );
+	}
+
+	/**
+	 * Calculates the angle between the two given normalized 2D vectors.
+	 *
+	 * @param FirstVector_Normalized	Normalized 2D vector.
+	 * @param SecondVector_Normalized	Normalized 2D vector.
+	 * @return Returns the angle (in radians) between the two given normalized vectors.
+	 */
+	template<typename Vector2Type>
+	inline auto CalculateAngleBetweenNormalizedVectors( const Vector2Type& FirstVector_Normalized, const Vector2Type& SecondVector_Normalized ) -> decltype( FirstVector_Normalized.X )
+	{
+		typedef decltype( FirstVector_Normalized.X ) ScalarType;
+
+		// The DotProduct is defined as:  Length(A) * Length(B) * (cosine(Angle between A and B))
+		// See https://en.wikipedia.org/wiki/Dot_product#Geometric_definition
+		//
+		// So, since we know these two vectors are normalized, we can assume that the DotProduct = cosine(Angle between A and B)
+		// Rounding can push it a hair past +/-1 though, which would make Acos return NaN.
+		const ScalarType DotProduct = Dot2D( FirstVector_Normalized, SecondVector_Normalized );
+		return std::acos( std::min( std::max( DotProduct, ScalarType( -1 ) ), ScalarType( 1 ) ) );
+	}
+
+	/**
+	 * Decides if the FirstVector should be rotated counterclockwise to meet the SecondVector (implies that a counterclockwise rotation
+	 * is shorter than a clockwise one).
+	 *
+	 * @param FirstVector	Arbitrary 2D vector.
+	 * @param SecondVector	Arbitrary 2D vector.
+	 * @return Returns true if the FirstVector should be rotated counterclockwise to meet the SecondVector, otherwise false.
+	 */
+	template<typename Vector2Type>
+	inline bool ShouldTurnCounterClockwiseToMeet( const Vector2Type& FirstVector, const Vector2Type& SecondVector )
+	{
+		// If the SecondVector "is in front of" FirstVector_Perp (positive dot product), then we should rotate counterclockwise.
+		// Rotating by 90 degrees just swaps the components and negates one of them, so there's no need for any trig.
+		const Vector2Type FirstVector_Perp = Vector2Type( -FirstVector.Y, FirstVector.X );
+
+		return Dot2D( FirstVector_Perp, SecondVector ) >= 0;
+	}
+
+	/**
+	 * Calculates the angle to rotate from the FirstVector to the SecondVector.  Also handles whether to rotate clockwise or counterclockwise.
+	 *
+	 * @param FirstVector	Arbitrary 2D vector.
+	 * @param SecondVector	Arbitrary 2D vector.
+	 * @param Accuracy		How accurately to do the trig.
+	 * @return Returns the angle (in degrees) needed to rotate the FirstVector to meet the SecondVector.
+	 */
+	template<typename Vector2Type>
+	inline auto CalculateAngleToRotateFromFirstVectorToSecondVector( const Vector2Type& FirstVector, const Vector2Type& SecondVector, EAimAccuracy Accuracy = EAimAccuracy::Exact ) -> decltype( FirstVector.X )
+	{
+		typedef decltype( FirstVector.X ) ScalarType;
+
+		if ( Accuracy != EAimAccuracy::Exact )
+		{
+			// Cross = |A||B|sin(Angle) and Dot = |A||B|cos(Angle), so one Atan2 gives the angle and its sign, without normalizing either vector.
+			const ScalarType CrossProduct = ScalarType( Cross2D( FirstVector, SecondVector ) );
+			const ScalarType DotProduct = ScalarType( Dot2D( FirstVector, SecondVector ) );
+			if ( CrossProduct == 0 && DotProduct == 0 )
+			{
+				// One of the vectors is zero.  The exact path's GetSafeNormal2D turns that into a 90 degree turn, so match it.
+				return ScalarType( 90 );
+			}
+
+			return Atan2( CrossProduct, DotProduct, Accuracy ) * TConstants<ScalarType>::RadiansToDegrees();
+		}
+
+		const Vector2Type FirstVector_Normalized = GetSafeNormal2D( FirstVector );
+		const Vector2Type SecondVector_Normalized = GetSafeNormal2D( SecondVector );
+
+		// Find the angle between the two vectors.
+		const ScalarType AngleBetweenAimJointVectors_Radians = CalculateAngleBetweenNormalizedVectors( FirstVector_Normalized, SecondVector_Normalized );
+		const ScalarType AngleBetweenAimJointVectors_Degrees = AngleBetweenAimJointVectors_Radians * TConstants<ScalarType>::RadiansToDegrees();
+
+		// If it's shorter to turn counterclockwise, then do so.  Else, let's turn clockwise.
+		const ScalarType RotationSign = ShouldTurnCounterClockwiseToMeet( FirstVector_Normalized, SecondVector_Normalized ) ? ScalarType( 1 ) : ScalarType( -1 );
+
+		return RotationSign * AngleBetweenAimJointVectors_Degrees;
+	}
+
+	/**
+	 * Calculates the sine/cosine of the angle to rotate from the FirstVector to the SecondVector.  Same angle (and sign) as
+	 * CalculateAngleToRotateFromFirstVectorToSecondVector, but with one square root instead of two normalizations and an Acos.
+	 *
+	 * @param FirstVector	Arbitrary 2D vector.
+	 * @param SecondVector	Arbitrary 2D vector.
+	 * @param Out_Sin		OUT - Sine of the angle.
+	 * @param Out_Cos		OUT - Cosine of the angle.
+	 */
+	template<typename Vector2Type, typename ScalarType>
+	inline void CalculateSinCosToRotateFromFirstVectorToSecondVector( const Vector2Type& FirstVector, const Vector2Type& SecondVector, ScalarType& Out_Sin, ScalarType& Out_Cos )
+	{
+		// Dot = |A||B|cos(Angle), and Cross = |A||B|sin(Angle), where a positive Cross means turning counterclockwise.
+		const ScalarType LengthProductSquared = ScalarType( SizeSquared2D( FirstVector ) * SizeSquared2D( SecondVector ) );
+		if ( LengthProductSquared <= TConstants<ScalarType>::SmallNumber() )
+		{
+			// Matches CalculateAngleToRotateFromFirstVectorToSecondVector, where GetSafeNormal2D turns the zero vector into a 90 degree turn.
+			Out_Sin = 1;
+			Out_Cos = 0;
+			return;
+		}
+
+		const ScalarType InverseLengthProduct = 1 / std::sqrt( LengthProductSquared );
+		Out_Sin = ScalarType( Cross2D( FirstVector, SecondVector ) ) * InverseLengthProduct;
+		Out_Cos = ScalarType( Dot2D( FirstVector, SecondVector ) ) * InverseLengthProduct;
+	}
+
+	/**
+	 * Calculates the sine/cosine of half of an angle, from the sine/cosine of the whole angle, with a single square root and no trig.
+	 *
+	 * (cos(A/2), sin(A/2)) points the same way as (1 + cos(A), sin(A)), and also as (sin(A), 1 - cos(A)).  The first one loses
+	 * precision near 180 degrees, and the second one near 0 degrees, so whichever is better is used.  The second one may flip the
+	 * sign of both results, which still gives the same rotation once they're in a quaternion.
+	 *
+	 * @param Sin			Sine of the angle.
+	 * @param Cos			Cosine of the angle.
+	 * @param Out_HalfSin	OUT - Sine of half of the angle (possibly negated, along with Out_HalfCos).
+	 * @param Out_HalfCos	OUT - Cosine of half of the angle (possibly negated, along with Out_HalfSin).
+	 */
+	template<typename ScalarType>
+	inline void CalculateHalfAngleSinCos( ScalarType Sin, ScalarType Cos, ScalarType& Out_HalfSin, ScalarType& Out_HalfCos )
+	{
+		const bool bNearZero = Cos >= 0;
+		const ScalarType HalfCos = bNearZero ? ( 1 + Cos ) : Sin;
+		const ScalarType HalfSin = bNearZero ? Sin : ( 1 - Cos );
+
+		// Both are at least 1 (squared) for a normalized Sin/Cos, so this can't divide by zero.
+		const ScalarType InverseLength = 1 / std::sqrt( ( HalfCos * HalfCos ) + ( HalfSin * HalfSin ) );
+		Out_HalfSin = HalfSin * InverseLength;
+		Out_HalfCos = HalfCos * InverseLength;
+	}
+
+	/**
+	 * Makes the quaternion for an AimJoint rotation, the same as FRotator( Pitch, Yaw, 0 ).Quaternion(), but without any trig.
+	 *
+	 * @param Rotation	The AimJoint's yaw/pitch, as sines/cosines.
+	 * @return Returns the quaternion for the AimJoint (relative to the Actor).
+	 */
+	template<typename ScalarType>
+	inline TQuaternion<ScalarType> MakeAimQuaternion( const TAimRotation<ScalarType>& Rotation )
+	{
+		ScalarType SP, CP, SY, CY;
+		CalculateHalfAngleSinCos( Rotation.SinPitch, Rotation.CosPitch, /*out*/ SP, /*out*/ CP );
+		CalculateHalfAngleSinCos( Rotation.SinYaw, Rotation.CosYaw, /*out*/ SY, /*out*/ CY );
+
+		// FRotator::Quaternion with a Roll of 0.
+		TQuaternion<ScalarType> Result;
+		Result.X = SP * SY;
+		Result.Y = -SP * CY;
+		Result.Z = CP * SY;
+		Result.W = CP * CY;
+		return Result;
+	}
+
+	/**
+	 * Everything about a turret that doesn't depend on the target, on the "X-Z" plane.
+	 * See FTurretAimGeometry for the engine version, which also knows about the Actor.
+	 */
+	template<typename ScalarType, typename Vector2Type = TVector2<ScalarType>>
+	class TAimGeometry
+	{
+	public:
+		/** Makes a geometry whose BarrelStart/BarrelEnd sit on top of the AimJoint.  Not very useful, but always valid. */
+		TAimGeometry()
+		{
+			Initialize( Vector2Type( 0, 0 ), Vector2Type( 0, 0 ), Vector2Type( 0, 0 ) );
+		}
+
+		/**
+		 * Makes the geometry from the vectors given to CalculateTurretRotation_ForActor.
+		 *
+		 * @param AimJoint_To_BarrelStart	The vector from the AimJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+		 * @param BarrelStart_To_BarrelEnd	The vector from the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+		 * @param ActorScale				The Actor's scale.
+		 */
+		template<typename Vector3Type>
+		static TAimGeometry MakeFromActorVectors( const Vector3Type& AimJoint_To_BarrelStart, const Vector3Type& BarrelStart_To_BarrelEnd, const Vector3Type& ActorScale )
+		{
+			// The Actor's Rotation/Translation will not affect the relative positions of the BarrelStart/BarrelEnd locations, but Scale will!
+			// In AimJoint space, the AimJoint is at the origin.  The pitch is solved on the "X-Z" plane, so that's all we need to keep.
+			const Vector2Type BarrelStart2D = Vector2Type( AimJoint_To_BarrelStart.X * ActorScale.X, AimJoint_To_BarrelStart.Z * ActorScale.Z );
+			const Vector2Type BarrelEnd2D = Vector2Type(
+				BarrelStart2D.X + ( BarrelStart_To_BarrelEnd.X * ActorScale.X ),
+				BarrelStart2D.Y + ( BarrelStart_To_BarrelEnd.Z * ActorScale.Z ) );
+
+			TAimGeometry Result;
+			Result.Initialize( Vector2Type( 0, 0 ), BarrelStart2D, BarrelEnd2D );
+			return Result;
+		}
+
+		/**
+		 * Makes the geometry from AimJoint/BarrelStart/BarrelEnd locations that are already aligned on the "X-Z" plane.
+		 * Only SolvePitch can be used with a geometry made this way (unless the AimJoint is at the origin).
+		 */
+		static TAimGeometry MakeFromLocations2D( const Vector2Type& AimJointLocation2D, const Vector2Type& BarrelStartLocation2D, const Vector2Type& BarrelEndLocation2D )
+		{
+			TAimGeometry Result;
+			Result.Initialize( AimJointLocation2D, BarrelStartLocation2D, BarrelEndLocation2D );
+			return Result;
+		}
+
+		/**
+		 * Calculates the yaw/pitch for the AimJoint so the turret's barrel points at the target.
+		 *
+		 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+		 * @param Accuracy					How accurately to do the trig.
+		 * @param Out_Events				OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns the yaw/pitch (in degrees) for the AimJoint.
+		 */
+		template<typename Vector3Type>
+		TAimAngles<ScalarType> Solve( const Vector3Type& Target_InAimJointSpace, EAimAccuracy Accuracy = EAimAccuracy::Exact, unsigned int* Out_Events = nullptr ) const
+		{
+			const ScalarType TargetX = ScalarType( Target_InAimJointSpace.X );
+			const ScalarType TargetY = ScalarType( Target_InAimJointSpace.Y );
+			const ScalarType TargetZ = ScalarType( Target_InAimJointSpace.Z );
+
+			TAimAngles<ScalarType> Result;
+			Result.Yaw = CalculateTurretYaw<ScalarType>( TVector3<ScalarType>(), TVector3<ScalarType>( TargetX, TargetY, TargetZ ), Accuracy );
+
+			// Rotating the target by the inverse of the yaw lines it up with the turret on the "X-Z" plane.
+			// That rotation only moves the target around the "Z" axis, so the aligned target's X is just its distance from the AimJoint across
+			// the "X-Y" plane.  No need to build a rotator and do more trig.
+			const Vector2Type Target_AlignedWithTurret2D = Vector2Type( std::sqrt( ( TargetX * TargetX ) + ( TargetY * TargetY ) ), TargetZ );
+
+			Result.Pitch = SolvePitch( Target_AlignedWithTurret2D, Accuracy, Out_Events );
+			return Result;
+		}
+
+		/**
+		 * Same as Solve, but returns the sine/cosine of the yaw/pitch instead of degrees, so there's no Atan2/Acos (and no trig at all).
+		 * The yaw's sine/cosine fall straight out of the target's direction, and the same horizontal distance that lines the target
+		 * up with the turret is reused for the pitch.  Use MakeAimQuaternion to turn the result into a quaternion.
+		 *
+		 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+		 * @param Out_Events				OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns the yaw/pitch for the AimJoint, as sines/cosines.
+		 */
+		template<typename Vector3Type>
+		TAimRotation<ScalarType> SolveRotation( const Vector3Type& Target_InAimJointSpace, unsigned int* Out_Events = nullptr ) const
+		{
+			const ScalarType TargetX = ScalarType( Target_InAimJointSpace.X );
+			const ScalarType TargetY = ScalarType( Target_InAimJointSpace.Y );
+			const ScalarType TargetZ = ScalarType( Target_InAimJointSpace.Z );
+
+			TAimRotation<ScalarType> Result;
+
+			const ScalarType HorizontalDistance = std::sqrt( ( TargetX * TargetX ) + ( TargetY * TargetY ) );
+			if ( HorizontalDistance > TConstants<ScalarType>::SmallNumber() )
+			{
+				const ScalarType InverseHorizontalDistance = 1 / HorizontalDistance;
+				Result.SinYaw = TargetY * InverseHorizontalDistance;
+				Result.CosYaw = TargetX * InverseHorizontalDistance;
+			}
+			else
+			{
+				// Straight above/below the AimJoint.  Atan2( 0, 0 ) is 0, so keep the same yaw as Solve.
+				Result.SinYaw = 0;
+				Result.CosYaw = 1;
+			}
+
+			Vector2Type AimJoint_To_ScaledBarrelEnd;
+			Vector2Type AimJoint_To_Target;
+			if ( CalculatePitchVectors( Vector2Type( HorizontalDistance, TargetZ ), /*out*/ AimJoint_To_ScaledBarrelEnd, /*out*/ AimJoint_To_Target, Out_Events ) )
+			{
+				CalculateSinCosToRotateFromFirstVectorToSecondVector( AimJoint_To_ScaledBarrelEnd, AimJoint_To_Target, /*out*/ Result.SinPitch, /*out*/ Result.CosPitch );
+			}
+			else
+			{
+				Result.SinPitch = 0;
+				Result.CosPitch = 1;
+			}
+
+			return Result;
+		}
+
+		/**
+		 * Calculates the pitch for a target that is already aligned with the turret on the "X-Z" plane.
+		 *
+		 * @param InTargetLocation2D	Location of the Target, in the same space as the AimJoint/BarrelStart/BarrelEnd.
+		 * @param Accuracy				How accurately to do the trig.
+		 * @param Out_Events			OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns the pitch (in degrees), or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the Target.
+		 */
+		ScalarType SolvePitch( const Vector2Type& InTargetLocation2D, EAimAccuracy Accuracy = EAimAccuracy::Exact, unsigned int* Out_Events = nullptr ) const
+		{
+			Vector2Type AimJoint_To_ScaledBarrelEnd;
+			Vector2Type AimJoint_To_Target;
+			if ( !CalculatePitchVectors( InTargetLocation2D, /*out*/ AimJoint_To_ScaledBarrelEnd, /*out*/ AimJoint_To_Target, Out_Events ) )
+			{
+				// For any really weird cases (like where the AimJoint, the BarrelStart, the BarrelEnd, and the TargetLocation are all equal), just return 0.
+				return 0;
+			}
+
+			return CalculateAngleToRotateFromFirstVectorToSecondVector( AimJoint_To_ScaledBarrelEnd, AimJoint_To_Target, Accuracy );
+		}
+
+		/**
+		 * Finds the two vectors whose angle is the pitch, for SolvePitch and SolveRotation.
+		 *
+		 * @param InTargetLocation2D				Location of the Target, in the same space as the AimJoint/BarrelStart/BarrelEnd.
+		 * @param Out_AimJoint_To_ScaledBarrelEnd	OUT - The vector from the AimJoint to the ScaledBarrelEnd.
+		 * @param Out_AimJoint_To_Target			OUT - The vector from the AimJoint to the (valid) Target.
+		 * @param Out_Events						OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns false if there is no BarrelRayDistance (in which case the pitch is 0), otherwise true.
+		 */
+		bool CalculatePitchVectors( const Vector2Type& InTargetLocation2D, Vector2Type& Out_AimJoint_To_ScaledBarrelEnd, Vector2Type& Out_AimJoint_To_Target, unsigned int* Out_Events = nullptr ) const
+		{
+			// Targets that are too close to the AimJoint are invalid, so, if that's the case, then get a "valid" location for the Target.
+			const Vector2Type TargetLocation2D = CalculateNearestValidTargetLocation2D( InTargetLocation2D, Out_Events );
+
+			// See CalculateTurretPitch in UTurretRotationFunctionLibrary for an explanation of the BarrelRayDistance and the ScaledBarrelEnd.
+			ScalarType BarrelRayDistance = 0;
+			const bool bFoundRayDistance = CalculateBarrelRayDistance( TargetLocation2D, /*out*/ BarrelRayDistance, Out_Events );
+			if ( !bFoundRayDistance )
+			{
+				return false;
+			}
+
+			const Vector2Type ScaledBarrelEndLocation2D = Add2D( BarrelStartLocation2D, Scale2D( BarrelRay, BarrelRayDistance ) );
+
+			// The angle between these two vectors represents the pitch.
+			Out_AimJoint_To_ScaledBarrelEnd = Subtract2D( ScaledBarrelEndLocation2D, AimJointLocation2D );
+			Out_AimJoint_To_Target = Subtract2D( TargetLocation2D, AimJointLocation2D );
+			return true;
+		}
+
+		/**
+		 * The correct pitch to calculate in SolvePitch is undefined if the Target is too close to the AimJoint.
+		 * If the Target is too close to the AimJoint, then it is technically impossible for the turret to point at the Target.
+		 * If an invalid Target Location is detected, then this function will return a new Location that is far enough from the AimJoint for
+		 * calculations to continue. This will result in behavior that "makes sense" for the invalid case, even though the turret won't end up
+		 * pointing at the Target.
+		 *
+		 * @param TargetLocation2D		Location of the Target.
+		 * @param Out_Events			OUT (optional) - EAimSolveEvent::TargetClamped is added if the Target had to be moved.
+		 * @return Returns a "valid" Target Location that should result in behavior that "makes sense" if the Target is too close to the AimJoint.
+		 */
+		Vector2Type CalculateNearestValidTargetLocation2D( const Vector2Type& TargetLocation2D, unsigned int* Out_Events = nullptr ) const
+		{
+			const Vector2Type AimJoint_To_Target = Subtract2D( TargetLocation2D, AimJointLocation2D );
+
+			// Comparing squared distances means that valid targets (by far the most common case) don't need a square root.
+			if ( SizeSquared2D( AimJoint_To_Target ) < MinimumTargetDistanceSquared )
+			{
+				if ( Out_Events )
+				{
+					*Out_Events |= EAimSolveEvent::TargetClamped;
+				}
+
+				// The Target is at an invalid location, so return a location that is a little farther away.
+				return Add2D( AimJointLocation2D, Scale2D( GetSafeNormal2D( AimJoint_To_Target ), MinimumTargetDistance ) );
+			}
+
+			// The Target is at a valid location, so just retun that.
+			return TargetLocation2D;
+		}
+
+		/**
+		 * For SolvePitch, find the Out_BarrelRayDistance so that the ScaledBarrelEnd can be found.
+		 *
+		 * @param TargetLocation2D		Location of the Target.
+		 * @param Out_BarrelRayDistance	OUT - The found BarrelRayDistance.
+		 * @param Out_Events			OUT (optional) - EAimSolveEvent::NoRoots or EAimSolveEvent::BothDistancesNegative are added if they happen.
+		 * @return Returns true if a valid BarrelRayDistance was found, otherwise false.
+		 */
+		bool CalculateBarrelRayDistance( const Vector2Type& TargetLocation2D, ScalarType& Out_BarrelRayDistance, unsigned int* Out_Events = nullptr ) const
+		{
+			// Let:
+			// J = AimJoint
+			// S = BarrelStart
+			// E = BarrelEnd
+			// R = BarrelRay = (E - S).GetSafeNormal()
+			// T = Target
+			// d = BarrelRay distance we're trying to find (Out_BarrelRayDistance)
+			// F(d)  = A point at distance "d" along the Barrel Ray
+			//       = S + (R*d)
+			// ||V|| = Calculates the magnitude (distance) of the 2D vector V.
+			//       = sqrt(V.x^2 + V.y^2)
+
+			// We're trying to find a value for "d" that solves this equation:
+			// || F(d) - J || = || T - J ||
+
+			// After a lot of algebra (omitted here), we can rewrite this as a quadratic equation:
+			// a*(d^2) + b*d + c, where
+			// a = (R.x^2) + (R.y^2)
+			// b = (2*S.x*R.x - 2*J.x*R.x) + (2*S.y*R.y - 2*J.y*R.y)
+			// c = (J.x-S.x)^2 + (J.y-S.y)^2 - (T.x-J.x)^2 - (T.y-J.y)^2
+
+			// Only the last two terms of "c" depend on the Target.  Everything else was calculated in Initialize.
+			const ScalarType QuadraticC = QuadraticC_AimJointToBarrelStartTerm - SizeSquared2D( Subtract2D( TargetLocation2D, AimJointLocation2D ) );
+
+			// Using our quadratic coefficients, find out roots.
+			ScalarType d1 = 0;
+			ScalarType d2 = 0;
+			const bool bRootsWereFound = CalculateQuadraticRoots( QuadraticA, QuadraticB, QuadraticC, /*out*/ d1, /*out*/ d2 );
+			if ( !bRootsWereFound )
+			{
+				if ( Out_Events )
+				{
+					*Out_Events |= EAimSolveEvent::NoRoots;
+				}
+				return false;
+			}
+
+			// Select the best root.
+			Out_BarrelRayDistance = SelectBestRayDistance( d1, d2, Out_Events );
+			return true;
+		}
+
+		const Vector2Type& GetAimJointLocation2D() const { return AimJointLocation2D; }
+		const Vector2Type& GetBarrelStartLocation2D() const { return BarrelStartLocation2D; }
+		const Vector2Type& GetBarrelEndLocation2D() const { return BarrelEndLocation2D; }
+		const Vector2Type& GetBarrelRay() const { return BarrelRay; }
+		ScalarType GetMinimumTargetDistance() const { return MinimumTargetDistance; }
+
+	private:
+		/** Precalculates everything that only depends on the AimJoint/BarrelStart/BarrelEnd. */
+		void Initialize( const Vector2Type& InAimJointLocation2D, const Vector2Type& InBarrelStartLocation2D, const Vector2Type& InBarrelEndLocation2D )
+		{
+			AimJointLocation2D = InAimJointLocation2D;
+			BarrelStartLocation2D = InBarrelStartLocation2D;
+			BarrelEndLocation2D = InBarrelEndLocation2D;
+
+			// See CalculateBarrelRayDistance for where these come from.
+			// Just for readability:
+			const Vector2Type& J = AimJointLocation2D;
+			const Vector2Type& S = BarrelStartLocation2D;
+			const Vector2Type& E = BarrelEndLocation2D;
+			const Vector2Type R = GetSafeNormal2D( Subtract2D( E, S ) );
+
+			BarrelRay = R;
+
+			// Since R is normalized, "a" is 1 (or 0 if the BarrelStart and BarrelEnd are at the same location).
+			QuadraticA = SizeSquared2D( R );
+			QuadraticB = 2 * Dot2D( Subtract2D( S, J ), R );
+			QuadraticC_AimJointToBarrelStartTerm = SizeSquared2D( Subtract2D( J, S ) );
+
+			// If the Target is closer than both the BarrelStart/BarrelEnd, then the Target is invalid.
+			const ScalarType AimJoint_To_BarrelStart_Distance = Size2D( Subtract2D( S, J ) );
+			const ScalarType AimJoint_To_BarrelEnd_Distance = Size2D( Subtract2D( E, J ) );
+
+			MinimumTargetDistance = std::min( AimJoint_To_BarrelStart_Distance, AimJoint_To_BarrelEnd_Distance );
+
+			// Push the MinimumDistance outwards a little bit, just so that we're 100% sure we have a valid value.
+			const ScalarType MinimumDistance_Tolerance = std::min( ScalarType( 3 ), ScalarType( 0.01 ) * MinimumTargetDistance );
+			MinimumTargetDistance += MinimumDistance_Tolerance;
+			MinimumTargetDistanceSquared = MinimumTargetDistance * MinimumTargetDistance;
+		}
+
+		/** AimJoint/BarrelStart/BarrelEnd on the "X-Z" plane. */
+		Vector2Type AimJointLocation2D;
+		Vector2Type BarrelStartLocation2D;
+		Vector2Type BarrelEndLocation2D;
+
+		/** Normalized vector that points from the BarrelStart to the BarrelEnd. */
+		Vector2Type BarrelRay;
+
+		/** Quadratic coefficients "a" and "b" from CalculateBarrelRayDistance, plus the part of "c" that doesn't depend on the Target. */
+		ScalarType QuadraticA;
+		ScalarType QuadraticB;
+		ScalarType QuadraticC_AimJointToBarrelStartTerm;
+
+		/** Targets closer to the AimJoint than this are pushed out by CalculateNearestValidTargetLocation2D. */
+		ScalarType MinimumTargetDistance;
+		ScalarType MinimumTargetDistanceSquared;
+	};
+
+	/**
+	 * This function assumes that the AimJoint, BarrelStart, BarrelEnd, and TargetLocation are all aligned on the "X-Z" plane.
+	 * It calculates the pitch, or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the TargetLocation.
+	 *
+	 * @param Accuracy		How accurately to do the trig.
+	 * @param Out_Events	OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+	 * @return Returns the pitch (in degrees) for the AimJoint.
+	 */
+	template<typename ScalarType, typename Vector3Type>
+	inline ScalarType CalculateTurretPitch( const Vector3Type& AimJointLocation, const Vector3Type& BarrelStartLocation, const Vector3Type& BarrelEndLocation, const Vector3Type& TargetLocation, EAimAccuracy Accuracy = EAimAccuracy::Exact, unsigned int* Out_Events = nullptr )
+	{
+		// Since we're assuming that all of these locations are already aligned on the "X-Z" plane, we know that this is really a 2D problem.
+		typedef TVector2<ScalarType> Vector2Type;
+
+		const TAimGeometry<ScalarType> Geometry = TAimGeometry<ScalarType>::MakeFromLocations2D(
+			Vector2Type( ScalarType( AimJointLocation.X ), ScalarType( AimJointLocation.Z ) ),
+			Vector2Type( ScalarType( BarrelStartLocation.X ), ScalarType( BarrelStartLocation.Z ) ),
+			Vector2Type( ScalarType( BarrelEndLocation.X ), ScalarType( BarrelEndLocation.Z ) ) );
+
+		return Geometry.SolvePitch( Vector2Type( ScalarType( TargetLocation.X ), ScalarType( TargetLocation.Z ) ), Accuracy, Out_Events );
+	}
+}
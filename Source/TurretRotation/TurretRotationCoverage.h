@@ -0,0 +1,343 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+
+/**
+ * Answers "can this turret hit that point?" without solving, without any engine dependencies.
+ *
+ * A turret can hit a point if the point is within its range and its yaw arc, the barrel can be lined up with it at all, and the
+ * pitch that does so is within the turret's pitch limits.  The first two are a couple of comparisons.  The other two come from the same
+ * math as TAimGeometry::SolvePitch:
+ *   - Targets closer than GetMinimumTargetDistance are pushed out by CalculateNearestValidTargetLocation2D, so the barrel never lines
+ *     up with them.  Anything farther away always gives CalculateBarrelRayDistance a root in front of the BarrelStart (the AimJoint is at
+ *     the origin), so the barrel lines up with it exactly.
+ *   - The ScaledBarrelEnd only depends on the target's distance, not its direction.  So the pitch is the target's elevation minus the
+ *     elevation of the (unrotated) ScaledBarrelEnd at that distance, and the pitch limits become elevation limits that only depend on
+ *     the distance.
+ *
+ * TAimCoverage bakes the ScaledBarrelEnd's elevation (shifted by the middle of the pitch limits) into a small table, indexed by
+ * MinimumTargetDistance / Distance, which covers every distance out to infinity.  The elevation changes smoothly with that, so the table
+ * is linearly interpolated.  A query is then two square roots, a table lookup, and a few multiplies, with no trig, and agrees with
+ * CanHit_Solve everywhere except within AIM_COVERAGE_TOLERANCE_DEGREES of a pitch limit (or of the edge of the yaw arc).  The
+ * interpolation is least accurate for targets right next to the MinimumTargetDistance, where the elevation changes fastest.
+ *
+ * Everything is in AimJoint space (relative to the unrotated AimJoint), same as TAimGeometry::Solve.
+ *
+ * MayCoverRegion is the conservative whole-region version (range and yaw arc only), used by FTurretCoverageField::IsRegionSafe.
+ */
+
+/** Largest pitch (in degrees) past a pitch limit at which TAimCoverage::CanHit may still disagree with TAimCoverage::CanHit_Solve. */
+#define AIM_COVERAGE_TOLERANCE_DEGREES 0.25
+
+namespace TurretRotationCore
+{
+	/** What a turret is allowed to aim at, on top of its geometry. */
+	template<typename ScalarType>
+	struct TAimLimits
+	{
+		/** Targets closer than this (to the AimJoint) can't be hit. */
+		ScalarType MinRange;
+
+		/** Targets farther away than this (from the AimJoint) can't be hit. */
+		ScalarType MaxRange;
+
+		/** How far (in degrees) to either side of the turret's forward ("X") the yaw can go.  180 or more means all the way around. */
+		ScalarType HalfArcDegrees;
+
+		/** Lowest and highest pitch (in degrees).  A range of 360 degrees or more means the pitch isn't limited. */
+		ScalarType MinPitchDegrees;
+		ScalarType MaxPitchDegrees;
+
+		TAimLimits()
+			: MinRange( 0 )
+			, MaxRange( 5000 )
+			, HalfArcDegrees( 180 )
+			, MinPitchDegrees( -180 )
+			, MaxPitchDegrees( 180 )
+		{
+		}
+	};
+
+	/**
+	 * Checks if a direction is within an angle of another one, without any trig, using the dot/cross products between them.
+	 * Cos( HalfAngle ) is badly conditioned for small angles, so those are checked with the sine instead.
+	 *
+	 * @param DotProduct		Dot product of the two directions.
+	 * @param CrossProduct		Cross product of the two directions.
+	 * @param LengthProduct		Product of the lengths of the two directions.
+	 * @param SinHalfAngle		Sine of the largest angle allowed.
+	 * @param CosHalfAngle		Cosine of the largest angle allowed.
+	 * @return Returns true if the angle between the two directions is at most HalfAngle.
+	 */
+	template<typename ScalarType>
+	inline bool IsWithinHalfAngle( ScalarType DotProduct, ScalarType CrossProduct, ScalarType LengthProduct, ScalarType SinHalfAngle, ScalarType CosHalfAngle )
+	{
+		if ( CosHalfAngle > 0 )
+		{
+			// Less than 90 degrees:  in front, and not too far to either side.
+			return DotProduct >= 0 && std::abs( CrossProduct ) <= SinHalfAngle * LengthProduct;
+		}
+
+		return DotProduct >= CosHalfAngle * LengthProduct;
+	}
+
+	/**
+	 * A turret's baked reachability.  See the top of this file.
+	 */
+	template<typename ScalarType, typename Vector2Type = TVector2<ScalarType>>
+	class TAimCoverage
+	{
+	public:
+		/** Number of table entries.  The error of the interpolation drops with the square of this. */
+		enum { NumEntries = 65 };
+
+		/** Makes a coverage that can't hit anything. */
+		TAimCoverage()
+			: bCanAim( false )
+		{
+		}
+
+		/**
+		 * Bakes the coverage.
+		 *
+		 * @param Geometry	The turret.  Its AimJoint has to be at the origin (made with MakeFromActorVectors).
+		 * @param Limits	Range, yaw arc, and pitch limits.
+		 */
+		void Initialize( const TAimGeometry<ScalarType, Vector2Type>& Geometry, const TAimLimits<ScalarType>& Limits )
+		{
+			const ScalarType DegreesToRadians = 1 / TConstants<ScalarType>::RadiansToDegrees();
+
+			MinRangeSquared = Limits.MinRange * Limits.MinRange;
+			MaxRangeSquared = Limits.MaxRange * Limits.MaxRange;
+
+			bAnyYaw = Limits.HalfArcDegrees >= 180;
+			const ScalarType HalfArc = std::max( Limits.HalfArcDegrees, ScalarType( 0 ) ) * DegreesToRadians;
+			SinHalfArc = std::sin( HalfArc );
+			CosHalfArc = std::cos( HalfArc );
+
+			bAnyPitch = ( Limits.MaxPitchDegrees - Limits.MinPitchDegrees ) >= 360;
+			const ScalarType HalfPitchRange = std::max( Limits.MaxPitchDegrees - Limits.MinPitchDegrees, ScalarType( 0 ) ) * ( DegreesToRadians / 2 );
+			SinHalfPitchRange = std::sin( HalfPitchRange );
+			CosHalfPitchRange = std::cos( HalfPitchRange );
+			const ScalarType MiddlePitch = ( Limits.MinPitchDegrees + Limits.MaxPitchDegrees ) * ( DegreesToRadians / 2 );
+
+			MinimumTargetDistance = Geometry.GetMinimumTargetDistance();
+
+			// A zero length barrel has no BarrelRayDistance for any target, so the solve always gives a pitch of 0 without lining anything up.
+			const Vector2Type& BarrelRay = Geometry.GetBarrelRay();
+			bCanAim = SizeSquared2D( BarrelRay ) >= ScalarType( 0.5 );
+
+			for ( int Index = 0; Index < NumEntries; ++Index )
+			{
+				// Entry 0 is infinitely far away, where the ScaledBarrelEnd is straight along the barrel.
+				Vector2Type Direction = BarrelRay;
+				const ScalarType InverseDistanceFraction = ScalarType( Index ) / ( NumEntries - 1 );
+				if ( Index > 0 && MinimumTargetDistance > 0 )
+				{
+					ScalarType BarrelRayDistance = 0;
+					const Vector2Type Target2D( MinimumTargetDistance / InverseDistanceFraction, 0 );
+					if ( Geometry.CalculateBarrelRayDistance( Target2D, /*out*/ BarrelRayDistance ) )
+					{
+						Direction = Add2D( Geometry.GetBarrelStartLocation2D(), Scale2D( BarrelRay, BarrelRayDistance ) );
+					}
+				}
+
+				// The pitch that lines the barrel up with a target at this distance is the target's elevation minus this direction's, so being
+				// within the pitch limits means the target's elevation is within half of their range of this angle (shifted by their middle).
+				const ScalarType Angle = std::atan2( Direction.Y, Direction.X ) + MiddlePitch;
+				CosTable[Index] = std::cos( Angle );
+				SinTable[Index] = std::sin( Angle );
+			}
+		}
+
+		/**
+		 * @param Target_InAimJointSpace	The point, relative to the (unrotated) AimJoint.
+		 * @return Returns true if the turret can hit the point.
+		 */
+		template<typename Vector3Type>
+		bool CanHit( const Vector3Type& Target_InAimJointSpace ) const
+		{
+			const ScalarType TargetX = ScalarType( Target_InAimJointSpace.X );
+			const ScalarType TargetY = ScalarType( Target_InAimJointSpace.Y );
+			const ScalarType TargetZ = ScalarType( Target_InAimJointSpace.Z );
+
+			const ScalarType HorizontalDistanceSquared = ( TargetX * TargetX ) + ( TargetY * TargetY );
+			const ScalarType DistanceSquared = HorizontalDistanceSquared + ( TargetZ * TargetZ );
+			if ( !bCanAim || DistanceSquared < MinRangeSquared || DistanceSquared > MaxRangeSquared || DistanceSquared <= 0 )
+			{
+				return false;
+			}
+
+			// Same as CalculateNearestValidTargetLocation2D: these would be pushed out, so the barrel can't line up with them.
+			if ( DistanceSquared < MinimumTargetDistance * MinimumTargetDistance )
+			{
+				return false;
+			}
+
+			// Targets straight above/below the AimJoint have no direction, so they always count as inside the arc (the solve's yaw is 0).
+			const ScalarType HorizontalDistance = std::sqrt( HorizontalDistanceSquared );
+			if ( !bAnyYaw && HorizontalDistance > 0 && !IsWithinHalfAngle( TargetX, TargetY, HorizontalDistance, SinHalfArc, CosHalfArc ) )
+			{
+				return false;
+			}
+
+			if ( bAnyPitch )
+			{
+				return true;
+			}
+
+			const ScalarType Distance = std::sqrt( DistanceSquared );
+			const ScalarType TableIndex = ( MinimumTargetDistance / Distance ) * ( NumEntries - 1 );
+			const int LowerIndex = std::min( static_cast<int>( TableIndex ), NumEntries - 2 );
+			const ScalarType Alpha = TableIndex - ScalarType( LowerIndex );
+			const ScalarType Cos = CosTable[LowerIndex] + ( ( CosTable[LowerIndex + 1] - CosTable[LowerIndex] ) * Alpha );
+			const ScalarType Sin = SinTable[LowerIndex] + ( ( SinTable[LowerIndex + 1] - SinTable[LowerIndex] ) * Alpha );
+
+			// The target, lined up with the turret, is (HorizontalDistance, TargetZ).  It's within the pitch limits if its angle to the
+			// table's direction (which is normalized) is at most half of their range.
+			const ScalarType DotProduct = ( HorizontalDistance * Cos ) + ( TargetZ * Sin );
+			const ScalarType CrossProduct = ( TargetZ * Cos ) - ( HorizontalDistance * Sin );
+			return IsWithinHalfAngle( DotProduct, CrossProduct, Distance, SinHalfPitchRange, CosHalfPitchRange );
+		}
+
+		/**
+		 * Same as CanHit, but finds out by solving.  Much slower.  Only useful for testing and benchmarking against CanHit.
+		 *
+		 * @param Geometry					The turret this coverage was made for.
+		 * @param Limits					The limits this coverage was made with.
+		 * @param Target_InAimJointSpace	The point, relative to the (unrotated) AimJoint.
+		 * @param Out_Pitch					OUT (optional) - The pitch from the solve (in degrees).
+		 * @return Returns true if the turret can hit the point.
+		 */
+		template<typename Vector3Type>
+		static bool CanHit_Solve( const TAimGeometry<ScalarType, Vector2Type>& Geometry, const TAimLimits<ScalarType>& Limits, const Vector3Type& Target_InAimJointSpace, ScalarType* Out_Pitch = nullptr )
+		{
+			const ScalarType TargetX = ScalarType( Target_InAimJointSpace.X );
+			const ScalarType TargetY = ScalarType( Target_InAimJointSpace.Y );
+			const ScalarType TargetZ = ScalarType( Target_InAimJointSpace.Z );
+
+			unsigned int Events = 0;
+			const TAimAngles<ScalarType> Angles = Geometry.Solve( Target_InAimJointSpace, EAimAccuracy::Exact, &Events );
+			if ( Out_Pitch )
+			{
+				*Out_Pitch = Angles.Pitch;
+			}
+
+			// The barrel doesn't line up with targets that were pushed out, or that have no root.
+			if ( ( Events & ( EAimSolveEvent::TargetClamped | EAimSolveEvent::NoRoots | EAimSolveEvent::BothDistancesNegative ) ) != 0 )
+			{
+				return false;
+			}
+
+			const ScalarType Distance = std::sqrt( ( TargetX * TargetX ) + ( TargetY * TargetY ) + ( TargetZ * TargetZ ) );
+			if ( Distance < Limits.MinRange || Distance > Limits.MaxRange || Distance <= 0 )
+			{
+				return false;
+			}
+
+			const bool bStraightUpOrDown = ( TargetX == 0 && TargetY == 0 );
+			if ( Limits.HalfArcDegrees < 180 && !bStraightUpOrDown && std::abs( Angles.Yaw ) > Limits.HalfArcDegrees )
+			{
+				return false;
+			}
+
+			return ( Limits.MaxPitchDegrees - Limits.MinPitchDegrees ) >= 360
+				|| ( Angles.Pitch >= Limits.MinPitchDegrees && Angles.Pitch <= Limits.MaxPitchDegrees );
+		}
+
+	private:
+		/** False if the turret can't line its barrel up with anything. */
+		bool bCanAim;
+
+		bool bAnyYaw;
+		bool bAnyPitch;
+
+		ScalarType MinRangeSquared;
+		ScalarType MaxRangeSquared;
+		ScalarType SinHalfArc;
+		ScalarType CosHalfArc;
+		ScalarType SinHalfPitchRange;
+		ScalarType CosHalfPitchRange;
+
+		/** From the geometry.  Closer targets are pushed out by the solve. */
+		ScalarType MinimumTargetDistance;
+
+		/**
+		 * Direction of the ScaledBarrelEnd, rotated by the middle of the pitch limits, for targets at MinimumTargetDistance / (Index / (NumEntries - 1)).
+		 * Entry 0 is for targets infinitely far away, and the last one for targets at the MinimumTargetDistance.
+		 */
+		ScalarType CosTable[NumEntries];
+		ScalarType SinTable[NumEntries];
+	};
+	/**
+	 * Checks if a turret might be able to aim at any point in an axis aligned box, from its range and yaw arc only.  This is conservative:
+	 * false means no point in the box can be hit, but true doesn't mean any can (the pitch limits and the MinimumTargetDistance aren't
+	 * checked).
+	 *
+	 * @param Limits			The turret's limits.
+	 * @param AimJointLocation	Location of the AimJoint.
+	 * @param Forward2D			The turret's (normalized) forward on the "X-Y" plane.  Zero if the turret isn't upright, since its yaw arc
+	 *							doesn't line up with the "X-Y" plane then, and only the range is checked.
+	 * @param RegionMin			Smallest corner of the box, in the same space as AimJointLocation.
+	 * @param RegionMax			Largest corner of the box.
+	 * @return Returns false if the turret can't possibly aim at any point in the box.
+	 */
+	template<typename ScalarType, typename Vector3Type, typename Vector2Type>
+	inline bool MayCoverRegion( const TAimLimits<ScalarType>& Limits, const Vector3Type& AimJointLocation, const Vector2Type& Forward2D, const Vector3Type& RegionMin, const Vector3Type& RegionMax )
+	{
+		// The nearest point of a box is the AimJoint clamped to it, and the farthest is one of its corners.
+		const ScalarType MinOffsets[] = { ScalarType( RegionMin.X - AimJointLocation.X ), ScalarType( RegionMin.Y - AimJointLocation.Y ), ScalarType( RegionMin.Z - AimJointLocation.Z ) };
+		const ScalarType MaxOffsets[] = { ScalarType( RegionMax.X - AimJointLocation.X ), ScalarType( RegionMax.Y - AimJointLocation.Y ), ScalarType( RegionMax.Z - AimJointLocation.Z ) };
+		ScalarType NearestDistanceSquared = 0;
+		ScalarType FarthestDistanceSquared = 0;
+		for ( int Axis = 0; Axis < 3; ++Axis )
+		{
+			const ScalarType Nearest = ( MinOffsets[Axis] > 0 ) ? MinOffsets[Axis] : ( ( MaxOffsets[Axis] < 0 ) ? -MaxOffsets[Axis] : ScalarType( 0 ) );
+			const ScalarType Farthest = std::max( std::abs( MinOffsets[Axis] ), std::abs( MaxOffsets[Axis] ) );
+			NearestDistanceSquared += Nearest * Nearest;
+			FarthestDistanceSquared += Farthest * Farthest;
+		}
+
+		if ( NearestDistanceSquared > Limits.MaxRange * Limits.MaxRange || FarthestDistanceSquared < Limits.MinRange * Limits.MinRange )
+		{
+			return false;
+		}
+
+		if ( Limits.HalfArcDegrees >= 180 || ( Forward2D.X == 0 && Forward2D.Y == 0 ) )
+		{
+			return true;
+		}
+
+		// Points straight above/below the AimJoint always count as inside the arc.
+		if ( MinOffsets[0] <= 0 && MaxOffsets[0] >= 0 && MinOffsets[1] <= 0 && MaxOffsets[1] >= 0 )
+		{
+			return true;
+		}
+
+		// Seen from outside, the region covers less than 180 degrees around the AimJoint, spanned by its corners.  Measuring the corners from
+		// the direction to the region's center keeps them all on the same side of the +/-180 degree seam.
+		const Vector2Type ToCenter = GetSafeNormal2D( Vector2Type( ( MinOffsets[0] + MaxOffsets[0] ) / 2, ( MinOffsets[1] + MaxOffsets[1] ) / 2 ) );
+		const Vector2Type Corners[] =
+		{
+			Vector2Type( MinOffsets[0], MinOffsets[1] ),
+			Vector2Type( MaxOffsets[0], MinOffsets[1] ),
+			Vector2Type( MinOffsets[0], MaxOffsets[1] ),
+			Vector2Type( MaxOffsets[0], MaxOffsets[1] ),
+		};
+
+		ScalarType MinAngle = TConstants<ScalarType>::Pi();
+		ScalarType MaxAngle = -TConstants<ScalarType>::Pi();
+		for ( const Vector2Type& Corner : Corners )
+		{
+			const ScalarType Angle = std::atan2( ScalarType( Cross2D( ToCenter, Corner ) ), ScalarType( Dot2D( ToCenter, Corner ) ) );
+			MinAngle = std::min( MinAngle, Angle );
+			MaxAngle = std::max( MaxAngle, Angle );
+		}
+
+		// Two arcs overlap if their middles are no farther apart than their half widths put together.
+		const ScalarType RegionMiddle = std::atan2( ScalarType( ToCenter.Y ), ScalarType( ToCenter.X ) ) + ( ( MinAngle + MaxAngle ) / 2 );
+		const ScalarType ForwardAngle = std::atan2( ScalarType( Forward2D.Y ), ScalarType( Forward2D.X ) );
+		const ScalarType Separation = std::abs( std::remainder( RegionMiddle - ForwardAngle, 2 * TConstants<ScalarType>::Pi() ) );
+		return Separation <= ( Limits.HalfArcDegrees / TConstants<ScalarType>::RadiansToDegrees() ) + ( ( MaxAngle - MinAngle ) / 2 );
+	}
+}
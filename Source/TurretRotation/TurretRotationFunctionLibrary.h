@@ -1,196 +1,348 @@
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Kismet/BlueprintFunctionLibrary.h"
-#include "TurretRotationFunctionLibrary.generated.h"
-
-/** This function library handles rotation for turrets with an "offset" aim joint. */
-UCLASS()
-class TURRETROTATION_API UTurretRotationFunctionLibrary : public UBlueprintFunctionLibrary
-{
-	GENERATED_BODY()
-
-public:
-	/**
-	 * Forces the construction script to run for a given Actor.
-	 * We use this to make sure that turrets update whenever targets are moved inside the editor.
-	 *
-	 * @param MyActor	The actor to update
-	 */
-	UFUNCTION( BlueprintCallable )
-	static void ForceExecuteConstructionScript( AActor* MyActor );
-
-	/**
-	 * This is the "complete" turret calculation function. 
-	 * If you're looking for the "final" function to get your own turret working in your own project, then use this one.
-	 * This function will calculate the rotation needed for the AimJoint to aim the turret's barrel towards the given target.
-	 *
-	 * @param ActorWorldTransform		This is included so that an Actor's Scale/Rotation/Translation are handled during the rotation calculation.
-	 * @param Actor_To_AimJoint			The vector from the Actor's location to the AimJoint's location (when the Actor is not Rotated/Scaled).
-	 * @param AimJoint_To_BarrelStart	The vector from the AimJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
-	 * @param BarrelStart_To_BarrelEnd	The vector for the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
-	 * @param Out_AimJointRotation		OUT - The new rotation for the AimJoint (relative to the Actor).
-	 */
-	UFUNCTION( BlueprintPure )
-	static void CalculateTurretRotation_ForActor(
-		const FTransform& ActorWorldTransform,
-		const FVector& Actor_To_AimJoint,
-		const FVector& AimJoint_To_BarrelStart,
-		const FVector& BarrelStart_To_BarrelEnd,
-		const FVector& TargetWorldLocation,
-		FRotator& Out_AimJointRotation );
-
-	/** 
-	 * Calculates turret rotation based on the AimJoint's world transform, and the BarrelStart/BarrelEnd/TargetWorldLocation.
-	 * It is assumed that the Actor's transform was already handled in CalculateTurretRotation_ForActor in order to calculate the AimJointWorldSpace transform.
-	 * If that's not the case, then this function may only work if the Actor has no Rotation/Scale applied to it.
-	 * 
-	 * @param AimJointWorldSpaceTransform	Transform that represents the AimJoint in world space.
-	 * @param AimJoint_To_BarrelStart		The vector from the AimJoint to the BarrelStart. This is expected to be scaled by the Actor's scale in CalculateTurretRotation_ForActor.
-	 * @param BarrelStart_To_BarrelEnd		The vector from the BarrelStart to the BarrlEnd. This is expected to be scaled by the Actor's scale in  CalculateTurretRotation_ForActor.
-	 * @param TargetWorldLocation			The target's location in world space.
-	 * @param Out_AimJointRotation			OUT - The new rotation for the AimJoint (relative to the Actor).
-	 */
-	UFUNCTION( BlueprintPure )
-	static void CalculateTurretRotation_ForAimJoint(
-		const FTransform& AimJointWorldSpaceTransform,
-		const FVector AimJoint_To_BarrelStart,
-		const FVector BarrelStart_To_BarrelEnd,
-		const FVector TargetWorldLocation,
-		FRotator& Out_AimJointRotation );
-
-	/**
-	 * In Unreal, Z is "up", and the "X-Y" plane makes up the horizontal plane.
-	 * This calculates the yaw, or the angle across the "X-Y" plane, for the AimJoint to rotate until it is aligned with the target location. 
-	 *
-	 * @param AimJointLocation	Location of the AimJoint.  
-	 * @param TargetLocation	Location of the target.
-	 * @return Returns the yaw needed to align the AimJoint (and the turret) with the target location.
-	 */
-	UFUNCTION( BlueprintPure )
-	static float CalculateTurretYaw( const FVector& AimJointLocation, const FVector& TargetLocation );
-
-	/**
-	 * This function assumes that the AimJoint, BarrelStart, BarrelEnd, and TargetLocation are all aligned on the "X-Z" plane.
-	 * It calculates the pitch, or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the TargetLocation.
-	 * 
-	 * @param AimJointLocation	Location of the AimJoint.
-	 * @param BarrelStart		Location of the BarrelStart.
-	 * @param BarrelEnd			Location of the BarrelEnd.
-	 * @param TargetLocation	Location of the Target.
-	 * @return Returns the pitch, or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the TargetLocation.
-	 */
-	UFUNCTION( BlueprintPure )
-	static float CalculateTurretPitch(
-		const FVector& AimJointLocation,
-		const FVector& BarrelStartLocation,
-		const FVector& BarrelEndLocation,
-		const FVector& TargetLocation );
-
-private:
-
-	/**
-	 * The correct pitch to calculate in CalculateTurretPitch is undefined if the Target is too close to the AimJoint.
-	 * If the Target is too close to the AimJoint, then it is technically impossible for the turret to point at the Target.
-	 * If an invalid Target Location is detected, then this function will return a new Location that is far enough from the AimJoint for 
-	 * calculations to continue. This will result in behavior that "makes sense" for the invalid case, even though the turret won't end up 
-	 * pointing at the Target.
-	 *
-	 * @param AimJointLocation2D	Location of the AimJoint.
-	 * @param BarrelStartLocation2D	Location of the BarrelStart.
-	 * @param BarrelEndLocation2D	Location of the BarrelEnd.
-	 * @param TargetLocation2D		Location of the Target.
-	 * @return Returns a "valid" Target Location that should result in behavior that "makes sense" if the Target is too close to the AimJoint.
-	 */
-	static FVector2D CalculateNearestValidTargetLocation2D(
-		const FVector2D& AimJointLocation2D,
-		const FVector2D& BarrelStartLocation2D,
-		const FVector2D& BarrelEndLocation2D,
-		const FVector2D& TargetLocation2D );
-
-	/** 
-	 * For CalculateNearestValidTargetLocation2D, find the Out_BarrelRayDistance so that the ScaledBarrelEnd can be found.
-	 *
-	 * @param AimJointLocation2D	Location of the AimJoint.
-	 * @param BarrelStartLocation2D	Location of the BarrelStart.
-	 * @param BarrelEndLocation2D	Location of the BarrelEnd.
-	 * @param TargetLocation2D		Location of the Target.
-	 * @param Out_BarrelRayDistance	OUT - The found BarrelRayDistance.
-	 * @return Returns true if a valid BarrelRayDistance was found, otherwise false.
-	 */
-	static bool CalculateBarrelRayDistance( const FVector2D& AimJointLocation2D,
-									        const FVector2D& BarrelStartLocation2D,
-									        const FVector2D& BarrelEndLocation2D,
-									        const FVector2D& TargetLocation2D,
-									        float& Out_BarrelRayDistance );
-
-	/** 
-	 * Calculates the quadratic coefficients for CalculateBarrelRayDistance
-	 * 
-	 * @param AimJointLocation2D	Location of the AimJoint.
-	 * @param BarrelStartLocation2D	Location of the BarrelStart.
-	 * @param BarrelEndLocation2D	Location of the BarrelEnd.
-	 * @param TargetLocation2D		Location of the Target.
-	 * @param Out_A					OUT - Value of coefficient "a"
-	 * @param Out_A					OUT - Value of coefficient "b"
-	 * @param Out_C					OUT - Value of coefficient "c"
-	 */
-	static void CalculateQuadraticCoefficients(
-		const FVector2D& AimJointLocation2D,
-		const FVector2D& BarrelStartLocation2D,
-		const FVector2D& BarrelEndLocation2D,
-		const FVector2D& TargetLocation2D,
-		float& Out_A,
-		float& Out_B,
-		float& Out_C );
-
-	/** 
-	 * Calculates the quadratic roots for CalculateBarrelRayDistance
-	 *
-	 * @param A			Quadratic coefficient "a"
-	 * @param B			Quadratic coefficient "b"
-	 * @param C			Quadratic coefficient "c"
-	 * @param Out_X1	OUT - Quadratic coefficient "x1"
-	 * @param Out_X2	OUT - Quadratic coefficient "x2"
-	 * @return Returns true if the roots could be found, otherwise false.
-	 */
-	static bool CalculateQuadraticRoots( float A, float B, float C, float& Out_X1, float& Out_X2 );
-
-	/**
-	 * Given two ray distances, this selects the best one (the one in front of BarrelStart).
-	 *
-	 * @param FirstDistance		First ray distance
-	 * @param SecondDistance	Second ray distance
-	 * @return Returns the best ray distance (the one in front of BarrelStart).
-	 */
-	static float SelectBestRayDistance( float FirstDistance, float SecondDistance );
-
-
-	/** 
-	 * Calculates the angle to rotate from the FirstVector to the SecondVector.  Also handles whether to rotate clockwise or counterclockwise.
-	 *
-	 * @param FirstVector	Arbitrary 2D vector.
-	 * @param SecondVector	Arbitrary 2D vector.
-	 * @return Returns the angle needed to rotate the FirstVector to meet the SecondVector.
-	 */
-	static float CalculateAngleToRotateFromFirstVectorToSecondVector( FVector2D FirstVector, FVector2D SecondVector );
-
-	/** 
-	 * Calculates the angle between the two given normalized 2D vectors.
-	 *
-	 * @param FirstVector	Normalized 2D vector.
-	 * @param SecondVector	Normalized 2D vector.
-	 * @return Returns the angle between the two given normalized vectors.
-	 */
-	static float CalculateAngleBetweenNormalizedVectors( FVector2D FirstVector_Normalized, FVector2D SecondVector_Normalized );
-
-	/**
-	 * Decides if the FirstVector should be rotated counterclockwise to meet the SecondVector (implies that a counterclockwise rotation
-	 * is shorter than a clockwise one).
-	 * 
-	 * @param FirstVector	Arbitrary 2D vector.
-	 * @param SecondVector	Arbitrary 2D vector.
-	 * @return Returns true if the FirstVector should be rotated counterclockwise to meet the SecondVector, otherwise false.
-	 */
-	static bool ShouldTurnCounterClockwiseToMeet( FVector2D FirstVector, FVector2D SecondVector );
-};
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "TurretAimGeometry.h"
+#include "TurretRotationFunctionLibrary.generated.h"
+
+struct FTurretRotationBatchScratch;
+
+/**
+ * How accurately the trig in the yaw/pitch solve is done.  Same as TurretRotationCore::EAimAccuracy (see there for the details).
+ */
+UENUM( BlueprintType )
+enum class ETurretAimAccuracy : uint8
+{
+	/** Standard library Atan2/Acos. */
+	Exact,
+
+	/** Polynomial Atan2, within AIM_ACCURACY_FAST_MAX_ERROR_DEGREES (0.0002) degrees of Exact. */
+	Fast,
+
+	/** Lower order polynomial Atan2, within AIM_ACCURACY_APPROXIMATE_MAX_ERROR_DEGREES (0.036) degrees of Exact. */
+	Approximate,
+};
+
+/** 
+ * This function library handles rotation for turrets with an "offset" aim joint.
+ * The math itself lives in TurretRotationCore.h (which has no engine dependencies), this library just exposes it to the engine and Blueprint.
+ */
+UCLASS()
+class TURRETROTATION_API UTurretRotationFunctionLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Forces the construction script to run for a given Actor.
+	 * We use this to make sure that turrets update whenever targets are moved inside the editor.
+	 *
+	 * @param MyActor	The actor to update
+	 */
+	UFUNCTION( BlueprintCallable )
+	static void ForceExecuteConstructionScript( AActor* MyActor );
+
+	/**
+	 * Asks for a turret to be re-aimed during the next editor tick.  Use this instead of ForceExecuteConstructionScript when a target is moved.
+	 * However many times a turret is requested during a tick, it's only updated once.  Turrets with a UTurretAimComponent only have their
+	 * AimJoint's rotation updated, other turrets fall back to having their construction script rerun.
+	 * Does nothing outside of the editor.
+	 *
+	 * @param TurretActor	The turret to update
+	 */
+	UFUNCTION( BlueprintCallable )
+	static void RequestEditorTurretRefresh( AActor* TurretActor );
+
+	/**
+	 * This is the "complete" turret calculation function. 
+	 * If you're looking for the "final" function to get your own turret working in your own project, then use this one.
+	 * This function will calculate the rotation needed for the AimJoint to aim the turret's barrel towards the given target.
+	 *
+	 * @param ActorWorldTransform		This is included so that an Actor's Scale/Rotation/Translation are handled during the rotation calculation.
+	 * @param Actor_To_AimJoint			The vector from the Actor's location to the AimJoint's location (when the Actor is not Rotated/Scaled).
+	 * @param AimJoint_To_BarrelStart	The vector from the AimJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param BarrelStart_To_BarrelEnd	The vector for the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param Out_AimJointRotation		OUT - The new rotation for the AimJoint (relative to the Actor).
+	 */
+	UFUNCTION( BlueprintPure )
+	static void CalculateTurretRotation_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_AimJoint,
+		const FVector& AimJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation,
+		FRotator& Out_AimJointRotation );
+
+	/**
+	 * Same as the Blueprint version, but solves with the given FTurretSolveSettings and counts the solve in the given FTurretSolveStats
+	 * (if any), so that callers solving many turrets only read the console variables and touch the stats once.
+	 */
+	static void CalculateTurretRotation_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_AimJoint,
+		const FVector& AimJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation,
+		FRotator& Out_AimJointRotation,
+		const FTurretSolveSettings& SolveSettings,
+		FTurretSolveStats* SolveStats );
+
+	/**
+	 * Batched version of CalculateTurretRotation_ForActor, for when there are a lot of turrets to update at once.
+	 * Every input is a separate array (structure-of-arrays), and element i of each array belongs to turret i.
+	 * The yaw/pitch solve runs TURRET_BATCH_WIDTH turrets at a time using SIMD math (see FTurretRotationBatchKernel),
+	 * and the results match CalculateTurretRotation_ForActor within TURRET_BATCH_TOLERANCE_DEGREES.
+	 * This isn't exposed to Blueprint since Blueprint can't pass array views.
+	 *
+	 * The solve works in the caller's FTurretRotationBatchScratch, so a caller that keeps one around (one per thread calling this) only
+	 * allocates when the number of turrets grows.  UTurretInstancedAimComponent does the same with its own.
+	 *
+	 * @param ActorWorldTransforms		World transform of each turret's Actor.
+	 * @param Actor_To_AimJoints		The vector from each Actor's location to its AimJoint's location (when the Actor is not Rotated/Scaled).
+	 * @param AimJoint_To_BarrelStarts	The vector from each AimJoint to its BarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param BarrelStart_To_BarrelEnds	The vector from each BarrelStart to its BarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param TargetWorldLocations		Each turret's target location in world space.
+	 * @param Scratch					Working memory for the solve.  Its contents are overwritten.
+	 * @param Out_Yaws					OUT - The new yaw for each AimJoint (relative to the Actor).
+	 * @param Out_Pitches				OUT - The new pitch for each AimJoint (relative to the Actor).
+	 */
+	static void CalculateTurretRotations_ForActors(
+		TArrayView<const FTransform> ActorWorldTransforms,
+		TArrayView<const FVector> Actor_To_AimJoints,
+		TArrayView<const FVector> AimJoint_To_BarrelStarts,
+		TArrayView<const FVector> BarrelStart_To_BarrelEnds,
+		TArrayView<const FVector> TargetWorldLocations,
+		FTurretRotationBatchScratch& Scratch,
+		TArrayView<float> Out_Yaws,
+		TArrayView<float> Out_Pitches );
+
+	/**
+	 * Lead aiming version of CalculateTurretRotation_ForActor, for turrets that fire projectiles under gravity at moving targets.
+	 * The offset barrel is taken into account, and the projectile is assumed to leave the BarrelEnd along the barrel.
+	 * The number of iterations is capped by Settings.MaxIterations, so the worst case cost is known.  See TurretRotationBallistics.h.
+	 *
+	 * @param ActorWorldTransform		This is included so that an Actor's Scale/Rotation/Translation are handled during the rotation calculation.
+	 * @param Actor_To_AimJoint			The vector from the Actor's location to the AimJoint's location (when the Actor is not Rotated/Scaled).
+	 * @param AimJoint_To_BarrelStart	The vector from the AimJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param BarrelStart_To_BarrelEnd	The vector for the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param TargetWorldLocation		The target's current location in world space.
+	 * @param TargetVelocity			The target's velocity in world space.
+	 * @param TargetAcceleration		The target's acceleration in world space.  Leave at zero if unknown.
+	 * @param Settings					Muzzle speed, gravity, high/low arc, and the iteration cap.
+	 * @param Out_Solution				OUT - The new rotation for the AimJoint, whether there is a firing solution, and the flight time.
+	 */
+	UFUNCTION( BlueprintPure )
+	static void CalculateTurretBallisticRotation_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_AimJoint,
+		const FVector& AimJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation,
+		const FVector& TargetVelocity,
+		const FVector& TargetAcceleration,
+		const FTurretBallisticSettings& Settings,
+		FTurretBallisticSolution& Out_Solution );
+
+	/**
+	 * Batched version of CalculateTurretBallisticRotation_ForActor.  Element i of each array belongs to turret i.
+	 * Takes already made geometries, since turrets that are solved every frame should keep theirs around anyway.
+	 * This isn't exposed to Blueprint since Blueprint can't pass array views.
+	 *
+	 * @param Geometries				Each turret's geometry (made with the Actor's current scale).
+	 * @param ActorWorldTransforms		World transform of each turret's Actor.
+	 * @param TargetWorldLocations		Each turret's target location in world space.
+	 * @param TargetVelocities			Each turret's target velocity in world space.
+	 * @param TargetAccelerations		Each turret's target acceleration in world space.  May be empty if the accelerations are unknown.
+	 * @param Settings					Muzzle speed, gravity, high/low arc, and the iteration cap (shared by every turret).
+	 * @param Out_Solutions				OUT - The solution for each turret.
+	 */
+	static void CalculateTurretBallisticRotations_ForActors(
+		TArrayView<const FTurretAimGeometry> Geometries,
+		TArrayView<const FTransform> ActorWorldTransforms,
+		TArrayView<const FVector> TargetWorldLocations,
+		TArrayView<const FVector> TargetVelocities,
+		TArrayView<const FVector> TargetAccelerations,
+		const FTurretBallisticSettings& Settings,
+		TArrayView<FTurretBallisticSolution> Out_Solutions );
+
+	/** 
+	 * Calculates turret rotation based on the AimJoint's world transform, and the BarrelStart/BarrelEnd/TargetWorldLocation.
+	 * It is assumed that the Actor's transform was already handled in CalculateTurretRotation_ForActor in order to calculate the AimJointWorldSpace transform.
+	 * If that's not the case, then this function may only work if the Actor has no Rotation/Scale applied to it.
+	 * 
+	 * @param AimJointWorldSpaceTransform	Transform that represents the AimJoint in world space.
+	 * @param AimJoint_To_BarrelStart		The vector from the AimJoint to the BarrelStart. This is expected to be scaled by the Actor's scale in CalculateTurretRotation_ForActor.
+	 * @param BarrelStart_To_BarrelEnd		The vector from the BarrelStart to the BarrlEnd. This is expected to be scaled by the Actor's scale in  CalculateTurretRotation_ForActor.
+	 * @param TargetWorldLocation			The target's location in world space.
+	 * @param Out_AimJointRotation			OUT - The new rotation for the AimJoint (relative to the Actor).
+	 */
+	UFUNCTION( BlueprintPure )
+	static void CalculateTurretRotation_ForAimJoint(
+		const FTransform& AimJointWorldSpaceTransform,
+		const FVector AimJoint_To_BarrelStart,
+		const FVector BarrelStart_To_BarrelEnd,
+		const FVector TargetWorldLocation,
+		FRotator& Out_AimJointRotation );
+
+	/**
+	 * Fast path for CalculateTurretRotation_ForAimJoint.  Instead of copying and inverting the AimJoint's transform, the target is moved
+	 * into AimJoint space with a matrix the caller computed once.  The yaw's sine/cosine come straight from the target's direction, so the
+	 * target is lined up with the turret without a second round of trig, and the result is built as a quaternion without going through
+	 * degrees or an FRotator.  Feed it to SetRelativeRotation( FQuat ).
+	 * This isn't exposed to Blueprint since Blueprint doesn't support FQuat.
+	 *
+	 * @param WorldToAimJoint				Inverse of the AimJoint's world transform, without any scale (the inverse of its rotation/translation matrix).
+	 * @param AimJoint_To_BarrelStart		The vector from the AimJoint to the BarrelStart. This is expected to be scaled by the Actor's scale.
+	 * @param BarrelStart_To_BarrelEnd		The vector from the BarrelStart to the BarrelEnd. This is expected to be scaled by the Actor's scale.
+	 * @param TargetWorldLocation			The target's location in world space.
+	 * @return Returns the new rotation for the AimJoint (relative to the Actor).
+	 */
+	static FQuat CalculateTurretRotationQuat_ForAimJoint(
+		const FMatrix& WorldToAimJoint,
+		const FVector& AimJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation );
+
+	/**
+	 * Version of CalculateTurretRotation_ForActor for turrets where the yaw and the pitch are separate joints, each with its own offset:
+	 * a YawJoint (the yaw ring) that only yaws, and a PitchJoint offset from it that only pitches.  The barrel may also sit to the side
+	 * of the YawJoint.  Each joint is solved in closed form, in order, so there's no iterative IK.  See TurretRotationChain.h.
+	 *
+	 * @param ActorWorldTransform			This is included so that an Actor's Scale/Rotation/Translation are handled during the rotation calculation.
+	 * @param Actor_To_YawJoint				The vector from the Actor's location to the YawJoint's location (when the Actor is not Rotated/Scaled).
+	 * @param YawJoint_To_PitchJoint		The vector from the YawJoint to the PitchJoint (when the Actor is not Rotated/Scaled).
+	 * @param PitchJoint_To_BarrelStart		The vector from the PitchJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param BarrelStart_To_BarrelEnd		The vector from the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param TargetWorldLocation			The target's location in world space.
+	 * @param Out_YawJointRotation			OUT - The new rotation for the YawJoint (relative to the Actor).  Only has a yaw.
+	 * @param Out_PitchJointRotation		OUT - The new rotation for the PitchJoint (relative to the YawJoint).  Only has a pitch.
+	 */
+	UFUNCTION( BlueprintPure )
+	static void CalculateTurretChainRotation_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_YawJoint,
+		const FVector& YawJoint_To_PitchJoint,
+		const FVector& PitchJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation,
+		FRotator& Out_YawJointRotation,
+		FRotator& Out_PitchJointRotation );
+
+	/** Same as the Blueprint version, but solves with the given FTurretSolveSettings/FTurretSolveStats.  See CalculateTurretRotation_ForActor. */
+	static void CalculateTurretChainRotation_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_YawJoint,
+		const FVector& YawJoint_To_PitchJoint,
+		const FVector& PitchJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& TargetWorldLocation,
+		FRotator& Out_YawJointRotation,
+		FRotator& Out_PitchJointRotation,
+		const FTurretSolveSettings& SolveSettings,
+		FTurretSolveStats* SolveStats );
+
+	/**
+	 * Same as CalculateTurretChainRotation_ForActor, for turrets that also carry a secondary weapon on its own SubPitchJoint, offset from
+	 * the PitchJoint.  The yaw/pitch aim the main barrel at the TargetWorldLocation, and the sub-pitch then aims the sub-barrel at the
+	 * SubTargetWorldLocation (pass the same location to aim both at one target).  The sub-barrel can only pitch, so a sub target that isn't
+	 * in line with the main barrel's yaw is aimed at as if it were.
+	 *
+	 * @param ActorWorldTransform				This is included so that an Actor's Scale/Rotation/Translation are handled during the rotation calculation.
+	 * @param Actor_To_YawJoint					The vector from the Actor's location to the YawJoint's location (when the Actor is not Rotated/Scaled).
+	 * @param YawJoint_To_PitchJoint			The vector from the YawJoint to the PitchJoint (when the Actor is not Rotated/Scaled).
+	 * @param PitchJoint_To_BarrelStart			The vector from the PitchJoint to the BarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param BarrelStart_To_BarrelEnd			The vector from the BarrelStart to the BarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param PitchJoint_To_SubPitchJoint		The vector from the PitchJoint to the SubPitchJoint (when the Actor is not Rotated/Scaled).
+	 * @param SubPitchJoint_To_SubBarrelStart	The vector from the SubPitchJoint to the SubBarrelStart (when the Actor is not Rotated/Scaled).
+	 * @param SubBarrelStart_To_SubBarrelEnd	The vector from the SubBarrelStart to the SubBarrelEnd (when the Actor is not Rotated/Scaled).
+	 * @param TargetWorldLocation				The main barrel's target location in world space.
+	 * @param SubTargetWorldLocation			The sub-barrel's target location in world space.
+	 * @param Out_YawJointRotation				OUT - The new rotation for the YawJoint (relative to the Actor).  Only has a yaw.
+	 * @param Out_PitchJointRotation			OUT - The new rotation for the PitchJoint (relative to the YawJoint).  Only has a pitch.
+	 * @param Out_SubPitchJointRotation			OUT - The new rotation for the SubPitchJoint (relative to the PitchJoint).  Only has a pitch.
+	 */
+	UFUNCTION( BlueprintPure )
+	static void CalculateTurretChainRotationWithSubBarrel_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_YawJoint,
+		const FVector& YawJoint_To_PitchJoint,
+		const FVector& PitchJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& PitchJoint_To_SubPitchJoint,
+		const FVector& SubPitchJoint_To_SubBarrelStart,
+		const FVector& SubBarrelStart_To_SubBarrelEnd,
+		const FVector& TargetWorldLocation,
+		const FVector& SubTargetWorldLocation,
+		FRotator& Out_YawJointRotation,
+		FRotator& Out_PitchJointRotation,
+		FRotator& Out_SubPitchJointRotation );
+
+	/** Same as the Blueprint version, but solves with the given FTurretSolveSettings/FTurretSolveStats.  See CalculateTurretRotation_ForActor. */
+	static void CalculateTurretChainRotationWithSubBarrel_ForActor(
+		const FTransform& ActorWorldTransform,
+		const FVector& Actor_To_YawJoint,
+		const FVector& YawJoint_To_PitchJoint,
+		const FVector& PitchJoint_To_BarrelStart,
+		const FVector& BarrelStart_To_BarrelEnd,
+		const FVector& PitchJoint_To_SubPitchJoint,
+		const FVector& SubPitchJoint_To_SubBarrelStart,
+		const FVector& SubBarrelStart_To_SubBarrelEnd,
+		const FVector& TargetWorldLocation,
+		const FVector& SubTargetWorldLocation,
+		FRotator& Out_YawJointRotation,
+		FRotator& Out_PitchJointRotation,
+		FRotator& Out_SubPitchJointRotation,
+		const FTurretSolveSettings& SolveSettings,
+		FTurretSolveStats* SolveStats );
+
+	/**
+	 * Changes how accurately every turret solve does its trig: every function in this library, UTurretAimComponent, ATurretAimManager,
+	 * the batched solve, and the Offset Turret Aim AnimGraph node.  Same as setting the TurretRotation.Accuracy console variable.
+	 *
+	 * @param Accuracy	The new accuracy tier.
+	 */
+	UFUNCTION( BlueprintCallable )
+	static void SetTurretAimAccuracy( ETurretAimAccuracy Accuracy );
+
+	/** @return Returns how accurately every turret solve does its trig. */
+	UFUNCTION( BlueprintPure )
+	static ETurretAimAccuracy GetTurretAimAccuracy();
+
+	/**
+	 * In Unreal, Z is "up", and the "X-Y" plane makes up the horizontal plane.
+	 * This calculates the yaw, or the angle across the "X-Y" plane, for the AimJoint to rotate until it is aligned with the target location. 
+	 *
+	 * @param AimJointLocation	Location of the AimJoint.  
+	 * @param TargetLocation	Location of the target.
+	 * @return Returns the yaw needed to align the AimJoint (and the turret) with the target location.
+	 */
+	UFUNCTION( BlueprintPure )
+	static float CalculateTurretYaw( const FVector& AimJointLocation, const FVector& TargetLocation );
+
+	/**
+	 * This function assumes that the AimJoint, BarrelStart, BarrelEnd, and TargetLocation are all aligned on the "X-Z" plane.
+	 * It calculates the pitch, or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the TargetLocation.
+	 * 
+	 * @param AimJointLocation	Location of the AimJoint.
+	 * @param BarrelStart		Location of the BarrelStart.
+	 * @param BarrelEnd			Location of the BarrelEnd.
+	 * @param TargetLocation	Location of the Target.
+	 * @return Returns the pitch, or the angle on the "X-Z" plane, for the AimJoint to rotate so the turret points to the TargetLocation.
+	 */
+	UFUNCTION( BlueprintPure )
+	static float CalculateTurretPitch(
+		const FVector& AimJointLocation,
+		const FVector& BarrelStartLocation,
+		const FVector& BarrelEndLocation,
+		const FVector& TargetLocation );
+
+	/** Same as the Blueprint version, but solves with the given FTurretSolveSettings/FTurretSolveStats.  See CalculateTurretRotation_ForActor. */
+	static float CalculateTurretPitch(
+		const FVector& AimJointLocation,
+		const FVector& BarrelStartLocation,
+		const FVector& BarrelEndLocation,
+		const FVector& TargetLocation,
+		const FTurretSolveSettings& SolveSettings,
+		FTurretSolveStats* SolveStats );
+};
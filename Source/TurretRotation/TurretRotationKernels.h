@@ -0,0 +1,316 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+
+/**
+ * Specialized versions of TAimGeometry::Solve, for the turret shapes that almost every turret has, without any engine dependencies.
+ *
+ * TAimGeometry::Solve handles a barrel pointing any way on the "X-Z" plane, starting anywhere.  Two things make most of that work
+ * unnecessary, and TAimKernel is compiled once for each combination:
+ *   - The barrel is parallel to "X" (BarrelStart_To_BarrelEnd has no Z).  The point on the barrel ray that is as far from the AimJoint as
+ *     the target is then at the BarrelStart's height, so it's one square root away, with no quadratic at all.
+ *   - There is no vertical offset (AimJoint_To_BarrelStart has no Z).  The BarrelStart is level with the AimJoint, which drops terms from
+ *     the quadratic.  With a barrel parallel to "X" as well, the barrel lines up with the AimJoint, and the pitch is simply the angle
+ *     to the target.
+ * Every kernel also skips the two normalizations at the end: the pitch comes straight from the cross/dot products of the ScaledBarrelEnd
+ * and the target, with one square root.
+ *
+ * Scale is applied when the geometry is made (see MakeFromActorVectors), so uniform and non-uniform scales end up with the same kernels.
+ *
+ * The kernel is picked once per geometry with ChooseAimKernel, and every kernel gives the same results as TAimGeometry::Solve
+ * (within float rounding, see AIM_KERNEL_TOLERANCE_DEGREES), including the EAimSolveEvent flags.
+ *
+ * The one shape where that doesn't hold is a BarrelEnd much closer to the AimJoint than the BarrelStart (a barrel pointing back past the
+ * AimJoint).  Targets there are only pushed out to the BarrelEnd's distance, and once the target is that much closer than the BarrelStart,
+ * the kernels' shortcuts and the general solve round differently enough to disagree by tenths of a degree (or by anything, as the target
+ * approaches the AimJoint).  Neither answer is better than the other; it's float conditioning.  ChooseAimKernel keeps those geometries
+ * on the general solve, so the tolerance holds for every geometry it picks a kernel for.
+ */
+
+/**
+ * Largest difference (in degrees) between any specialized kernel and TAimGeometry::Solve, at the same EAimAccuracy, in float, for any
+ * geometry that ChooseAimKernel picked the kernel for.
+ */
+#define AIM_KERNEL_TOLERANCE_DEGREES 0.1
+
+namespace TurretRotationCore
+{
+	/** Which version of the solve a geometry uses.  See ChooseAimKernel. */
+	enum class EAimKernel : unsigned char
+	{
+		/**
+		 * TAimGeometry::Solve itself.  Used when none of the others apply (a zero length barrel, or an AimJoint that isn't at the origin), and
+		 * for barrels that end much closer to the AimJoint than they start (see ChooseAimKernel).
+		 */
+		Reference,
+
+		/** Any barrel direction and any vertical offset.  Still skips the normalizations and the Acos. */
+		AnyBarrel,
+
+		/** Any barrel direction, with the BarrelStart level with the AimJoint. */
+		AnyBarrel_NoOffset,
+
+		/** Barrel parallel to "X", with any vertical offset. */
+		BarrelAlongX,
+
+		/** Barrel parallel to "X", with the BarrelStart level with the AimJoint. */
+		BarrelAlongX_NoOffset,
+	};
+
+	/** @return Returns the kernel's name, for logging. */
+	inline const char* GetAimKernelName( EAimKernel Kernel )
+	{
+		switch ( Kernel )
+		{
+		case EAimKernel::AnyBarrel:					return "AnyBarrel";
+		case EAimKernel::AnyBarrel_NoOffset:		return "AnyBarrel_NoOffset";
+		case EAimKernel::BarrelAlongX:				return "BarrelAlongX";
+		case EAimKernel::BarrelAlongX_NoOffset:		return "BarrelAlongX_NoOffset";
+		default:									return "Reference";
+		}
+	}
+
+	/**
+	 * The pitch solve, specialized for one turret shape.  Only valid for geometries that ChooseAimKernel picked it for.
+	 *
+	 * @param bBarrelAlongX			If true, the barrel ray is (1, 0) or (-1, 0).
+	 * @param bNoVerticalOffset		If true, the BarrelStart is level with the AimJoint.
+	 */
+	template<bool bBarrelAlongX, bool bNoVerticalOffset>
+	struct TAimKernel
+	{
+		/**
+		 * Same as TAimGeometry::SolvePitch.
+		 *
+		 * @param Geometry				The turret.  Its AimJoint has to be at the origin.
+		 * @param InTargetLocation2D	Location of the Target, aligned with the turret on the "X-Z" plane.
+		 * @param Accuracy				How accurately to do the trig.
+		 * @param Out_Events			OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns the pitch (in degrees) for the AimJoint.
+		 */
+		template<typename ScalarType, typename Vector2Type>
+		static ScalarType SolvePitch( const TAimGeometry<ScalarType, Vector2Type>& Geometry, const Vector2Type& InTargetLocation2D, EAimAccuracy Accuracy, unsigned int* Out_Events = nullptr )
+		{
+			const Vector2Type& BarrelStart = Geometry.GetBarrelStartLocation2D();
+			const Vector2Type& BarrelRay = Geometry.GetBarrelRay();
+
+			// Pushing the target out doesn't change its direction.  It only matters for the kernels below that depend on its distance.
+			const Vector2Type TargetLocation2D = Geometry.CalculateNearestValidTargetLocation2D( InTargetLocation2D, Out_Events );
+			const ScalarType TargetX = TargetLocation2D.X;
+			const ScalarType TargetZ = TargetLocation2D.Y;
+			if ( TargetX == 0 && TargetZ == 0 )
+			{
+				// The target is right on the AimJoint, which can't be pushed out (it has no direction).  The pitch is meaningless, so just
+				// make sure it's the same meaningless pitch as TAimGeometry::SolvePitch.
+				return Geometry.SolvePitch( InTargetLocation2D, Accuracy, Out_Events );
+			}
+
+			// The ScaledBarrelEnd, or at least a vector pointing the same way.
+			ScalarType PointX;
+			ScalarType PointZ;
+
+			if ( bBarrelAlongX && bNoVerticalOffset )
+			{
+				// The barrel ray goes through the AimJoint, so the ScaledBarrelEnd is straight along the barrel, at the target's distance.
+				// Only its direction matters for the angle.  Both roots can't be behind the BarrelStart here, since the (pushed out) target
+				// is always farther away than the BarrelStart or the BarrelEnd.
+				PointX = BarrelRay.X;
+				PointZ = 0;
+			}
+			else if ( bBarrelAlongX )
+			{
+				// The ScaledBarrelEnd is at the BarrelStart's height, and as far from the AimJoint as the target, so the quadratic's roots are
+				// -(S.x * R.x) -/+ sqrt( |T|^2 - S.z^2 ), and the ScaledBarrelEnd is at x = R.x * +/-sqrt( |T|^2 - S.z^2 ).
+				const ScalarType RadicalInput = SizeSquared2D( TargetLocation2D ) - ( BarrelStart.Y * BarrelStart.Y );
+				if ( RadicalInput < 0 )
+				{
+					if ( Out_Events )
+					{
+						*Out_Events |= EAimSolveEvent::NoRoots;
+					}
+					return 0;
+				}
+
+				const ScalarType Radical = std::sqrt( RadicalInput );
+				const ScalarType LargestDistance = Radical - ( BarrelStart.X * BarrelRay.X );
+				if ( LargestDistance < 0 )
+				{
+					// Same as SelectBestRayDistance: both roots are behind the BarrelStart, so take the other one.
+					if ( Out_Events )
+					{
+						*Out_Events |= EAimSolveEvent::BothDistancesNegative;
+					}
+					PointX = -BarrelRay.X * Radical;
+				}
+				else
+				{
+					PointX = BarrelRay.X * Radical;
+				}
+				PointZ = BarrelStart.Y;
+			}
+			else
+			{
+				// Same quadratic as CalculateBarrelRayDistance, but the barrel ray is normalized, so "a" is 1, and working with "b/2" drops
+				// the other constants.  With no vertical offset, the BarrelStart's Z terms are all 0.
+				const ScalarType HalfB = bNoVerticalOffset ? ( BarrelStart.X * BarrelRay.X ) : Dot2D( BarrelStart, BarrelRay );
+				const ScalarType BarrelStartDistanceSquared = bNoVerticalOffset ? ( BarrelStart.X * BarrelStart.X ) : SizeSquared2D( BarrelStart );
+				const ScalarType RadicalInput = ( HalfB * HalfB ) - ( BarrelStartDistanceSquared - SizeSquared2D( TargetLocation2D ) );
+				if ( RadicalInput < 0 )
+				{
+					if ( Out_Events )
+					{
+						*Out_Events |= EAimSolveEvent::NoRoots;
+					}
+					return 0;
+				}
+
+				// Same as SelectBestRayDistance, but the larger root is always the "+" one, so there's only one thing to test.
+				const ScalarType Radical = std::sqrt( RadicalInput );
+				ScalarType BarrelRayDistance = Radical - HalfB;
+				if ( BarrelRayDistance < 0 )
+				{
+					if ( Out_Events )
+					{
+						*Out_Events |= EAimSolveEvent::BothDistancesNegative;
+					}
+					BarrelRayDistance = -HalfB - Radical;
+				}
+
+				PointX = BarrelStart.X + ( BarrelRay.X * BarrelRayDistance );
+				PointZ = ( bNoVerticalOffset ? ScalarType( 0 ) : BarrelStart.Y ) + ( BarrelRay.Y * BarrelRayDistance );
+			}
+
+			// Cross = |P||T|sin(Angle) and Dot = |P||T|cos(Angle), same as CalculateAngleToRotateFromFirstVectorToSecondVector.
+			const ScalarType CrossProduct = ( PointX * TargetZ ) - ( PointZ * TargetX );
+			const ScalarType DotProduct = ( PointX * TargetX ) + ( PointZ * TargetZ );
+			if ( CrossProduct == 0 && DotProduct == 0 )
+			{
+				// The ScaledBarrelEnd landed on the AimJoint.  Same as CalculateAngleToRotateFromFirstVectorToSecondVector.
+				return ScalarType( 90 );
+			}
+
+			if ( Accuracy != EAimAccuracy::Exact )
+			{
+				return Atan2( CrossProduct, DotProduct, Accuracy ) * TConstants<ScalarType>::RadiansToDegrees();
+			}
+
+			// std::atan2 costs a few times more than std::acos, so the Exact tier keeps the Acos (and the sign test), with a single square root
+			// instead of two normalizations.
+			const ScalarType LengthProduct = std::sqrt( ( ( PointX * PointX ) + ( PointZ * PointZ ) ) * SizeSquared2D( TargetLocation2D ) );
+			const ScalarType Cosine = std::min( std::max( DotProduct / LengthProduct, ScalarType( -1 ) ), ScalarType( 1 ) );
+			const ScalarType RotationSign = ( CrossProduct >= 0 ) ? ScalarType( 1 ) : ScalarType( -1 );
+			return RotationSign * std::acos( Cosine ) * TConstants<ScalarType>::RadiansToDegrees();
+		}
+
+		/**
+		 * Same as TAimGeometry::Solve.
+		 *
+		 * @param Geometry					The turret.  Its AimJoint has to be at the origin.
+		 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+		 * @param Accuracy					How accurately to do the trig.
+		 * @param Out_Events				OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+		 * @return Returns the yaw/pitch (in degrees) for the AimJoint.
+		 */
+		template<typename ScalarType, typename Vector2Type, typename Vector3Type>
+		static TAimAngles<ScalarType> Solve( const TAimGeometry<ScalarType, Vector2Type>& Geometry, const Vector3Type& Target_InAimJointSpace, EAimAccuracy Accuracy, unsigned int* Out_Events = nullptr )
+		{
+			const ScalarType TargetX = ScalarType( Target_InAimJointSpace.X );
+			const ScalarType TargetY = ScalarType( Target_InAimJointSpace.Y );
+			const ScalarType TargetZ = ScalarType( Target_InAimJointSpace.Z );
+
+			TAimAngles<ScalarType> Result;
+			Result.Yaw = Atan2( TargetY, TargetX, Accuracy ) * TConstants<ScalarType>::RadiansToDegrees();
+			Result.Pitch = SolvePitch( Geometry, Vector2Type( std::sqrt( ( TargetX * TargetX ) + ( TargetY * TargetY ) ), TargetZ ), Accuracy, Out_Events );
+			return Result;
+		}
+	};
+
+	/**
+	 * Picks the most specialized kernel that gives the same results as TAimGeometry::Solve for the given geometry.
+	 * Call this once, when the geometry is made.
+	 *
+	 * @param Geometry	The turret.
+	 * @return Returns the kernel to use with SolveWithKernel.
+	 */
+	template<typename ScalarType, typename Vector2Type>
+	inline EAimKernel ChooseAimKernel( const TAimGeometry<ScalarType, Vector2Type>& Geometry )
+	{
+		// Small enough that treating them as 0 moves the pitch by far less than float rounding already does.
+		const ScalarType BarrelRayTolerance = ScalarType( 1.e-6 );
+		const ScalarType OffsetTolerance = ScalarType( 1.e-4 );
+
+		const Vector2Type& AimJoint = Geometry.GetAimJointLocation2D();
+		const Vector2Type& BarrelStart = Geometry.GetBarrelStartLocation2D();
+		const Vector2Type& BarrelRay = Geometry.GetBarrelRay();
+
+		// A zero length barrel has no roots at all, and the kernels assume the AimJoint is at the origin (which it is unless the geometry was
+		// made with MakeFromLocations2D).
+		if ( AimJoint.X != 0 || AimJoint.Y != 0 || SizeSquared2D( BarrelRay ) < ScalarType( 0.5 ) )
+		{
+			return EAimKernel::Reference;
+		}
+
+		// A BarrelEnd within a tenth of the BarrelStart's distance from the AimJoint lets targets get close enough that the kernels can't
+		// match the general solve in float (see AIM_KERNEL_TOLERANCE_DEGREES).  Outside of that, they stay within about 0.05 degrees.
+		if ( SizeSquared2D( Geometry.GetBarrelEndLocation2D() ) < ScalarType( 0.01 ) * SizeSquared2D( BarrelStart ) )
+		{
+			return EAimKernel::Reference;
+		}
+
+		const bool bBarrelAlongX = std::abs( BarrelRay.Y ) <= BarrelRayTolerance;
+		const bool bNoVerticalOffset = std::abs( BarrelStart.Y ) <= OffsetTolerance;
+
+		if ( bBarrelAlongX )
+		{
+			return bNoVerticalOffset ? EAimKernel::BarrelAlongX_NoOffset : EAimKernel::BarrelAlongX;
+		}
+
+		return bNoVerticalOffset ? EAimKernel::AnyBarrel_NoOffset : EAimKernel::AnyBarrel;
+	}
+
+	/**
+	 * Same as TAimGeometry::SolvePitch, using the given kernel.
+	 *
+	 * @param Kernel				The kernel picked by ChooseAimKernel for this geometry (or Reference).
+	 * @param Geometry				The turret.
+	 * @param TargetLocation2D		Location of the Target, aligned with the turret on the "X-Z" plane.
+	 * @param Accuracy				How accurately to do the trig.
+	 * @param Out_Events			OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+	 * @return Returns the pitch (in degrees) for the AimJoint.
+	 */
+	template<typename ScalarType, typename Vector2Type>
+	inline ScalarType SolvePitchWithKernel( EAimKernel Kernel, const TAimGeometry<ScalarType, Vector2Type>& Geometry, const Vector2Type& TargetLocation2D, EAimAccuracy Accuracy, unsigned int* Out_Events = nullptr )
+	{
+		switch ( Kernel )
+		{
+		case EAimKernel::AnyBarrel:					return TAimKernel<false, false>::SolvePitch( Geometry, TargetLocation2D, Accuracy, Out_Events );
+		case EAimKernel::AnyBarrel_NoOffset:		return TAimKernel<false, true>::SolvePitch( Geometry, TargetLocation2D, Accuracy, Out_Events );
+		case EAimKernel::BarrelAlongX:				return TAimKernel<true, false>::SolvePitch( Geometry, TargetLocation2D, Accuracy, Out_Events );
+		case EAimKernel::BarrelAlongX_NoOffset:		return TAimKernel<true, true>::SolvePitch( Geometry, TargetLocation2D, Accuracy, Out_Events );
+		default:									return Geometry.SolvePitch( TargetLocation2D, Accuracy, Out_Events );
+		}
+	}
+
+	/**
+	 * Same as TAimGeometry::Solve, using the given kernel.
+	 *
+	 * @param Kernel					The kernel picked by ChooseAimKernel for this geometry (or Reference).
+	 * @param Geometry					The turret.
+	 * @param Target_InAimJointSpace	The target's location relative to the (unrotated) AimJoint.
+	 * @param Accuracy					How accurately to do the trig.
+	 * @param Out_Events				OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+	 * @return Returns the yaw/pitch (in degrees) for the AimJoint.
+	 */
+	template<typename ScalarType, typename Vector2Type, typename Vector3Type>
+	inline TAimAngles<ScalarType> SolveWithKernel( EAimKernel Kernel, const TAimGeometry<ScalarType, Vector2Type>& Geometry, const Vector3Type& Target_InAimJointSpace, EAimAccuracy Accuracy, unsigned int* Out_Events = nullptr )
+	{
+		switch ( Kernel )
+		{
+		case EAimKernel::AnyBarrel:					return TAimKernel<false, false>::Solve( Geometry, Target_InAimJointSpace, Accuracy, Out_Events );
+		case EAimKernel::AnyBarrel_NoOffset:		return TAimKernel<false, true>::Solve( Geometry, Target_InAimJointSpace, Accuracy, Out_Events );
+		case EAimKernel::BarrelAlongX:				return TAimKernel<true, false>::Solve( Geometry, Target_InAimJointSpace, Accuracy, Out_Events );
+		case EAimKernel::BarrelAlongX_NoOffset:		return TAimKernel<true, true>::Solve( Geometry, Target_InAimJointSpace, Accuracy, Out_Events );
+		default:									return Geometry.Solve( Target_InAimJointSpace, Accuracy, Out_Events );
+		}
+	}
+}
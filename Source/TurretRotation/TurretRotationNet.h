@@ -0,0 +1,421 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+#include <vector>
+
+/**
+ * Compact encoding of turret aim angles for replication, without any engine dependencies.
+ *
+ * Each angle is quantized to a configurable number of bits over the full circle, so the yaw and the pitch wrap around the same way
+ * the solver's angles do.  A whole set of turrets (a "snapshot": turret IDs and quantized aims, sorted by ID) is sent as the
+ * difference from a base snapshot that the receiver already has:
+ *
+ *   - Turrets whose quantized aim didn't change aren't written at all.
+ *   - Changed angles are written as a short signed delta when they moved a little, and as the full value otherwise.
+ *   - New turrets are written in full, and removed turrets are just their ID.
+ *
+ * The bits go through any type with WriteBits( unsigned int Value, int NumBits ) / ReadBits( int NumBits ), so the same code runs
+ * over FBitWriter/FBitReader in the engine (see FTurretAimNetArray) and over TBitWriter/TBitReader below when testing offline.
+ */
+namespace TurretRotationCore
+{
+	/** How many bits are used for each angle.  Each step is 360 / 2^Bits degrees: 0.35 degrees at 10 bits, 0.0055 degrees at 16 bits. */
+	struct FAimQuantization
+	{
+		/** Bits for the yaw, from 1 to 16. */
+		int YawBits;
+
+		/** Bits for the pitch, from 1 to 16. */
+		int PitchBits;
+
+		/** Bits for an angle that only moved a little since the base snapshot, from 2 to 8.  Moves of 2^(SmallDeltaBits-1) steps or more are sent in full. */
+		int SmallDeltaBits;
+
+		FAimQuantization()
+			: YawBits( 12 )
+			, PitchBits( 12 )
+			, SmallDeltaBits( 5 )
+		{
+		}
+
+		FAimQuantization( int InYawBits, int InPitchBits, int InSmallDeltaBits = 5 )
+			: YawBits( InYawBits )
+			, PitchBits( InPitchBits )
+			, SmallDeltaBits( InSmallDeltaBits )
+		{
+		}
+
+		bool operator==( const FAimQuantization& Other ) const { return YawBits == Other.YawBits && PitchBits == Other.PitchBits && SmallDeltaBits == Other.SmallDeltaBits; }
+		bool operator!=( const FAimQuantization& Other ) const { return !( *this == Other ); }
+	};
+
+	/** The yaw/pitch in quantized steps (from 0 to 2^Bits - 1). */
+	struct FQuantizedAim
+	{
+		unsigned int Yaw;
+		unsigned int Pitch;
+
+		FQuantizedAim() : Yaw( 0 ), Pitch( 0 ) {}
+		FQuantizedAim( unsigned int InYaw, unsigned int InPitch ) : Yaw( InYaw ), Pitch( InPitch ) {}
+
+		bool operator==( const FQuantizedAim& Other ) const { return Yaw == Other.Yaw && Pitch == Other.Pitch; }
+		bool operator!=( const FQuantizedAim& Other ) const { return !( *this == Other ); }
+	};
+
+	/** One turret in a snapshot. */
+	struct FAimSnapshotItem
+	{
+		unsigned int Id;
+		FQuantizedAim Aim;
+
+		FAimSnapshotItem() : Id( 0 ) {}
+		FAimSnapshotItem( unsigned int InId, const FQuantizedAim& InAim ) : Id( InId ), Aim( InAim ) {}
+
+		bool operator==( const FAimSnapshotItem& Other ) const { return Id == Other.Id && Aim == Other.Aim; }
+		bool operator!=( const FAimSnapshotItem& Other ) const { return !( *this == Other ); }
+	};
+
+	/**
+	 * @param Degrees	Any angle.  It's wrapped into the full circle first.
+	 * @param NumBits	Number of bits to quantize to (1 to 16).
+	 * @return Returns the nearest step, from 0 to 2^NumBits - 1.
+	 */
+	template<typename ScalarType>
+	inline unsigned int QuantizeAngle( ScalarType Degrees, int NumBits )
+	{
+		const double NumSteps = double( 1u << NumBits );
+		const double Steps = std::floor( ( double( Degrees ) * NumSteps / 360.0 ) + 0.5 );
+		const double WrappedSteps = Steps - ( std::floor( Steps / NumSteps ) * NumSteps );
+		return static_cast<unsigned int>( WrappedSteps ) & ( ( 1u << NumBits ) - 1 );
+	}
+
+	/** @return Returns the angle (in degrees, from -180 up to but not including 180) of a step returned by QuantizeAngle. */
+	template<typename ScalarType>
+	inline ScalarType DequantizeAngle( unsigned int Value, int NumBits )
+	{
+		const double Degrees = double( Value ) * 360.0 / double( 1u << NumBits );
+		return ScalarType( Degrees >= 180.0 ? Degrees - 360.0 : Degrees );
+	}
+
+	template<typename ScalarType>
+	inline FQuantizedAim QuantizeAim( const TAimAngles<ScalarType>& Angles, const FAimQuantization& Quantization )
+	{
+		return FQuantizedAim( QuantizeAngle( Angles.Yaw, Quantization.YawBits ), QuantizeAngle( Angles.Pitch, Quantization.PitchBits ) );
+	}
+
+	template<typename ScalarType>
+	inline TAimAngles<ScalarType> DequantizeAim( const FQuantizedAim& Aim, const FAimQuantization& Quantization )
+	{
+		TAimAngles<ScalarType> Angles;
+		Angles.Yaw = DequantizeAngle<ScalarType>( Aim.Yaw, Quantization.YawBits );
+		Angles.Pitch = DequantizeAngle<ScalarType>( Aim.Pitch, Quantization.PitchBits );
+		return Angles;
+	}
+
+	/** Appends bits to a byte array, least significant bit first (the same order as FBitWriter). */
+	template<typename ContainerType = std::vector<unsigned char>>
+	class TBitWriter
+	{
+	public:
+		TBitWriter() : NumBits( 0 ) {}
+
+		/** Writes the low NumBitsToWrite (up to 32) bits of Value. */
+		void WriteBits( unsigned int Value, int NumBitsToWrite )
+		{
+			for ( int Bit = 0; Bit < NumBitsToWrite; ++Bit, ++NumBits )
+			{
+				if ( ( NumBits & 7 ) == 0 )
+				{
+					Bytes.push_back( 0 );
+				}
+
+				if ( ( Value >> Bit ) & 1u )
+				{
+					Bytes[NumBits >> 3] |= static_cast<unsigned char>( 1u << ( NumBits & 7 ) );
+				}
+			}
+		}
+
+		size_t GetNumBits() const { return NumBits; }
+		const ContainerType& GetBytes() const { return Bytes; }
+
+	private:
+		ContainerType Bytes;
+		size_t NumBits;
+	};
+
+	/** Reads bits written by TBitWriter.  Reading past the end returns zeros and sets the overflow flag (like FBitReader::IsError). */
+	template<typename ContainerType = std::vector<unsigned char>>
+	class TBitReader
+	{
+	public:
+		TBitReader( const ContainerType& InBytes, size_t InNumBits )
+			: Bytes( InBytes )
+			, NumBits( InNumBits )
+			, Position( 0 )
+			, bOverflowed( false )
+		{
+		}
+
+		unsigned int ReadBits( int NumBitsToRead )
+		{
+			if ( bOverflowed || Position + NumBitsToRead > NumBits )
+			{
+				bOverflowed = true;
+				return 0;
+			}
+
+			unsigned int Value = 0;
+			for ( int Bit = 0; Bit < NumBitsToRead; ++Bit, ++Position )
+			{
+				Value |= static_cast<unsigned int>( ( Bytes[Position >> 3] >> ( Position & 7 ) ) & 1u ) << Bit;
+			}
+			return Value;
+		}
+
+		bool IsOverflowed() const { return bOverflowed; }
+		bool IsAtEnd() const { return Position == NumBits; }
+
+	private:
+		const ContainerType& Bytes;
+		size_t NumBits;
+		size_t Position;
+		bool bOverflowed;
+	};
+
+	/** Writes Value in groups of 3 bits, each followed by a bit saying if there's another group.  Small values (like ID gaps) cost 4 bits. */
+	template<typename WriterType>
+	inline void WritePackedUInt( WriterType& Writer, unsigned int Value )
+	{
+		do
+		{
+			Writer.WriteBits( Value & 7u, 3 );
+			Value >>= 3;
+			Writer.WriteBits( Value != 0 ? 1u : 0u, 1 );
+		}
+		while ( Value != 0 );
+	}
+
+	template<typename ReaderType>
+	inline unsigned int ReadPackedUInt( ReaderType& Reader )
+	{
+		unsigned int Value = 0;
+
+		// 11 groups cover 33 bits, so a corrupt stream can't keep us here forever.
+		for ( int Shift = 0; Shift < 33; Shift += 3 )
+		{
+			Value |= Reader.ReadBits( 3 ) << Shift;
+			if ( Reader.ReadBits( 1 ) == 0 )
+			{
+				break;
+			}
+		}
+		return Value;
+	}
+
+	/**
+	 * Writes one quantized angle relative to the base snapshot's value:
+	 *   0								- Unchanged.
+	 *   10 + SmallDeltaBits			- Moved by less than 2^(SmallDeltaBits-1) steps either way (wrapping around the circle).
+	 *   11 + NumBits					- The full value.
+	 */
+	template<typename WriterType>
+	inline void WriteQuantizedAngleDelta( WriterType& Writer, unsigned int BaseValue, unsigned int Value, int NumBits, int SmallDeltaBits )
+	{
+		const unsigned int Mask = ( 1u << NumBits ) - 1;
+		const int HalfRange = int( 1u << ( NumBits - 1 ) );
+		int Delta = int( ( Value - BaseValue ) & Mask );
+		if ( Delta >= HalfRange )
+		{
+			Delta -= int( 1u << NumBits );
+		}
+
+		const int SmallDeltaLimit = 1 << ( SmallDeltaBits - 1 );
+		if ( Delta == 0 )
+		{
+			Writer.WriteBits( 0, 1 );
+		}
+		else if ( Delta >= -SmallDeltaLimit && Delta < SmallDeltaLimit && SmallDeltaBits < NumBits )
+		{
+			Writer.WriteBits( 1, 1 );
+			Writer.WriteBits( 0, 1 );
+			Writer.WriteBits( unsigned( Delta ) & ( ( 1u << SmallDeltaBits ) - 1 ), SmallDeltaBits );
+		}
+		else
+		{
+			Writer.WriteBits( 1, 1 );
+			Writer.WriteBits( 1, 1 );
+			Writer.WriteBits( Value, NumBits );
+		}
+	}
+
+	template<typename ReaderType>
+	inline unsigned int ReadQuantizedAngleDelta( ReaderType& Reader, unsigned int BaseValue, int NumBits, int SmallDeltaBits )
+	{
+		if ( Reader.ReadBits( 1 ) == 0 )
+		{
+			return BaseValue;
+		}
+
+		if ( Reader.ReadBits( 1 ) == 0 )
+		{
+			// Sign extend the small delta.
+			const unsigned int SmallDelta = Reader.ReadBits( SmallDeltaBits );
+			const int Delta = int( SmallDelta ) - ( ( SmallDelta >> ( SmallDeltaBits - 1 ) ) != 0 ? int( 1u << SmallDeltaBits ) : 0 );
+			return ( BaseValue + unsigned( Delta ) ) & ( ( 1u << NumBits ) - 1 );
+		}
+
+		return Reader.ReadBits( NumBits );
+	}
+
+	template<typename WriterType>
+	inline void WriteQuantizedAim( WriterType& Writer, const FQuantizedAim& Aim, const FAimQuantization& Quantization )
+	{
+		Writer.WriteBits( Aim.Yaw, Quantization.YawBits );
+		Writer.WriteBits( Aim.Pitch, Quantization.PitchBits );
+	}
+
+	template<typename ReaderType>
+	inline FQuantizedAim ReadQuantizedAim( ReaderType& Reader, const FAimQuantization& Quantization )
+	{
+		const unsigned int Yaw = Reader.ReadBits( Quantization.YawBits );
+		const unsigned int Pitch = Reader.ReadBits( Quantization.PitchBits );
+		return FQuantizedAim( Yaw, Pitch );
+	}
+
+	/**
+	 * Writes the difference between two snapshots.  Every entry starts with a 1 bit (a 0 bit ends the list), then the gap from the
+	 * previous entry's ID, then:
+	 *   0 + yaw/pitch deltas			- A turret in both snapshots whose aim changed (see WriteQuantizedAngleDelta).
+	 *   10 + full yaw/pitch			- A turret that isn't in the base snapshot.
+	 *   11								- A turret that was removed.
+	 *
+	 * @param BaseItems		The snapshot the receiver already has, sorted by ID.  Can be empty, to write the whole snapshot.
+	 * @param Items			The new snapshot, sorted by ID.
+	 * @return Returns the number of entries written.  Zero means the snapshots are the same (and only the end bit was written).
+	 */
+	template<typename WriterType>
+	inline int WriteAimSnapshotDelta(
+		WriterType& Writer,
+		const FAimSnapshotItem* BaseItems,
+		int NumBaseItems,
+		const FAimSnapshotItem* Items,
+		int NumItems,
+		const FAimQuantization& Quantization )
+	{
+		int NumEntries = 0;
+		unsigned int PreviousId = 0;
+
+		auto BeginEntry = [&Writer, &NumEntries, &PreviousId]( unsigned int Id )
+		{
+			Writer.WriteBits( 1, 1 );
+			WritePackedUInt( Writer, Id - PreviousId );
+			PreviousId = Id;
+			++NumEntries;
+		};
+
+		int BaseIndex = 0;
+		int Index = 0;
+		while ( BaseIndex < NumBaseItems || Index < NumItems )
+		{
+			if ( Index < NumItems && ( BaseIndex == NumBaseItems || Items[Index].Id < BaseItems[BaseIndex].Id ) )
+			{
+				BeginEntry( Items[Index].Id );
+				Writer.WriteBits( 1, 1 );
+				Writer.WriteBits( 0, 1 );
+				WriteQuantizedAim( Writer, Items[Index].Aim, Quantization );
+				++Index;
+			}
+			else if ( Index == NumItems || BaseItems[BaseIndex].Id < Items[Index].Id )
+			{
+				BeginEntry( BaseItems[BaseIndex].Id );
+				Writer.WriteBits( 1, 1 );
+				Writer.WriteBits( 1, 1 );
+				++BaseIndex;
+			}
+			else
+			{
+				const FQuantizedAim& BaseAim = BaseItems[BaseIndex].Aim;
+				const FQuantizedAim& Aim = Items[Index].Aim;
+				if ( Aim != BaseAim )
+				{
+					BeginEntry( Items[Index].Id );
+					Writer.WriteBits( 0, 1 );
+					WriteQuantizedAngleDelta( Writer, BaseAim.Yaw, Aim.Yaw, Quantization.YawBits, Quantization.SmallDeltaBits );
+					WriteQuantizedAngleDelta( Writer, BaseAim.Pitch, Aim.Pitch, Quantization.PitchBits, Quantization.SmallDeltaBits );
+				}
+				++BaseIndex;
+				++Index;
+			}
+		}
+
+		Writer.WriteBits( 0, 1 );
+		return NumEntries;
+	}
+
+	/**
+	 * Reads what WriteAimSnapshotDelta wrote, and rebuilds the new snapshot from the base snapshot.
+	 *
+	 * The whole difference is always read, even if it doesn't fit the base snapshot, so the reader ends up right after it either way.
+	 *
+	 * @param BaseItems		The same base snapshot the writer used, sorted by ID.
+	 * @param AddItem		Called with each FAimSnapshotItem of the new snapshot, in ID order.
+	 * @return Returns false if the stream ran out, or if it doesn't fit the base snapshot (a changed/removed turret that isn't in it,
+	 *         a new turret that already is, or IDs out of order).  The items passed to AddItem are meaningless in that case.
+	 */
+	template<typename ReaderType, typename AddItemType>
+	inline bool ReadAimSnapshotDelta(
+		ReaderType& Reader,
+		const FAimSnapshotItem* BaseItems,
+		int NumBaseItems,
+		const FAimQuantization& Quantization,
+		AddItemType&& AddItem )
+	{
+		bool bValid = true;
+		int BaseIndex = 0;
+		unsigned int Id = 0;
+		bool bFirstEntry = true;
+
+		while ( Reader.ReadBits( 1 ) != 0 )
+		{
+			const unsigned int IdGap = ReadPackedUInt( Reader );
+			bValid &= bFirstEntry || IdGap != 0;
+			Id += IdGap;
+			bFirstEntry = false;
+
+			// Everything in the base snapshot before this ID is unchanged.
+			while ( BaseIndex < NumBaseItems && BaseItems[BaseIndex].Id < Id )
+			{
+				AddItem( BaseItems[BaseIndex++] );
+			}
+
+			const bool bInBase = BaseIndex < NumBaseItems && BaseItems[BaseIndex].Id == Id;
+			if ( Reader.ReadBits( 1 ) == 0 )
+			{
+				const FQuantizedAim BaseAim = bInBase ? BaseItems[BaseIndex].Aim : FQuantizedAim();
+				const unsigned int Yaw = ReadQuantizedAngleDelta( Reader, BaseAim.Yaw, Quantization.YawBits, Quantization.SmallDeltaBits );
+				const unsigned int Pitch = ReadQuantizedAngleDelta( Reader, BaseAim.Pitch, Quantization.PitchBits, Quantization.SmallDeltaBits );
+				AddItem( FAimSnapshotItem( Id, FQuantizedAim( Yaw, Pitch ) ) );
+				bValid &= bInBase;
+			}
+			else if ( Reader.ReadBits( 1 ) == 0 )
+			{
+				AddItem( FAimSnapshotItem( Id, ReadQuantizedAim( Reader, Quantization ) ) );
+				bValid &= !bInBase;
+			}
+			else
+			{
+				bValid &= bInBase;
+			}
+
+			BaseIndex += bInBase ? 1 : 0;
+		}
+
+		while ( BaseIndex < NumBaseItems )
+		{
+			AddItem( BaseItems[BaseIndex++] );
+		}
+
+		return bValid && !Reader.IsOverflowed();
+	}
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+
+/**
+ * How fast the aim turns for a moving target, and extrapolating the aim between solves, without any engine dependencies.
+ *
+ * The yaw is atan2( Y, X ), so its rate is the usual ( X*Vy - Y*Vx ) / ( X^2 + Y^2 ).  The pitch is the angle from P (the AimJoint to
+ * the ScaledBarrelEnd) to T (the AimJoint to the target), on the "X-Z" plane:
+ *   Pitch = Angle( T ) - Angle( P ), where P = S + R*d - J and |P| = |T|  (see TAimGeometry::CalculateBarrelRayDistance)
+ * Differentiating |P|^2 = |T|^2 gives the rate of the BarrelRayDistance, d' = ( T . T' ) / ( P . R ), and since P' = R*d':
+ *   Pitch' = ( Cross( T, T' ) - Cross( P, R ) * d' ) / |T|^2
+ * So the rates cost a few multiplies on top of the vectors the solve already finds, and no extra trig.
+ *
+ * Everything is in AimJoint space (relative to the unrotated AimJoint), same as TAimGeometry::Solve.  The velocity is the target's
+ * velocity relative to the AimJoint, so a turret on a moving Actor should pass the difference of the two.  The Actor's own rotation
+ * isn't part of the rates.
+ */
+namespace TurretRotationCore
+{
+	/** @return Returns the angle (in degrees) wrapped to [-180, 180]. */
+	template<typename ScalarType>
+	inline ScalarType NormalizeAngleDegrees( ScalarType Angle )
+	{
+		Angle = std::fmod( Angle, ScalarType( 360 ) );
+		if ( Angle > ScalarType( 180 ) )
+		{
+			Angle -= ScalarType( 360 );
+		}
+		else if ( Angle < ScalarType( -180 ) )
+		{
+			Angle += ScalarType( 360 );
+		}
+		return Angle;
+	}
+
+	/**
+	 * Calculates how fast the yaw/pitch from TAimGeometry::Solve change while the target moves at the given velocity.
+	 *
+	 * Targets that TAimGeometry::CalculateNearestValidTargetLocation2D pushes out only turn the pitch by moving around the AimJoint, and
+	 * targets straight above/below the AimJoint (where the yaw is undefined) don't turn the yaw at all.  Where the solve has no
+	 * BarrelRayDistance (so the pitch is 0), the pitch rate is 0 too.
+	 *
+	 * @param Geometry							The turret's geometry.
+	 * @param Target_InAimJointSpace			The target's location relative to the (unrotated) AimJoint.
+	 * @param TargetVelocity_InAimJointSpace	The target's velocity relative to the (unrotated) AimJoint.
+	 * @param Out_Events						OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+	 * @return Returns the rates of the yaw/pitch, in degrees per second (per unit of time the velocity is in).
+	 */
+	template<typename ScalarType, typename Vector2Type, typename Vector3Type>
+	inline TAimAngles<ScalarType> CalculateAimRates(
+		const TAimGeometry<ScalarType, Vector2Type>& Geometry,
+		const Vector3Type& Target_InAimJointSpace,
+		const Vector3Type& TargetVelocity_InAimJointSpace,
+		unsigned int* Out_Events = nullptr )
+	{
+		const ScalarType SmallNumber = TConstants<ScalarType>::SmallNumber();
+
+		const ScalarType TargetX = ScalarType( Target_InAimJointSpace.X );
+		const ScalarType TargetY = ScalarType( Target_InAimJointSpace.Y );
+		const ScalarType TargetZ = ScalarType( Target_InAimJointSpace.Z );
+		const ScalarType VelocityX = ScalarType( TargetVelocity_InAimJointSpace.X );
+		const ScalarType VelocityY = ScalarType( TargetVelocity_InAimJointSpace.Y );
+		const ScalarType VelocityZ = ScalarType( TargetVelocity_InAimJointSpace.Z );
+
+		TAimAngles<ScalarType> Result;
+		Result.Yaw = 0;
+		Result.Pitch = 0;
+
+		// The target lines up with the turret at ( HorizontalDistance, Z ) on the "X-Z" plane, same as in TAimGeometry::Solve.
+		const ScalarType HorizontalDistanceSquared = ( TargetX * TargetX ) + ( TargetY * TargetY );
+		const ScalarType HorizontalDistance = std::sqrt( HorizontalDistanceSquared );
+		ScalarType HorizontalSpeed = 0;
+		if ( HorizontalDistance > SmallNumber )
+		{
+			Result.Yaw = ( ( TargetX * VelocityY ) - ( TargetY * VelocityX ) ) / HorizontalDistanceSquared;
+			HorizontalSpeed = ( ( TargetX * VelocityX ) + ( TargetY * VelocityY ) ) / HorizontalDistance;
+		}
+
+		unsigned int Events = 0;
+		Vector2Type AimJoint_To_ScaledBarrelEnd;
+		Vector2Type AimJoint_To_Target;
+		const Vector2Type TargetLocation2D( HorizontalDistance, TargetZ );
+		if ( Geometry.CalculatePitchVectors( TargetLocation2D, /*out*/ AimJoint_To_ScaledBarrelEnd, /*out*/ AimJoint_To_Target, &Events ) )
+		{
+			Vector2Type TargetVelocity2D( HorizontalSpeed, VelocityZ );
+
+			// A pushed out target stays on the circle of MinimumTargetDistance, so only the part of its velocity around the AimJoint counts.
+			if ( Events & EAimSolveEvent::TargetClamped )
+			{
+				const Vector2Type Unclamped = Subtract2D( TargetLocation2D, Geometry.GetAimJointLocation2D() );
+				const ScalarType UnclampedDistanceSquared = SizeSquared2D( Unclamped );
+				if ( UnclampedDistanceSquared > SmallNumber )
+				{
+					const ScalarType UnclampedDistance = std::sqrt( UnclampedDistanceSquared );
+					const ScalarType RadialSpeed = Dot2D( Unclamped, TargetVelocity2D ) / UnclampedDistanceSquared;
+					const Vector2Type Tangential = Subtract2D( TargetVelocity2D, Scale2D( Unclamped, RadialSpeed ) );
+					TargetVelocity2D = Scale2D( Tangential, Geometry.GetMinimumTargetDistance() / UnclampedDistance );
+				}
+				else
+				{
+					TargetVelocity2D = Vector2Type( 0, 0 );
+				}
+			}
+
+			const ScalarType TargetDistanceSquared = SizeSquared2D( AimJoint_To_Target );
+			if ( TargetDistanceSquared > SmallNumber )
+			{
+				// d' blows up where the barrel ray only just touches the target's circle (a double root), so leave it out there.
+				const Vector2Type& BarrelRay = Geometry.GetBarrelRay();
+				const ScalarType BarrelEndAlongRay = Dot2D( AimJoint_To_ScaledBarrelEnd, BarrelRay );
+				const ScalarType BarrelRayDistanceRate = ( std::abs( BarrelEndAlongRay ) > SmallNumber )
+					? Dot2D( AimJoint_To_Target, TargetVelocity2D ) / BarrelEndAlongRay
+					: ScalarType( 0 );
+
+				Result.Pitch = ( Cross2D( AimJoint_To_Target, TargetVelocity2D ) - ( Cross2D( AimJoint_To_ScaledBarrelEnd, BarrelRay ) * BarrelRayDistanceRate ) ) / TargetDistanceSquared;
+			}
+		}
+
+		if ( Out_Events )
+		{
+			*Out_Events |= Events;
+		}
+
+		const ScalarType RadiansToDegrees = TConstants<ScalarType>::RadiansToDegrees();
+		Result.Yaw *= RadiansToDegrees;
+		Result.Pitch *= RadiansToDegrees;
+		return Result;
+	}
+
+	/**
+	 * Same as TAimGeometry::Solve, but also finds the rates of the yaw/pitch (see CalculateAimRates).
+	 *
+	 * @param Geometry							The turret's geometry.
+	 * @param Target_InAimJointSpace			The target's location relative to the (unrotated) AimJoint.
+	 * @param TargetVelocity_InAimJointSpace	The target's velocity relative to the (unrotated) AimJoint.
+	 * @param Out_Rates							OUT - The rates of the yaw/pitch, in degrees per second.
+	 * @param Accuracy							How accurately to do the trig.
+	 * @param Out_Events						OUT (optional) - The edge cases the solve ran into (see EAimSolveEvent) are added to this.
+	 * @return Returns the yaw/pitch (in degrees) for the AimJoint.
+	 */
+	template<typename ScalarType, typename Vector2Type, typename Vector3Type>
+	inline TAimAngles<ScalarType> SolveWithRates(
+		const TAimGeometry<ScalarType, Vector2Type>& Geometry,
+		const Vector3Type& Target_InAimJointSpace,
+		const Vector3Type& TargetVelocity_InAimJointSpace,
+		TAimAngles<ScalarType>& Out_Rates,
+		EAimAccuracy Accuracy = EAimAccuracy::Exact,
+		unsigned int* Out_Events = nullptr )
+	{
+		Out_Rates = CalculateAimRates( Geometry, Target_InAimJointSpace, TargetVelocity_InAimJointSpace );
+		return Geometry.Solve( Target_InAimJointSpace, Accuracy, Out_Events );
+	}
+
+	/**
+	 * Estimates how fast the rates will change over the next LookAheadSeconds if the target keeps its velocity, by finding the rates
+	 * again where the target will be.  Even a target moving in a straight line turns the aim faster the closer it gets, and this catches
+	 * that from a single solve.
+	 *
+	 * @param Geometry							The turret's geometry.
+	 * @param Target_InAimJointSpace			The target's location relative to the (unrotated) AimJoint.
+	 * @param TargetVelocity_InAimJointSpace	The target's velocity relative to the (unrotated) AimJoint.
+	 * @param Rates								The rates at Target_InAimJointSpace (from CalculateAimRates).
+	 * @param LookAheadSeconds					How far ahead to look.  Should be about as long as the aim is extrapolated for.
+	 * @return Returns the larger change of the yaw/pitch rates, in degrees per second squared.
+	 */
+	template<typename ScalarType, typename Vector2Type, typename Vector3Type>
+	inline ScalarType EstimateAimAcceleration(
+		const TAimGeometry<ScalarType, Vector2Type>& Geometry,
+		const Vector3Type& Target_InAimJointSpace,
+		const Vector3Type& TargetVelocity_InAimJointSpace,
+		const TAimAngles<ScalarType>& Rates,
+		ScalarType LookAheadSeconds )
+	{
+		if ( LookAheadSeconds <= TConstants<ScalarType>::SmallNumber() )
+		{
+			return 0;
+		}
+
+		const Vector3Type FutureTarget(
+			Target_InAimJointSpace.X + ( TargetVelocity_InAimJointSpace.X * LookAheadSeconds ),
+			Target_InAimJointSpace.Y + ( TargetVelocity_InAimJointSpace.Y * LookAheadSeconds ),
+			Target_InAimJointSpace.Z + ( TargetVelocity_InAimJointSpace.Z * LookAheadSeconds ) );
+		const TAimAngles<ScalarType> FutureRates = CalculateAimRates( Geometry, FutureTarget, TargetVelocity_InAimJointSpace );
+
+		return std::max( std::abs( FutureRates.Yaw - Rates.Yaw ), std::abs( FutureRates.Pitch - Rates.Pitch ) ) / LookAheadSeconds;
+	}
+
+	/**
+	 * Moves the yaw/pitch along their rates.
+	 *
+	 * @param Angles	The yaw/pitch (in degrees) when the rates were found.
+	 * @param Rates		The rates of the yaw/pitch, in degrees per second.
+	 * @param Seconds	How far ahead to extrapolate.
+	 * @return Returns the extrapolated yaw/pitch.  The yaw is wrapped to [-180, 180].
+	 */
+	template<typename ScalarType>
+	inline TAimAngles<ScalarType> ExtrapolateAimAngles( const TAimAngles<ScalarType>& Angles, const TAimAngles<ScalarType>& Rates, ScalarType Seconds )
+	{
+		TAimAngles<ScalarType> Result;
+		Result.Yaw = NormalizeAngleDegrees( Angles.Yaw + ( Rates.Yaw * Seconds ) );
+		Result.Pitch = Angles.Pitch + ( Rates.Pitch * Seconds );
+		return Result;
+	}
+
+	/**
+	 * Estimates how far (in degrees) an extrapolated aim is from where a new solve would put it.
+	 *
+	 * Two things make the extrapolation drift:
+	 *   - The rates themselves change, even for a target moving in a straight line (the yaw of a passing target speeds up and slows
+	 *     down).  Moving along a rate that changes by AngularAcceleration is off by 1/2 * AngularAcceleration * Seconds^2.
+	 *     See EstimateAimAcceleration.
+	 *   - The target doesn't follow its velocity.  Being TargetDeviation away from where the velocity said it would be turns the aim by
+	 *     up to atan( TargetDeviation / TargetDistance ), which is close to TargetDeviation / TargetDistance radians.
+	 *
+	 * @param AngularAcceleration	How fast the rates change, in degrees per second squared.
+	 * @param Seconds				How long ago the rates were found.
+	 * @param TargetDeviation		How far the target is from where its velocity said it would be.
+	 * @param TargetDistance		How far the target is from the AimJoint.
+	 * @return Returns the estimated error, in degrees.
+	 */
+	template<typename ScalarType>
+	inline ScalarType EstimateExtrapolationErrorDegrees( ScalarType AngularAcceleration, ScalarType Seconds, ScalarType TargetDeviation, ScalarType TargetDistance )
+	{
+		const ScalarType CurveError = ScalarType( 0.5 ) * std::abs( AngularAcceleration ) * Seconds * Seconds;
+
+		// Targets right on top of the AimJoint can turn the aim any amount, so give up on them.
+		const ScalarType DeviationError = ( TargetDistance > TConstants<ScalarType>::SmallNumber() )
+			? ( TargetDeviation / TargetDistance ) * TConstants<ScalarType>::RadiansToDegrees()
+			: ScalarType( 180 );
+
+		return CurveError + DeviationError;
+	}
+
+	/**
+	 * Turns the aim towards the desired yaw/pitch, no faster than the given rates.  The yaw turns the short way around.
+	 *
+	 * @param Current			The current yaw/pitch (in degrees).
+	 * @param Desired			The yaw/pitch (in degrees) to turn towards.
+	 * @param MaxYawRate		Fastest the yaw can turn, in degrees per second.  0 (or less) for no limit.
+	 * @param MaxPitchRate		Fastest the pitch can turn, in degrees per second.  0 (or less) for no limit.
+	 * @param DeltaSeconds		How long the aim has had to turn.
+	 * @return Returns the new yaw/pitch.
+	 */
+	template<typename ScalarType>
+	inline TAimAngles<ScalarType> ApplySlewLimit( const TAimAngles<ScalarType>& Current, const TAimAngles<ScalarType>& Desired, ScalarType MaxYawRate, ScalarType MaxPitchRate, ScalarType DeltaSeconds )
+	{
+		TAimAngles<ScalarType> Result = Desired;
+
+		if ( MaxYawRate > 0 )
+		{
+			const ScalarType MaxStep = MaxYawRate * DeltaSeconds;
+			const ScalarType Step = NormalizeAngleDegrees( Desired.Yaw - Current.Yaw );
+			Result.Yaw = NormalizeAngleDegrees( Current.Yaw + std::max( -MaxStep, std::min( Step, MaxStep ) ) );
+		}
+
+		if ( MaxPitchRate > 0 )
+		{
+			const ScalarType MaxStep = MaxPitchRate * DeltaSeconds;
+			const ScalarType Step = Desired.Pitch - Current.Pitch;
+			Result.Pitch = Current.Pitch + std::max( -MaxStep, std::min( Step, MaxStep ) );
+		}
+
+		return Result;
+	}
+}
@@ -0,0 +1,29 @@
+#include "TurretTargetComponent.h"
+#include "TurretAimManager.h"
+
+
+UTurretTargetComponent::UTurretTargetComponent()
+	: TargetGridHandle( INDEX_NONE )
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UTurretTargetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if ( ATurretAimManager* Manager = ATurretAimManager::Get( GetWorld() ) )
+	{
+		Manager->RegisterTarget( this );
+	}
+}
+
+void UTurretTargetComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	if ( ATurretAimManager* Manager = ATurretAimManager::Get( GetWorld(), /*bCreateIfMissing*/ false ) )
+	{
+		Manager->UnregisterTarget( this );
+	}
+
+	Super::EndPlay( EndPlayReason );
+}
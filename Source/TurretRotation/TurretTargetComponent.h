@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TurretTargetComponent.generated.h"
+
+/**
+ * Marks its owner as something that turrets can target.
+ *
+ * During gameplay, the owner is added to the world's ATurretAimManager, which keeps the location of every target in a spatial hash
+ * (FTurretTargetGrid).  Turrets with bAutoAcquireTarget pick the nearest target within their range and firing arc from there.
+ */
+UCLASS( ClassGroup=(Turret), meta=(BlueprintSpawnableComponent) )
+class TURRETROTATION_API UTurretTargetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTurretTargetComponent();
+
+	/** @return Returns this target's handle in the manager's FTurretTargetGrid, or INDEX_NONE if it isn't registered. */
+	int32 GetTargetGridHandle() const { return TargetGridHandle; }
+
+	/** Only for ATurretAimManager. */
+	void SetTargetGridHandle( int32 Handle ) { TargetGridHandle = Handle; }
+
+	// UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+private:
+	int32 TargetGridHandle;
+};
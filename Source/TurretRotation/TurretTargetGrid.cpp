@@ -0,0 +1,285 @@
+#include "TurretTargetGrid.h"
+#include "Async/ParallelFor.h"
+
+
+FTurretTargetQuery::FTurretTargetQuery()
+	: Origin( FVector::ZeroVector )
+	, Forward( FVector::ForwardVector )
+	, MinRange( 0.0f )
+	, MaxRange( 5000.0f )
+	, HalfArcDegrees( 180.0f )
+	, IgnoredTag( 0 )
+{
+}
+
+FTurretTargetGrid::FTurretTargetGrid( float InCellSize )
+	: CellSize( FMath::Max( InCellSize, 1.0f ) )
+	, InverseCellSize( 1.0f / FMath::Max( InCellSize, 1.0f ) )
+{
+	Reset();
+}
+
+void FTurretTargetGrid::Reset()
+{
+	Targets.Reset();
+	FreeHandles.Reset();
+	Cells.Reset();
+
+	// Empty bounds, so the first target sets them.
+	MinCell = FIntPoint( MAX_int32, MAX_int32 );
+	MaxCell = FIntPoint( MIN_int32, MIN_int32 );
+}
+
+int32 FTurretTargetGrid::AddTarget( const FVector& Location, UPTRINT Tag )
+{
+	const int32 Handle = FreeHandles.Num() > 0 ? FreeHandles.Pop( /*bAllowShrinking*/ false ) : Targets.AddUninitialized();
+
+	FTarget& Target = Targets[Handle];
+	Target.Location = Location;
+	Target.Tag = Tag;
+	Target.bInUse = true;
+
+	AddToCell( Handle, GetCell( Location ) );
+	return Handle;
+}
+
+void FTurretTargetGrid::UpdateTarget( int32 Handle, const FVector& Location )
+{
+	check( IsValidTarget( Handle ) );
+
+	FTarget& Target = Targets[Handle];
+	Target.Location = Location;
+
+	const FIntPoint NewCell = GetCell( Location );
+	if ( NewCell == Target.Cell )
+	{
+		// Still in the same cell, so just update the copy that the cell keeps.
+		Cells.FindChecked( Target.Cell )[Target.IndexInCell].Location = Location;
+		return;
+	}
+
+	RemoveFromCell( Handle );
+	AddToCell( Handle, NewCell );
+}
+
+void FTurretTargetGrid::RemoveTarget( int32 Handle )
+{
+	check( IsValidTarget( Handle ) );
+
+	RemoveFromCell( Handle );
+	Targets[Handle].bInUse = false;
+	FreeHandles.Add( Handle );
+}
+
+FIntPoint FTurretTargetGrid::GetCell( const FVector& Location ) const
+{
+	return FIntPoint( FMath::FloorToInt( Location.X * InverseCellSize ), FMath::FloorToInt( Location.Y * InverseCellSize ) );
+}
+
+void FTurretTargetGrid::AddToCell( int32 Handle, const FIntPoint& Cell )
+{
+	FTarget& Target = Targets[Handle];
+	TArray<FCellEntry>& Entries = Cells.FindOrAdd( Cell );
+
+	FCellEntry Entry;
+	Entry.Location = Target.Location;
+	Entry.Tag = Target.Tag;
+	Entry.Handle = Handle;
+
+	Target.Cell = Cell;
+	Target.IndexInCell = Entries.Add( Entry );
+
+	MinCell = FIntPoint( FMath::Min( MinCell.X, Cell.X ), FMath::Min( MinCell.Y, Cell.Y ) );
+	MaxCell = FIntPoint( FMath::Max( MaxCell.X, Cell.X ), FMath::Max( MaxCell.Y, Cell.Y ) );
+}
+
+void FTurretTargetGrid::RemoveFromCell( int32 Handle )
+{
+	const FTarget& Target = Targets[Handle];
+	TArray<FCellEntry>& Entries = Cells.FindChecked( Target.Cell );
+
+	// The last entry gets swapped into the removed entry's place, so its target needs to know its new index.
+	Entries.RemoveAtSwap( Target.IndexInCell, 1, /*bAllowShrinking*/ false );
+	if ( Entries.IsValidIndex( Target.IndexInCell ) )
+	{
+		Targets[Entries[Target.IndexInCell].Handle].IndexInCell = Target.IndexInCell;
+	}
+}
+
+bool FTurretTargetGrid::PassesQuery( const FCellEntry& Entry, const FTurretTargetQuery& Query, float CosHalfArc, const FVector2D& Forward2D, float DistanceSquared )
+{
+	if ( DistanceSquared < FMath::Square( Query.MinRange ) || DistanceSquared > FMath::Square( Query.MaxRange ) )
+	{
+		return false;
+	}
+
+	if ( Query.IgnoredTag != 0 && Entry.Tag == Query.IgnoredTag )
+	{
+		return false;
+	}
+
+	if ( !Forward2D.IsZero() )
+	{
+		// Inside the arc if the angle to the target is at most HalfArcDegrees, which is the same as:
+		// Dot( Forward2D, Origin_To_Target2D ) >= Cos( HalfArc ) * Size( Origin_To_Target2D )
+		// Targets straight above/below the Origin have no direction, so they always count as inside.
+		const FVector2D Origin_To_Target2D = FVector2D( Entry.Location.X - Query.Origin.X, Entry.Location.Y - Query.Origin.Y );
+		if ( ( Forward2D | Origin_To_Target2D ) < CosHalfArc * Origin_To_Target2D.Size() )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FTurretTargetGrid::CheckCell( const FIntPoint& Cell, const FTurretTargetQuery& Query, float CosHalfArc, const FVector2D& Forward2D, int32& Out_BestHandle, float& Out_BestDistanceSquared ) const
+{
+	const TArray<FCellEntry>* Entries = Cells.Find( Cell );
+	if ( !Entries )
+	{
+		return;
+	}
+
+	for ( const FCellEntry& Entry : *Entries )
+	{
+		const float DistanceSquared = FVector::DistSquared( Entry.Location, Query.Origin );
+		if ( DistanceSquared < Out_BestDistanceSquared && PassesQuery( Entry, Query, CosHalfArc, Forward2D, DistanceSquared ) )
+		{
+			Out_BestHandle = Entry.Handle;
+			Out_BestDistanceSquared = DistanceSquared;
+		}
+	}
+}
+
+int32 FTurretTargetGrid::FindNearestTarget( const FTurretTargetQuery& Query ) const
+{
+	if ( GetNumTargets() == 0 )
+	{
+		return INDEX_NONE;
+	}
+
+	const bool bHasArc = Query.HalfArcDegrees < 180.0f;
+	const float CosHalfArc = FMath::Cos( FMath::DegreesToRadians( Query.HalfArcDegrees ) );
+	const FVector2D Forward2D = bHasArc ? FVector2D( Query.Forward.X, Query.Forward.Y ).GetSafeNormal() : FVector2D::ZeroVector;
+
+	int32 BestHandle = INDEX_NONE;
+	float BestDistanceSquared = FMath::Square( Query.MaxRange ) * ( 1.0f + KINDA_SMALL_NUMBER ) + KINDA_SMALL_NUMBER;
+
+	const FIntPoint OriginCell = GetCell( Query.Origin );
+
+	// Past this ring, there are no cells that have ever held a target.
+	const int32 LastUsefulRing = FMath::Max(
+		FMath::Max( OriginCell.X - MinCell.X, MaxCell.X - OriginCell.X ),
+		FMath::Max( OriginCell.Y - MinCell.Y, MaxCell.Y - OriginCell.Y ) );
+
+	// Past this ring, every cell is out of range.
+	const int32 LastInRangeRing = FMath::CeilToInt( Query.MaxRange * InverseCellSize ) + 1;
+
+	const int32 LastRing = FMath::Min( LastUsefulRing, LastInRangeRing );
+	for ( int32 Ring = 0; Ring <= LastRing; ++Ring )
+	{
+		// The Origin is somewhere inside OriginCell, so nothing in this ring can be closer than (Ring - 1) cells.
+		// Once that's farther than the best target, then nothing in this ring (or any later ring) can beat it.
+		if ( Ring > 0 && FMath::Square( ( Ring - 1 ) * CellSize ) > BestDistanceSquared )
+		{
+			break;
+		}
+
+		if ( Ring == 0 )
+		{
+			CheckCell( OriginCell, Query, CosHalfArc, Forward2D, BestHandle, BestDistanceSquared );
+			continue;
+		}
+
+		// Only visit the part of the ring that is inside the bounds.
+		const int32 MinX = FMath::Max( OriginCell.X - Ring, MinCell.X );
+		const int32 MaxX = FMath::Min( OriginCell.X + Ring, MaxCell.X );
+		const int32 MinY = FMath::Max( OriginCell.Y - Ring + 1, MinCell.Y );
+		const int32 MaxY = FMath::Min( OriginCell.Y + Ring - 1, MaxCell.Y );
+
+		// Bottom and top rows.
+		for ( const int32 Y : { OriginCell.Y - Ring, OriginCell.Y + Ring } )
+		{
+			if ( Y < MinCell.Y || Y > MaxCell.Y )
+			{
+				continue;
+			}
+
+			for ( int32 X = MinX; X <= MaxX; ++X )
+			{
+				CheckCell( FIntPoint( X, Y ), Query, CosHalfArc, Forward2D, BestHandle, BestDistanceSquared );
+			}
+		}
+
+		// Left and right columns, without the corners (the rows already had those).
+		for ( const int32 X : { OriginCell.X - Ring, OriginCell.X + Ring } )
+		{
+			if ( X < MinCell.X || X > MaxCell.X )
+			{
+				continue;
+			}
+
+			for ( int32 Y = MinY; Y <= MaxY; ++Y )
+			{
+				CheckCell( FIntPoint( X, Y ), Query, CosHalfArc, Forward2D, BestHandle, BestDistanceSquared );
+			}
+		}
+	}
+
+	return BestHandle;
+}
+
+int32 FTurretTargetGrid::FindNearestTarget_BruteForce( const FTurretTargetQuery& Query ) const
+{
+	const bool bHasArc = Query.HalfArcDegrees < 180.0f;
+	const float CosHalfArc = FMath::Cos( FMath::DegreesToRadians( Query.HalfArcDegrees ) );
+	const FVector2D Forward2D = bHasArc ? FVector2D( Query.Forward.X, Query.Forward.Y ).GetSafeNormal() : FVector2D::ZeroVector;
+
+	int32 BestHandle = INDEX_NONE;
+	float BestDistanceSquared = MAX_flt;
+
+	for ( int32 Handle = 0; Handle < Targets.Num(); ++Handle )
+	{
+		const FTarget& Target = Targets[Handle];
+		if ( !Target.bInUse )
+		{
+			continue;
+		}
+
+		FCellEntry Entry;
+		Entry.Location = Target.Location;
+		Entry.Tag = Target.Tag;
+		Entry.Handle = Handle;
+
+		const float DistanceSquared = FVector::DistSquared( Target.Location, Query.Origin );
+		if ( DistanceSquared < BestDistanceSquared && PassesQuery( Entry, Query, CosHalfArc, Forward2D, DistanceSquared ) )
+		{
+			BestHandle = Handle;
+			BestDistanceSquared = DistanceSquared;
+		}
+	}
+
+	return BestHandle;
+}
+
+void FTurretTargetGrid::FindNearestTargets( TArrayView<const FTurretTargetQuery> Queries, TArrayView<int32> Out_Targets, bool bForceSingleThread ) const
+{
+	check( Queries.Num() == Out_Targets.Num() );
+
+	// Queries are cheap, so give each task a decent amount of them.
+	const int32 NumQueries = Queries.Num();
+	const int32 ChunkSize = 64;
+	const int32 NumChunks = FMath::DivideAndRoundUp( NumQueries, ChunkSize );
+
+	ParallelFor( NumChunks, [this, &Queries, &Out_Targets, NumQueries, ChunkSize]( int32 ChunkIndex )
+	{
+		const int32 StartIndex = ChunkIndex * ChunkSize;
+		const int32 EndIndex = FMath::Min( StartIndex + ChunkSize, NumQueries );
+
+		for ( int32 Index = StartIndex; Index < EndIndex; ++Index )
+		{
+			Out_Targets[Index] = FindNearestTarget( Queries[Index] );
+		}
+	}, bForceSingleThread );
+}
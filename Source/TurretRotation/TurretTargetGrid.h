@@ -0,0 +1,160 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+
+/**
+ * What a turret is allowed to pick as its target.
+ */
+struct TURRETROTATION_API FTurretTargetQuery
+{
+public:
+	FTurretTargetQuery();
+
+	/** Where distances are measured from.  Usually the turret's AimJoint. */
+	FVector Origin;
+
+	/** The direction (in world space) that the middle of the firing arc faces.  Only "X-Y" matters. */
+	FVector Forward;
+
+	/** Targets closer than this are ignored. */
+	float MinRange;
+
+	/** Targets farther away than this are ignored. */
+	float MaxRange;
+
+	/** How far (in degrees, across the "X-Y" plane) a target can be from Forward.  180 or more means all the way around. */
+	float HalfArcDegrees;
+
+	/** Targets with this tag are ignored, so a turret doesn't pick itself.  0 ignores nothing. */
+	UPTRINT IgnoredTag;
+};
+
+/**
+ * Spatial hash of the possible targets, so that turrets can find the nearest valid target without checking every single one.
+ *
+ * Targets are bucketed into square cells across the "X-Y" plane.  A query starts at the cell holding its Origin and searches outward,
+ * one ring of cells at a time, and stops as soon as the next ring can't possibly hold anything closer than the best target so far.
+ * With targets spread out over the map, that means a query only looks at a handful of cells, instead of every target.
+ *
+ * Moving a target only touches the grid when it crosses into a different cell, so updating every target every frame is cheap.
+ *
+ * Queries don't modify anything, so any number of them can run in parallel (see FindNearestTargets), as long as nothing is added,
+ * moved, or removed at the same time.
+ */
+class TURRETROTATION_API FTurretTargetGrid
+{
+public:
+	/**
+	 * @param InCellSize	Size of each cell.  Around the typical distance between targets (or a bit less than the typical MaxRange) works well.
+	 */
+	explicit FTurretTargetGrid( float InCellSize = 1000.0f );
+
+	/**
+	 * Adds a target.
+	 *
+	 * @param Location	The target's location in world space.
+	 * @param Tag		Anything that identifies the target's owner, for FTurretTargetQuery::IgnoredTag.
+	 * @return Returns the target's handle.  Handles of removed targets are reused.
+	 */
+	int32 AddTarget( const FVector& Location, UPTRINT Tag = 0 );
+
+	/** Moves a target.  Only touches the cells if the target moved into a different cell. */
+	void UpdateTarget( int32 Handle, const FVector& Location );
+
+	/** Removes a target.  Its handle may be given out again by AddTarget. */
+	void RemoveTarget( int32 Handle );
+
+	/** Removes every target, and forgets every cell. */
+	void Reset();
+
+	/** @return Returns true if the handle belongs to a target that hasn't been removed. */
+	bool IsValidTarget( int32 Handle ) const { return Targets.IsValidIndex( Handle ) && Targets[Handle].bInUse; }
+
+	/** @return Returns the location of the given target. */
+	const FVector& GetTargetLocation( int32 Handle ) const { return Targets[Handle].Location; }
+
+	/** @return Returns the highest handle + 1, for sizing arrays that are indexed by handle. */
+	int32 GetMaxHandles() const { return Targets.Num(); }
+
+	/** @return Returns the number of targets. */
+	int32 GetNumTargets() const { return Targets.Num() - FreeHandles.Num(); }
+
+	float GetCellSize() const { return CellSize; }
+
+	/**
+	 * Finds the nearest target that the query allows.
+	 *
+	 * @param Query		Where to search from, the range, and the firing arc.
+	 * @return Returns the handle of the nearest target, or INDEX_NONE if there isn't one.
+	 */
+	int32 FindNearestTarget( const FTurretTargetQuery& Query ) const;
+
+	/**
+	 * Same as FindNearestTarget, but checks every target.  Only useful for testing and benchmarking against FindNearestTarget.
+	 */
+	int32 FindNearestTarget_BruteForce( const FTurretTargetQuery& Query ) const;
+
+	/**
+	 * Runs FindNearestTarget for a lot of queries at once, splitting them across worker threads.
+	 *
+	 * @param Queries				One query per turret.
+	 * @param Out_Targets			OUT - The nearest target for each query, or INDEX_NONE.
+	 * @param bForceSingleThread	If true, every query runs on the calling thread.
+	 */
+	void FindNearestTargets( TArrayView<const FTurretTargetQuery> Queries, TArrayView<int32> Out_Targets, bool bForceSingleThread = false ) const;
+
+private:
+	/** A target, as seen by the cells.  The location is copied into the cell so queries don't have to jump around in memory. */
+	struct FCellEntry
+	{
+		FVector Location;
+		UPTRINT Tag;
+		int32 Handle;
+	};
+
+	struct FTarget
+	{
+		FVector Location;
+		UPTRINT Tag;
+		FIntPoint Cell;
+		int32 IndexInCell;
+		bool bInUse;
+	};
+
+	/** @return Returns the cell holding the given location. */
+	FIntPoint GetCell( const FVector& Location ) const;
+
+	/** Puts the target into the given cell. */
+	void AddToCell( int32 Handle, const FIntPoint& Cell );
+
+	/** Takes the target out of its cell. */
+	void RemoveFromCell( int32 Handle );
+
+	/**
+	 * Checks every target in the cell against the query.
+	 *
+	 * @param Cell						The cell to check.
+	 * @param Query						The query.
+	 * @param CosHalfArc				Cosine of the query's HalfArcDegrees.
+	 * @param Forward2D					The query's normalized Forward, on the "X-Y" plane.  Zero means no arc.
+	 * @param Out_BestHandle			IN/OUT - The nearest target found so far.
+	 * @param Out_BestDistanceSquared	IN/OUT - The squared distance to the nearest target found so far.
+	 */
+	void CheckCell( const FIntPoint& Cell, const FTurretTargetQuery& Query, float CosHalfArc, const FVector2D& Forward2D, int32& Out_BestHandle, float& Out_BestDistanceSquared ) const;
+
+	/** @return Returns true if the entry passes the query's range, arc, and tag checks. */
+	static bool PassesQuery( const FCellEntry& Entry, const FTurretTargetQuery& Query, float CosHalfArc, const FVector2D& Forward2D, float DistanceSquared );
+
+	float CellSize;
+	float InverseCellSize;
+
+	TArray<FTarget> Targets;
+	TArray<int32> FreeHandles;
+
+	TMap<FIntPoint, TArray<FCellEntry>> Cells;
+
+	/** Every cell that has ever held a target is within these bounds, so queries know when to stop searching outward. */
+	FIntPoint MinCell;
+	FIntPoint MaxCell;
+};
@@ -1,14 +1,14 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-using UnrealBuildTool;
-using System.Collections.Generic;
-
-public class TurretRotationEditorTarget : TargetRules
-{
-	public TurretRotationEditorTarget(TargetInfo Target) : base(Target)
-	{
-		Type = TargetType.Editor;
-
-		ExtraModuleNames.AddRange( new string[] { "TurretRotation" } );
-	}
-}
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class TurretRotationEditorTarget : TargetRules
+{
+	public TurretRotationEditorTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Editor;
+
+		ExtraModuleNames.AddRange( new string[] { "TurretRotation", "TurretRotationEditor" } );
+	}
+}
@@ -0,0 +1,29 @@
+#include "AnimGraphNode_OffsetTurretAim.h"
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_OffsetTurretAim"
+
+
+FText UAnimGraphNode_OffsetTurretAim::GetNodeTitle( ENodeTitleType::Type TitleType ) const
+{
+	if ( ( TitleType == ENodeTitleType::ListView || TitleType == ENodeTitleType::MenuTitle ) || Node.AimJoint.BoneName == NAME_None )
+	{
+		return GetControllerDescription();
+	}
+
+	FFormatNamedArguments Args;
+	Args.Add( TEXT( "ControllerDescription" ), GetControllerDescription() );
+	Args.Add( TEXT( "BoneName" ), FText::FromName( Node.AimJoint.BoneName ) );
+	return FText::Format( LOCTEXT( "OffsetTurretAim_Title", "{ControllerDescription}\nAim Joint: {BoneName}" ), Args );
+}
+
+FText UAnimGraphNode_OffsetTurretAim::GetTooltipText() const
+{
+	return LOCTEXT( "OffsetTurretAim_Tooltip", "Rotates the AimJoint so that a barrel that is offset from it points at the target.  Same as CalculateTurretRotation_ForAimJoint, but runs during animation evaluation." );
+}
+
+FText UAnimGraphNode_OffsetTurretAim::GetControllerDescription() const
+{
+	return LOCTEXT( "OffsetTurretAim", "Offset Turret Aim" );
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimGraphNode_SkeletalControlBase.h"
+#include "AnimNode_OffsetTurretAim.h"
+#include "AnimGraphNode_OffsetTurretAim.generated.h"
+
+/**
+ * Editor side of FAnimNode_OffsetTurretAim, the "Offset Turret Aim" node in the AnimGraph.
+ */
+UCLASS()
+class TURRETROTATIONEDITOR_API UAnimGraphNode_OffsetTurretAim : public UAnimGraphNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY( EditAnywhere, Category = "Settings" )
+	FAnimNode_OffsetTurretAim Node;
+
+	// UEdGraphNode interface
+	virtual FText GetNodeTitle( ENodeTitleType::Type TitleType ) const override;
+	virtual FText GetTooltipText() const override;
+
+protected:
+	// UAnimGraphNode_SkeletalControlBase interface
+	virtual FText GetControllerDescription() const override;
+	virtual const FAnimNode_SkeletalControlBase* GetNode() const override { return &Node; }
+};
@@ -0,0 +1,43 @@
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+#include "Engine/Engine.h"
+#include "TurretEditorRefresher.h"
+
+
+/**
+ * Owns the FTurretEditorRefresher.  The module loads at PostEngineInit, so GEngine is around to bind OnActorMoved to, and everything is
+ * unbound and destroyed in ShutdownModule rather than during static destruction.
+ */
+class FTurretRotationEditorModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override
+	{
+		Refresher = MakeUnique<FTurretEditorRefresher>();
+		FTurretEditorRefresher::SetInstance( Refresher.Get() );
+
+		if ( GEngine )
+		{
+			OnActorMovedHandle = GEngine->OnActorMoved().AddRaw( Refresher.Get(), &FTurretEditorRefresher::OnActorMoved );
+		}
+	}
+
+	virtual void ShutdownModule() override
+	{
+		if ( GEngine && OnActorMovedHandle.IsValid() )
+		{
+			GEngine->OnActorMoved().Remove( OnActorMovedHandle );
+		}
+		OnActorMovedHandle.Reset();
+
+		FTurretEditorRefresher::SetInstance( nullptr );
+		Refresher.Reset();
+	}
+
+private:
+	TUniquePtr<FTurretEditorRefresher> Refresher;
+
+	FDelegateHandle OnActorMovedHandle;
+};
+
+IMPLEMENT_MODULE( FTurretRotationEditorModule, TurretRotationEditor );
@@ -0,0 +1,93 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationCore.h"
+
+
+/**
+ * Checks every EAimAccuracy tier against its documented error bound (GetMaxAngleErrorDegrees).
+ */
+namespace TurretRotationAccuracyTests
+{
+	typedef TurretRotationCore::TVector3<double> FVector3d;
+
+	/** @return Returns the worst error (in degrees) of float Atan2, swept all the way around the circle at several lengths. */
+	static double CalculateWorstAtan2Error( TurretRotationCore::EAimAccuracy Accuracy )
+	{
+		const double Pi = TurretRotationCore::TConstants<double>::Pi();
+		const double RadiansToDegrees = TurretRotationCore::TConstants<double>::RadiansToDegrees();
+
+		double WorstError = 0.0;
+		const int NumAngles = 1000000;
+		const double Lengths[] = { 1.e-3, 1.0, 1.e4 };
+		for ( int AngleIndex = 0; AngleIndex <= NumAngles; ++AngleIndex )
+		{
+			const double Angle = -Pi + ( ( 2.0 * Pi * AngleIndex ) / NumAngles );
+			for ( const double Length : Lengths )
+			{
+				const float Y = float( std::sin( Angle ) * Length );
+				const float X = float( std::cos( Angle ) * Length );
+				const double Approximation = double( TurretRotationCore::Atan2<float>( Y, X, Accuracy ) ) * RadiansToDegrees;
+				const double Reference = std::atan2( double( Y ), double( X ) ) * RadiansToDegrees;
+				WorstError = std::max( WorstError, TurretRotationTests::GetAngleDifferenceDegrees( Approximation, Reference ) );
+			}
+		}
+		return WorstError;
+	}
+
+	/**
+	 * @return Returns the worst error (in degrees) of the whole solve over every direction, distances from inside the barrel out to a
+	 * kilometer, and the degenerate inputs.  The solve is done in double precision against the Exact tier, so that float rounding (which
+	 * every tier has) doesn't hide the error the tier itself adds.
+	 */
+	static double CalculateWorstSolveError( TurretRotationCore::EAimAccuracy Accuracy )
+	{
+		TurretRotationTests::FTestRandom Random( 2468 );
+		double WorstError = 0.0;
+		for ( int Index = 0; Index < 200000; ++Index )
+		{
+			const bool bDegenerate = ( Index % 8 ) == 0;
+			const FVector3d AimJoint_To_BarrelStart( Random.FRandRange( -10.0f, 80.0f ), 0.0, Random.FRandRange( -60.0f, 60.0f ) );
+			const FVector3d BarrelStart_To_BarrelEnd = ( bDegenerate && ( Index % 16 ) == 0 ) ? FVector3d() : FVector3d( Random.FRandRange( 0.0f, 300.0f ), 0.0, Random.FRandRange( -30.0f, 30.0f ) );
+			const TurretRotationCore::TAimGeometry<double> Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, FVector3d( 1.0, 1.0, 1.0 ) );
+
+			FVector3d Target;
+			if ( bDegenerate )
+			{
+				// Right on the AimJoint, or straight above/below it.
+				Target = ( Index % 3 ) == 0 ? FVector3d() : FVector3d( 0.0, 0.0, Random.FRandRange( -1000.0f, 1000.0f ) );
+			}
+			else
+			{
+				const FVector3d Direction = Random.VRand();
+				const double Distance = std::pow( 10.0, Random.DRandRange( 0.0, 5.0 ) );
+				Target = FVector3d( Direction.X * Distance, Direction.Y * Distance, Direction.Z * Distance );
+			}
+
+			const TurretRotationCore::TAimAngles<double> Exact = Geometry.Solve( Target, TurretRotationCore::EAimAccuracy::Exact );
+			const TurretRotationCore::TAimAngles<double> Approximate = Geometry.Solve( Target, Accuracy );
+			WorstError = std::max( WorstError, TurretRotationTests::GetAngleDifferenceDegrees( Exact.Yaw, Approximate.Yaw ) );
+			WorstError = std::max( WorstError, TurretRotationTests::GetAngleDifferenceDegrees( Exact.Pitch, Approximate.Pitch ) );
+		}
+		return WorstError;
+	}
+}
+
+using namespace TurretRotationAccuracyTests;
+
+TURRET_TEST( Accuracy, Exact )
+{
+	// Exact is compared against itself (and std::atan2), so anything other than ~0 means the tiers got mixed up.
+	TURRET_CHECK_LE( CalculateWorstAtan2Error( TurretRotationCore::EAimAccuracy::Exact ), 1.e-4 );
+	TURRET_CHECK_LE( CalculateWorstSolveError( TurretRotationCore::EAimAccuracy::Exact ), 0.0 );
+}
+
+TURRET_TEST( Accuracy, Fast )
+{
+	TURRET_CHECK_LE( CalculateWorstAtan2Error( TurretRotationCore::EAimAccuracy::Fast ), AIM_ACCURACY_FAST_MAX_ERROR_DEGREES );
+	TURRET_CHECK_LE( CalculateWorstSolveError( TurretRotationCore::EAimAccuracy::Fast ), AIM_ACCURACY_FAST_MAX_ERROR_DEGREES );
+}
+
+TURRET_TEST( Accuracy, Approximate )
+{
+	TURRET_CHECK_LE( CalculateWorstAtan2Error( TurretRotationCore::EAimAccuracy::Approximate ), AIM_ACCURACY_APPROXIMATE_MAX_ERROR_DEGREES );
+	TURRET_CHECK_LE( CalculateWorstSolveError( TurretRotationCore::EAimAccuracy::Approximate ), AIM_ACCURACY_APPROXIMATE_MAX_ERROR_DEGREES );
+}
@@ -0,0 +1,183 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationBallistics.h"
+
+
+/**
+ * Checks SolveBallistic (TurretRotationBallistics.h) by firing the projectile along the barrel it aims, and seeing where it is once the
+ * time of flight is up.
+ */
+namespace TurretRotationBallisticsTests
+{
+	typedef TurretRotationCore::TVector3<double> FVector3d;
+
+	/** 100 m/s with the engine's default gravity, so the longest reach (at 45 degrees, on flat ground) is a little over 1 km. */
+	const double MuzzleSpeed = 10000.0;
+	const double GravityZ = -980.0;
+	const double MaxRange = ( MuzzleSpeed * MuzzleSpeed ) / -GravityZ;
+
+	/** How far (in cm) the projectile can be from the target when it gets there.  The solve stops once the flight time is within 1 ms. */
+	const double MissTolerance = 25.0;
+
+	struct FBallisticTestCase
+	{
+		TurretRotationCore::TAimGeometry<double> Geometry;
+		FVector3d Target;
+		FVector3d Velocity;
+		FVector3d Acceleration;
+	};
+
+	/**
+	 * Turrets sized like the demo turrets, with targets moving at up to 15 m/s (some of them speeding up or slowing down).
+	 *
+	 * @param MinDistance	Closest a target can start to the AimJoint (horizontally).
+	 * @param MaxDistance	Furthest a target can start from the AimJoint (horizontally).
+	 */
+	static std::vector<FBallisticTestCase> MakeBallisticCases( int NumCases, double MinDistance, double MaxDistance, TurretRotationTests::FTestRandom& Random )
+	{
+		std::vector<FBallisticTestCase> Cases;
+		for ( int Index = 0; Index < NumCases; ++Index )
+		{
+			FBallisticTestCase Case;
+			Case.Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors(
+				FVector3d( Random.FRandRange( 0.0f, 50.0f ), 0, Random.FRandRange( -50.0f, 50.0f ) ),
+				FVector3d( Random.FRandRange( 50.0f, 300.0f ), 0, Random.FRandRange( -20.0f, 20.0f ) ),
+				FVector3d( 1, 1, 1 ) );
+
+			const double Angle = Random.DRandRange( -TurretRotationCore::TConstants<double>::Pi(), TurretRotationCore::TConstants<double>::Pi() );
+			const double Distance = Random.DRandRange( MinDistance, MaxDistance );
+			Case.Target = FVector3d( std::cos( Angle ) * Distance, std::sin( Angle ) * Distance, Random.DRandRange( -2000.0, 2000.0 ) );
+			Case.Velocity = FVector3d( Random.DRandRange( -1500.0, 1500.0 ), Random.DRandRange( -1500.0, 1500.0 ), Random.DRandRange( -100.0, 100.0 ) );
+			Case.Acceleration = ( Index % 4 ) == 0
+				? FVector3d( Random.DRandRange( -200.0, 200.0 ), Random.DRandRange( -200.0, 200.0 ), 0 )
+				: FVector3d( 0, 0, 0 );
+			Cases.push_back( Case );
+		}
+		return Cases;
+	}
+
+	static TurretRotationCore::TBallisticSettings<double> MakeSettings( bool bHighArc )
+	{
+		TurretRotationCore::TBallisticSettings<double> Settings;
+		Settings.MuzzleSpeed = MuzzleSpeed;
+		Settings.Gravity = FVector3d( 0, 0, GravityZ );
+		Settings.bHighArc = bHighArc;
+		Settings.MaxIterations = 12;
+		return Settings;
+	}
+
+	/** @return Returns where something that starts at Location is after the given time. */
+	static FVector3d Move( const FVector3d& Location, const FVector3d& Velocity, const FVector3d& Acceleration, double Seconds )
+	{
+		return TurretRotationCore::Add3D( Location, TurretRotationCore::Add3D( TurretRotationCore::Scale3D( Velocity, Seconds ), TurretRotationCore::Scale3D( Acceleration, 0.5 * Seconds * Seconds ) ) );
+	}
+
+	/** @return Returns which way the barrel (BarrelStart to BarrelEnd) points once the AimJoint is rotated by the given angles. */
+	static FVector3d CalculateBarrelDirection( const TurretRotationCore::TAimGeometry<double>& Geometry, const TurretRotationCore::TAimAngles<double>& Angles )
+	{
+		const double DegreesToRadians = 1.0 / TurretRotationCore::TConstants<double>::RadiansToDegrees();
+		const double PitchRadians = Angles.Pitch * DegreesToRadians;
+		const double YawRadians = Angles.Yaw * DegreesToRadians;
+
+		const double BarrelX = Geometry.GetBarrelEndLocation2D().X - Geometry.GetBarrelStartLocation2D().X;
+		const double BarrelZ = Geometry.GetBarrelEndLocation2D().Y - Geometry.GetBarrelStartLocation2D().Y;
+		const double PitchedX = ( BarrelX * std::cos( PitchRadians ) ) - ( BarrelZ * std::sin( PitchRadians ) );
+		const double PitchedZ = ( BarrelX * std::sin( PitchRadians ) ) + ( BarrelZ * std::cos( PitchRadians ) );
+
+		const FVector3d Direction( PitchedX * std::cos( YawRadians ), PitchedX * std::sin( YawRadians ), PitchedZ );
+		return TurretRotationCore::Scale3D( Direction, 1.0 / TurretRotationCore::Size3D( Direction ) );
+	}
+
+	/**
+	 * Solves every case, fires the projectile from the muzzle along the barrel, and measures how far it is from the target once the time of
+	 * flight is up.
+	 *
+	 * @param Out_NumSolved				OUT - Number of cases that had a solution.
+	 * @param Out_AverageTimeOfFlight	OUT - Average time of flight of the cases that had a solution.
+	 * @return Returns the largest miss distance (in cm) of the cases that had a solution.
+	 */
+	static double CalculateWorstMiss( const std::vector<FBallisticTestCase>& Cases, bool bHighArc, int& Out_NumSolved, double& Out_AverageTimeOfFlight )
+	{
+		const TurretRotationCore::TBallisticSettings<double> Settings = MakeSettings( bHighArc );
+
+		Out_NumSolved = 0;
+		Out_AverageTimeOfFlight = 0.0;
+		double WorstMiss = 0.0;
+		for ( const FBallisticTestCase& Case : Cases )
+		{
+			const TurretRotationCore::TBallisticSolution<double> Solution = TurretRotationCore::SolveBallistic( Case.Geometry, Case.Target, Case.Velocity, Case.Acceleration, Settings );
+			if ( !Solution.bHasSolution )
+			{
+				continue;
+			}
+
+			const double TimeOfFlight = Solution.TimeOfFlight;
+			const FVector3d LaunchVelocity = TurretRotationCore::Scale3D( CalculateBarrelDirection( Case.Geometry, Solution.Angles ), MuzzleSpeed );
+			const FVector3d Projectile = Move( Solution.MuzzleLocation, LaunchVelocity, Settings.Gravity, TimeOfFlight );
+			const FVector3d Target = Move( Case.Target, Case.Velocity, Case.Acceleration, TimeOfFlight );
+
+			WorstMiss = std::max( WorstMiss, TurretRotationCore::Size3D( TurretRotationCore::Subtract3D( Projectile, Target ) ) );
+			Out_AverageTimeOfFlight += TimeOfFlight;
+			++Out_NumSolved;
+		}
+
+		Out_AverageTimeOfFlight /= std::max( 1, Out_NumSolved );
+		return WorstMiss;
+	}
+}
+
+using namespace TurretRotationBallisticsTests;
+
+TURRET_TEST( Ballistics, LowArcHitsTarget )
+{
+	TurretRotationTests::FTestRandom Random( 2468 );
+	const std::vector<FBallisticTestCase> Cases = MakeBallisticCases( 20000, 500.0, 0.6 * MaxRange, Random );
+
+	int NumSolved = 0;
+	double AverageTimeOfFlight = 0.0;
+	TURRET_CHECK_LE( CalculateWorstMiss( Cases, /*bHighArc*/ false, NumSolved, AverageTimeOfFlight ), MissTolerance );
+
+	// Every target is well within reach, so the low arc always converges.
+	TURRET_CHECK_EQ( NumSolved, int( Cases.size() ) );
+}
+
+TURRET_TEST( Ballistics, HighArcHitsTarget )
+{
+	TurretRotationTests::FTestRandom Random( 2468 );
+	const std::vector<FBallisticTestCase> Cases = MakeBallisticCases( 20000, 500.0, 0.6 * MaxRange, Random );
+
+	int NumLowSolved = 0;
+	double AverageLowTimeOfFlight = 0.0;
+	CalculateWorstMiss( Cases, /*bHighArc*/ false, NumLowSolved, AverageLowTimeOfFlight );
+
+	int NumSolved = 0;
+	double AverageTimeOfFlight = 0.0;
+	TURRET_CHECK_LE( CalculateWorstMiss( Cases, /*bHighArc*/ true, NumSolved, AverageTimeOfFlight ), MissTolerance );
+
+	// Near vertical high arcs are allowed to not converge (see TBallisticSolution::bHasSolution), but they should be rare.
+	TURRET_CHECK( NumSolved >= int( Cases.size() * 0.99 ) );
+
+	// And it really is the other arc.
+	TURRET_CHECK( AverageTimeOfFlight > 2.0 * AverageLowTimeOfFlight );
+}
+
+TURRET_TEST( Ballistics, OutOfRangeHasNoSolution )
+{
+	TurretRotationTests::FTestRandom Random( 1357 );
+	const std::vector<FBallisticTestCase> Cases = MakeBallisticCases( 20000, 1.5 * MaxRange, 5.0 * MaxRange, Random );
+
+	int NumSolved = 0;
+	for ( const bool bHighArc : { false, true } )
+	{
+		const TurretRotationCore::TBallisticSettings<double> Settings = MakeSettings( bHighArc );
+		for ( const FBallisticTestCase& Case : Cases )
+		{
+			NumSolved += TurretRotationCore::SolveBallistic( Case.Geometry, Case.Target, Case.Velocity, Case.Acceleration, Settings ).bHasSolution ? 1 : 0;
+		}
+	}
+	TURRET_CHECK_EQ( NumSolved, 0 );
+
+	// A projectile that isn't fired can't reach anything.
+	TurretRotationCore::TBallisticSettings<double> NoSpeedSettings = MakeSettings( false );
+	NoSpeedSettings.MuzzleSpeed = 0.0;
+	TURRET_CHECK( !TurretRotationCore::SolveBallistic( Cases[0].Geometry, FVector3d( 1000, 0, 0 ), FVector3d( 0, 0, 0 ), FVector3d( 0, 0, 0 ), NoSpeedSettings ).bHasSolution );
+}
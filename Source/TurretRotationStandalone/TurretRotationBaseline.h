@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+/**
+ * Frozen copy of the original yaw/pitch math from UTurretRotationFunctionLibrary, from before it moved into TurretRotationCore.
+ *
+ * The tests compare TurretRotationCore against this, so it must not be "fixed" or sped up: it only swaps FVector2D/FMath for the
+ * plain float math that they boil down to.  The AimJoint's transform is left out, since the tests give targets in AimJoint space.
+ */
+namespace TurretRotationBaseline
+{
+	/** Stand-in for FVector2D, with the parts of it that the original math used. */
+	struct FVector2
+	{
+		float X;
+		float Y;
+
+		FVector2() : X( 0.0f ), Y( 0.0f ) {}
+		FVector2( float InX, float InY ) : X( InX ), Y( InY ) {}
+
+		FVector2 operator+( const FVector2& Other ) const { return FVector2( X + Other.X, Y + Other.Y ); }
+		FVector2 operator-( const FVector2& Other ) const { return FVector2( X - Other.X, Y - Other.Y ); }
+		FVector2 operator*( float Scale ) const { return FVector2( X * Scale, Y * Scale ); }
+		float operator|( const FVector2& Other ) const { return ( X * Other.X ) + ( Y * Other.Y ); }
+
+		float Size() const { return std::sqrt( ( X * X ) + ( Y * Y ) ); }
+
+		/** Same as FVector2D::GetSafeNormal, with its default tolerance (SMALL_NUMBER). */
+		FVector2 GetSafeNormal() const
+		{
+			const float SquareSum = ( X * X ) + ( Y * Y );
+			if ( SquareSum == 1.0f )
+			{
+				return *this;
+			}
+			else if ( SquareSum < 1.e-8f )
+			{
+				return FVector2();
+			}
+			const float Scale = 1.0f / std::sqrt( SquareSum );
+			return FVector2( X * Scale, Y * Scale );
+		}
+
+		/** Same as FVector2D::GetRotated. */
+		FVector2 GetRotated( float AngleDeg ) const
+		{
+			const float Radians = AngleDeg * ( 3.1415926535897932f / 180.0f );
+			const float S = std::sin( Radians );
+			const float C = std::cos( Radians );
+			return FVector2( ( C * X ) - ( S * Y ), ( S * X ) + ( C * Y ) );
+		}
+	};
+
+	inline float RadiansToDegrees( float Radians ) { return Radians * ( 180.0f / 3.1415926535897932f ); }
+
+	inline float CalculateTurretYaw( float AimJoint_To_Target_X, float AimJoint_To_Target_Y )
+	{
+		// Atan2 will give us the angle (in radians) that corresponds to AimJoint_To_Target.
+		return RadiansToDegrees( std::atan2( AimJoint_To_Target_Y, AimJoint_To_Target_X ) );
+	}
+
+	inline FVector2 CalculateNearestValidTargetLocation2D( const FVector2& AimJointLocation2D, const FVector2& BarrelStartLocation2D, const FVector2& BarrelEndLocation2D, const FVector2& TargetLocation2D )
+	{
+		const float AimJoint_To_BarrelStart_Distance = ( BarrelStartLocation2D - AimJointLocation2D ).Size();
+		const float AimJoint_To_BarrelEnd_Distance = ( BarrelEndLocation2D - AimJointLocation2D ).Size();
+
+		const FVector2 AimJoint_To_Target = ( TargetLocation2D - AimJointLocation2D );
+		const float AimJoint_To_Target_Distance = AimJoint_To_Target.Size();
+
+		float MinimumDistance = std::min( AimJoint_To_BarrelStart_Distance, AimJoint_To_BarrelEnd_Distance );
+
+		const float MinimumDistance_Tolerance = std::min( 3.0f, 0.01f * MinimumDistance );
+		MinimumDistance += MinimumDistance_Tolerance;
+
+		if ( AimJoint_To_Target_Distance < MinimumDistance )
+		{
+			return AimJoint_To_Target.GetSafeNormal() * MinimumDistance;
+		}
+
+		return TargetLocation2D;
+	}
+
+	inline void CalculateQuadraticCoefficients( const FVector2& J, const FVector2& S, const FVector2& E, const FVector2& T, float& Out_A, float& Out_B, float& Out_C )
+	{
+		const FVector2 R = ( E - S ).GetSafeNormal();
+
+		const float A_Term1 = std::pow( R.X, 2.0f );
+		const float A_Term2 = std::pow( R.Y, 2.0f );
+
+		const float B_Term1 = ( 2 * S.X * R.X ) - ( 2 * J.X * R.X );
+		const float B_Term2 = ( 2 * S.Y * R.Y ) - ( 2 * J.Y * R.Y );
+
+		const float C_Term1 = std::pow( J.X - S.X, 2.0f );
+		const float C_Term2 = std::pow( J.Y - S.Y, 2.0f );
+		const float C_Term3 = -std::pow( T.X - J.X, 2.0f );
+		const float C_Term4 = -std::pow( T.Y - J.Y, 2.0f );
+
+		Out_A = A_Term1 + A_Term2;
+		Out_B = B_Term1 + B_Term2;
+		Out_C = C_Term1 + C_Term2 + C_Term3 + C_Term4;
+	}
+
+	inline bool CalculateQuadraticRoots( float A, float B, float C, float& Out_X1, float& Out_X2 )
+	{
+		const float Denominator = 2 * A;
+		if ( std::fabs( Denominator ) <= 1.e-8f )
+		{
+			return false;
+		}
+
+		const float RadicalInput = std::pow( B, 2.0f ) - ( 4 * A * C );
+		if ( RadicalInput < 0 )
+		{
+			return false;
+		}
+
+		const float Radical = std::sqrt( RadicalInput );
+
+		Out_X1 = ( ( -B ) - ( Radical ) ) / Denominator;
+		Out_X2 = ( ( -B ) + ( Radical ) ) / Denominator;
+		return true;
+	}
+
+	inline float SelectBestRayDistance( float FirstDistance, float SecondDistance )
+	{
+		if ( FirstDistance < 0 && SecondDistance < 0 )
+		{
+			return std::min( FirstDistance, SecondDistance );
+		}
+
+		return std::max( FirstDistance, SecondDistance );
+	}
+
+	inline bool CalculateBarrelRayDistance( const FVector2& AimJointLocation2D, const FVector2& BarrelStartLocation2D, const FVector2& BarrelEndLocation2D, const FVector2& TargetLocation2D, float& Out_BarrelRayDistance )
+	{
+		float a = 0.0f;
+		float b = 0.0f;
+		float c = 0.0f;
+		CalculateQuadraticCoefficients( AimJointLocation2D, BarrelStartLocation2D, BarrelEndLocation2D, TargetLocation2D, /*out*/ a, /*out*/ b, /*out*/ c );
+
+		float d1 = 0.0f;
+		float d2 = 0.0f;
+		if ( !CalculateQuadraticRoots( a, b, c, /*out*/ d1, /*out*/ d2 ) )
+		{
+			return false;
+		}
+
+		Out_BarrelRayDistance = SelectBestRayDistance( d1, d2 );
+		return true;
+	}
+
+	inline float CalculateAngleBetweenNormalizedVectors( const FVector2& FirstVector_Normalized, const FVector2& SecondVector_Normalized )
+	{
+		// Same as FMath::Acos, which clamps its input.
+		const float DotProduct = FirstVector_Normalized | SecondVector_Normalized;
+		return std::acos( std::min( std::max( DotProduct, -1.0f ), 1.0f ) );
+	}
+
+	inline bool ShouldTurnCounterClockwiseToMeet( const FVector2& FirstVector, const FVector2& SecondVector )
+	{
+		const FVector2 FirstVector_Perp = FirstVector.GetRotated( 90 );
+		return ( FirstVector_Perp | SecondVector ) >= 0;
+	}
+
+	inline float CalculateAngleToRotateFromFirstVectorToSecondVector( const FVector2& FirstVector, const FVector2& SecondVector )
+	{
+		const FVector2 FirstVector_Normalized = FirstVector.GetSafeNormal();
+		const FVector2 SecondVector_Normalized = SecondVector.GetSafeNormal();
+
+		const float AngleBetweenAimJointVectors_Degrees = RadiansToDegrees( CalculateAngleBetweenNormalizedVectors( FirstVector_Normalized, SecondVector_Normalized ) );
+		const float RotationSign = ShouldTurnCounterClockwiseToMeet( FirstVector_Normalized, SecondVector_Normalized ) ? 1.0f : -1.0f;
+
+		return RotationSign * AngleBetweenAimJointVectors_Degrees;
+	}
+
+	/** The original CalculateTurretPitch, with every location already on the "X-Z" plane (X, Z). */
+	inline float CalculateTurretPitch( const FVector2& AimJointLocation2D, const FVector2& BarrelStartLocation2D, const FVector2& BarrelEndLocation2D, const FVector2& InTargetLocation2D )
+	{
+		const FVector2 TargetLocation2D = CalculateNearestValidTargetLocation2D( AimJointLocation2D, BarrelStartLocation2D, BarrelEndLocation2D, InTargetLocation2D );
+
+		float BarrelRayDistance = 0.0f;
+		if ( !CalculateBarrelRayDistance( AimJointLocation2D, BarrelStartLocation2D, BarrelEndLocation2D, TargetLocation2D, /*out*/ BarrelRayDistance ) )
+		{
+			return 0.0f;
+		}
+
+		const FVector2 BarrelRay = ( BarrelEndLocation2D - BarrelStartLocation2D ).GetSafeNormal();
+		const FVector2 ScaledBarrelEndLocation2D = BarrelStartLocation2D + ( BarrelRay * BarrelRayDistance );
+
+		const FVector2 AimJoint_To_ScaledBarrelEnd = ScaledBarrelEndLocation2D - AimJointLocation2D;
+		const FVector2 AimJoint_To_Target = TargetLocation2D - AimJointLocation2D;
+
+		return CalculateAngleToRotateFromFirstVectorToSecondVector( AimJoint_To_ScaledBarrelEnd, AimJoint_To_Target );
+	}
+
+	/**
+	 * The original CalculateTurretRotation_ForAimJoint, for a target that is already in AimJoint space.  The target is aligned with the
+	 * turret by rotating it back by the yaw, the same way FRotator::GetInverse().RotateVector does it.
+	 *
+	 * @param BarrelStart	BarrelStart in AimJoint space (only X/Z matter).
+	 * @param BarrelEnd		BarrelEnd in AimJoint space (only X/Z matter).
+	 * @param TargetX		Target in AimJoint space (X).
+	 * @param TargetY		Target in AimJoint space (Y).
+	 * @param TargetZ		Target in AimJoint space (Z).
+	 * @param Out_Yaw		OUT - Yaw, in degrees.
+	 * @param Out_Pitch		OUT - Pitch, in degrees.
+	 */
+	inline void CalculateTurretRotation_InAimJointSpace( const FVector2& BarrelStart, const FVector2& BarrelEnd, float TargetX, float TargetY, float TargetZ, float& Out_Yaw, float& Out_Pitch )
+	{
+		Out_Yaw = CalculateTurretYaw( TargetX, TargetY );
+
+		const float Radians = -Out_Yaw * ( 3.1415926535897932f / 180.0f );
+		const float S = std::sin( Radians );
+		const float C = std::cos( Radians );
+		const float AlignedX = ( TargetX * C ) - ( TargetY * S );
+
+		Out_Pitch = CalculateTurretPitch( FVector2( 0.0f, 0.0f ), BarrelStart, BarrelEnd, FVector2( AlignedX, TargetZ ) );
+	}
+}
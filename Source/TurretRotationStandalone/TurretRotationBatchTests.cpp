@@ -0,0 +1,212 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationBatchKernel.h"
+
+
+/**
+ * Checks SolveAimBatch (TurretRotationBatchKernel.h) against TAimGeometry::Solve, with the portable lanes type.
+ */
+namespace TurretRotationBatchTests
+{
+	typedef TurretRotationCore::TVector3<float> FVector3;
+
+	struct FBatchTestCase
+	{
+		TurretRotationCore::TAimGeometry<float> Geometry;
+		FVector3 Target;
+	};
+
+	/** The batch's structure of arrays, padded up to a multiple of AIM_BATCH_WIDTH. */
+	struct FBatchArrays
+	{
+		std::vector<float> TargetX, TargetY, TargetZ;
+		std::vector<float> BarrelStartX, BarrelStartZ, BarrelEndX, BarrelEndZ;
+		std::vector<float> Yaw, Pitch;
+		TurretRotationCore::FAimBatch Batch;
+	};
+
+	/**
+	 * Turrets sized like the demo turrets, with any barrel direction and vertical offset, and uniform or non-uniform scales.  Every 8th
+	 * turret is an edge case (a target right on the AimJoint, straight above/below it, or just in front of the BarrelStart, or a zero
+	 * length barrel).
+	 */
+	static std::vector<FBatchTestCase> MakeBatchCases( int NumCases, TurretRotationTests::FTestRandom& Random )
+	{
+		std::vector<FBatchTestCase> Cases;
+		for ( int Index = 0; Index < NumCases; ++Index )
+		{
+			const bool bEdgeCase = ( Index % 8 ) == 0;
+			const bool bZeroLengthBarrel = bEdgeCase && ( ( Index / 8 ) % 4 ) == 3;
+			const FVector3 AimJoint_To_BarrelStart( Random.FRandRange( 0.0f, 50.0f ), 0, Random.FRandRange( -50.0f, 50.0f ) );
+			const FVector3 BarrelStart_To_BarrelEnd = bZeroLengthBarrel ? FVector3( 0, 0, 0 ) : FVector3( Random.FRandRange( 50.0f, 300.0f ), 0, Random.FRandRange( -20.0f, 20.0f ) );
+			const FVector3 ActorScale = ( Index % 2 ) == 0
+				? FVector3( 1, 1, 1 )
+				: FVector3( Random.FRandRange( 0.5f, 2.0f ), Random.FRandRange( 0.5f, 2.0f ), Random.FRandRange( 0.5f, 2.0f ) );
+
+			FBatchTestCase Case;
+			Case.Geometry = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale );
+
+			if ( bEdgeCase )
+			{
+				const TurretRotationCore::TVector2<float>& BarrelStart = Case.Geometry.GetBarrelStartLocation2D();
+				switch ( ( Index / 8 ) % 4 )
+				{
+				case 0:		Case.Target = FVector3( 0, 0, 0 ); break;
+				case 1:		Case.Target = FVector3( 0, 0, Random.FRandRange( -1000.0f, 1000.0f ) ); break;
+				case 2:		Case.Target = FVector3( BarrelStart.X + 1.0f, 0, BarrelStart.Y ); break;
+				default:	Case.Target = FVector3( Random.FRandRange( -500.0f, 500.0f ), Random.FRandRange( -500.0f, 500.0f ), Random.FRandRange( -500.0f, 500.0f ) ); break;
+				}
+			}
+			else
+			{
+				const TurretRotationCore::TVector3<double> Direction = Random.VRand();
+				const float Distance = std::pow( 10.0f, Random.FRandRange( 1.0f, 5.0f ) );
+				Case.Target = FVector3( float( Direction.X * Distance ), float( Direction.Y * Distance ), float( Direction.Z * Distance ) );
+			}
+			Cases.push_back( Case );
+		}
+		return Cases;
+	}
+
+	/**
+	 * Fills the batch with the cases.  The padding lanes repeat the first case, so any padding lane that was counted would show up in
+	 * the events.
+	 */
+	static void MakeBatch( const std::vector<FBatchTestCase>& Cases, FBatchArrays& Out_Arrays )
+	{
+		const int NumTurrets = int( Cases.size() );
+		const int NumPadded = ( ( NumTurrets + AIM_BATCH_WIDTH - 1 ) / AIM_BATCH_WIDTH ) * AIM_BATCH_WIDTH;
+		std::vector<float>* AllArrays[] = { &Out_Arrays.TargetX, &Out_Arrays.TargetY, &Out_Arrays.TargetZ, &Out_Arrays.BarrelStartX, &Out_Arrays.BarrelStartZ,
+			&Out_Arrays.BarrelEndX, &Out_Arrays.BarrelEndZ, &Out_Arrays.Yaw, &Out_Arrays.Pitch };
+		for ( std::vector<float>* Array : AllArrays )
+		{
+			Array->assign( NumPadded, 0.0f );
+		}
+
+		for ( int Index = 0; Index < NumPadded; ++Index )
+		{
+			const FBatchTestCase& Case = Cases[Index < NumTurrets ? Index : 0];
+			Out_Arrays.TargetX[Index] = Case.Target.X;
+			Out_Arrays.TargetY[Index] = Case.Target.Y;
+			Out_Arrays.TargetZ[Index] = Case.Target.Z;
+			Out_Arrays.BarrelStartX[Index] = Case.Geometry.GetBarrelStartLocation2D().X;
+			Out_Arrays.BarrelStartZ[Index] = Case.Geometry.GetBarrelStartLocation2D().Y;
+			Out_Arrays.BarrelEndX[Index] = Case.Geometry.GetBarrelEndLocation2D().X;
+			Out_Arrays.BarrelEndZ[Index] = Case.Geometry.GetBarrelEndLocation2D().Y;
+		}
+
+		TurretRotationCore::FAimBatch& Batch = Out_Arrays.Batch;
+		Batch.TargetX = Out_Arrays.TargetX.data();
+		Batch.TargetY = Out_Arrays.TargetY.data();
+		Batch.TargetZ = Out_Arrays.TargetZ.data();
+		Batch.BarrelStartX = Out_Arrays.BarrelStartX.data();
+		Batch.BarrelStartZ = Out_Arrays.BarrelStartZ.data();
+		Batch.BarrelEndX = Out_Arrays.BarrelEndX.data();
+		Batch.BarrelEndZ = Out_Arrays.BarrelEndZ.data();
+		Batch.Yaw = Out_Arrays.Yaw.data();
+		Batch.Pitch = Out_Arrays.Pitch.data();
+		Batch.NumTurrets = NumTurrets;
+		Batch.NumPadded = NumPadded;
+	}
+
+	/**
+	 * Solves every case with SolveAimBatch and with TAimGeometry::Solve, at the given accuracy.
+	 *
+	 * @param Out_NumEventMismatches	OUT - Number of event counts (clamps, failed roots, both distances negative) that didn't match.
+	 * @return Returns the largest yaw/pitch difference (in degrees).
+	 */
+	static double CalculateWorstBatchDifference( const std::vector<FBatchTestCase>& Cases, TurretRotationCore::EAimAccuracy Accuracy, int& Out_NumEventMismatches )
+	{
+		FBatchArrays Arrays;
+		MakeBatch( Cases, Arrays );
+
+		TurretRotationCore::FAimBatchEvents Events;
+		TurretRotationCore::SolveAimBatch<TurretRotationCore::FPortableAimLanes>( Arrays.Batch, Accuracy, &Events );
+
+		double WorstDifference = 0.0;
+		TurretRotationCore::FAimBatchEvents ReferenceEvents;
+		for ( int Index = 0; Index < int( Cases.size() ); ++Index )
+		{
+			unsigned int SolveEvents = 0;
+			const TurretRotationCore::TAimAngles<float> Reference = Cases[Index].Geometry.Solve( Cases[Index].Target, Accuracy, &SolveEvents );
+			WorstDifference = std::max( WorstDifference, TurretRotationTests::GetAngleDifferenceDegrees( Reference.Yaw, Arrays.Yaw[Index] ) );
+			WorstDifference = std::max( WorstDifference, TurretRotationTests::GetAngleDifferenceDegrees( Reference.Pitch, Arrays.Pitch[Index] ) );
+
+			ReferenceEvents.NumTargetClamps += ( SolveEvents & TurretRotationCore::EAimSolveEvent::TargetClamped ) ? 1 : 0;
+			ReferenceEvents.NumFailedRoots += ( SolveEvents & TurretRotationCore::EAimSolveEvent::NoRoots ) ? 1 : 0;
+			ReferenceEvents.NumBothDistancesNegative += ( SolveEvents & TurretRotationCore::EAimSolveEvent::BothDistancesNegative ) ? 1 : 0;
+		}
+
+		Out_NumEventMismatches = ( Events.NumTargetClamps != ReferenceEvents.NumTargetClamps ? 1 : 0 )
+			+ ( Events.NumFailedRoots != ReferenceEvents.NumFailedRoots ? 1 : 0 )
+			+ ( Events.NumBothDistancesNegative != ReferenceEvents.NumBothDistancesNegative ? 1 : 0 );
+		return WorstDifference;
+	}
+
+	static void CheckAccuracy( TurretRotationCore::EAimAccuracy Accuracy )
+	{
+		TurretRotationTests::FTestRandom Random( 9753 );
+
+		// Not a multiple of AIM_BATCH_WIDTH, so the last pass has padding lanes.
+		const std::vector<FBatchTestCase> Cases = MakeBatchCases( 100001, Random );
+
+		int NumEventMismatches = 0;
+		TURRET_CHECK_LE( CalculateWorstBatchDifference( Cases, Accuracy, NumEventMismatches ), AIM_BATCH_TOLERANCE_DEGREES );
+		TURRET_CHECK_EQ( NumEventMismatches, 0 );
+	}
+}
+
+using namespace TurretRotationBatchTests;
+
+TURRET_TEST( Batch, Exact )
+{
+	CheckAccuracy( TurretRotationCore::EAimAccuracy::Exact );
+}
+
+TURRET_TEST( Batch, Fast )
+{
+	CheckAccuracy( TurretRotationCore::EAimAccuracy::Fast );
+}
+
+TURRET_TEST( Batch, Approximate )
+{
+	CheckAccuracy( TurretRotationCore::EAimAccuracy::Approximate );
+}
+
+TURRET_TEST( Batch, Atan2MatchesScalar )
+{
+	// The lane-wide Atan2 has to round the same way as the scalar polynomial, including at 0, on the axes, and on the diagonals.
+	TurretRotationTests::FTestRandom Random( 8642 );
+	std::vector<float> Ys;
+	std::vector<float> Xs;
+	const float SpecialValues[] = { 0.0f, 1.0f, -1.0f, 1000.0f, -1000.0f };
+	for ( const float Y : SpecialValues )
+	{
+		for ( const float X : SpecialValues )
+		{
+			Ys.push_back( Y );
+			Xs.push_back( X );
+		}
+	}
+	while ( Ys.size() < 100000 )
+	{
+		Ys.push_back( Random.FRandRange( -1000.0f, 1000.0f ) );
+		Xs.push_back( Random.FRandRange( -1000.0f, 1000.0f ) );
+	}
+
+	typedef TurretRotationCore::FPortableAimLanes FLanes;
+	double WorstDifference = 0.0;
+	for ( const TurretRotationCore::EAimAccuracy Accuracy : { TurretRotationCore::EAimAccuracy::Fast, TurretRotationCore::EAimAccuracy::Approximate } )
+	{
+		for ( size_t Index = 0; Index < Ys.size(); Index += AIM_BATCH_WIDTH )
+		{
+			float Angles[AIM_BATCH_WIDTH];
+			FLanes::Store( TurretRotationCore::LanesAtan2Degrees<FLanes>( FLanes::Load( &Ys[Index] ), FLanes::Load( &Xs[Index] ), Accuracy ), Angles );
+			for ( int Lane = 0; Lane < AIM_BATCH_WIDTH; ++Lane )
+			{
+				const float Reference = TurretRotationCore::Atan2( Ys[Index + Lane], Xs[Index + Lane], Accuracy ) * TurretRotationCore::TConstants<float>::RadiansToDegrees();
+				WorstDifference = std::max( WorstDifference, TurretRotationTests::GetAngleDifferenceDegrees( Reference, Angles[Lane] ) );
+			}
+		}
+	}
+	TURRET_CHECK_LE( WorstDifference, 1.e-4 );
+}
@@ -0,0 +1,304 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationChain.h"
+
+
+/**
+ * Checks the closed form yaw ring/pitch/sub-barrel solve (TurretRotationChain.h) against TAimGeometry::Solve, forward kinematics, and
+ * iterative CCD IK.
+ */
+namespace TurretRotationChainTests
+{
+	typedef TurretRotationCore::TVector3<double> FChainVector;
+
+	/** One yaw ring/pitch/sub-barrel turret, and its target (in YawJoint space). */
+	struct FChainTestTurret
+	{
+		FChainVector YawJoint_To_PitchJoint;
+		FChainVector PitchJoint_To_BarrelStart;
+		FChainVector BarrelStart_To_BarrelEnd;
+		FChainVector PitchJoint_To_SubPitchJoint;
+		FChainVector SubPitchJoint_To_SubBarrelStart;
+		FChainVector SubBarrelStart_To_SubBarrelEnd;
+		FChainVector Target_InYawJointSpace;
+	};
+
+	static FChainVector AddChainVectors( const FChainVector& A, const FChainVector& B ) { return FChainVector( A.X + B.X, A.Y + B.Y, A.Z + B.Z ); }
+	static FChainVector SubtractChainVectors( const FChainVector& A, const FChainVector& B ) { return FChainVector( A.X - B.X, A.Y - B.Y, A.Z - B.Z ); }
+	static FChainVector ScaleChainVector( const FChainVector& A, double Scale ) { return FChainVector( A.X * Scale, A.Y * Scale, A.Z * Scale ); }
+	static double DotChainVectors( const FChainVector& A, const FChainVector& B ) { return ( A.X * B.X ) + ( A.Y * B.Y ) + ( A.Z * B.Z ); }
+	static FChainVector CrossChainVectors( const FChainVector& A, const FChainVector& B )
+	{
+		return FChainVector( ( A.Y * B.Z ) - ( A.Z * B.Y ), ( A.Z * B.X ) - ( A.X * B.Z ), ( A.X * B.Y ) - ( A.Y * B.X ) );
+	}
+
+	static double DegreesToRadians( double Degrees ) { return Degrees * TurretRotationCore::TConstants<double>::Pi() / 180.0; }
+	static double RadiansToDegrees( double Radians ) { return Radians * TurretRotationCore::TConstants<double>::RadiansToDegrees(); }
+
+	/** Yaws a vector (turning "X" towards "Y"), like FRotator does. */
+	static FChainVector YawChainVector( const FChainVector& A, double YawDegrees )
+	{
+		const double Cos = std::cos( DegreesToRadians( YawDegrees ) );
+		const double Sin = std::sin( DegreesToRadians( YawDegrees ) );
+		return FChainVector( ( A.X * Cos ) - ( A.Y * Sin ), ( A.X * Sin ) + ( A.Y * Cos ), A.Z );
+	}
+
+	/** Pitches a vector (turning "X" towards "Z"), like FRotator does. */
+	static FChainVector PitchChainVector( const FChainVector& A, double PitchDegrees )
+	{
+		const double Cos = std::cos( DegreesToRadians( PitchDegrees ) );
+		const double Sin = std::sin( DegreesToRadians( PitchDegrees ) );
+		return FChainVector( ( A.X * Cos ) - ( A.Z * Sin ), A.Y, ( A.X * Sin ) + ( A.Z * Cos ) );
+	}
+
+	/** @return Returns a point given in (pitched) PitchJoint space in YawJoint space. */
+	static FChainVector PitchJointToYawJointSpace( const FChainTestTurret& Turret, const TurretRotationCore::TChainAngles<double>& Angles, const FChainVector& Point )
+	{
+		return YawChainVector( AddChainVectors( Turret.YawJoint_To_PitchJoint, PitchChainVector( Point, Angles.Pitch ) ), Angles.Yaw );
+	}
+
+	/** @return Returns a point given in (pitched) SubPitchJoint space in YawJoint space. */
+	static FChainVector SubPitchJointToYawJointSpace( const FChainTestTurret& Turret, const TurretRotationCore::TChainAngles<double>& Angles, const FChainVector& Point )
+	{
+		return PitchJointToYawJointSpace( Turret, Angles, AddChainVectors( Turret.PitchJoint_To_SubPitchJoint, PitchChainVector( Point, Angles.SubPitch ) ) );
+	}
+
+	/** @return Returns the point on the barrel's ray (from the BarrelStart, through the BarrelEnd, and on) closest to the target. */
+	static FChainVector CalculateClosestPointOnBarrel( const FChainVector& BarrelStart, const FChainVector& BarrelEnd, const FChainVector& Target )
+	{
+		const FChainVector BarrelRay = SubtractChainVectors( BarrelEnd, BarrelStart );
+		const double BarrelLengthSquared = std::max( DotChainVectors( BarrelRay, BarrelRay ), 1.e-12 );
+		const double RayDistance = std::max( DotChainVectors( SubtractChainVectors( Target, BarrelStart ), BarrelRay ) / BarrelLengthSquared, 0.0 );
+		return AddChainVectors( BarrelStart, ScaleChainVector( BarrelRay, RayDistance ) );
+	}
+
+	/** @return Returns how far the target is from the barrel's ray (0 means the barrel points straight at it). */
+	static double CalculateMissDistance( const FChainVector& BarrelStart, const FChainVector& BarrelEnd, const FChainVector& Target )
+	{
+		const FChainVector Miss = SubtractChainVectors( Target, CalculateClosestPointOnBarrel( BarrelStart, BarrelEnd, Target ) );
+		return std::sqrt( DotChainVectors( Miss, Miss ) );
+	}
+
+	/** @return Returns how far the target is from the barrel's ray, and from the sub-barrel's (if bSubBarrel), after posing the chain. */
+	static double CalculateChainMissDistance( const FChainTestTurret& Turret, const TurretRotationCore::TChainAngles<double>& Angles, bool bSubBarrel )
+	{
+		const FChainVector& Target = Turret.Target_InYawJointSpace;
+		double MissDistance = CalculateMissDistance(
+			PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_BarrelStart ),
+			PitchJointToYawJointSpace( Turret, Angles, AddChainVectors( Turret.PitchJoint_To_BarrelStart, Turret.BarrelStart_To_BarrelEnd ) ),
+			Target );
+
+		if ( bSubBarrel )
+		{
+			MissDistance = std::max( MissDistance, CalculateMissDistance(
+				SubPitchJointToYawJointSpace( Turret, Angles, Turret.SubPitchJoint_To_SubBarrelStart ),
+				SubPitchJointToYawJointSpace( Turret, Angles, AddChainVectors( Turret.SubPitchJoint_To_SubBarrelStart, Turret.SubBarrelStart_To_SubBarrelEnd ) ),
+				Target ) );
+		}
+
+		return MissDistance;
+	}
+
+	/** @return Returns the angle (in degrees) that turns a joint around its axis so the effector lines up with the target. */
+	static double CalculateCCDStepDegrees( const FChainVector& JointLocation, const FChainVector& Axis, const FChainVector& Effector, const FChainVector& Target )
+	{
+		const FChainVector Joint_To_Effector = SubtractChainVectors( Effector, JointLocation );
+		const FChainVector Joint_To_Target = SubtractChainVectors( Target, JointLocation );
+		const FChainVector Effector_OnPlane = SubtractChainVectors( Joint_To_Effector, ScaleChainVector( Axis, DotChainVectors( Joint_To_Effector, Axis ) ) );
+		const FChainVector Target_OnPlane = SubtractChainVectors( Joint_To_Target, ScaleChainVector( Axis, DotChainVectors( Joint_To_Target, Axis ) ) );
+		return RadiansToDegrees( std::atan2( DotChainVectors( Axis, CrossChainVectors( Effector_OnPlane, Target_OnPlane ) ), DotChainVectors( Effector_OnPlane, Target_OnPlane ) ) );
+	}
+
+	/**
+	 * Reference solver: cyclic coordinate descent, the same as TurretRotation.Bench.Chain times TAimChain against.  Every pass turns the
+	 * joints from the end of the chain back to the YawJoint, with the pitches limited to +/- 90 degrees.
+	 *
+	 * @param Out_Iterations	OUT - The number of passes it took (MaxIterations if it didn't converge).
+	 */
+	static TurretRotationCore::TChainAngles<double> SolveChainCCD( const FChainTestTurret& Turret, bool bSubBarrel, double Tolerance, int MaxIterations, int& Out_Iterations )
+	{
+		const FChainVector& Target = Turret.Target_InYawJointSpace;
+		const FChainVector BarrelEnd_InPitchJointSpace = AddChainVectors( Turret.PitchJoint_To_BarrelStart, Turret.BarrelStart_To_BarrelEnd );
+		const FChainVector SubBarrelEnd_InSubPitchJointSpace = AddChainVectors( Turret.SubPitchJoint_To_SubBarrelStart, Turret.SubBarrelStart_To_SubBarrelEnd );
+
+		TurretRotationCore::TChainAngles<double> Angles;
+		Angles.Yaw = RadiansToDegrees( std::atan2( Target.Y, Target.X ) );
+		Angles.Pitch = 0.0;
+		Angles.SubPitch = 0.0;
+
+		for ( Out_Iterations = 0; Out_Iterations < MaxIterations; ++Out_Iterations )
+		{
+			if ( CalculateChainMissDistance( Turret, Angles, bSubBarrel ) < Tolerance )
+			{
+				break;
+			}
+
+			const FChainVector PitchAxis = YawChainVector( FChainVector( 0.0, -1.0, 0.0 ), Angles.Yaw );
+
+			if ( bSubBarrel )
+			{
+				const FChainVector SubEffector = CalculateClosestPointOnBarrel(
+					SubPitchJointToYawJointSpace( Turret, Angles, Turret.SubPitchJoint_To_SubBarrelStart ),
+					SubPitchJointToYawJointSpace( Turret, Angles, SubBarrelEnd_InSubPitchJointSpace ),
+					Target );
+				const double SubPitchStep = CalculateCCDStepDegrees( PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_SubPitchJoint ), PitchAxis, SubEffector, Target );
+				Angles.SubPitch = std::min( std::max( Angles.SubPitch + SubPitchStep, -90.0 ), 90.0 );
+			}
+
+			const FChainVector PitchEffector = CalculateClosestPointOnBarrel(
+				PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_BarrelStart ),
+				PitchJointToYawJointSpace( Turret, Angles, BarrelEnd_InPitchJointSpace ),
+				Target );
+			const double PitchStep = CalculateCCDStepDegrees( YawChainVector( Turret.YawJoint_To_PitchJoint, Angles.Yaw ), PitchAxis, PitchEffector, Target );
+			Angles.Pitch = std::min( std::max( Angles.Pitch + PitchStep, -90.0 ), 90.0 );
+
+			const FChainVector YawEffector = CalculateClosestPointOnBarrel(
+				PitchJointToYawJointSpace( Turret, Angles, Turret.PitchJoint_To_BarrelStart ),
+				PitchJointToYawJointSpace( Turret, Angles, BarrelEnd_InPitchJointSpace ),
+				Target );
+			Angles.Yaw += CalculateCCDStepDegrees( FChainVector( 0.0, 0.0, 0.0 ), FChainVector( 0.0, 0.0, 1.0 ), YawEffector, Target );
+		}
+
+		return Angles;
+	}
+
+	/** Vehicle-like turrets, the same as TurretRotation.Bench.Chain uses.  Targets are 10 to 300 meters away. */
+	static std::vector<FChainTestTurret> MakeChainTurrets( int NumTurrets, TurretRotationTests::FTestRandom& Random )
+	{
+		std::vector<FChainTestTurret> Turrets;
+		for ( int Index = 0; Index < NumTurrets; ++Index )
+		{
+			FChainTestTurret Turret;
+			Turret.YawJoint_To_PitchJoint = FChainVector( Random.FRandRange( -50.0f, 50.0f ), Random.FRandRange( -40.0f, 40.0f ), Random.FRandRange( 20.0f, 60.0f ) );
+			Turret.PitchJoint_To_BarrelStart = FChainVector( Random.FRandRange( 10.0f, 60.0f ), Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ) );
+			Turret.BarrelStart_To_BarrelEnd = FChainVector( Random.FRandRange( 100.0f, 400.0f ), 0.0, Random.FRandRange( -10.0f, 10.0f ) );
+			Turret.PitchJoint_To_SubPitchJoint = FChainVector( Random.FRandRange( -20.0f, 20.0f ), Turret.PitchJoint_To_BarrelStart.Y, Random.FRandRange( -30.0f, 30.0f ) );
+			Turret.SubPitchJoint_To_SubBarrelStart = FChainVector( Random.FRandRange( 0.0f, 30.0f ), 0.0, Random.FRandRange( -10.0f, 10.0f ) );
+			Turret.SubBarrelStart_To_SubBarrelEnd = FChainVector( Random.FRandRange( 30.0f, 100.0f ), 0.0, Random.FRandRange( -5.0f, 5.0f ) );
+
+			const FChainVector Direction = Random.VRand();
+			const double Distance = Random.DRandRange( 1000.0, 30000.0 );
+			Turret.Target_InYawJointSpace = FChainVector( Direction.X * Distance, Direction.Y * Distance, std::abs( Direction.Z ) * Distance * 0.5 );
+
+			Turrets.push_back( Turret );
+		}
+		return Turrets;
+	}
+
+	/** @return Returns the turret's chain, with or without its sub-barrel. */
+	static TurretRotationCore::TAimChain<double> MakeTestChain( const FChainTestTurret& Turret, bool bSubBarrel )
+	{
+		const FChainVector ActorScale( 1.0, 1.0, 1.0 );
+		TurretRotationCore::TAimChain<double> Chain = TurretRotationCore::TAimChain<double>::MakeFromActorVectors(
+			Turret.YawJoint_To_PitchJoint,
+			Turret.PitchJoint_To_BarrelStart,
+			Turret.BarrelStart_To_BarrelEnd,
+			ActorScale );
+
+		if ( bSubBarrel )
+		{
+			Chain.SetSubBarrel( Turret.PitchJoint_To_SubPitchJoint, Turret.SubPitchJoint_To_SubBarrelStart, Turret.SubBarrelStart_To_SubBarrelEnd, ActorScale );
+		}
+
+		return Chain;
+	}
+
+	/**
+	 * Checks that posing each chain with its solved angles puts the target on the barrel's ray (and the sub-barrel's).  Targets closer to
+	 * the YawJoint's axis than the barrel's lateral offset can't be reached at all, which the solve reports as an edge case.
+	 */
+	static void CheckTargetIsOnTheBarrels( bool bSubBarrel )
+	{
+		TurretRotationTests::FTestRandom Random( 2468 );
+		int NumEdgeCases = 0;
+		double MaxMissDistance = 0.0;
+		for ( const FChainTestTurret& Turret : MakeChainTurrets( 20000, Random ) )
+		{
+			unsigned int Events = 0;
+			const TurretRotationCore::TChainAngles<double> Angles = MakeTestChain( Turret, bSubBarrel ).Solve( Turret.Target_InYawJointSpace, TurretRotationCore::EAimAccuracy::Exact, &Events );
+			if ( Events != 0 )
+			{
+				++NumEdgeCases;
+				continue;
+			}
+			MaxMissDistance = std::max( MaxMissDistance, CalculateChainMissDistance( Turret, Angles, bSubBarrel ) );
+		}
+		TURRET_CHECK_LE( NumEdgeCases, 20 );
+		TURRET_CHECK_LE( MaxMissDistance, 1.e-3 );
+	}
+
+	/** Checks that the closed form agrees with SolveChainCCD wherever the CCD converges. */
+	static void CheckMatchesCCD( bool bSubBarrel )
+	{
+		const double Tolerance = 0.01;
+		const int MaxIterations = 100;
+
+		TurretRotationTests::FTestRandom Random( 1357 );
+		const std::vector<FChainTestTurret> Turrets = MakeChainTurrets( 5000, Random );
+
+		int NumConverged = 0;
+		double MaxDifference = 0.0;
+		for ( const FChainTestTurret& Turret : Turrets )
+		{
+			int Iterations = 0;
+			const TurretRotationCore::TChainAngles<double> Actual = SolveChainCCD( Turret, bSubBarrel, Tolerance, MaxIterations, Iterations );
+			if ( Iterations >= MaxIterations )
+			{
+				continue;
+			}
+
+			++NumConverged;
+			const TurretRotationCore::TChainAngles<double> Expected = MakeTestChain( Turret, bSubBarrel ).Solve( Turret.Target_InYawJointSpace );
+			MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Actual.Yaw, Expected.Yaw ) );
+			MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Actual.Pitch, Expected.Pitch ) );
+			if ( bSubBarrel )
+			{
+				MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Actual.SubPitch, Expected.SubPitch ) );
+			}
+		}
+
+		// Missing by the CCD's tolerance at 10 meters is well under a thousandth of a degree.
+		TURRET_CHECK( NumConverged > int( Turrets.size() * 9 ) / 10 );
+		TURRET_CHECK_LE( MaxDifference, 0.01 );
+	}
+}
+
+using namespace TurretRotationChainTests;
+
+TURRET_TEST( Chain, MatchesSolveWithoutOffsets )
+{
+	// With the YawJoint and PitchJoint at the same location (and nothing to the side), the chain is a single AimJoint.
+	TurretRotationTests::FTestRandom Random( 9753 );
+	double MaxDifference = 0.0;
+	for ( const FChainTestTurret& Turret : MakeChainTurrets( 20000, Random ) )
+	{
+		const FChainVector ActorScale( 1.0, 1.0, 1.0 );
+		const FChainVector AimJoint_To_BarrelStart( Turret.PitchJoint_To_BarrelStart.X, 0.0, Turret.PitchJoint_To_BarrelStart.Z );
+		const TurretRotationCore::TAimChain<double> Chain = TurretRotationCore::TAimChain<double>::MakeFromActorVectors( FChainVector( 0.0, 0.0, 0.0 ), AimJoint_To_BarrelStart, Turret.BarrelStart_To_BarrelEnd, ActorScale );
+		const TurretRotationCore::TAimGeometry<double> Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors( AimJoint_To_BarrelStart, Turret.BarrelStart_To_BarrelEnd, ActorScale );
+
+		const TurretRotationCore::TChainAngles<double> ChainAngles = Chain.Solve( Turret.Target_InYawJointSpace );
+		const TurretRotationCore::TAimAngles<double> GeometryAngles = Geometry.Solve( Turret.Target_InYawJointSpace );
+		MaxDifference = std::max( MaxDifference, std::max( std::abs( ChainAngles.Yaw - GeometryAngles.Yaw ), std::abs( ChainAngles.Pitch - GeometryAngles.Pitch ) ) );
+	}
+	TURRET_CHECK_LE( MaxDifference, 1.e-9 );
+}
+
+TURRET_TEST( Chain, TargetIsOnTheBarrel )
+{
+	CheckTargetIsOnTheBarrels( false );
+}
+
+TURRET_TEST( Chain, TargetIsOnTheSubBarrel )
+{
+	CheckTargetIsOnTheBarrels( true );
+}
+
+TURRET_TEST( Chain, MatchesCCD )
+{
+	CheckMatchesCCD( false );
+}
+
+TURRET_TEST( Chain, MatchesCCD_SubBarrel )
+{
+	CheckMatchesCCD( true );
+}
@@ -0,0 +1,197 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationBaseline.h"
+#include "TurretRotationCore.h"
+
+
+/**
+ * Checks TurretRotationCore against the frozen baseline math (TurretRotationBaseline.h), and against itself in double precision.
+ */
+namespace TurretRotationCoreTests
+{
+	typedef TurretRotationCore::TVector3<float> FVector3f;
+	typedef TurretRotationCore::TVector3<double> FVector3d;
+
+	/**
+	 * Largest difference (in degrees) allowed between the core and the baseline.  Both are float, and the baseline gets the angle from
+	 * an Acos of a normalized dot product, which only has about 0.02 degrees of precision for angles near 0 (and 180).
+	 */
+	const double BaselineToleranceDegrees = 0.05;
+
+	/** One turret and its target, in AimJoint space. */
+	struct FCoreTestCase
+	{
+		FVector3f AimJoint_To_BarrelStart;
+		FVector3f BarrelStart_To_BarrelEnd;
+		FVector3f Target;
+	};
+
+	/** Turrets sized like the demo turrets, aiming at targets from just outside the barrel to a kilometer away, in every direction. */
+	static std::vector<FCoreTestCase> MakeTypicalCases( int NumCases, TurretRotationTests::FTestRandom& Random )
+	{
+		std::vector<FCoreTestCase> Cases;
+		for ( int Index = 0; Index < NumCases; ++Index )
+		{
+			FCoreTestCase Case;
+			Case.AimJoint_To_BarrelStart = FVector3f( Random.FRandRange( 0.0f, 50.0f ), 0.0f, Random.FRandRange( -50.0f, 50.0f ) );
+			Case.BarrelStart_To_BarrelEnd = FVector3f( Random.FRandRange( 50.0f, 300.0f ), 0.0f, Random.FRandRange( -20.0f, 20.0f ) );
+
+			const FVector3d Direction = Random.VRand();
+			const float Distance = std::pow( 10.0f, Random.FRandRange( 2.7f, 5.0f ) );
+			Case.Target = FVector3f( float( Direction.X * Distance ), float( Direction.Y * Distance ), float( Direction.Z * Distance ) );
+			Cases.push_back( Case );
+		}
+		return Cases;
+	}
+
+	/** Targets inside the barrel (clamped), right on the AimJoint, straight above/below it, and zero-length barrels (no roots). */
+	static std::vector<FCoreTestCase> MakeDegenerateCases( int NumCases, TurretRotationTests::FTestRandom& Random )
+	{
+		std::vector<FCoreTestCase> Cases;
+		for ( int Index = 0; Index < NumCases; ++Index )
+		{
+			FCoreTestCase Case;
+			Case.AimJoint_To_BarrelStart = FVector3f( 40.0f, 0.0f, 30.0f );
+			Case.BarrelStart_To_BarrelEnd = ( Index % 4 ) == 0 ? FVector3f( 0.0f, 0.0f, 0.0f ) : FVector3f( 150.0f, 0.0f, 0.0f );
+
+			switch ( Index % 3 )
+			{
+			case 0:		Case.Target = FVector3f( 0.0f, 0.0f, 0.0f ); break;
+			case 1:		Case.Target = FVector3f( 0.0f, 0.0f, Random.FRandRange( -1000.0f, 1000.0f ) ); break;
+			default:	Case.Target = FVector3f( Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ), Random.FRandRange( -20.0f, 20.0f ) ); break;
+			}
+			Cases.push_back( Case );
+		}
+		return Cases;
+	}
+
+	static TurretRotationCore::TAimGeometry<float> MakeGeometry( const FCoreTestCase& Case )
+	{
+		return TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( Case.AimJoint_To_BarrelStart, Case.BarrelStart_To_BarrelEnd, FVector3f( 1.0f, 1.0f, 1.0f ) );
+	}
+
+	/** @return Returns the largest yaw/pitch difference (in degrees) between the core and the baseline over the cases. */
+	static double CalculateMaxBaselineDifference( const std::vector<FCoreTestCase>& Cases )
+	{
+		typedef TurretRotationBaseline::FVector2 FBaselineVector2;
+
+		double MaxDifference = 0.0;
+		for ( const FCoreTestCase& Case : Cases )
+		{
+			const FBaselineVector2 BarrelStart( Case.AimJoint_To_BarrelStart.X, Case.AimJoint_To_BarrelStart.Z );
+			const FBaselineVector2 BarrelEnd( BarrelStart.X + Case.BarrelStart_To_BarrelEnd.X, BarrelStart.Y + Case.BarrelStart_To_BarrelEnd.Z );
+
+			float BaselineYaw = 0.0f;
+			float BaselinePitch = 0.0f;
+			TurretRotationBaseline::CalculateTurretRotation_InAimJointSpace( BarrelStart, BarrelEnd, Case.Target.X, Case.Target.Y, Case.Target.Z, BaselineYaw, BaselinePitch );
+
+			const TurretRotationCore::TAimAngles<float> Angles = MakeGeometry( Case ).Solve( Case.Target );
+			MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Angles.Yaw, BaselineYaw ) );
+			MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Angles.Pitch, BaselinePitch ) );
+		}
+		return MaxDifference;
+	}
+}
+
+using namespace TurretRotationCoreTests;
+
+TURRET_TEST( Core, MatchesBaseline_Typical )
+{
+	TurretRotationTests::FTestRandom Random( 1234 );
+	TURRET_CHECK_LE( CalculateMaxBaselineDifference( MakeTypicalCases( 200000, Random ) ), BaselineToleranceDegrees );
+}
+
+TURRET_TEST( Core, MatchesBaseline_Degenerate )
+{
+	TurretRotationTests::FTestRandom Random( 5678 );
+	TURRET_CHECK_LE( CalculateMaxBaselineDifference( MakeDegenerateCases( 20000, Random ) ), BaselineToleranceDegrees );
+}
+
+TURRET_TEST( Core, CalculateTurretPitchMatchesBaseline )
+{
+	typedef TurretRotationBaseline::FVector2 FBaselineVector2;
+
+	// The free function takes every location on the "X-Z" plane, with the AimJoint anywhere.
+	TurretRotationTests::FTestRandom Random( 91011 );
+	double MaxDifference = 0.0;
+	for ( int Index = 0; Index < 100000; ++Index )
+	{
+		const FVector3f AimJoint( Random.FRandRange( -100.0f, 100.0f ), 0.0f, Random.FRandRange( -100.0f, 100.0f ) );
+		const FVector3f BarrelStart( AimJoint.X + Random.FRandRange( 0.0f, 50.0f ), 0.0f, AimJoint.Z + Random.FRandRange( -50.0f, 50.0f ) );
+		const FVector3f BarrelEnd( BarrelStart.X + Random.FRandRange( 50.0f, 300.0f ), 0.0f, BarrelStart.Z + Random.FRandRange( -20.0f, 20.0f ) );
+		const float Angle = Random.FRandRange( -3.14159f, 3.14159f );
+		const float Distance = std::pow( 10.0f, Random.FRandRange( 2.7f, 5.0f ) );
+		const FVector3f Target( AimJoint.X + ( std::cos( Angle ) * Distance ), 0.0f, AimJoint.Z + ( std::sin( Angle ) * Distance ) );
+
+		const float Pitch = TurretRotationCore::CalculateTurretPitch<float>( AimJoint, BarrelStart, BarrelEnd, Target );
+		const float BaselinePitch = TurretRotationBaseline::CalculateTurretPitch(
+			FBaselineVector2( AimJoint.X, AimJoint.Z ),
+			FBaselineVector2( BarrelStart.X, BarrelStart.Z ),
+			FBaselineVector2( BarrelEnd.X, BarrelEnd.Z ),
+			FBaselineVector2( Target.X, Target.Z ) );
+		MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Pitch, BaselinePitch ) );
+	}
+
+	TURRET_CHECK_LE( MaxDifference, BaselineToleranceDegrees );
+}
+
+TURRET_TEST( Core, FloatMatchesDouble )
+{
+	// Away from the Acos precision loss near 0 degrees, float and double should only differ by rounding.
+	TurretRotationTests::FTestRandom Random( 1213 );
+	double MaxDifference = 0.0;
+	for ( const FCoreTestCase& Case : MakeTypicalCases( 100000, Random ) )
+	{
+		const FVector3d AimJoint_To_BarrelStart( Case.AimJoint_To_BarrelStart.X, Case.AimJoint_To_BarrelStart.Y, Case.AimJoint_To_BarrelStart.Z );
+		const FVector3d BarrelStart_To_BarrelEnd( Case.BarrelStart_To_BarrelEnd.X, Case.BarrelStart_To_BarrelEnd.Y, Case.BarrelStart_To_BarrelEnd.Z );
+		const TurretRotationCore::TAimGeometry<double> Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, FVector3d( 1.0, 1.0, 1.0 ) );
+
+		const TurretRotationCore::TAimAngles<double> Reference = Geometry.Solve( FVector3d( Case.Target.X, Case.Target.Y, Case.Target.Z ) );
+		const TurretRotationCore::TAimAngles<float> Angles = MakeGeometry( Case ).Solve( Case.Target );
+		MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Angles.Yaw, Reference.Yaw ) );
+		MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Angles.Pitch, Reference.Pitch ) );
+	}
+
+	TURRET_CHECK_LE( MaxDifference, BaselineToleranceDegrees );
+}
+
+TURRET_TEST( Core, SolveRotationMatchesSolve )
+{
+	TurretRotationTests::FTestRandom Random( 1415 );
+	std::vector<FCoreTestCase> Cases = MakeTypicalCases( 50000, Random );
+	const std::vector<FCoreTestCase> DegenerateCases = MakeDegenerateCases( 5000, Random );
+	Cases.insert( Cases.end(), DegenerateCases.begin(), DegenerateCases.end() );
+
+	double MaxDifference = 0.0;
+	for ( const FCoreTestCase& Case : Cases )
+	{
+		const TurretRotationCore::TAimGeometry<float> Geometry = MakeGeometry( Case );
+		const TurretRotationCore::TAimAngles<float> Angles = Geometry.Solve( Case.Target );
+		const TurretRotationCore::TAimRotation<float> Rotation = Geometry.SolveRotation( Case.Target );
+
+		const double RadiansToDegrees = TurretRotationCore::TConstants<double>::RadiansToDegrees();
+		MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Angles.Yaw, std::atan2( Rotation.SinYaw, Rotation.CosYaw ) * RadiansToDegrees ) );
+		MaxDifference = std::max( MaxDifference, TurretRotationTests::GetAngleDifferenceDegrees( Angles.Pitch, std::atan2( Rotation.SinPitch, Rotation.CosPitch ) * RadiansToDegrees ) );
+	}
+
+	TURRET_CHECK_LE( MaxDifference, BaselineToleranceDegrees );
+}
+
+TURRET_TEST( Core, ReportsEdgeCases )
+{
+	const FVector3f ActorScale( 1.0f, 1.0f, 1.0f );
+	const TurretRotationCore::TAimGeometry<float> Geometry = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( FVector3f( 40.0f, 0.0f, 30.0f ), FVector3f( 150.0f, 0.0f, 0.0f ), ActorScale );
+	const TurretRotationCore::TAimGeometry<float> ZeroLengthBarrel = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( FVector3f( 40.0f, 0.0f, 30.0f ), FVector3f( 0.0f, 0.0f, 0.0f ), ActorScale );
+
+	unsigned int Events = 0;
+	Geometry.Solve( FVector3f( 5000.0f, 100.0f, 200.0f ), TurretRotationCore::EAimAccuracy::Exact, &Events );
+	TURRET_CHECK_EQ( Events, TurretRotationCore::EAimSolveEvent::None );
+
+	Events = 0;
+	Geometry.Solve( FVector3f( 10.0f, 0.0f, 0.0f ), TurretRotationCore::EAimAccuracy::Exact, &Events );
+	TURRET_CHECK( ( Events & TurretRotationCore::EAimSolveEvent::TargetClamped ) != 0 );
+
+	Events = 0;
+	const TurretRotationCore::TAimAngles<float> Angles = ZeroLengthBarrel.Solve( FVector3f( 5000.0f, 0.0f, 0.0f ), TurretRotationCore::EAimAccuracy::Exact, &Events );
+	TURRET_CHECK( ( Events & TurretRotationCore::EAimSolveEvent::NoRoots ) != 0 );
+	TURRET_CHECK( Angles.Pitch == 0.0f );
+}
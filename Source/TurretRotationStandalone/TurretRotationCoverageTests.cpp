@@ -0,0 +1,200 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationCoverage.h"
+
+
+/**
+ * Checks TAimCoverage::CanHit against solving (TAimCoverage::CanHit_Solve), and that MayCoverRegion never calls a region safe when
+ * a point in it can be hit.  These are the checks that TurretRotation.Bench.Coverage logs, for the math under FTurretCoverageField.
+ */
+namespace TurretRotationCoverageTests
+{
+	typedef TurretRotationCore::TVector3<float> FVector3;
+	typedef TurretRotationCore::TVector2<float> FVector2;
+
+	struct FCoverageTestTurret
+	{
+		TurretRotationCore::TAimGeometry<float> Geometry;
+		TurretRotationCore::TAimLimits<float> Limits;
+		TurretRotationCore::TAimCoverage<float> Coverage;
+
+		FVector3 AimJointLocation;
+
+		/** Where the turret's "X", "Y", and "Z" point. */
+		FVector3 Forward;
+		FVector3 Right;
+		FVector3 Up;
+
+		/** Forward on the "X-Y" plane, or zero if the turret is tilted (same as FTurretCoverageField). */
+		FVector2 Forward2D;
+	};
+
+	static float Dot( const FVector3& A, const FVector3& B )
+	{
+		return ( A.X * B.X ) + ( A.Y * B.Y ) + ( A.Z * B.Z );
+	}
+
+	/** Rolls around "X", then pitches around "Y", then yaws around "Z" (all in degrees). */
+	static FVector3 Rotate( const FVector3& Vector, float Yaw, float Pitch, float Roll )
+	{
+		const float DegreesToRadians = 1.0f / TurretRotationCore::TConstants<float>::RadiansToDegrees();
+		const float SR = std::sin( Roll * DegreesToRadians ), CR = std::cos( Roll * DegreesToRadians );
+		const float SP = std::sin( Pitch * DegreesToRadians ), CP = std::cos( Pitch * DegreesToRadians );
+		const float SY = std::sin( Yaw * DegreesToRadians ), CY = std::cos( Yaw * DegreesToRadians );
+
+		const FVector3 Rolled( Vector.X, ( CR * Vector.Y ) - ( SR * Vector.Z ), ( SR * Vector.Y ) + ( CR * Vector.Z ) );
+		const FVector3 Pitched( ( CP * Rolled.X ) + ( SP * Rolled.Z ), Rolled.Y, ( CP * Rolled.Z ) - ( SP * Rolled.X ) );
+		return FVector3( ( CY * Pitched.X ) - ( SY * Pitched.Y ), ( SY * Pitched.X ) + ( CY * Pitched.Y ), Pitched.Z );
+	}
+
+	/**
+	 * A turret like the ones in TurretRotation.Bench.Coverage: sized like the demo turrets, with a mix of ranges, yaw arcs, and pitch
+	 * limits, and about a tenth of them tilted (so their yaw arc isn't on the "X-Y" plane).
+	 */
+	static FCoverageTestTurret MakeTurret( const FVector3& AimJointLocation, TurretRotationTests::FTestRandom& Random )
+	{
+		FCoverageTestTurret Turret;
+		Turret.Geometry = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors(
+			FVector3( Random.FRandRange( 0.0f, 50.0f ), 0, Random.FRandRange( -50.0f, 50.0f ) ),
+			FVector3( Random.FRandRange( 50.0f, 300.0f ), 0, Random.FRandRange( -20.0f, 20.0f ) ),
+			FVector3( 1, 1, 1 ) );
+
+		Turret.Limits.MinRange = Random.FRandRange( 0.0f, 300.0f );
+		Turret.Limits.MaxRange = Random.FRandRange( 2000.0f, 6000.0f );
+		Turret.Limits.HalfArcDegrees = Random.FRand() < 0.25f ? 180.0f : Random.FRandRange( 30.0f, 170.0f );
+		if ( Random.FRand() < 0.75f )
+		{
+			Turret.Limits.MinPitchDegrees = Random.FRandRange( -30.0f, -5.0f );
+			Turret.Limits.MaxPitchDegrees = Random.FRandRange( 20.0f, 85.0f );
+		}
+		Turret.Coverage.Initialize( Turret.Geometry, Turret.Limits );
+
+		const bool bTilted = Random.FRand() < 0.1f;
+		const float Yaw = Random.FRandRange( -180.0f, 180.0f );
+		const float Pitch = bTilted ? Random.FRandRange( -20.0f, 20.0f ) : 0.0f;
+		const float Roll = bTilted ? Random.FRandRange( -20.0f, 20.0f ) : 0.0f;
+		Turret.AimJointLocation = AimJointLocation;
+		Turret.Forward = Rotate( FVector3( 1, 0, 0 ), Yaw, Pitch, Roll );
+		Turret.Right = Rotate( FVector3( 0, 1, 0 ), Yaw, Pitch, Roll );
+		Turret.Up = Rotate( FVector3( 0, 0, 1 ), Yaw, Pitch, Roll );
+		Turret.Forward2D = ( Turret.Up.Z >= 0.9999f ) ? TurretRotationCore::GetSafeNormal2D( FVector2( Turret.Forward.X, Turret.Forward.Y ) ) : FVector2( 0, 0 );
+		return Turret;
+	}
+
+	static FVector3 ToAimJointSpace( const FCoverageTestTurret& Turret, const FVector3& WorldLocation )
+	{
+		const FVector3 Offset( WorldLocation.X - Turret.AimJointLocation.X, WorldLocation.Y - Turret.AimJointLocation.Y, WorldLocation.Z - Turret.AimJointLocation.Z );
+		return FVector3( Dot( Offset, Turret.Forward ), Dot( Offset, Turret.Right ), Dot( Offset, Turret.Up ) );
+	}
+
+	/**
+	 * Checks if CanHit and CanHit_Solve are allowed to disagree about a point: when it's right at one of the turret's limits (within
+	 * AIM_COVERAGE_TOLERANCE_DEGREES of a pitch limit or of the yaw arc, or right at a range).
+	 */
+	static bool IsAtCoverageLimit( const FCoverageTestTurret& Turret, const FVector3& Target_InAimJointSpace )
+	{
+		float Pitch = 0.0f;
+		TurretRotationCore::TAimCoverage<float>::CanHit_Solve( Turret.Geometry, Turret.Limits, Target_InAimJointSpace, &Pitch );
+
+		const float Tolerance = float( AIM_COVERAGE_TOLERANCE_DEGREES );
+		const float Yaw = std::atan2( Target_InAimJointSpace.Y, Target_InAimJointSpace.X ) * TurretRotationCore::TConstants<float>::RadiansToDegrees();
+		const float Distance = std::sqrt( Dot( Target_InAimJointSpace, Target_InAimJointSpace ) );
+		const float RangeTolerance = std::max( 1.0f, Distance * 1.e-4f );
+
+		return std::abs( Pitch - Turret.Limits.MinPitchDegrees ) <= Tolerance
+			|| std::abs( Pitch - Turret.Limits.MaxPitchDegrees ) <= Tolerance
+			|| ( Turret.Limits.HalfArcDegrees < 180.0f && std::abs( std::abs( Yaw ) - Turret.Limits.HalfArcDegrees ) <= Tolerance )
+			|| std::abs( Distance - Turret.Limits.MinRange ) <= RangeTolerance
+			|| std::abs( Distance - Turret.Limits.MaxRange ) <= RangeTolerance
+			|| std::abs( Distance - Turret.Geometry.GetMinimumTargetDistance() ) <= RangeTolerance;
+	}
+
+	/** @return Returns true if either CanHit or CanHit_Solve says the turret can hit the point, leaving out points at its limits. */
+	static bool CanClearlyHit( const FCoverageTestTurret& Turret, const FVector3& WorldLocation )
+	{
+		const FVector3 Target = ToAimJointSpace( Turret, WorldLocation );
+		const bool bCanHit = Turret.Coverage.CanHit( Target ) || TurretRotationCore::TAimCoverage<float>::CanHit_Solve( Turret.Geometry, Turret.Limits, Target );
+		return bCanHit && !IsAtCoverageLimit( Turret, Target );
+	}
+}
+
+using namespace TurretRotationCoverageTests;
+
+TURRET_TEST( Coverage, FieldMatchesSolve )
+{
+	// Points from right on the AimJoint out past the MaxRange, in every direction.  Every fourth one is near the MinimumTargetDistance,
+	// where the table is least accurate.
+	TurretRotationTests::FTestRandom Random( 19 );
+	int NumPoints = 0;
+	int NumHits = 0;
+	int NumMismatches = 0;
+	for ( int TurretIndex = 0; TurretIndex < 2000; ++TurretIndex )
+	{
+		const FCoverageTestTurret Turret = MakeTurret( FVector3( 0, 0, 0 ), Random );
+		const float MinimumTargetDistance = Turret.Geometry.GetMinimumTargetDistance();
+		for ( int PointIndex = 0; PointIndex < 200; ++PointIndex )
+		{
+			const TurretRotationCore::TVector3<double> Direction = Random.VRand();
+			const float Distance = ( ( PointIndex % 4 ) == 0 )
+				? Random.FRandRange( 0.5f * MinimumTargetDistance, 3.0f * MinimumTargetDistance )
+				: Random.FRandRange( 0.0f, 1.2f * Turret.Limits.MaxRange );
+			const FVector3 Target( float( Direction.X * Distance ), float( Direction.Y * Distance ), float( Direction.Z * Distance ) );
+
+			const bool bFieldCanHit = Turret.Coverage.CanHit( Target );
+			const bool bSolveCanHit = TurretRotationCore::TAimCoverage<float>::CanHit_Solve( Turret.Geometry, Turret.Limits, Target );
+			NumMismatches += ( bFieldCanHit != bSolveCanHit && !IsAtCoverageLimit( Turret, Target ) ) ? 1 : 0;
+			NumHits += bSolveCanHit ? 1 : 0;
+			++NumPoints;
+		}
+	}
+	TURRET_CHECK_EQ( NumMismatches, 0 );
+
+	// Make sure both answers were covered.
+	TURRET_CHECK( NumHits > NumPoints / 10 && NumHits < NumPoints - ( NumPoints / 10 ) );
+}
+
+TURRET_TEST( Coverage, SafeRegionsAreSafe )
+{
+	// Boxes around each turret, from small to bigger than its arc.  Every box MayCoverRegion calls safe is sampled at its corners and
+	// inside, and no sample may be hit (by the field or by solving).
+	TurretRotationTests::FTestRandom Random( 23 );
+	const int NumSamplesInside = 8;
+	int NumRegions = 0;
+	int NumSafeRegions = 0;
+	int NumUnsafeSamples = 0;
+	for ( int TurretIndex = 0; TurretIndex < 2000; ++TurretIndex )
+	{
+		const FVector3 AimJointLocation( Random.FRandRange( -40000.0f, 40000.0f ), Random.FRandRange( -40000.0f, 40000.0f ), Random.FRandRange( 100.0f, 500.0f ) );
+		const FCoverageTestTurret Turret = MakeTurret( AimJointLocation, Random );
+		for ( int RegionIndex = 0; RegionIndex < 20; ++RegionIndex )
+		{
+			const TurretRotationCore::TVector3<double> Direction = Random.VRand();
+			const float Distance = Random.FRandRange( 0.0f, 1.2f * Turret.Limits.MaxRange );
+			const FVector3 Center( AimJointLocation.X + float( Direction.X * Distance ), AimJointLocation.Y + float( Direction.Y * Distance ), AimJointLocation.Z + float( Direction.Z * Distance ) * 0.25f );
+			const FVector3 Extent( Random.FRandRange( 100.0f, 1500.0f ), Random.FRandRange( 100.0f, 1500.0f ), Random.FRandRange( 100.0f, 500.0f ) );
+			const FVector3 RegionMin( Center.X - Extent.X, Center.Y - Extent.Y, Center.Z - Extent.Z );
+			const FVector3 RegionMax( Center.X + Extent.X, Center.Y + Extent.Y, Center.Z + Extent.Z );
+
+			++NumRegions;
+			if ( TurretRotationCore::MayCoverRegion( Turret.Limits, Turret.AimJointLocation, Turret.Forward2D, RegionMin, RegionMax ) )
+			{
+				continue;
+			}
+
+			++NumSafeRegions;
+			for ( int Corner = 0; Corner < 8; ++Corner )
+			{
+				const FVector3 Location( ( Corner & 1 ) ? RegionMax.X : RegionMin.X, ( Corner & 2 ) ? RegionMax.Y : RegionMin.Y, ( Corner & 4 ) ? RegionMax.Z : RegionMin.Z );
+				NumUnsafeSamples += CanClearlyHit( Turret, Location ) ? 1 : 0;
+			}
+			for ( int Sample = 0; Sample < NumSamplesInside; ++Sample )
+			{
+				const FVector3 Location( Random.FRandRange( RegionMin.X, RegionMax.X ), Random.FRandRange( RegionMin.Y, RegionMax.Y ), Random.FRandRange( RegionMin.Z, RegionMax.Z ) );
+				NumUnsafeSamples += CanClearlyHit( Turret, Location ) ? 1 : 0;
+			}
+		}
+	}
+	TURRET_CHECK_EQ( NumUnsafeSamples, 0 );
+
+	// Make sure both answers were covered.
+	TURRET_CHECK( NumSafeRegions > NumRegions / 20 && NumSafeRegions < NumRegions - ( NumRegions / 20 ) );
+}
@@ -0,0 +1,188 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationKernels.h"
+
+
+/**
+ * Checks every specialized kernel (TurretRotationKernels.h) against TAimGeometry::Solve.
+ */
+namespace TurretRotationKernelTests
+{
+	typedef TurretRotationCore::TVector3<float> FVector3;
+
+	struct FKernelTestCase
+	{
+		TurretRotationCore::TAimGeometry<float> Geometry;
+		FVector3 Target;
+	};
+
+	/**
+	 * Turrets shaped for one of the specialized kernels, sized like the demo turrets.  Every 8th target is an edge case (right on the
+	 * AimJoint, straight above/below it, or just in front of the BarrelStart).
+	 */
+	static std::vector<FKernelTestCase> MakeKernelCases( TurretRotationCore::EAimKernel Kernel, bool bUniformScale, int NumCases, TurretRotationTests::FTestRandom& Random )
+	{
+		const bool bBarrelAlongX = ( Kernel == TurretRotationCore::EAimKernel::BarrelAlongX || Kernel == TurretRotationCore::EAimKernel::BarrelAlongX_NoOffset );
+		const bool bNoVerticalOffset = ( Kernel == TurretRotationCore::EAimKernel::AnyBarrel_NoOffset || Kernel == TurretRotationCore::EAimKernel::BarrelAlongX_NoOffset );
+
+		std::vector<FKernelTestCase> Cases;
+		for ( int Index = 0; Index < NumCases; ++Index )
+		{
+			// Offsets/slopes are kept away from 0, so that ChooseAimKernel can't pick a more specialized kernel than the one being tested.
+			const float OffsetZ = ( Random.FRand() < 0.5f ? -1.0f : 1.0f ) * Random.FRandRange( 5.0f, 50.0f );
+			const float BarrelZ = ( Random.FRand() < 0.5f ? -1.0f : 1.0f ) * Random.FRandRange( 5.0f, 20.0f );
+			const FVector3 AimJoint_To_BarrelStart( Random.FRandRange( 0.0f, 50.0f ), 0, bNoVerticalOffset ? 0.0f : OffsetZ );
+			const FVector3 BarrelStart_To_BarrelEnd( Random.FRandRange( 50.0f, 300.0f ), 0, bBarrelAlongX ? 0.0f : BarrelZ );
+
+			const float UniformScale = Random.FRandRange( 0.5f, 2.0f );
+			const FVector3 ActorScale = bUniformScale
+				? FVector3( UniformScale, UniformScale, UniformScale )
+				: FVector3( Random.FRandRange( 0.5f, 2.0f ), Random.FRandRange( 0.5f, 2.0f ), Random.FRandRange( 0.5f, 2.0f ) );
+
+			FKernelTestCase Case;
+			Case.Geometry = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale );
+
+			if ( ( Index % 8 ) == 0 )
+			{
+				const TurretRotationCore::TVector2<float>& BarrelStart = Case.Geometry.GetBarrelStartLocation2D();
+				switch ( ( Index / 8 ) % 3 )
+				{
+				case 0:		Case.Target = FVector3( 0, 0, 0 ); break;
+				case 1:		Case.Target = FVector3( 0, 0, Random.FRandRange( -1000.0f, 1000.0f ) ); break;
+				default:	Case.Target = FVector3( BarrelStart.X + 1.0f, 0, BarrelStart.Y ); break;
+				}
+			}
+			else
+			{
+				const TurretRotationCore::TVector3<double> Direction = Random.VRand();
+				const float Distance = std::pow( 10.0f, Random.FRandRange( 1.0f, 5.0f ) );
+				Case.Target = FVector3( float( Direction.X * Distance ), float( Direction.Y * Distance ), float( Direction.Z * Distance ) );
+			}
+			Cases.push_back( Case );
+		}
+		return Cases;
+	}
+
+	/**
+	 * Solves every case with ChooseAimKernel's kernel and with TAimGeometry::Solve, in every accuracy tier.
+	 *
+	 * @param Out_NumEventMismatches	OUT - Number of solves where the kernel reported different EAimSolveEvent flags.
+	 * @return Returns the largest yaw/pitch difference (in degrees).
+	 */
+	static double CalculateWorstKernelDifference( const std::vector<FKernelTestCase>& Cases, int& Out_NumEventMismatches )
+	{
+		const TurretRotationCore::EAimAccuracy Accuracies[] = { TurretRotationCore::EAimAccuracy::Exact, TurretRotationCore::EAimAccuracy::Fast, TurretRotationCore::EAimAccuracy::Approximate };
+
+		double WorstDifference = 0.0;
+		Out_NumEventMismatches = 0;
+		for ( const FKernelTestCase& Case : Cases )
+		{
+			const TurretRotationCore::EAimKernel Kernel = TurretRotationCore::ChooseAimKernel( Case.Geometry );
+			for ( const TurretRotationCore::EAimAccuracy Accuracy : Accuracies )
+			{
+				unsigned int ReferenceEvents = 0;
+				unsigned int KernelEvents = 0;
+				const TurretRotationCore::TAimAngles<float> Reference = Case.Geometry.Solve( Case.Target, Accuracy, &ReferenceEvents );
+				const TurretRotationCore::TAimAngles<float> Specialized = TurretRotationCore::SolveWithKernel( Kernel, Case.Geometry, Case.Target, Accuracy, &KernelEvents );
+
+				WorstDifference = std::max( WorstDifference, TurretRotationTests::GetAngleDifferenceDegrees( Reference.Yaw, Specialized.Yaw ) );
+				WorstDifference = std::max( WorstDifference, TurretRotationTests::GetAngleDifferenceDegrees( Reference.Pitch, Specialized.Pitch ) );
+				Out_NumEventMismatches += ( ReferenceEvents != KernelEvents ) ? 1 : 0;
+			}
+		}
+		return WorstDifference;
+	}
+
+	/** Checks that ChooseAimKernel picks the kernel, and that it matches TAimGeometry::Solve, with uniform and non-uniform scales. */
+	static void CheckKernel( TurretRotationCore::EAimKernel Kernel )
+	{
+		TurretRotationTests::FTestRandom Random( 1357 );
+		for ( const bool bUniformScale : { true, false } )
+		{
+			const std::vector<FKernelTestCase> Cases = MakeKernelCases( Kernel, bUniformScale, 50000, Random );
+
+			int NumWrongKernels = 0;
+			for ( const FKernelTestCase& Case : Cases )
+			{
+				NumWrongKernels += ( TurretRotationCore::ChooseAimKernel( Case.Geometry ) != Kernel ) ? 1 : 0;
+			}
+			TURRET_CHECK_EQ( NumWrongKernels, 0 );
+
+			int NumEventMismatches = 0;
+			TURRET_CHECK_LE( CalculateWorstKernelDifference( Cases, NumEventMismatches ), AIM_KERNEL_TOLERANCE_DEGREES );
+			TURRET_CHECK_EQ( NumEventMismatches, 0 );
+		}
+	}
+}
+
+using namespace TurretRotationKernelTests;
+
+TURRET_TEST( Kernels, AnyBarrel )
+{
+	CheckKernel( TurretRotationCore::EAimKernel::AnyBarrel );
+}
+
+TURRET_TEST( Kernels, AnyBarrel_NoOffset )
+{
+	CheckKernel( TurretRotationCore::EAimKernel::AnyBarrel_NoOffset );
+}
+
+TURRET_TEST( Kernels, BarrelAlongX )
+{
+	CheckKernel( TurretRotationCore::EAimKernel::BarrelAlongX );
+}
+
+TURRET_TEST( Kernels, BarrelAlongX_NoOffset )
+{
+	CheckKernel( TurretRotationCore::EAimKernel::BarrelAlongX_NoOffset );
+}
+
+TURRET_TEST( Kernels, BarrelsEndingNearTheAimJoint )
+{
+	// Barrels pointing back at the AimJoint, ending within a few units of it (on either side), with targets from a hundredth of a unit
+	// out.  The ones that end too close to the AimJoint have to stay on the reference solve, and every other one has to stay within the
+	// tolerance, however close the target is.
+	TurretRotationTests::FTestRandom Random( 2468 );
+	std::vector<FKernelTestCase> Cases;
+	int NumEndingNearAimJoint = 0;
+	int NumWrongKernels = 0;
+	for ( int Index = 0; Index < 200000; ++Index )
+	{
+		const bool bBarrelAlongX = ( Index % 2 ) == 0;
+		const bool bNoVerticalOffset = ( Index % 4 ) < 2;
+		const FVector3 AimJoint_To_BarrelStart( Random.FRandRange( 5.0f, 50.0f ), 0, bNoVerticalOffset ? 0.0f : Random.FRandRange( 5.0f, 50.0f ) );
+		const float BarrelLength = AimJoint_To_BarrelStart.X + Random.FRandRange( -5.0f, 5.0f );
+		const FVector3 BarrelStart_To_BarrelEnd( -BarrelLength, 0, bBarrelAlongX ? 0.0f : -AimJoint_To_BarrelStart.Z + Random.FRandRange( -5.0f, 5.0f ) );
+
+		FKernelTestCase Case;
+		Case.Geometry = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, FVector3( 1, 1, 1 ) );
+
+		const TurretRotationCore::TVector3<double> Direction = Random.VRand();
+		const float Distance = std::pow( 10.0f, Random.FRandRange( -2.0f, 4.0f ) );
+		Case.Target = FVector3( float( Direction.X * Distance ), float( Direction.Y * Distance ), float( Direction.Z * Distance ) );
+		Cases.push_back( Case );
+
+		const TurretRotationCore::TVector2<float>& BarrelStart = Case.Geometry.GetBarrelStartLocation2D();
+		const TurretRotationCore::TVector2<float>& BarrelEnd = Case.Geometry.GetBarrelEndLocation2D();
+		const bool bEndsNearAimJoint = TurretRotationCore::SizeSquared2D( BarrelEnd ) < 0.01f * TurretRotationCore::SizeSquared2D( BarrelStart );
+		NumEndingNearAimJoint += bEndsNearAimJoint ? 1 : 0;
+		NumWrongKernels += ( bEndsNearAimJoint && TurretRotationCore::ChooseAimKernel( Case.Geometry ) != TurretRotationCore::EAimKernel::Reference ) ? 1 : 0;
+	}
+	TURRET_CHECK_EQ( NumWrongKernels, 0 );
+
+	// Make sure both sides of the cutoff were covered.
+	TURRET_CHECK( NumEndingNearAimJoint > 1000 && NumEndingNearAimJoint < int( Cases.size() ) - 1000 );
+
+	int NumEventMismatches = 0;
+	TURRET_CHECK_LE( CalculateWorstKernelDifference( Cases, NumEventMismatches ), AIM_KERNEL_TOLERANCE_DEGREES );
+	TURRET_CHECK_EQ( NumEventMismatches, 0 );
+}
+
+TURRET_TEST( Kernels, ReferenceIsSolve )
+{
+	// Zero length barrels, and geometries whose AimJoint isn't at the origin, use TAimGeometry::Solve itself.
+	typedef TurretRotationCore::TVector2<float> FVector2;
+	const TurretRotationCore::TAimGeometry<float> ZeroLengthBarrel = TurretRotationCore::TAimGeometry<float>::MakeFromActorVectors( FVector3( 40, 0, 30 ), FVector3( 0, 0, 0 ), FVector3( 1, 1, 1 ) );
+	const TurretRotationCore::TAimGeometry<float> OffsetAimJoint = TurretRotationCore::TAimGeometry<float>::MakeFromLocations2D( FVector2( 10, 5 ), FVector2( 50, 35 ), FVector2( 200, 35 ) );
+	TURRET_CHECK( TurretRotationCore::ChooseAimKernel( ZeroLengthBarrel ) == TurretRotationCore::EAimKernel::Reference );
+	TURRET_CHECK( TurretRotationCore::ChooseAimKernel( OffsetAimJoint ) == TurretRotationCore::EAimKernel::Reference );
+}
@@ -0,0 +1,238 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationNet.h"
+#include <algorithm>
+
+
+/**
+ * Checks that everything TurretRotationNet.h writes through TBitWriter reads back the same through TBitReader: raw bits, packed
+ * integers, quantized aims, and whole snapshot deltas.
+ */
+namespace TurretRotationNetTests
+{
+	typedef std::vector<TurretRotationCore::FAimSnapshotItem> FSnapshot;
+
+	/**
+	 * Makes a sequence of snapshots at 30 Hz: most turrets turn a little every frame (small deltas), some snap to a new aim (full
+	 * values), some hold still (not written at all), and a few are destroyed and replaced by new ones (with new IDs) every frame.
+	 */
+	static std::vector<FSnapshot> MakeSnapshotSequence( int NumTurrets, int NumFrames, const TurretRotationCore::FAimQuantization& Quantization, TurretRotationTests::FTestRandom& Random )
+	{
+		struct FTurret
+		{
+			unsigned int Id;
+			TurretRotationCore::TAimAngles<double> Angles;
+			double YawRate;
+			double PitchRate;
+		};
+
+		unsigned int NextId = 1;
+		auto MakeTurret = [&Random, &NextId]()
+		{
+			FTurret Turret;
+			Turret.Id = NextId;
+			NextId += 1 + Random.RandHelper( 3 );
+			Turret.Angles.Yaw = Random.DRandRange( -180.0, 180.0 );
+			Turret.Angles.Pitch = Random.DRandRange( -30.0, 80.0 );
+
+			const bool bStill = Random.FRand() < 0.25f;
+			Turret.YawRate = bStill ? 0.0 : Random.DRandRange( -90.0, 90.0 );
+			Turret.PitchRate = bStill ? 0.0 : Random.DRandRange( -20.0, 20.0 );
+			return Turret;
+		};
+
+		std::vector<FTurret> Turrets;
+		for ( int Index = 0; Index < NumTurrets; ++Index )
+		{
+			Turrets.push_back( MakeTurret() );
+		}
+
+		std::vector<FSnapshot> Snapshots;
+		const double DeltaSeconds = 1.0 / 30.0;
+		for ( int Frame = 0; Frame < NumFrames; ++Frame )
+		{
+			for ( FTurret& Turret : Turrets )
+			{
+				const float Event = Random.FRand();
+				if ( Event < 0.005f )
+				{
+					Turret = MakeTurret();
+				}
+				else if ( Event < 0.02f )
+				{
+					Turret.Angles.Yaw = Random.DRandRange( -180.0, 180.0 );
+				}
+				else
+				{
+					Turret.Angles.Yaw += Turret.YawRate * DeltaSeconds;
+					Turret.Angles.Pitch += Turret.PitchRate * DeltaSeconds;
+				}
+			}
+
+			// Replacements get higher IDs, so sort to keep the snapshot in ID order.
+			std::sort( Turrets.begin(), Turrets.end(), []( const FTurret& A, const FTurret& B ) { return A.Id < B.Id; } );
+
+			FSnapshot Snapshot;
+			for ( const FTurret& Turret : Turrets )
+			{
+				Snapshot.push_back( TurretRotationCore::FAimSnapshotItem( Turret.Id, TurretRotationCore::QuantizeAim( Turret.Angles, Quantization ) ) );
+			}
+			Snapshots.push_back( Snapshot );
+		}
+		return Snapshots;
+	}
+
+	/** Writes the difference between two snapshots, and reads it back from what the receiver has. */
+	static bool RoundTripSnapshot( const FSnapshot& BaseItems, const FSnapshot& ReceiverBaseItems, const FSnapshot& Items, const TurretRotationCore::FAimQuantization& Quantization, FSnapshot& Out_DecodedItems )
+	{
+		TurretRotationCore::TBitWriter<> Writer;
+		TurretRotationCore::WriteAimSnapshotDelta( Writer, BaseItems.data(), int( BaseItems.size() ), Items.data(), int( Items.size() ), Quantization );
+
+		Out_DecodedItems.clear();
+		TurretRotationCore::TBitReader<> Reader( Writer.GetBytes(), Writer.GetNumBits() );
+		const bool bValid = TurretRotationCore::ReadAimSnapshotDelta( Reader, ReceiverBaseItems.data(), int( ReceiverBaseItems.size() ), Quantization,
+			[&Out_DecodedItems]( const TurretRotationCore::FAimSnapshotItem& Item ) { Out_DecodedItems.push_back( Item ); } );
+		return bValid && Reader.IsAtEnd();
+	}
+}
+
+using namespace TurretRotationNetTests;
+
+TURRET_TEST( Net, BitRoundTrip )
+{
+	TurretRotationTests::FTestRandom Random( 1234 );
+
+	std::vector<unsigned int> Values;
+	std::vector<int> Widths;
+	TurretRotationCore::TBitWriter<> Writer;
+	size_t ExpectedNumBits = 0;
+	for ( int Index = 0; Index < 10000; ++Index )
+	{
+		const int Width = 1 + int( Random.RandHelper( 32 ) );
+		const unsigned int Mask = Width == 32 ? 0xFFFFFFFFu : ( ( 1u << Width ) - 1 );
+		const unsigned int Value = Random.RandHelper( 0xFFFFFFFFu ) & Mask;
+
+		Writer.WriteBits( Value, Width );
+		Values.push_back( Value );
+		Widths.push_back( Width );
+		ExpectedNumBits += Width;
+	}
+	TURRET_CHECK_EQ( Writer.GetNumBits(), ExpectedNumBits );
+	TURRET_CHECK_EQ( Writer.GetBytes().size(), ( ExpectedNumBits + 7 ) / 8 );
+
+	TurretRotationCore::TBitReader<> Reader( Writer.GetBytes(), Writer.GetNumBits() );
+	int NumMismatches = 0;
+	for ( size_t Index = 0; Index < Values.size(); ++Index )
+	{
+		NumMismatches += Reader.ReadBits( Widths[Index] ) != Values[Index] ? 1 : 0;
+	}
+	TURRET_CHECK_EQ( NumMismatches, 0 );
+	TURRET_CHECK( Reader.IsAtEnd() );
+	TURRET_CHECK( !Reader.IsOverflowed() );
+
+	// Reading past the end returns zeros and overflows.
+	TURRET_CHECK_EQ( Reader.ReadBits( 1 ), 0 );
+	TURRET_CHECK( Reader.IsOverflowed() );
+}
+
+TURRET_TEST( Net, PackedUIntRoundTrip )
+{
+	const unsigned int Values[] = { 0u, 1u, 7u, 8u, 63u, 64u, 511u, 512u, 123456u, 0x7FFFFFFFu, 0xFFFFFFFFu };
+
+	TurretRotationCore::TBitWriter<> Writer;
+	for ( const unsigned int Value : Values )
+	{
+		TurretRotationCore::WritePackedUInt( Writer, Value );
+	}
+
+	TurretRotationCore::TBitReader<> Reader( Writer.GetBytes(), Writer.GetNumBits() );
+	for ( const unsigned int Value : Values )
+	{
+		TURRET_CHECK_EQ( TurretRotationCore::ReadPackedUInt( Reader ), Value );
+	}
+	TURRET_CHECK( Reader.IsAtEnd() );
+
+	// Small values (like ID gaps) cost 4 bits.
+	TurretRotationCore::TBitWriter<> SmallWriter;
+	TurretRotationCore::WritePackedUInt( SmallWriter, 5u );
+	TURRET_CHECK_EQ( SmallWriter.GetNumBits(), 4 );
+}
+
+TURRET_TEST( Net, QuantizeErrorIsHalfAStep )
+{
+	TurretRotationTests::FTestRandom Random( 5678 );
+	for ( int NumBits = 1; NumBits <= 16; ++NumBits )
+	{
+		const double HalfStepDegrees = 180.0 / double( 1u << NumBits );
+		double MaxErrorDegrees = 0.0;
+		for ( int Index = 0; Index < 10000; ++Index )
+		{
+			const double Degrees = Random.DRandRange( -720.0, 720.0 );
+			const unsigned int Value = TurretRotationCore::QuantizeAngle( Degrees, NumBits );
+			TURRET_CHECK( Value < ( 1u << NumBits ) );
+			MaxErrorDegrees = std::max( MaxErrorDegrees, TurretRotationTests::GetAngleDifferenceDegrees( TurretRotationCore::DequantizeAngle<double>( Value, NumBits ), Degrees ) );
+		}
+		TURRET_CHECK_LE( MaxErrorDegrees, HalfStepDegrees * ( 1.0 + 1.e-9 ) );
+	}
+}
+
+TURRET_TEST( Net, SnapshotDeltaRoundTrip )
+{
+	const TurretRotationCore::FAimQuantization Quantizations[] =
+	{
+		TurretRotationCore::FAimQuantization( 10, 10, 4 ),
+		TurretRotationCore::FAimQuantization( 12, 12, 5 ),
+		TurretRotationCore::FAimQuantization( 14, 12, 6 ),
+		TurretRotationCore::FAimQuantization( 16, 16, 8 ),
+	};
+
+	TurretRotationTests::FTestRandom Random( 9012 );
+	for ( const TurretRotationCore::FAimQuantization& Quantization : Quantizations )
+	{
+		const std::vector<FSnapshot> Snapshots = MakeSnapshotSequence( 500, 120, Quantization, Random );
+
+		// The receiver only has what it decoded so far, with a full snapshot every 30 frames.
+		FSnapshot ReceivedItems;
+		int NumMismatches = 0;
+		for ( size_t Frame = 0; Frame < Snapshots.size(); ++Frame )
+		{
+			const bool bFullSnapshot = ( Frame % 30 ) == 0;
+			const FSnapshot NoItems;
+
+			FSnapshot DecodedItems;
+			const bool bValid = RoundTripSnapshot( bFullSnapshot ? NoItems : Snapshots[Frame - 1], bFullSnapshot ? NoItems : ReceivedItems, Snapshots[Frame], Quantization, DecodedItems );
+			NumMismatches += ( !bValid || DecodedItems != Snapshots[Frame] ) ? 1 : 0;
+			ReceivedItems = DecodedItems;
+		}
+		TURRET_CHECK_EQ( NumMismatches, 0 );
+	}
+}
+
+TURRET_TEST( Net, UnchangedSnapshotIsOneBit )
+{
+	const TurretRotationCore::FAimQuantization Quantization;
+	TurretRotationTests::FTestRandom Random( 3456 );
+	const FSnapshot Snapshot = MakeSnapshotSequence( 100, 1, Quantization, Random )[0];
+
+	TurretRotationCore::TBitWriter<> Writer;
+	TURRET_CHECK_EQ( TurretRotationCore::WriteAimSnapshotDelta( Writer, Snapshot.data(), int( Snapshot.size() ), Snapshot.data(), int( Snapshot.size() ), Quantization ), 0 );
+	TURRET_CHECK_EQ( Writer.GetNumBits(), 1 );
+}
+
+TURRET_TEST( Net, RejectsBadStreams )
+{
+	const TurretRotationCore::FAimQuantization Quantization;
+	TurretRotationTests::FTestRandom Random( 7890 );
+	const std::vector<FSnapshot> Snapshots = MakeSnapshotSequence( 100, 2, Quantization, Random );
+
+	TurretRotationCore::TBitWriter<> Writer;
+	TurretRotationCore::WriteAimSnapshotDelta( Writer, Snapshots[0].data(), int( Snapshots[0].size() ), Snapshots[1].data(), int( Snapshots[1].size() ), Quantization );
+	const auto IgnoreItem = []( const TurretRotationCore::FAimSnapshotItem& ) {};
+
+	// Cut short.
+	TurretRotationCore::TBitReader<> TruncatedReader( Writer.GetBytes(), Writer.GetNumBits() - 1 );
+	TURRET_CHECK( !TurretRotationCore::ReadAimSnapshotDelta( TruncatedReader, Snapshots[0].data(), int( Snapshots[0].size() ), Quantization, IgnoreItem ) );
+
+	// Read against a base snapshot that the writer didn't use (changed turrets that the reader doesn't have).
+	TurretRotationCore::TBitReader<> NoBaseReader( Writer.GetBytes(), Writer.GetNumBits() );
+	TURRET_CHECK( !TurretRotationCore::ReadAimSnapshotDelta( NoBaseReader, nullptr, 0, Quantization, IgnoreItem ) );
+}
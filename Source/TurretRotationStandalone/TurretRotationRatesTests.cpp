@@ -0,0 +1,157 @@
+#include "TurretRotationTestFramework.h"
+#include "TurretRotationRates.h"
+
+
+/**
+ * Checks the analytic aim rates (TurretRotationRates.h) against central differences of TAimGeometry::Solve.
+ */
+namespace TurretRotationRatesTests
+{
+	typedef TurretRotationCore::TVector3<double> FVector3d;
+
+	/** Turrets sized like the demo turrets, targets a few meters to a few hundred meters away, moving at up to 15 m/s. */
+	struct FRatesTestCase
+	{
+		TurretRotationCore::TAimGeometry<double> Geometry;
+		FVector3d Target;
+		FVector3d Velocity;
+	};
+
+	static std::vector<FRatesTestCase> MakeRatesCases( int NumCases, TurretRotationTests::FTestRandom& Random )
+	{
+		std::vector<FRatesTestCase> Cases;
+		for ( int Index = 0; Index < NumCases; ++Index )
+		{
+			FRatesTestCase Case;
+			Case.Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors(
+				FVector3d( Random.FRandRange( 0.0f, 50.0f ), 0, Random.FRandRange( -50.0f, 50.0f ) ),
+				FVector3d( Random.FRandRange( 50.0f, 300.0f ), 0, Random.FRandRange( -20.0f, 20.0f ) ),
+				FVector3d( 1, 1, 1 ) );
+
+			const FVector3d Direction = Random.VRand();
+			const double Distance = Random.DRandRange( 500.0, 50000.0 );
+			Case.Target = FVector3d( Direction.X * Distance, Direction.Y * Distance, Direction.Z * Distance );
+			Case.Velocity = FVector3d( Random.DRandRange( -1500.0, 1500.0 ), Random.DRandRange( -1500.0, 1500.0 ), Random.DRandRange( -300.0, 300.0 ) );
+			Cases.push_back( Case );
+		}
+		return Cases;
+	}
+
+	static FVector3d MoveTarget( const FVector3d& Target, const FVector3d& Velocity, double Seconds )
+	{
+		return FVector3d( Target.X + ( Velocity.X * Seconds ), Target.Y + ( Velocity.Y * Seconds ), Target.Z + ( Velocity.Z * Seconds ) );
+	}
+
+	/** @return Returns the yaw/pitch rates from central differences of TAimGeometry::Solve, with the given step (in seconds). */
+	static TurretRotationCore::TAimAngles<double> CalculateCentralDifferenceRates( const FRatesTestCase& Case, double Step )
+	{
+		const TurretRotationCore::TAimAngles<double> Ahead = Case.Geometry.Solve( MoveTarget( Case.Target, Case.Velocity, Step ) );
+		const TurretRotationCore::TAimAngles<double> Behind = Case.Geometry.Solve( MoveTarget( Case.Target, Case.Velocity, -Step ) );
+
+		TurretRotationCore::TAimAngles<double> Rates;
+		Rates.Yaw = TurretRotationCore::NormalizeAngleDegrees( Ahead.Yaw - Behind.Yaw ) / ( 2.0 * Step );
+		Rates.Pitch = ( Ahead.Pitch - Behind.Pitch ) / ( 2.0 * Step );
+		return Rates;
+	}
+}
+
+using namespace TurretRotationRatesTests;
+
+TURRET_TEST( Rates, MatchesCentralDifferences )
+{
+	// The yaw turns very fast for targets passing almost straight above/below the AimJoint, where plain central differences need a step
+	// small enough that rounding in the solve takes over for far away targets.  Richardson extrapolation of two steps cancels the
+	// step's squared error instead, so one step works for both.
+	TurretRotationTests::FTestRandom Random( 4321 );
+	const double Step = 1.e-4;
+
+	int NumChecked = 0;
+	double MaxRelativeError = 0.0;
+	for ( const FRatesTestCase& Case : MakeRatesCases( 100000, Random ) )
+	{
+		unsigned int Events = 0;
+		const TurretRotationCore::TAimAngles<double> Rates = TurretRotationCore::CalculateAimRates( Case.Geometry, Case.Target, Case.Velocity, &Events );
+		if ( Events != 0 )
+		{
+			// The edge cases have kinks, which central differences can't follow.
+			continue;
+		}
+
+		const TurretRotationCore::TAimAngles<double> CoarseRates = CalculateCentralDifferenceRates( Case, Step );
+		const TurretRotationCore::TAimAngles<double> FineRates = CalculateCentralDifferenceRates( Case, Step * 0.5 );
+		const double YawRate = ( ( 4.0 * FineRates.Yaw ) - CoarseRates.Yaw ) / 3.0;
+		const double PitchRate = ( ( 4.0 * FineRates.Pitch ) - CoarseRates.Pitch ) / 3.0;
+
+		const double Error = std::max( std::abs( Rates.Yaw - YawRate ), std::abs( Rates.Pitch - PitchRate ) );
+		MaxRelativeError = std::max( MaxRelativeError, Error / ( 1.0 + std::abs( YawRate ) + std::abs( PitchRate ) ) );
+		++NumChecked;
+	}
+
+	TURRET_CHECK( NumChecked > 90000 );
+	TURRET_CHECK_LE( MaxRelativeError, 1.e-4 );
+}
+
+TURRET_TEST( Rates, SolveWithRatesMatchesSolve )
+{
+	TurretRotationTests::FTestRandom Random( 8765 );
+	int NumMismatches = 0;
+	for ( const FRatesTestCase& Case : MakeRatesCases( 1000, Random ) )
+	{
+		TurretRotationCore::TAimAngles<double> Rates;
+		const TurretRotationCore::TAimAngles<double> Angles = TurretRotationCore::SolveWithRates( Case.Geometry, Case.Target, Case.Velocity, Rates );
+		const TurretRotationCore::TAimAngles<double> ExpectedAngles = Case.Geometry.Solve( Case.Target );
+		const TurretRotationCore::TAimAngles<double> ExpectedRates = TurretRotationCore::CalculateAimRates( Case.Geometry, Case.Target, Case.Velocity );
+
+		NumMismatches += ( Angles.Yaw != ExpectedAngles.Yaw || Angles.Pitch != ExpectedAngles.Pitch || Rates.Yaw != ExpectedRates.Yaw || Rates.Pitch != ExpectedRates.Pitch ) ? 1 : 0;
+	}
+	TURRET_CHECK_EQ( NumMismatches, 0 );
+}
+
+TURRET_TEST( Rates, EdgeCases )
+{
+	const TurretRotationCore::TAimGeometry<double> Geometry = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors( FVector3d( 40, 0, 30 ), FVector3d( 150, 0, 0 ), FVector3d( 1, 1, 1 ) );
+
+	// Straight above the AimJoint, the yaw is undefined, so it doesn't turn.
+	const TurretRotationCore::TAimAngles<double> AboveRates = TurretRotationCore::CalculateAimRates( Geometry, FVector3d( 0, 0, 5000 ), FVector3d( 300, 200, 0 ) );
+	TURRET_CHECK( AboveRates.Yaw == 0.0 );
+
+	// A target that isn't moving doesn't turn the aim.
+	const TurretRotationCore::TAimAngles<double> StillRates = TurretRotationCore::CalculateAimRates( Geometry, FVector3d( 3000, -2000, 500 ), FVector3d( 0, 0, 0 ) );
+	TURRET_CHECK( StillRates.Yaw == 0.0 && StillRates.Pitch == 0.0 );
+
+	// Moving straight towards/away from the AimJoint across the "X-Y" plane doesn't turn the yaw.
+	const TurretRotationCore::TAimAngles<double> RadialRates = TurretRotationCore::CalculateAimRates( Geometry, FVector3d( 3000, 4000, 0 ), FVector3d( 300, 400, 0 ) );
+	TURRET_CHECK_LE( std::abs( RadialRates.Yaw ), 1.e-9 );
+
+	// No BarrelRayDistance means no pitch, and no pitch rate.
+	const TurretRotationCore::TAimGeometry<double> ZeroLengthBarrel = TurretRotationCore::TAimGeometry<double>::MakeFromActorVectors( FVector3d( 40, 0, 30 ), FVector3d( 0, 0, 0 ), FVector3d( 1, 1, 1 ) );
+	unsigned int Events = 0;
+	const TurretRotationCore::TAimAngles<double> NoRootsRates = TurretRotationCore::CalculateAimRates( ZeroLengthBarrel, FVector3d( 3000, 0, 500 ), FVector3d( 0, 0, 300 ), &Events );
+	TURRET_CHECK( ( Events & TurretRotationCore::EAimSolveEvent::NoRoots ) != 0 );
+	TURRET_CHECK( NoRootsRates.Pitch == 0.0 );
+}
+
+TURRET_TEST( Rates, ExtrapolationAndSlewLimit )
+{
+	TURRET_CHECK_LE( std::abs( TurretRotationCore::NormalizeAngleDegrees( 540.0 ) - 180.0 ), 1.e-12 );
+	TURRET_CHECK_LE( std::abs( TurretRotationCore::NormalizeAngleDegrees( -190.0 ) - 170.0 ), 1.e-12 );
+
+	// Extrapolating wraps the yaw.
+	TurretRotationCore::TAimAngles<double> Angles;
+	Angles.Yaw = 170.0;
+	Angles.Pitch = 10.0;
+	TurretRotationCore::TAimAngles<double> Rates;
+	Rates.Yaw = 40.0;
+	Rates.Pitch = -20.0;
+	const TurretRotationCore::TAimAngles<double> Extrapolated = TurretRotationCore::ExtrapolateAimAngles( Angles, Rates, 0.5 );
+	TURRET_CHECK_LE( std::abs( Extrapolated.Yaw - -170.0 ), 1.e-9 );
+	TURRET_CHECK_LE( std::abs( Extrapolated.Pitch - 0.0 ), 1.e-9 );
+
+	// The slew limit turns the short way around, no faster than allowed.
+	TurretRotationCore::TAimAngles<double> Desired;
+	Desired.Yaw = -160.0;
+	Desired.Pitch = 50.0;
+	const TurretRotationCore::TAimAngles<double> Limited = TurretRotationCore::ApplySlewLimit( Angles, Desired, 60.0, 30.0, 0.1 );
+	TURRET_CHECK_LE( std::abs( Limited.Yaw - 176.0 ), 1.e-9 );
+	TURRET_CHECK_LE( std::abs( Limited.Pitch - 13.0 ), 1.e-9 );
+}
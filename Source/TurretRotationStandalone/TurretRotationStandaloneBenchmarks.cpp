@@ -0,0 +1,266 @@
+#include "TurretRotationBaseline.h"
+#include "TurretRotationBatchKernel.h"
+#include "TurretRotationCore.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+/**
+ * The TurretRotation.Bench.Solve benchmark without the engine, so it can run (and be profiled) anywhere there's a compiler:
+ *
+ *   TurretRotationBenchmarks [NumTurrets]
+ *
+ * Reports the cost of TurretRotationCore's solve for typical, degenerate, and large input sets, in float and double, next to the cost
+ * of the frozen baseline math (TurretRotationBaseline.h) on the typical set, and the cost of the batched solve (TurretRotationBatchKernel.h)
+ * at every accuracy.
+ */
+namespace TurretRotationStandaloneBenchmarks
+{
+	/** One set of benchmark inputs: every turret has its own geometry and target. */
+	template<typename ScalarType>
+	struct TBenchmarkInputs
+	{
+		typedef TurretRotationCore::TVector3<ScalarType> FVector3;
+
+		std::vector<TurretRotationCore::TAimGeometry<ScalarType>> Geometries;
+		std::vector<FVector3> Targets_InAimJointSpace;
+	};
+
+	static double GetSeconds()
+	{
+		return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	}
+
+	/** Turrets sized like the demo turrets, aiming at targets a few meters to a few hundred meters away. */
+	template<typename ScalarType>
+	static void MakeTypicalInputs( int NumTurrets, std::mt19937& Random, TBenchmarkInputs<ScalarType>& Out_Inputs )
+	{
+		typedef typename TBenchmarkInputs<ScalarType>::FVector3 FVector3;
+
+		std::uniform_real_distribution<float> Unit( 0.0f, 1.0f );
+		const auto FRandRange = [&]( float Min, float Max ) { return Min + ( ( Max - Min ) * Unit( Random ) ); };
+
+		for ( int Index = 0; Index < NumTurrets; ++Index )
+		{
+			const FVector3 AimJoint_To_BarrelStart( FRandRange( 0.0f, 50.0f ), 0, FRandRange( -50.0f, 50.0f ) );
+			const FVector3 BarrelStart_To_BarrelEnd( FRandRange( 50.0f, 300.0f ), 0, FRandRange( -20.0f, 20.0f ) );
+			const FVector3 ActorScale( 1, 1, 1 );
+			Out_Inputs.Geometries.push_back( TurretRotationCore::TAimGeometry<ScalarType>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale ) );
+
+			const float Z = FRandRange( -1.0f, 1.0f );
+			const float Angle = FRandRange( -3.14159265f, 3.14159265f );
+			const float Radius = std::sqrt( std::max( 0.0f, 1.0f - ( Z * Z ) ) );
+			const float Distance = FRandRange( 500.0f, 50000.0f );
+			Out_Inputs.Targets_InAimJointSpace.push_back( FVector3( Radius * std::cos( Angle ) * Distance, Radius * std::sin( Angle ) * Distance, Z * Distance ) );
+		}
+	}
+
+	/**
+	 * The edge cases: targets closer than the barrel (clamped), targets sitting right on the AimJoint, zero-length barrels (no roots),
+	 * and targets straight above/below the AimJoint.
+	 */
+	template<typename ScalarType>
+	static void MakeDegenerateInputs( int NumTurrets, std::mt19937& Random, TBenchmarkInputs<ScalarType>& Out_Inputs )
+	{
+		typedef typename TBenchmarkInputs<ScalarType>::FVector3 FVector3;
+
+		std::uniform_real_distribution<float> Unit( 0.0f, 1.0f );
+		const auto FRandRange = [&]( float Min, float Max ) { return Min + ( ( Max - Min ) * Unit( Random ) ); };
+
+		for ( int Index = 0; Index < NumTurrets; ++Index )
+		{
+			const bool bZeroLengthBarrel = ( Index % 4 ) == 0;
+			const FVector3 AimJoint_To_BarrelStart( 40, 0, 30 );
+			const FVector3 BarrelStart_To_BarrelEnd = bZeroLengthBarrel ? FVector3( 0, 0, 0 ) : FVector3( 150, 0, 0 );
+			const FVector3 ActorScale( 1, 1, 1 );
+			Out_Inputs.Geometries.push_back( TurretRotationCore::TAimGeometry<ScalarType>::MakeFromActorVectors( AimJoint_To_BarrelStart, BarrelStart_To_BarrelEnd, ActorScale ) );
+
+			switch ( Index % 3 )
+			{
+			case 0:		Out_Inputs.Targets_InAimJointSpace.push_back( FVector3( 0, 0, 0 ) ); break;
+			case 1:		Out_Inputs.Targets_InAimJointSpace.push_back( FVector3( 0, 0, FRandRange( -1000.0f, 1000.0f ) ) ); break;
+			default:	Out_Inputs.Targets_InAimJointSpace.push_back( FVector3( FRandRange( -20.0f, 20.0f ), FRandRange( -20.0f, 20.0f ), FRandRange( -20.0f, 20.0f ) ) ); break;
+			}
+		}
+	}
+
+	/** @return Returns the average cost of one solve, in nanoseconds. */
+	template<typename ScalarType>
+	static double RunSolveBenchmark( const TBenchmarkInputs<ScalarType>& Inputs, int NumRepeats )
+	{
+		const int NumTurrets = int( Inputs.Geometries.size() );
+		ScalarType Checksum = 0;
+
+		const double StartTime = GetSeconds();
+		for ( int Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int Index = 0; Index < NumTurrets; ++Index )
+			{
+				const TurretRotationCore::TAimAngles<ScalarType> Angles = Inputs.Geometries[Index].Solve( Inputs.Targets_InAimJointSpace[Index] );
+				Checksum += Angles.Pitch + Angles.Yaw;
+			}
+		}
+		const double EndTime = GetSeconds();
+
+		// Use the checksum so the compiler can't throw the solves away.
+		if ( Checksum == ScalarType( 12345.678 ) )
+		{
+			std::printf( "Checksum: %f\n", double( Checksum ) );
+		}
+
+		return ( ( EndTime - StartTime ) * 1.e9 ) / std::max( 1, NumTurrets * NumRepeats );
+	}
+
+	/** @return Returns the average cost of one solve with the frozen baseline math, in nanoseconds. */
+	static double RunBaselineBenchmark( const TBenchmarkInputs<float>& Inputs, int NumRepeats )
+	{
+		typedef TurretRotationBaseline::FVector2 FBaselineVector2;
+
+		const int NumTurrets = int( Inputs.Geometries.size() );
+		float Checksum = 0;
+
+		const double StartTime = GetSeconds();
+		for ( int Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int Index = 0; Index < NumTurrets; ++Index )
+			{
+				const TurretRotationCore::TAimGeometry<float>& Geometry = Inputs.Geometries[Index];
+				const TurretRotationCore::TVector3<float>& Target = Inputs.Targets_InAimJointSpace[Index];
+				const FBaselineVector2 BarrelStart( Geometry.GetBarrelStartLocation2D().X, Geometry.GetBarrelStartLocation2D().Y );
+				const FBaselineVector2 BarrelEnd( Geometry.GetBarrelEndLocation2D().X, Geometry.GetBarrelEndLocation2D().Y );
+
+				float Yaw = 0.0f;
+				float Pitch = 0.0f;
+				TurretRotationBaseline::CalculateTurretRotation_InAimJointSpace( BarrelStart, BarrelEnd, Target.X, Target.Y, Target.Z, Yaw, Pitch );
+				Checksum += Pitch + Yaw;
+			}
+		}
+		const double EndTime = GetSeconds();
+
+		if ( Checksum == 12345.678f )
+		{
+			std::printf( "Checksum: %f\n", double( Checksum ) );
+		}
+
+		return ( ( EndTime - StartTime ) * 1.e9 ) / std::max( 1, NumTurrets * NumRepeats );
+	}
+
+	/**
+	 * Times the scalar solve against SolveAimBatch, on the same turrets and at the same accuracy.  This uses FPortableAimLanes, which the
+	 * compiler may or may not vectorize, so the engine's TurretRotation.Bench.Batch (on VectorRegister) is the one to trust for the speedup.
+	 *
+	 * @param Out_ScalarNanoseconds		OUT - Average cost of one scalar solve, in nanoseconds.
+	 * @param Out_BatchNanoseconds		OUT - Average cost of one turret in the batched solve, in nanoseconds.
+	 */
+	static void RunBatchBenchmark( const TBenchmarkInputs<float>& Inputs, TurretRotationCore::EAimAccuracy Accuracy, int NumRepeats, double& Out_ScalarNanoseconds, double& Out_BatchNanoseconds )
+	{
+		const int NumTurrets = int( Inputs.Geometries.size() );
+		const int NumPadded = ( ( NumTurrets + AIM_BATCH_WIDTH - 1 ) / AIM_BATCH_WIDTH ) * AIM_BATCH_WIDTH;
+
+		// Padding lanes repeat the first turret.
+		std::vector<float> TargetX( NumPadded ), TargetY( NumPadded ), TargetZ( NumPadded );
+		std::vector<float> BarrelStartX( NumPadded ), BarrelStartZ( NumPadded ), BarrelEndX( NumPadded ), BarrelEndZ( NumPadded );
+		std::vector<float> Yaw( NumPadded ), Pitch( NumPadded );
+		for ( int Index = 0; Index < NumPadded; ++Index )
+		{
+			const int TurretIndex = Index < NumTurrets ? Index : 0;
+			const TurretRotationCore::TAimGeometry<float>& Geometry = Inputs.Geometries[TurretIndex];
+			TargetX[Index] = Inputs.Targets_InAimJointSpace[TurretIndex].X;
+			TargetY[Index] = Inputs.Targets_InAimJointSpace[TurretIndex].Y;
+			TargetZ[Index] = Inputs.Targets_InAimJointSpace[TurretIndex].Z;
+			BarrelStartX[Index] = Geometry.GetBarrelStartLocation2D().X;
+			BarrelStartZ[Index] = Geometry.GetBarrelStartLocation2D().Y;
+			BarrelEndX[Index] = Geometry.GetBarrelEndLocation2D().X;
+			BarrelEndZ[Index] = Geometry.GetBarrelEndLocation2D().Y;
+		}
+
+		TurretRotationCore::FAimBatch Batch;
+		Batch.TargetX = TargetX.data();
+		Batch.TargetY = TargetY.data();
+		Batch.TargetZ = TargetZ.data();
+		Batch.BarrelStartX = BarrelStartX.data();
+		Batch.BarrelStartZ = BarrelStartZ.data();
+		Batch.BarrelEndX = BarrelEndX.data();
+		Batch.BarrelEndZ = BarrelEndZ.data();
+		Batch.Yaw = Yaw.data();
+		Batch.Pitch = Pitch.data();
+		Batch.NumTurrets = NumTurrets;
+		Batch.NumPadded = NumPadded;
+
+		float Checksum = 0;
+
+		double StartTime = GetSeconds();
+		for ( int Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			for ( int Index = 0; Index < NumTurrets; ++Index )
+			{
+				const TurretRotationCore::TAimAngles<float> Angles = Inputs.Geometries[Index].Solve( Inputs.Targets_InAimJointSpace[Index], Accuracy );
+				Checksum += Angles.Pitch + Angles.Yaw;
+			}
+		}
+		Out_ScalarNanoseconds = ( ( GetSeconds() - StartTime ) * 1.e9 ) / std::max( 1, NumTurrets * NumRepeats );
+
+		StartTime = GetSeconds();
+		for ( int Repeat = 0; Repeat < NumRepeats; ++Repeat )
+		{
+			TurretRotationCore::SolveAimBatch<TurretRotationCore::FPortableAimLanes>( Batch, Accuracy );
+			Checksum += Yaw[Repeat % NumTurrets] + Pitch[Repeat % NumTurrets];
+		}
+		Out_BatchNanoseconds = ( ( GetSeconds() - StartTime ) * 1.e9 ) / std::max( 1, NumTurrets * NumRepeats );
+
+		if ( Checksum == 12345.678f )
+		{
+			std::printf( "Checksum: %f\n", double( Checksum ) );
+		}
+	}
+
+	template<typename ScalarType>
+	static void RunSolveBenchmarks( const char* ScalarName, int NumTurrets )
+	{
+		std::mt19937 Random( 1234 );
+
+		TBenchmarkInputs<ScalarType> TypicalInputs;
+		MakeTypicalInputs( 1024, Random, TypicalInputs );
+
+		TBenchmarkInputs<ScalarType> DegenerateInputs;
+		MakeDegenerateInputs( 1024, Random, DegenerateInputs );
+
+		// The large set doesn't fit in cache, so it also measures the cost of streaming the geometry in.
+		TBenchmarkInputs<ScalarType> LargeInputs;
+		MakeTypicalInputs( NumTurrets, Random, LargeInputs );
+
+		const int SmallSetRepeats = 1000;
+		std::printf( "[%s] Typical:    %.1f ns/solve\n", ScalarName, RunSolveBenchmark( TypicalInputs, SmallSetRepeats ) );
+		std::printf( "[%s] Degenerate: %.1f ns/solve\n", ScalarName, RunSolveBenchmark( DegenerateInputs, SmallSetRepeats ) );
+		std::printf( "[%s] Large (%d): %.1f ns/solve\n", ScalarName, NumTurrets, RunSolveBenchmark( LargeInputs, 1 ) );
+	}
+}
+
+int main( int ArgC, char** ArgV )
+{
+	using namespace TurretRotationStandaloneBenchmarks;
+
+	const int NumTurrets = ArgC > 1 ? std::max( 1, std::atoi( ArgV[1] ) ) : 1000000;
+
+	RunSolveBenchmarks<float>( "float", NumTurrets );
+	RunSolveBenchmarks<double>( "double", NumTurrets );
+
+	std::mt19937 Random( 1234 );
+	TBenchmarkInputs<float> TypicalInputs;
+	MakeTypicalInputs( 1024, Random, TypicalInputs );
+	std::printf( "[baseline] Typical:    %.1f ns/solve\n", RunBaselineBenchmark( TypicalInputs, 1000 ) );
+
+	const TurretRotationCore::EAimAccuracy Accuracies[] = { TurretRotationCore::EAimAccuracy::Exact, TurretRotationCore::EAimAccuracy::Fast, TurretRotationCore::EAimAccuracy::Approximate };
+	const char* AccuracyNames[] = { "Exact", "Fast", "Approximate" };
+	for ( int AccuracyIndex = 0; AccuracyIndex < 3; ++AccuracyIndex )
+	{
+		double ScalarNanoseconds = 0.0;
+		double BatchNanoseconds = 0.0;
+		RunBatchBenchmark( TypicalInputs, Accuracies[AccuracyIndex], 1000, ScalarNanoseconds, BatchNanoseconds );
+		std::printf( "[batch] %-11s scalar %.1f ns/solve, batch %.1f ns/solve\n", AccuracyNames[AccuracyIndex], ScalarNanoseconds, BatchNanoseconds );
+	}
+	return 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "TurretRotationCore.h"
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Just enough of a test framework for the standalone tests, so CI doesn't need anything besides a compiler and CMake.
+ *
+ * Each TURRET_TEST registers itself under a group ("Core", "Accuracy", ...), and TurretRotationTests runs every test whose group matches
+ * its first argument (or every test).  TURRET_CHECK* report the failing expression (and values) and mark the test as failed, but keep
+ * going, so one run shows every broken case.
+ */
+namespace TurretRotationTests
+{
+	typedef void ( *FTestFunction )();
+
+	struct FTestInfo
+	{
+		const char* Group;
+		const char* Name;
+		FTestFunction Function;
+	};
+
+	inline std::vector<FTestInfo>& GetTests()
+	{
+		static std::vector<FTestInfo> Tests;
+		return Tests;
+	}
+
+	/** Number of failed checks in the test that is currently running. */
+	inline int& GetNumFailedChecks()
+	{
+		static int NumFailedChecks = 0;
+		return NumFailedChecks;
+	}
+
+	struct FTestRegistrar
+	{
+		FTestRegistrar( const char* Group, const char* Name, FTestFunction Function )
+		{
+			GetTests().push_back( FTestInfo{ Group, Name, Function } );
+		}
+	};
+
+	inline void ReportFailure( const char* File, int Line, const char* Message )
+	{
+		std::printf( "%s(%d): check failed: %s\n", File, Line, Message );
+		++GetNumFailedChecks();
+	}
+
+	/** @return Returns the difference between two angles (in degrees), taking wrap around into account. */
+	inline double GetAngleDifferenceDegrees( double FirstAngle, double SecondAngle )
+	{
+		const double Difference = std::fmod( std::fabs( FirstAngle - SecondAngle ), 360.0 );
+		return std::min( Difference, 360.0 - Difference );
+	}
+
+	/** Seeded random numbers, so every run checks the same inputs. */
+	class FTestRandom
+	{
+	public:
+		explicit FTestRandom( unsigned int Seed ) : Engine( Seed ) {}
+
+		float FRand() { return std::uniform_real_distribution<float>( 0.0f, 1.0f )( Engine ); }
+		float FRandRange( float Min, float Max ) { return Min + ( ( Max - Min ) * FRand() ); }
+		double DRandRange( double Min, double Max ) { return std::uniform_real_distribution<double>( Min, Max )( Engine ); }
+		unsigned int RandHelper( unsigned int Max ) { return std::uniform_int_distribution<unsigned int>( 0, Max - 1 )( Engine ); }
+
+		/** @return Returns a uniformly distributed unit vector. */
+		TurretRotationCore::TVector3<double> VRand()
+		{
+			const double Z = DRandRange( -1.0, 1.0 );
+			const double Angle = DRandRange( -TurretRotationCore::TConstants<double>::Pi(), TurretRotationCore::TConstants<double>::Pi() );
+			const double Radius = std::sqrt( std::max( 0.0, 1.0 - ( Z * Z ) ) );
+			return TurretRotationCore::TVector3<double>( Radius * std::cos( Angle ), Radius * std::sin( Angle ), Z );
+		}
+
+	private:
+		std::mt19937 Engine;
+	};
+}
+
+#define TURRET_TEST( Group, Name ) \
+	static void TurretTest_##Group##_##Name(); \
+	static const TurretRotationTests::FTestRegistrar TurretTestRegistrar_##Group##_##Name( #Group, #Name, &TurretTest_##Group##_##Name ); \
+	static void TurretTest_##Group##_##Name()
+
+#define TURRET_CHECK( Condition ) \
+	do { if ( !( Condition ) ) { TurretRotationTests::ReportFailure( __FILE__, __LINE__, #Condition ); } } while ( 0 )
+
+/** Checks Value <= Bound, and prints both if it isn't. */
+#define TURRET_CHECK_LE( Value, Bound ) \
+	do { \
+		const double TurretCheckValue = double( Value ); \
+		const double TurretCheckBound = double( Bound ); \
+		if ( !( TurretCheckValue <= TurretCheckBound ) ) \
+		{ \
+			char TurretCheckMessage[512]; \
+			std::snprintf( TurretCheckMessage, sizeof( TurretCheckMessage ), "%s <= %s (%.6g > %.6g)", #Value, #Bound, TurretCheckValue, TurretCheckBound ); \
+			TurretRotationTests::ReportFailure( __FILE__, __LINE__, TurretCheckMessage ); \
+		} \
+	} while ( 0 )
+
+#define TURRET_CHECK_EQ( Value, Expected ) \
+	do { \
+		const long long TurretCheckValue = (long long)( Value ); \
+		const long long TurretCheckExpected = (long long)( Expected ); \
+		if ( TurretCheckValue != TurretCheckExpected ) \
+		{ \
+			char TurretCheckMessage[512]; \
+			std::snprintf( TurretCheckMessage, sizeof( TurretCheckMessage ), "%s == %s (%lld != %lld)", #Value, #Expected, TurretCheckValue, TurretCheckExpected ); \
+			TurretRotationTests::ReportFailure( __FILE__, __LINE__, TurretCheckMessage ); \
+		} \
+	} while ( 0 )
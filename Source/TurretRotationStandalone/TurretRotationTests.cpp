@@ -0,0 +1,44 @@
+#include "TurretRotationTestFramework.h"
+#include <cstring>
+
+
+/**
+ * Runs the standalone tests.
+ *
+ *   TurretRotationTests				Runs every test.
+ *   TurretRotationTests <Group>		Runs every test in the group (see CMakeLists.txt for the groups that ctest runs).
+ *
+ * @return Returns 0 if every check passed, 1 otherwise.
+ */
+int main( int ArgC, char** ArgV )
+{
+	const char* Group = ArgC > 1 ? ArgV[1] : nullptr;
+
+	int NumTests = 0;
+	int NumFailedTests = 0;
+	for ( const TurretRotationTests::FTestInfo& Test : TurretRotationTests::GetTests() )
+	{
+		if ( Group && std::strcmp( Group, Test.Group ) != 0 )
+		{
+			continue;
+		}
+
+		TurretRotationTests::GetNumFailedChecks() = 0;
+		Test.Function();
+
+		const bool bPassed = TurretRotationTests::GetNumFailedChecks() == 0;
+		std::printf( "[%s] %s.%s\n", bPassed ? "passed" : "FAILED", Test.Group, Test.Name );
+
+		++NumTests;
+		NumFailedTests += bPassed ? 0 : 1;
+	}
+
+	if ( NumTests == 0 )
+	{
+		std::printf( "No tests in group %s\n", Group ? Group : "(any)" );
+		return 1;
+	}
+
+	std::printf( "%d/%d tests passed\n", NumTests - NumFailedTests, NumTests );
+	return NumFailedTests == 0 ? 0 : 1;
+}